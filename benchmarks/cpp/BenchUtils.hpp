@@ -0,0 +1,133 @@
+// benchmarks/cpp/BenchUtils.hpp
+
+#pragma once
+#include "indexes/FlatIndex.hpp"
+#include "storage/DatasetLoader.hpp"
+#include "storage/MatrixView.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// =========================================================
+// SECTION: Datasets
+// =========================================================
+
+/**
+ * @brief An owned row-major float matrix.
+ */
+struct Dataset {
+  std::vector<float> values;
+  size_t rows = 0;
+  size_t dim = 0;
+
+  MatrixView view() const {
+    MatrixView v;
+    v.data = values.data();
+    v.rows = rows;
+    v.dim = dim;
+    return v;
+  }
+
+  std::vector<float> row(size_t i) const {
+    return std::vector<float>(values.begin() + i * dim,
+                              values.begin() + (i + 1) * dim);
+  }
+};
+
+/**
+ * @brief Gaussian blobs: n_clusters random centers, rows scattered around
+ * them. Clustered data behaves like real embeddings for IVF/Annoy, unlike
+ * uniform noise where every partition is equally good.
+ */
+inline Dataset make_clustered(size_t rows, size_t dim, uint32_t seed,
+                              size_t n_clusters = 64) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> center_dist(0.0f, 3.0f);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+
+  std::vector<float> centers(n_clusters * dim);
+  for (auto &x : centers)
+    x = center_dist(rng);
+
+  Dataset ds;
+  ds.rows = rows;
+  ds.dim = dim;
+  ds.values.resize(rows * dim);
+  std::uniform_int_distribution<size_t> pick(0, n_clusters - 1);
+  for (size_t i = 0; i < rows; i++) {
+    const float *center = &centers[pick(rng) * dim];
+    for (size_t d = 0; d < dim; d++) {
+      ds.values[i * dim + d] = center[d] + noise(rng);
+    }
+  }
+  return ds;
+}
+
+/**
+ * @brief Loads an .fvecs, .bvecs or .npy file (at most max_rows rows,
+ * 0 = all) into memory.
+ */
+inline Dataset read_dataset(const std::string &path, size_t max_rows = 0) {
+  Dataset ds;
+  DatasetInfo info = probe_dataset(path);
+  ds.values.reserve(info.rows * info.dim);
+  read_vectors(
+      path,
+      [&](const float *rows, size_t n_rows, size_t dim) {
+        ds.values.insert(ds.values.end(), rows, rows + n_rows * dim);
+        ds.rows += n_rows;
+        ds.dim = dim;
+      },
+      max_rows);
+  return ds;
+}
+
+inline void normalize_rows(Dataset &ds) {
+  for (size_t i = 0; i < ds.rows; i++) {
+    normalize(&ds.values[i * ds.dim], ds.dim);
+  }
+}
+
+// =========================================================
+// SECTION: Ground truth and recall
+// =========================================================
+
+/**
+ * @brief Exact top-k ids for every query, computed with FlatIndex. Queries
+ * are independent, so they are spread over all cores.
+ */
+inline std::vector<std::vector<int>> ground_truth(const Dataset &base,
+                                                  const Dataset &queries,
+                                                  int k, Metric metric) {
+  std::vector<std::vector<int>> truth(queries.rows);
+  MatrixView view = base.view();
+  parallel_for(queries.rows, default_num_threads(),
+               [&](size_t begin, size_t end) {
+                 FlatIndex flat(metric);
+                 for (size_t q = begin; q < end; q++) {
+                   truth[q] = flat.search(view, queries.row(q), k).ids;
+                 }
+               });
+  return truth;
+}
+
+/**
+ * @brief |found ∩ truth| / |truth|.
+ */
+inline double recall_at_k(const std::vector<int> &found,
+                          const std::vector<int> &truth) {
+  if (truth.empty())
+    return 1.0;
+  std::unordered_set<int> expected(truth.begin(), truth.end());
+  size_t hits = 0;
+  for (int id : found) {
+    hits += expected.count(id);
+  }
+  return static_cast<double>(hits) / truth.size();
+}
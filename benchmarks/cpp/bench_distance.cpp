@@ -0,0 +1,55 @@
+// benchmarks/cpp/bench_distance.cpp
+//
+// Distance kernel throughput per metric and dimension. Dimensions with a
+// fixed-size specialization (128, 768, ...) can be compared against the
+// generic kernel at nearby sizes (100, 1000).
+
+#include "utils/Distance.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Scores one query against a block of rows, like a list scan. The block is
+// larger than L1 but small enough to stay in L2/L3, so this measures the
+// kernel rather than DRAM bandwidth.
+constexpr size_t kRows = 256;
+
+void BM_Distance(benchmark::State &state, Metric metric) {
+  const size_t dim = state.range(0);
+  std::mt19937 rng(7);
+  std::normal_distribution<float> dist;
+
+  std::vector<float> rows(kRows * dim);
+  std::vector<float> query(dim);
+  for (auto &x : rows)
+    x = dist(rng);
+  for (auto &x : query)
+    x = dist(rng);
+
+  DistanceFunction distance_fn = get_distance_function(metric, dim);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < kRows; i++) {
+      benchmark::DoNotOptimize(
+          distance_fn(rows.data() + i * dim, query.data(), dim));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.SetBytesProcessed(state.iterations() * kRows * dim * sizeof(float));
+}
+
+void DimensionArgs(benchmark::internal::Benchmark *b) {
+  for (int dim : {32, 64, 100, 128, 256, 384, 512, 768, 1000, 1024, 1536}) {
+    b->Arg(dim);
+  }
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Distance, l2, Metric::L2)->Apply(DimensionArgs);
+BENCHMARK_CAPTURE(BM_Distance, ip, Metric::InnerProduct)->Apply(DimensionArgs);
+BENCHMARK_CAPTURE(BM_Distance, cosine, Metric::Cosine)->Apply(DimensionArgs);
@@ -0,0 +1,162 @@
+// benchmarks/cpp/bench_index.cpp
+//
+// Build and single-query search for every index type, plus batch search
+// through VegamDB. All benchmarks share one clustered synthetic dataset
+// (50k x 128) so numbers are comparable across indexes.
+
+#include "BenchUtils.hpp"
+#include "VegamDB.hpp"
+#include "indexes/AnnoyIndex.hpp"
+#include "indexes/FlatIndex.hpp"
+#include "indexes/IVFIndex.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr size_t kRows = 50000;
+constexpr size_t kDim = 128;
+constexpr size_t kQueries = 1000;
+constexpr int kTopK = 10;
+constexpr int kClusters = 256;
+
+const Dataset &base_data() {
+  static const Dataset data = make_clustered(kRows, kDim, 1);
+  return data;
+}
+
+const Dataset &query_data() {
+  static const Dataset data = make_clustered(kQueries, kDim, 2);
+  return data;
+}
+
+// Trained indexes are cached so search benchmarks don't pay for a build
+IVFIndex &trained_ivf() {
+  static std::unique_ptr<IVFIndex> index = [] {
+    auto idx = std::make_unique<IVFIndex>(kClusters, kDim, 20);
+    idx->build(base_data().view());
+    return idx;
+  }();
+  return *index;
+}
+
+AnnoyIndex &trained_annoy() {
+  static std::unique_ptr<AnnoyIndex> index = [] {
+    auto idx = std::make_unique<AnnoyIndex>(kDim, 16, 64);
+    idx->build(base_data().view());
+    return idx;
+  }();
+  return *index;
+}
+
+// Runs each query in turn; items/s is therefore single-thread QPS
+template <typename SearchFn>
+void run_queries(benchmark::State &state, SearchFn &&search) {
+  const Dataset &queries = query_data();
+  std::vector<std::vector<float>> rows;
+  for (size_t q = 0; q < queries.rows; q++) {
+    rows.push_back(queries.row(q));
+  }
+
+  size_t q = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(search(rows[q]));
+    q = (q + 1) % rows.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// =========================================================
+// SECTION: Build
+// =========================================================
+
+void BM_IVFBuild(benchmark::State &state) {
+  for (auto _ : state) {
+    IVFIndex index(state.range(0), kDim, 20);
+    index.build(base_data().view());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+BENCHMARK(BM_IVFBuild)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+
+void BM_AnnoyBuild(benchmark::State &state) {
+  for (auto _ : state) {
+    AnnoyIndex index(kDim, state.range(0), 64);
+    index.build(base_data().view());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+BENCHMARK(BM_AnnoyBuild)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
+// =========================================================
+// SECTION: Search
+// =========================================================
+
+void BM_FlatSearch(benchmark::State &state) {
+  FlatIndex index;
+  index.build(base_data().view());
+  run_queries(state, [&](const std::vector<float> &query) {
+    return index.search(base_data().view(), query, kTopK);
+  });
+}
+BENCHMARK(BM_FlatSearch)->Unit(benchmark::kMicrosecond);
+
+void BM_IVFSearch(benchmark::State &state) {
+  IVFIndex &index = trained_ivf();
+  IVFSearchParams params;
+  params.n_probe = state.range(0);
+  run_queries(state, [&](const std::vector<float> &query) {
+    return index.search(base_data().view(), query, kTopK, &params);
+  });
+}
+BENCHMARK(BM_IVFSearch)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_AnnoySearch(benchmark::State &state) {
+  AnnoyIndex &index = trained_annoy();
+  AnnoyIndexParams params;
+  params.search_k = state.range(0);
+  params.use_priority_queue = true;
+  run_queries(state, [&](const std::vector<float> &query) {
+    return index.search(base_data().view(), query, kTopK, &params);
+  });
+}
+BENCHMARK(BM_AnnoySearch)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384)
+    ->Unit(benchmark::kMicrosecond);
+
+// =========================================================
+// SECTION: Batch search
+// The whole query set through VegamDB::search, as an application would
+// issue it. items/s is end-to-end QPS including the database layer.
+// =========================================================
+
+void BM_BatchSearch(benchmark::State &state) {
+  VegamDB db;
+  const Dataset &base = base_data();
+  db.add_vector_np(base.values.data(), base.rows, base.dim);
+  db.set_index(std::make_unique<IVFIndex>(kClusters, kDim, 20,
+                                          static_cast<int>(state.range(0))));
+  db.build_index();
+
+  const Dataset &queries = query_data();
+  std::vector<std::vector<float>> rows;
+  for (size_t q = 0; q < queries.rows; q++) {
+    rows.push_back(queries.row(q));
+  }
+
+  for (auto _ : state) {
+    for (const auto &query : rows) {
+      benchmark::DoNotOptimize(db.search(query, kTopK));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_BatchSearch)->Arg(8)->Arg(32)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,243 @@
+// benchmarks/cpp/recall_sweep.cpp
+//
+// Recall@k vs QPS sweep for IVF (over n_probe) and Annoy (over search_k).
+// Ground truth is exact FlatIndex search on the same data unless --gt is
+// given.
+//
+// Usage:
+//   vegamdb_recall [--base FILE --queries FILE [--gt FILE]] [--rows N --dim D]
+//                  [--nq N] [--k K] [--metric l2|ip|cosine]
+//                  [--index ivf|annoy|all] [--n-clusters C] [--trees T]
+//                  [--max-rows N] [--csv]
+//
+// Without --base a clustered synthetic dataset is generated. Data files may
+// be .fvecs, .bvecs (TEXMEX format, e.g. SIFT1M / BIGANN) or .npy. --gt
+// takes published ground truth (.ivecs) instead of computing it; it is only
+// valid when the whole base set is loaded (no --max-rows).
+
+#include "BenchUtils.hpp"
+#include "indexes/AnnoyIndex.hpp"
+#include "indexes/IVFIndex.hpp"
+#include "indexes/IndexBase.hpp"
+#include "storage/DatasetLoader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string base_path;
+  std::string query_path;
+  std::string gt_path;
+  size_t rows = 100000;
+  size_t dim = 128;
+  size_t n_queries = 1000;
+  size_t max_rows = 0;
+  int k = 10;
+  Metric metric = Metric::L2;
+  std::string index = "all";
+  int n_clusters = 0; // 0 = sqrt(rows)
+  int n_trees = 16;
+  bool csv = false;
+};
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+Options parse_args(int argc, char **argv) {
+  std::map<std::string, std::string> args;
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string key = argv[i];
+    if (key == "--csv") {
+      opts.csv = true;
+    } else if (key.rfind("--", 0) == 0 && i + 1 < argc) {
+      args[key] = argv[++i];
+    } else {
+      std::fprintf(stderr, "Unknown argument: %s\n", key.c_str());
+      std::exit(2);
+    }
+  }
+
+  auto get = [&](const std::string &key, const std::string &fallback) {
+    auto it = args.find(key);
+    return it == args.end() ? fallback : it->second;
+  };
+
+  opts.base_path = get("--base", "");
+  opts.query_path = get("--queries", "");
+  opts.gt_path = get("--gt", "");
+  opts.rows = std::stoul(get("--rows", std::to_string(opts.rows)));
+  opts.dim = std::stoul(get("--dim", std::to_string(opts.dim)));
+  opts.n_queries = std::stoul(get("--nq", std::to_string(opts.n_queries)));
+  opts.max_rows = std::stoul(get("--max-rows", "0"));
+  opts.k = std::stoi(get("--k", std::to_string(opts.k)));
+  opts.index = get("--index", opts.index);
+  opts.n_clusters = std::stoi(get("--n-clusters", "0"));
+  opts.n_trees = std::stoi(get("--trees", std::to_string(opts.n_trees)));
+
+  std::string metric = get("--metric", "l2");
+  if (metric == "ip") {
+    opts.metric = Metric::InnerProduct;
+  } else if (metric == "cosine") {
+    opts.metric = Metric::Cosine;
+  } else {
+    opts.metric = Metric::L2;
+  }
+  return opts;
+}
+
+struct SweepPoint {
+  std::string index;
+  std::string param;
+  int value;
+  double recall;
+  double qps;
+  double mean_latency_us;
+};
+
+SweepPoint measure(IndexBase &index, const Dataset &base,
+                   const Dataset &queries,
+                   const std::vector<std::vector<int>> &truth, int k,
+                   const SearchParams *params) {
+  std::vector<std::vector<float>> rows;
+  for (size_t q = 0; q < queries.rows; q++) {
+    rows.push_back(queries.row(q));
+  }
+
+  double recall_sum = 0.0;
+  auto start = Clock::now();
+  std::vector<SearchResults> results(rows.size());
+  for (size_t q = 0; q < rows.size(); q++) {
+    results[q] = index.search(base.view(), rows[q], k, params);
+  }
+  double elapsed = seconds_since(start);
+
+  for (size_t q = 0; q < rows.size(); q++) {
+    recall_sum += recall_at_k(results[q].ids, truth[q]);
+  }
+
+  SweepPoint point;
+  point.recall = recall_sum / rows.size();
+  point.qps = rows.size() / elapsed;
+  point.mean_latency_us = elapsed * 1e6 / rows.size();
+  return point;
+}
+
+void print_header(bool csv) {
+  if (csv) {
+    std::printf("index,param,value,recall,qps,latency_us\n");
+  } else {
+    std::printf("%-8s %-10s %8s %10s %12s %12s\n", "index", "param", "value",
+                "recall", "QPS", "latency_us");
+  }
+}
+
+void print_point(const SweepPoint &p, bool csv) {
+  if (csv) {
+    std::printf("%s,%s,%d,%.4f,%.1f,%.1f\n", p.index.c_str(),
+                p.param.c_str(), p.value, p.recall, p.qps, p.mean_latency_us);
+  } else {
+    std::printf("%-8s %-10s %8d %10.4f %12.1f %12.1f\n", p.index.c_str(),
+                p.param.c_str(), p.value, p.recall, p.qps, p.mean_latency_us);
+  }
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opts = parse_args(argc, argv);
+
+  Dataset base, queries;
+  if (!opts.base_path.empty()) {
+    base = read_dataset(opts.base_path, opts.max_rows);
+    queries = opts.query_path.empty()
+                  ? make_clustered(opts.n_queries, base.dim, 2)
+                  : read_dataset(opts.query_path, opts.n_queries);
+  } else {
+    base = make_clustered(opts.rows, opts.dim, 1);
+    queries = make_clustered(opts.n_queries, opts.dim, 2);
+  }
+
+  // Cosine databases store unit vectors; mirror what VegamDB does
+  if (opts.metric == Metric::Cosine) {
+    normalize_rows(base);
+    normalize_rows(queries);
+  }
+
+  int n_clusters = opts.n_clusters > 0
+                       ? opts.n_clusters
+                       : std::max(1, static_cast<int>(std::sqrt(base.rows)));
+
+  std::fprintf(stderr, "base %zu x %zu, %zu queries, k=%d, metric=%s\n",
+               base.rows, base.dim, queries.rows, opts.k,
+               metric_name(opts.metric).c_str());
+
+  std::vector<std::vector<int>> truth;
+  if (!opts.gt_path.empty()) {
+    // Published lists are usually top-100; recall@k uses the first k
+    truth = read_ivecs(opts.gt_path, queries.rows);
+    for (auto &row : truth) {
+      row.resize(std::min(row.size(), static_cast<size_t>(opts.k)));
+    }
+  } else {
+    std::fprintf(stderr, "computing ground truth...\n");
+    truth = ground_truth(base, queries, opts.k, opts.metric);
+  }
+
+  print_header(opts.csv);
+
+  if (opts.index == "ivf" || opts.index == "all") {
+    IVFIndex ivf(n_clusters, base.dim, 20, 1, opts.metric);
+    auto start = Clock::now();
+    ivf.build(base.view());
+    std::fprintf(stderr, "IVF build (%d lists): %.2fs\n", n_clusters,
+                 seconds_since(start));
+
+    for (int n_probe = 1; n_probe <= n_clusters; n_probe *= 2) {
+      IVFSearchParams params;
+      params.n_probe = n_probe;
+      SweepPoint p = measure(ivf, base, queries, truth, opts.k, &params);
+      p.index = "ivf";
+      p.param = "n_probe";
+      p.value = n_probe;
+      print_point(p, opts.csv);
+      if (p.recall >= 0.999)
+        break;
+    }
+  }
+
+  if (opts.index == "annoy" || opts.index == "all") {
+    AnnoyIndex annoy(base.dim, opts.n_trees, 64, -1, true, opts.metric);
+    auto start = Clock::now();
+    annoy.build(base.view());
+    std::fprintf(stderr, "Annoy build (%d trees): %.2fs\n", opts.n_trees,
+                 seconds_since(start));
+
+    for (int search_k = 10 * opts.k; search_k <= static_cast<int>(base.rows);
+         search_k *= 2) {
+      AnnoyIndexParams params;
+      params.search_k = search_k;
+      params.use_priority_queue = true;
+      SweepPoint p = measure(annoy, base, queries, truth, opts.k, &params);
+      p.index = "annoy";
+      p.param = "search_k";
+      p.value = search_k;
+      print_point(p, opts.csv);
+      if (p.recall >= 0.999)
+        break;
+    }
+  }
+
+  return 0;
+}
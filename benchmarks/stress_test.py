@@ -20,8 +20,7 @@ def run_benchmark(n_vectors, dim=128):
     # 3. Ingestion Test
     print("-> Testing Ingestion...")
     start = time.time()
-    for i in range(n_vectors):
-        db.add_vector_numpy(data[i])
+    db.add_vector_numpy(data)
     duration = time.time() - start
     print(f"   Ingestion Time: {duration:.4f}s")
     print(f"   Throughput:     {n_vectors / duration:,.0f} vectors/sec")
@@ -0,0 +1,134 @@
+// include/ShardedVegamDB.hpp
+
+#pragma once
+
+#include "VegamDB.hpp"
+#include "indexes/IndexBase.hpp"
+#include "utils/Bitmap.hpp"
+#include "utils/Stats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// =========================================================
+// SECTION: Sharded database
+// Vectors are partitioned across N independent VegamDB shards. Each shard
+// owns its rows and its index, so shards build (and rebuild) on their own
+// threads and a search fans out to all of them before merging the top-k.
+//
+// Ids are global and assigned in insertion order, as in VegamDB. Within a
+// shard, rows keep the relative order of their global ids, so the
+// global <-> local mapping is a pure function of the policy and the row
+// count; load() rebuilds it without storing it.
+// =========================================================
+
+enum class ShardPolicy : uint32_t {
+  Hash = 0, // Shard of id i: mix(i) % N. Spreads every batch evenly
+  Range = 1 // Runs of `range_size` consecutive ids, dealt round-robin
+};
+
+class ShardedVegamDB {
+private:
+  // Shared, so a shard handed out by shard() outlives a load() that
+  // replaces it
+  std::vector<std::shared_ptr<VegamDB>> shards_;
+  ShardPolicy policy_;
+  size_t range_size_;
+  Metric metric_;
+  int dimension_ = 0;
+
+  // Global id -> (shard, row in shard), and each shard's rows -> global id
+  std::vector<uint32_t> shard_of_;
+  std::vector<int> local_of_;
+  std::vector<std::vector<int>> global_ids_;
+
+  // Guards the id mapping: adds and loads take it exclusively, searches
+  // and removes share it. Each shard has its own lock for its data.
+  mutable std::shared_mutex mutex_;
+
+  SearchStatsAggregator search_stats_;
+
+public:
+  /**
+   * @throws std::invalid_argument if n_shards or range_size is 0.
+   */
+  explicit ShardedVegamDB(size_t n_shards,
+                          ShardPolicy policy = ShardPolicy::Hash,
+                          Metric metric = Metric::L2,
+                          size_t range_size = 4096);
+
+  // Configuration; load() replaces it, so these take the lock
+  size_t shard_count() const;
+  ShardPolicy policy() const;
+  size_t range_size() const;
+  Metric metric() const;
+
+  /**
+   * @brief Shard `i`, to give it its own index (set_index) or inspect it.
+   * Its ids are local; global_id() translates them. The caller shares
+   * ownership: after load() replaces the shards, the returned one stays
+   * valid but is no longer part of this database.
+   * @throws std::out_of_range if i >= shard_count().
+   */
+  std::shared_ptr<VegamDB> shard(size_t i) const;
+  size_t shard_of(int id) const;
+  int global_id(size_t shard, int local_id) const;
+
+  // Data. Rows are routed to their shards and each shard's batch is
+  // added on its own thread.
+  void add_vector(const std::vector<float> &vec);
+  void add_vector_np(const float *arr, size_t n_vectors, size_t dim);
+  // Rows ever added, over all shards
+  int size() const;
+  int dimension() const;
+
+  // Tombstones global ids in their shards (see VegamDB::remove).
+  void remove(const std::vector<int> &ids);
+  bool is_deleted(int id) const;
+  size_t deleted_count() const;
+
+  // Index management. set_index() gives every shard an index from
+  // `make_index`; shard(i).set_index() overrides one of them.
+  void
+  set_index(const std::function<std::unique_ptr<IndexBase>()> &make_index);
+  // Builds every non-empty shard in parallel. Shards without an index get
+  // a flat one. Rethrows the first shard's error after all have finished.
+  void build_index();
+  void build_shard(size_t i);
+
+  /**
+   * @brief Searches every non-empty shard concurrently and merges their
+   * top-k. `filter` holds global ids. `stats` gets the counters summed
+   * over shards and, for phases, the slowest shard's time.
+   */
+  SearchResults search(const std::vector<float> &query, int k,
+                       const SearchParams *params = nullptr,
+                       const Bitmap *filter = nullptr,
+                       SearchStats *stats = nullptr);
+
+  SearchStatsSummary search_stats() const;
+  void reset_search_stats();
+
+  // Persistence. save() writes each shard, in parallel, to
+  // `filename`.g<N>.shard<i> for a new generation N, then a small
+  // manifest to `filename`, then deletes the previous generation's
+  // shards; a crash mid-save leaves the previous snapshot loadable.
+  // load() replaces this database's shards and configuration with the
+  // saved ones. Both throw std::runtime_error on I/O errors or a
+  // mismatched shard.
+  void save(const std::string &filename,
+            const SaveOptions &options = SaveOptions());
+  void load(const std::string &filename);
+
+private:
+  size_t route(size_t id) const;
+  // Callers hold mutex_ exclusively
+  void assign_ids(size_t first, size_t end);
+  void reset_mapping();
+  // Callers hold mutex_
+  void build_shard_locked(size_t i);
+};
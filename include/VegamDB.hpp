@@ -2,32 +2,187 @@
 
 #pragma once
 
+#include "indexes/IVFIndex.hpp"
 #include "indexes/IndexBase.hpp"
+#include "storage/Predicate.hpp"
+#include "storage/Snapshot.hpp"
 #include "storage/VectorStore.hpp"
+#include "storage/WriteAheadLog.hpp"
+#include "utils/Progress.hpp"
+#include "utils/Stats.hpp"
 #include <cstddef>
+#include <cstdint>
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
 class VegamDB {
 private:
   VectorStore store_;
   std::unique_ptr<IndexBase> index_;
+  Metric metric_ = Metric::L2;
+
+  // Bumped under the writer lock whenever index_ is replaced, rebuilt or
+  // reloaded. A freed index's address can be reused, so code that drops
+  // the lock compares this rather than the pointer.
+  uint64_t index_generation_ = 0;
+
+  // Searches and other reads share the lock; adds, index changes, builds
+  // and loads take it exclusively. The bindings release the GIL around
+  // long calls, so Python threads can reach the database concurrently.
+  mutable std::shared_mutex mutex_;
+
+  // Running totals over every search() call (lock-free)
+  SearchStatsAggregator search_stats_;
+
+  // Progress of the current or last build; has its own synchronization so
+  // it can be polled while build_index() holds the lock.
+  BuildProgress build_progress_;
+
+  // Optional log of adds/removes made since the snapshot at
+  // `wal_snapshot_` (see enable_wal()). `applied_lsn_` is the LSN of the
+  // last logged mutation reflected here; snapshots record it so load()
+  // replays only newer records.
+  std::unique_ptr<WriteAheadLog> wal_;
+  std::string wal_snapshot_;
+  uint64_t applied_lsn_ = 0;
+
+  // Serializes save(): saves share a temp file name and may empty the log
+  std::mutex save_mutex_;
 
 public:
-  VegamDB() = default;
+  explicit VegamDB(Metric metric = Metric::L2);
+
+  // load() can replace it, so this takes the lock
+  Metric metric() const;
 
-  // Data
+  // Data. When the index supports incremental adds (HNSWIndex) and is
+  // built, new rows are linked into it before these return: in parallel
+  // for large batches, and without blocking concurrent searches.
   void add_vector(const std::vector<float> &vec);
   void add_vector_np(const float *arr, size_t n_vectors, size_t dim);
+
+  // Streams vectors from an .fvecs/.bvecs/.npy file straight into the
+  // store (see DatasetLoader.hpp). Returns the number of vectors added.
+  // A failure part way through adds (and logs) nothing.
+  size_t add_from_file(const std::string &path, size_t max_rows = 0);
+
+  // Searches a caller-owned buffer in place instead of copying it; `owner`
+  // keeps it alive. The database must be empty and becomes read-only.
+  void attach_external(const float *arr, size_t n_vectors, size_t dim,
+                       std::shared_ptr<const void> owner);
+  bool is_external() const;
+  // Rows ever added; removed rows keep their ids and are still counted
   int size() const;
   int dimension() const;
 
+  // Removal. Removed rows are tombstoned: every search skips them as if
+  // filtered out, and their ids are never reused. Throws
+  // std::invalid_argument for an out-of-range id.
+  void remove(const std::vector<int> &ids);
+  bool is_deleted(int id) const;
+  size_t deleted_count() const;
+
+  // Attributes (one value per vector, in insertion order)
+  void set_int_attribute(const std::string &name,
+                         const std::vector<int64_t> &values);
+  void set_float_attribute(const std::string &name,
+                           const std::vector<float> &values);
+  void set_string_attribute(const std::string &name,
+                            const std::vector<std::string> &values);
+  std::vector<std::string> attribute_names() const;
+  std::shared_ptr<const Bitmap> evaluate(const Predicate &predicate) const;
+
   // Index management
   void set_index(std::unique_ptr<IndexBase> index);
   void build_index();
   IndexBase *get_index();
 
+  // List sizes of the current IVF index, read under the lock.
+  // @throws std::runtime_error if the index is not an IVFIndex.
+  std::vector<size_t> ivf_list_sizes() const;
+  ListSizeStats ivf_list_size_stats() const;
+
+  // Snapshot of the current (or last finished) build. Safe to call from
+  // any thread while build_index() runs.
+  BuildProgressSnapshot build_progress() const;
+  // Called on the building thread at each phase change and periodically
+  // within a phase. Pass an empty function to remove it.
+  void set_build_callback(BuildProgressCallback callback);
+
+  // `filter` restricts results to the allowed ids (see IndexBase::search).
+  // `stats`, if given, is overwritten with this query's statistics.
   SearchResults search(const std::vector<float> &query, int k,
-                       const SearchParams *params = nullptr);
-  // Persistence
-  void save(const std::string &filename);
+                       const SearchParams *params = nullptr,
+                       const Bitmap *filter = nullptr,
+                       SearchStats *stats = nullptr);
+  SearchResults search(const std::vector<float> &query, int k,
+                       const SearchParams *params, const Predicate &where,
+                       SearchStats *stats = nullptr);
+
+  // Aggregate search statistics since construction or the last reset
+  SearchStatsSummary search_stats() const;
+  void reset_search_stats();
+  // Persistence. save() writes a versioned snapshot with a CRC32C per
+  // section (see Snapshot.hpp) to a temp file, fsyncs it and renames it
+  // over `filename`, so a crash leaves the old or the new snapshot intact.
+  // load() verifies it before replacing any state, still reads files from
+  // before the format existed, and then replays `filename`.wal if present.
+  // `options` selects compression and parallel section serialization.
+  // Both throw std::runtime_error on I/O errors or corruption.
+  void save(const std::string &filename,
+            const SaveOptions &options = SaveOptions());
   void load(const std::string &filename);
+
+  /**
+   * @brief Logs every later add/remove to `snapshot_path`.wal before
+   * applying it. save(snapshot_path) checkpoints: the log is emptied once
+   * the new snapshot is durable. When reopening, load() the snapshot
+   * before enabling the log. With `sync`, each logged call is fsynced
+   * before it returns. Attribute changes are not logged.
+   * @throws std::runtime_error if the log cannot be opened, or holds
+   *         records this database has not applied.
+   */
+  void enable_wal(const std::string &snapshot_path, bool sync = true);
+  void disable_wal();
+  bool wal_enabled() const;
+
+private:
+  void check_attribute_length(size_t n_values) const;
+  // Callers hold mutex_ exclusively
+  void set_index_locked(std::unique_ptr<IndexBase> index);
+  void build_index_locked();
+  // Callers hold mutex_
+  const IVFIndex &ivf_index_locked() const;
+  // Hands rows [first, size()) to an index that supports add(); releases
+  // `lock` and links them under the reader lock
+  void index_added_rows(std::unique_lock<std::shared_mutex> &lock,
+                        size_t first);
+  void write_snapshot(std::ostream &out, const SaveOptions &options) const;
+
+  // Everything load() reads, decoded aside and swapped in only once the
+  // snapshot and the log have both succeeded
+  struct LoadedState {
+    VectorStore store;
+    std::unique_ptr<IndexBase> index;
+    uint64_t applied_lsn = 0;
+    Metric metric = Metric::L2;
+  };
+  // With `map_vectors`, a DiskANN snapshot's rows stay in the mapped file
+  void load_snapshot(const std::string &filename, bool map_vectors,
+                     LoadedState &loaded) const;
+  void load_legacy(std::istream &in, LoadedState &loaded) const;
+  static void replay_wal(const std::string &path, LoadedState &loaded);
+  // Callers hold mutex_. Throws std::invalid_argument unless the query
+  // has the stored rows' dimension.
+  void check_query_locked(const std::vector<float> &query) const;
+  const Bitmap *live_filter(const Bitmap *filter, Bitmap &scratch) const;
+  // Callers hold mutex_ exclusively
+  void commit_loaded(LoadedState &loaded);
+  // Checks and normalizes the query, then searches, all under the lock
+  SearchResults search_prepared(const std::vector<float> &query, int k,
+                                const SearchParams *params,
+                                const Bitmap *filter, SearchStats *stats);
 };
\ No newline at end of file
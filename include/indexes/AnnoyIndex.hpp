@@ -2,7 +2,8 @@
 
 #pragma once
 #include "indexes/IndexBase.hpp"
-#include <fstream>
+#include <istream>
+#include <ostream>
 #include <random>
 #include <string>
 #include <vector>
@@ -50,25 +51,30 @@ private:
 
 public:
   AnnoyIndex(int dimension, int num_trees, int k_leaf, int search_k = -1,
-             bool use_priority_queue = true);
+             bool use_priority_queue = true, Metric metric = Metric::L2);
   ~AnnoyIndex();
-  virtual void build(const std::vector<std::vector<float>> &data) override;
-  virtual SearchResults search(const std::vector<std::vector<float>> &data,
+  virtual void build(const MatrixView &data,
+                     BuildProgress *progress = nullptr) override;
+  virtual SearchResults search(const MatrixView &data,
                                const std::vector<float> &query, int k,
-                               const SearchParams *params = nullptr) override;
+                               const SearchParams *params = nullptr,
+                               const Bitmap *filter = nullptr,
+                               SearchStats *stats = nullptr) override;
   virtual bool is_trained() const override;
-  virtual void save(std::ofstream &out) const override;
-  virtual void load(std::ifstream &in) override;
+  virtual void save(std::ostream &out) const override;
+  virtual void load(std::istream &in) override;
+  // Re-ranks the dimension blocks, which are not saved
+  virtual void after_load(const MatrixView &data) override;
   virtual std::string name() const override { return "AnnoyIndex"; };
 
 private:
-  AnnoyNode *build_tree_recursive(const std::vector<std::vector<float>> &data,
+  AnnoyNode *build_tree_recursive(const MatrixView &data,
                                   std::vector<int> &indices, std::mt19937 &rng);
   void free_tree(AnnoyNode *node);
-  float get_margin(HyperPlane *hyperplane, const std::vector<float> &x);
-  void create_hyperplane_for_split(const std::vector<std::vector<float>> &data,
+  float get_margin(HyperPlane *hyperplane, const float *x);
+  void create_hyperplane_for_split(const MatrixView &data,
                                    std::vector<int> &indices,
                                    HyperPlane *hyperplane, std::mt19937 &rng);
-  void save_node(std::ofstream &out, AnnoyNode *node) const;
-  AnnoyNode *load_node(std::ifstream &in);
+  void save_node(std::vector<char> &out, AnnoyNode *node) const;
+  AnnoyNode *load_node(std::istream &in);
 };
\ No newline at end of file
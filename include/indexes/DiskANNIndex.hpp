@@ -0,0 +1,97 @@
+// include/indexes/DiskANNIndex.hpp
+
+#pragma once
+#include "indexes/IndexBase.hpp"
+#include "indexes/ProductQuantizer.hpp"
+#include "utils/BlockReader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct DiskANNSearchParams : public SearchParams {
+  int search_list = 100; // Candidate list size L (raised to k if smaller)
+  int beam_width = 4;    // Nodes fetched from disk per round trip
+};
+
+/**
+ * @brief Disk-resident graph index in the style of DiskANN.
+ * build() constructs a Vamana graph (greedy search plus alpha-pruning,
+ * two passes) and writes it to `graph_path`: one sector-aligned block per
+ * node holding its full-precision vector and neighbor list. Only the PQ
+ * codes (pq_subspaces bytes per vector) stay in memory.
+ * search() is a beam search: candidates are ranked by PQ distance, the
+ * `beam_width` best unexpanded nodes are read in one batch per round
+ * (io_uring where available), and the results are reranked with the full
+ * vectors from the blocks read.
+ * Snapshots store the PQ data and the graph path; the graph file itself
+ * must stay where it was built.
+ */
+class DiskANNIndex : public IndexBase {
+private:
+  int dimension;
+  std::string graph_path;
+
+  // ----- Build Args -----
+  int max_degree;   // R: neighbors per node
+  int build_list;   // L used by the construction searches
+  float alpha;      // Pruning slack; > 1 keeps long-range edges
+  int pq_subspaces; // PQ code bytes per vector (0: dimension / 4)
+
+  // ----- Search Args -----
+  int search_list;
+  int beam_width;
+
+  // ----- Trained State -----
+  uint64_t n_nodes = 0;
+  uint32_t entry_point = 0;
+  ProductQuantizer pq;
+  std::vector<uint8_t> codes; // n_nodes x pq.code_size()
+  std::unique_ptr<BlockReader> reader;
+
+  // Graph file layout, derived from the header (see DiskANNIndex.cpp)
+  size_t node_bytes = 0;
+  size_t nodes_per_sector = 0; // > 0 when several nodes share a sector
+  size_t sectors_per_node = 0; // > 0 when a node spans several sectors
+
+public:
+  DiskANNIndex(int dimension, const std::string &graph_path,
+               int max_degree = 64, int build_list = 100, float alpha = 1.2f,
+               int search_list = 100, int beam_width = 4,
+               int pq_subspaces = 0, Metric metric = Metric::L2);
+
+  virtual void build(const MatrixView &data,
+                     BuildProgress *progress = nullptr) override;
+  virtual SearchResults search(const MatrixView &data,
+                               const std::vector<float> &query, int k,
+                               const SearchParams *params = nullptr,
+                               const Bitmap *filter = nullptr,
+                               SearchStats *stats = nullptr) override;
+
+  virtual bool is_trained() const override;
+  virtual void save(std::ostream &out) const override;
+  virtual void load(std::istream &in) override;
+  virtual std::string name() const override { return "DiskANNIndex"; };
+
+  const std::string &path() const { return graph_path; }
+  bool uses_io_uring() const { return reader && reader->uses_io_uring(); }
+
+private:
+  void write_graph(const MatrixView &data,
+                   const std::vector<std::vector<uint32_t>> &graph,
+                   BuildProgress *progress) const;
+  void open_graph();
+
+  // Byte range of node `id`'s block, and its offset inside that range
+  uint64_t block_offset(uint64_t id) const;
+  size_t block_length() const;
+  size_t offset_in_block(uint64_t id) const;
+
+  // Exact top-k over the allowed nodes, read block by block from the graph
+  // file, so a filtered search never touches the in-memory rows
+  SearchResults search_allowed(const std::vector<float> &query, int k,
+                               const Bitmap &filter, SearchStats *stats) const;
+};
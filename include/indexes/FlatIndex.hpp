@@ -2,7 +2,9 @@
 
 #pragma once
 #include "IndexBase.hpp"
-#include <fstream>
+#include <cstdint>
+#include <istream>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -17,14 +19,33 @@
 
 class FlatIndex : public IndexBase {
 public:
-  void build(const std::vector<std::vector<float>> &data) override;
+  explicit FlatIndex(Metric metric = Metric::L2);
 
-  SearchResults search(const std::vector<std::vector<float>> &data,
+  void build(const MatrixView &data,
+             BuildProgress *progress = nullptr) override;
+
+  SearchResults search(const MatrixView &data,
                        const std::vector<float> &query, int k,
-                       const SearchParams *params = nullptr) override;
+                       const SearchParams *params = nullptr,
+                       const Bitmap *filter = nullptr,
+                       SearchStats *stats = nullptr) override;
+
+  // Exact search restricted to the ids set in `allowed`: the same split,
+  // early-abandoning scan as search(), walking the bitmap's set bits
+  // block by block, so distances are computed for allowed rows only.
+  // `order` is the caller's dimension block order, if it has one.
+  // Approximate indexes fall back to this when a filter is very selective.
+  static SearchResults search_allowed(const MatrixView &data,
+                                      const std::vector<float> &query, int k,
+                                      const Bitmap &allowed,
+                                      Metric metric = Metric::L2,
+                                      SearchStats *stats = nullptr,
+                                      const uint32_t *order = nullptr);
 
   bool is_trained() const override;
-  void save(std::ofstream &out) const override;
-  void load(std::ifstream &in) override;
+  void save(std::ostream &out) const override;
+  void load(std::istream &in) override;
+  // Nothing is saved, so the kernel and block order are set up again
+  void after_load(const MatrixView &data) override;
   std::string name() const override { return "FlatIndex"; };
 };
\ No newline at end of file
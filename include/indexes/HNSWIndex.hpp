@@ -0,0 +1,137 @@
+// include/indexes/HNSWIndex.hpp
+
+#pragma once
+#include "indexes/IndexBase.hpp"
+#include "utils/HugePages.hpp"
+#include "utils/SpinLock.hpp"
+#include "utils/VisitMarks.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HNSWSearchParams : public SearchParams {
+  int ef_search = 50; // Candidate list size (raised to k if smaller)
+};
+
+/**
+ * @brief In-memory Hierarchical Navigable Small World graph.
+ * Each node gets a random top layer (geometric, factor 1/ln M) and up to
+ * M links per upper layer, 2M on layer 0, chosen by the neighbor
+ * selection heuristic. search() descends greedily to layer 0 and runs a
+ * best-first search with ef_search candidates.
+ *
+ * Inserts are concurrent: build() links all rows on every core, and
+ * add() links new rows while searches run. Every node has its own
+ * SpinLock guarding its neighbor lists; searchers copy a list under the
+ * lock and release it before computing distances. Only an insert that
+ * raises the top layer serializes on the entry point.
+ */
+class HNSWIndex : public IndexBase {
+private:
+  // ----- Build Args -----
+  int M;               // Links per node on upper layers (2M on layer 0)
+  int ef_construction; // Candidate list size while inserting
+
+  // ----- Search Args -----
+  int ef_search;
+
+  // ----- Graph -----
+  int dimension = 0;
+  bool trained = false;
+  uint64_t level_seed = 0;
+
+  // Storage for `capacity` nodes; grown only by reserve()
+  size_t capacity = 0;
+  // capacity x (1 + 2M): count, then ids. On huge pages once large.
+  std::vector<uint32_t, HugePageAllocator<uint32_t>> level0;
+  std::vector<int> levels;         // Top layer per node; -1 if not inserted
+  std::vector<std::vector<uint32_t>> upper; // Layers 1..level x (1 + M)
+  std::unique_ptr<SpinLock[]> locks;
+  std::atomic<size_t> n_inserted{0};
+
+  // Entry node and its top layer packed as (layer << 32 | id), or
+  // kNoEntry while the graph is empty. Written under entry_mutex.
+  std::atomic<uint64_t> entry{0};
+  std::mutex entry_mutex;
+
+  // add() holds this shared; save() and reserve() take it exclusively
+  mutable std::shared_mutex graph_mutex;
+
+  // Visited sets reused across searches and inserts
+  std::vector<std::unique_ptr<VisitMarks>> marks_pool;
+  std::mutex marks_mutex;
+
+public:
+  HNSWIndex(int M = 16, int ef_construction = 200, int ef_search = 50,
+            Metric metric = Metric::L2);
+
+  virtual void build(const MatrixView &data,
+                     BuildProgress *progress = nullptr) override;
+  virtual SearchResults search(const MatrixView &data,
+                               const std::vector<float> &query, int k,
+                               const SearchParams *params = nullptr,
+                               const Bitmap *filter = nullptr,
+                               SearchStats *stats = nullptr) override;
+
+  virtual bool supports_add() const override { return true; }
+  virtual void reserve(size_t n_rows) override;
+  virtual void add(const MatrixView &data, size_t begin,
+                   size_t end) override;
+
+  virtual bool is_trained() const override;
+  virtual void save(std::ostream &out) const override;
+  virtual void load(std::istream &in) override;
+  // Links rows the saved graph is missing: save() can run after the store
+  // took a batch but before add() linked it
+  virtual void after_load(const MatrixView &data) override;
+  virtual std::string name() const override { return "HNSWIndex"; };
+
+  // Rows linked into the graph so far
+  size_t size() const { return n_inserted.load(std::memory_order_relaxed); }
+
+private:
+  using Scored = std::pair<float, uint32_t>; // (distance, id)
+
+  void clear_graph();
+  void insert(const MatrixView &data, uint32_t id, VisitMarks &marks);
+  int random_level(uint32_t id) const;
+  size_t max_links(int layer) const;
+
+  // Neighbor list of `id` at `layer`: [count, ids...]. Callers hold the
+  // node's lock.
+  uint32_t *links(uint32_t id, int layer);
+  const uint32_t *links(uint32_t id, int layer) const;
+  void copy_links(uint32_t id, int layer, std::vector<uint32_t> &out);
+
+  // Greedy walk towards `query` on one layer, starting from `current`
+  uint32_t greedy_step(const MatrixView &data, const float *query,
+                       uint32_t current, float &current_distance, int layer,
+                       SearchStats *stats);
+
+  // Best-first search on one layer; returns up to `ef` nodes, closest
+  // first. With a filter only allowed nodes are returned, but all are
+  // traversed.
+  std::vector<Scored> search_layer(const MatrixView &data, const float *query,
+                                   uint32_t start, float start_distance,
+                                   int layer, size_t ef, VisitMarks &marks,
+                                   const Bitmap *filter, SearchStats *stats);
+
+  // Neighbor selection heuristic: keeps a candidate only if it is closer
+  // to the base node than to every candidate kept so far
+  void select_neighbors(const MatrixView &data, std::vector<Scored> &candidates,
+                        size_t max_count) const;
+
+  void link_back(const MatrixView &data, uint32_t neighbor, uint32_t id,
+                 int layer);
+
+  std::unique_ptr<VisitMarks> acquire_marks();
+  void release_marks(std::unique_ptr<VisitMarks> marks);
+};
@@ -2,18 +2,80 @@
 
 #pragma once
 #include "IndexBase.hpp"
+#include "indexes/HNSWIndex.hpp"
+#include "indexes/ScalarQuantizer.hpp"
+#include "utils/HugePages.hpp"
+#include <cstdint>
+#include <memory>
+#include <utility>
 
 struct IVFSearchParams : public SearchParams {
   int n_probe = 1;
+  // Candidate list size of the HNSW coarse quantizer
+  // (0: max(64, 8 * n_probe))
+  int coarse_ef = 0;
+  // SQ8 storage: re-score the best k * rerank_factor code distances with
+  // the full vectors (0: return the code distances as they are)
+  int rerank_factor = 0;
+};
+
+/**
+ * @brief How IVFIndex finds the lists to probe.
+ *  - Flat: scores every centroid and keeps the n_probe closest. Exact.
+ *  - HNSW: searches a small HNSW graph over the centroids, so ranking
+ *    costs O(log n_clusters) instead of O(n_clusters). Worth it from
+ *    about 16k clusters; may occasionally miss one of the true closest.
+ */
+enum class CoarseQuantizer { Flat = 0, HNSW = 1 };
+
+/**
+ * @brief What IVFIndex lists hold besides the ids.
+ *  - Full: nothing; scans read the rows from the VectorStore.
+ *  - SQ8: each row's residual to its centroid as one byte per dimension,
+ *    stored in list order, so scans read a quarter of the bytes,
+ *    sequentially. Distances are approximate; IVFSearchParams
+ *    rerank_factor re-scores the best of them exactly.
+ */
+enum class IVFStorage { Full = 0, SQ8 = 1 };
+
+/**
+ * @brief Distribution of IVF list sizes, in rows. A query's scan cost is
+ * the size of the lists it probes, so `max` and the upper percentiles
+ * bound its tail latency; imbalance = max / mean (1: perfectly even).
+ */
+struct ListSizeStats {
+  size_t lists = 0;
+  size_t empty = 0;
+  size_t min = 0;
+  size_t max = 0;
+  double mean = 0.0;
+  double stddev = 0.0;
+  size_t p50 = 0;
+  size_t p90 = 0;
+  size_t p99 = 0;
+  double imbalance = 0.0;
 };
 
 class IVFIndex : public IndexBase {
 private:
-  // The Cluster Centers (K vectors)
-  std::vector<std::vector<float>> centroids;
+  // The Cluster Centers, row-major (K x dimension)
+  std::vector<float> centroids;
 
-  // The Buckets (K lists of vector IDs)
-  std::vector<std::vector<int>> inverted_index;
+  // Graph over the centroids when quantizer == HNSW
+  CoarseQuantizer quantizer;
+  std::unique_ptr<HNSWIndex> coarse_graph;
+
+  // The Buckets (K lists of vector IDs), back to back in one array: list
+  // i is list_ids[list_offsets[i], list_offsets[i + 1]). A single buffer
+  // is contiguous for scans and large enough to sit on huge pages.
+  std::vector<int, HugePageAllocator<int>> list_ids;
+  std::vector<size_t> list_offsets;
+
+  // SQ8 residual codes, code_size() bytes per list position (storage ==
+  // SQ8 only): the codes of list_ids[p] start at p * code_size()
+  IVFStorage storage;
+  ScalarQuantizer sq;
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> list_codes;
 
   // Number of Clusters to consider
   int n_probe;
@@ -28,16 +90,82 @@ private:
   // Number of iterations
   int max_iters;
 
+  // Balanced k-means list cap, as a multiple of the mean (0: unbounded)
+  float max_list_factor;
+
+  // Lists each vector is stored in: its own cluster plus the spill - 1
+  // next-closest ones. Above 1, an id can turn up in several probed lists
+  // and searches drop the repeats.
+  int spill;
+
 public:
-  IVFIndex(int n_clusters, int dimension, int max_iters = 50, int n_probe = 1);
+  IVFIndex(int n_clusters, int dimension, int max_iters = 50, int n_probe = 1,
+           Metric metric = Metric::L2,
+           CoarseQuantizer quantizer = CoarseQuantizer::Flat,
+           IVFStorage storage = IVFStorage::Full,
+           float max_list_factor = 0.0f, int spill = 1);
 
-  virtual void build(const std::vector<std::vector<float>> &data) override;
-  virtual SearchResults search(const std::vector<std::vector<float>> &data,
+  virtual void build(const MatrixView &data,
+                     BuildProgress *progress = nullptr) override;
+  virtual SearchResults search(const MatrixView &data,
                                const std::vector<float> &query, int k,
-                               const SearchParams *params = nullptr) override;
+                               const SearchParams *params = nullptr,
+                               const Bitmap *filter = nullptr,
+                               SearchStats *stats = nullptr) override;
 
   virtual bool is_trained() const override;
-  virtual void save(std::ofstream &out) const override;
-  virtual void load(std::ifstream &in) override;
+  virtual void save(std::ostream &out) const override;
+  virtual void load(std::istream &in) override;
   virtual std::string name() const override { return "IVFIndex"; };
+
+  // Also applies to the coarse graph; VegamDB sets the metric after load()
+  virtual void set_metric(Metric metric) override {
+    IndexBase::set_metric(metric);
+    if (coarse_graph)
+      coarse_graph->set_metric(metric);
+  }
+
+  CoarseQuantizer coarse_quantizer() const { return quantizer; }
+  IVFStorage storage_mode() const { return storage; }
+  float list_factor() const { return max_list_factor; }
+  int spill_count() const { return spill; }
+
+  // Rows in each list, in list order (empty before build)
+  std::vector<size_t> list_sizes() const;
+  ListSizeStats list_size_stats() const;
+
+private:
+  size_t n_centroids() const {
+    return dimension > 0 ? centroids.size() / dimension : 0;
+  }
+  MatrixView centroid_view() const {
+    return MatrixView{centroids.data(), n_centroids(),
+                      static_cast<size_t>(dimension)};
+  }
+
+  // The `n` lists whose centroids are closest to `query`, closest first,
+  // as (distance, list). Uses the coarse graph when there is one and `n`
+  // is below the number of lists.
+  std::vector<std::pair<float, int>>
+  rank_lists(const std::vector<float> &query, size_t n, int coarse_ef,
+             SearchStats *stats);
+  void build_coarse_graph(BuildProgress *progress);
+  // Adds every row to the spill - 1 lists closest to it after its own;
+  // lists stay in ascending id order
+  void spill_buckets(const MatrixView &data,
+                     std::vector<std::vector<int>> &buckets) const;
+  // Trains the SQ8 ranges on the residuals and fills list_codes
+  void encode_lists(const MatrixView &data, BuildProgress *progress);
+
+  const int *list_begin(int list) const {
+    return list_ids.data() + list_offsets[list];
+  }
+  size_t list_size(int list) const {
+    return list_offsets[list + 1] - list_offsets[list];
+  }
+  void set_lists(const std::vector<std::vector<int>> &lists);
+
+  // Ranks dimension blocks by variance across the centroids, which is
+  // cheap and needs nothing persisted beyond the centroids themselves
+  void update_block_order();
 };
\ No newline at end of file
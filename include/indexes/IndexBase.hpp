@@ -1,7 +1,16 @@
 // include/indexes/IndexBase.hpp
 
 #pragma once
-#include <fstream>
+#include "storage/MatrixView.hpp"
+#include "utils/Bitmap.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Progress.hpp"
+#include "utils/Stats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -15,17 +24,102 @@ struct SearchParams {
 };
 
 class IndexBase {
+protected:
+  Metric metric_ = Metric::L2;
+
+  // Kernel for (metric_, distance_dim_), resolved once in build()/load()
+  // instead of being dispatched on every comparison.
+  DistanceFunction distance_ = nullptr;
+  BoundedDistanceFunction bounded_distance_ = nullptr;
+  size_t distance_dim_ = 0;
+
+  // Block visiting order for the bounded kernel (empty = natural order).
+  // Set by indexes that know the data's variance profile.
+  std::vector<uint32_t> block_order_;
+
+  void resolve_distance(size_t dim) {
+    distance_ = get_distance_function(metric_, dim);
+    bounded_distance_ = get_bounded_distance_function(metric_, dim);
+    distance_dim_ = dim;
+  }
+
+  // The resolved kernel, or a freshly looked-up one if the index has not
+  // been built for this dimension. Never writes, so concurrent searches
+  // are safe.
+  DistanceFunction distance_for(size_t dim) const {
+    if (distance_ && distance_dim_ == dim)
+      return distance_;
+    return get_distance_function(metric_, dim);
+  }
+
+  // Same as distance_for(), for the early-abandoning kernel
+  BoundedDistanceFunction bounded_distance_for(size_t dim) const {
+    if (bounded_distance_ && distance_dim_ == dim)
+      return bounded_distance_;
+    return get_bounded_distance_function(metric_, dim);
+  }
+
+  // block_order_ if it was computed for `dim`, else nullptr
+  const uint32_t *block_order(size_t dim) const {
+    if (block_order_.empty() || block_order_.size() != dim / kAbandonBlock)
+      return nullptr;
+    return block_order_.data();
+  }
+
 public:
   virtual ~IndexBase() = default;
 
-  virtual void build(const std::vector<std::vector<float>> &data) = 0;
+  Metric metric() const { return metric_; }
 
-  virtual SearchResults search(const std::vector<std::vector<float>> &data,
+  // VegamDB owns the metric and applies it before build/search; changing
+  // it on a trained index requires a rebuild.
+  virtual void set_metric(Metric metric) {
+    metric_ = metric;
+    if (distance_dim_ > 0)
+      resolve_distance(distance_dim_);
+  }
+
+  // `data` views the store's contiguous row-major buffer; row i is vector
+  // id i. `progress`, when given, receives phase changes and work units as
+  // the build runs (it may be polled from another thread).
+  virtual void build(const MatrixView &data,
+                     BuildProgress *progress = nullptr) = 0;
+
+  // `filter` is an optional allow-list: when set, only ids contained in it
+  // may be returned. Indexes apply it inside their scan loops rather than
+  // post-filtering, so k results are returned whenever k ids are allowed.
+  // `stats`, when given, receives counters and phase timings for this
+  // query; without it no clocks are read.
+  virtual SearchResults search(const MatrixView &data,
                                const std::vector<float> &query, int k,
-                               const SearchParams *params = nullptr) = 0;
+                               const SearchParams *params = nullptr,
+                               const Bitmap *filter = nullptr,
+                               SearchStats *stats = nullptr) = 0;
+
+  // ----- Incremental inserts (optional) -----
+  // Indexes that can take rows after build() override these three.
+  // VegamDB appends rows to the store and calls reserve() under its
+  // writer lock, then calls add() under the reader lock, so searches and
+  // other adds keep running while the rows are linked in. reserve() must
+  // not run concurrently with search() or add().
+  virtual bool supports_add() const { return false; }
+
+  // Makes room for rows [0, n_rows)
+  virtual void reserve(size_t n_rows) {}
+
+  // Indexes rows [begin, end) of `data`. Rows already indexed are
+  // skipped, so overlapping calls are harmless.
+  virtual void add(const MatrixView &data, size_t begin, size_t end) {
+    throw std::logic_error(name() + " does not support incremental adds");
+  }
 
   virtual bool is_trained() const = 0;
-  virtual void save(std::ofstream &out) const = 0;
-  virtual void load(std::ifstream &in) = 0;
+  virtual void save(std::ostream &out) const = 0;
+  virtual void load(std::istream &in) = 0;
   virtual std::string name() const = 0;
-};
\ No newline at end of file
+
+  // Called by VegamDB after load() with the loaded rows, so indexes can
+  // restore state that build() derives from the rows instead of
+  // persisting it (e.g. block_order_)
+  virtual void after_load(const MatrixView &data) {}
+};
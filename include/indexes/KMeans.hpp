@@ -1,5 +1,8 @@
 // include/indexes/KMeans.hpp
 #pragma once
+#include "storage/MatrixView.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Progress.hpp"
 #include <cmath>
 #include <vector>
 
@@ -33,6 +36,9 @@ private:
   int k;
   int max_iters;
   int dimension;
+  Metric metric;
+  // Bucket size cap as a multiple of the mean size (0: unbounded)
+  float max_bucket_factor;
 
 public:
   /**
@@ -40,15 +46,34 @@ public:
    * @param k Number of clusters (centroids) to find.
    * @param max_iters Maximum iterations for the training loop.
    * @param dimension Dimensionality of the vectors.
+   * @param metric For InnerProduct/Cosine, runs spherical k-means: points
+   *        are assigned by maximum inner product and centroids are kept at
+   *        unit norm.
+   * @param max_bucket_factor Balanced k-means: no bucket may hold more
+   *        than max(1, factor) * rows / k points. Every assignment step
+   *        keeps each bucket's closest points up to the cap and moves the
+   *        rest to their nearest centroid with room. 0 (default) runs
+   *        plain Lloyd's.
+   * @throws std::invalid_argument if max_bucket_factor is negative.
    */
-  KMeans(int k, int max_iters, int dimension);
+  KMeans(int k, int max_iters, int dimension, Metric metric = Metric::L2,
+         float max_bucket_factor = 0.0f);
 
   /**
    * @brief Main Training Function.
    * Runs the clustering algorithm on the provided data.
-   * @param data Reference to the dataset.
+   * @param data View of the dataset (contiguous rows).
+   * @param progress Optional; reports the "kmeans" phase as vectors
+   *        assigned over all iterations (max_iters * rows units).
    * @return KMeansIndex Struct containing centroids and buckets.
    */
+  KMeansIndex train(const MatrixView &data,
+                    BuildProgress *progress = nullptr);
+
+  /**
+   * @brief Convenience overload for row-of-rows input (used by the Python
+   * bindings). Packs the rows into one buffer and trains on that.
+   */
   KMeansIndex train(const std::vector<std::vector<float>> &data);
 
 private:
@@ -60,21 +85,34 @@ private:
    * @brief Initialization Step.
    * Picks random points from the dataset to serve as initial centroids.
    */
-  void init_centroids(const std::vector<std::vector<float>> &data,
-                      KMeansIndex &index);
+  void init_centroids(const MatrixView &data, KMeansIndex &index);
 
   /**
    * @brief Assignment Step (Expectation).
-   * Assigns every data point to its nearest centroid.
+   * Assigns every data point to its nearest centroid, then enforces the
+   * bucket cap when there is one. Buckets list their ids in ascending
+   * order.
    */
-  void assign_points_to_buckets(const std::vector<std::vector<float>> &data,
-                                KMeansIndex &index);
+  void assign_points_to_buckets(const MatrixView &data, KMeansIndex &index,
+                                BuildProgress *progress);
 
   /**
    * @brief Update Step (Maximization).
    * Recalculates centroid positions based on the average of their buckets.
    * Uses Row-Wise iteration for CPU cache optimization.
    */
-  void update_centroids(const std::vector<std::vector<float>> &data,
-                        KMeansIndex &index);
+  void update_centroids(const MatrixView &data, KMeansIndex &index);
+
+  /**
+   * @brief Balancing Step.
+   * Each bucket above `cap` keeps its `cap` closest points. The evicted
+   * points, taken closest-first, move to the nearest centroid whose
+   * bucket still has room.
+   */
+  void cap_buckets(const MatrixView &data, const KMeansIndex &index,
+                   size_t cap, std::vector<int> &assignment,
+                   const std::vector<float> &distances);
+
+  // Largest bucket allowed for `rows` points (0: no cap)
+  size_t bucket_cap(size_t rows) const;
 };
\ No newline at end of file
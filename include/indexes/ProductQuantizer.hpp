@@ -0,0 +1,87 @@
+// include/indexes/ProductQuantizer.hpp
+
+#pragma once
+#include "storage/MatrixView.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Progress.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Product quantizer: splits vectors into `n_subspaces` contiguous
+ * slices and codes each slice as its nearest k-means centroid (at most
+ * 256 per slice), so a vector is stored in n_subspaces bytes.
+ * Distances to a query are approximated through a per-query lookup table
+ * of slice-to-centroid distances (compute_table / table_distance).
+ */
+class ProductQuantizer {
+public:
+  static constexpr size_t kMaxCentroids = 256;
+
+private:
+  size_t dim_ = 0;
+  size_t n_subspaces_ = 0;
+  size_t n_centroids_ = 0;
+
+  // Slice m covers dimensions [offsets_[m], offsets_[m + 1]); the first
+  // dim % n_subspaces slices are one wider
+  std::vector<size_t> offsets_;
+
+  // Slice m's centroids, n_centroids_ rows of its width, start at
+  // n_centroids_ * offsets_[m]
+  std::vector<float> codebooks_;
+
+public:
+  ProductQuantizer() = default;
+
+  /**
+   * @throws std::invalid_argument unless 1 <= n_subspaces <= dim.
+   */
+  ProductQuantizer(size_t dim, size_t n_subspaces);
+
+  /**
+   * @brief Trains each slice's codebook with k-means on up to
+   * `max_samples` evenly spaced rows. Reports phase "pq" (one unit per
+   * slice) to `progress` when given.
+   */
+  void train(const MatrixView &data, size_t max_samples = 65536,
+             int max_iters = 20, BuildProgress *progress = nullptr);
+
+  /**
+   * @brief Writes code_size() bytes per row of `data` to `codes`.
+   */
+  void encode(const MatrixView &data, uint8_t *codes) const;
+
+  /**
+   * @brief Fills `table` (n_subspaces x kMaxCentroids) with the distance
+   * from each query slice to each centroid. L2 tables hold squared
+   * distances; angular metrics hold negated inner products, so sums rank
+   * like the metric's distance.
+   */
+  void compute_table(const float *query, Metric metric, float *table) const;
+
+  float table_distance(const float *table, const uint8_t *code) const {
+    float sum = 0.0f;
+    for (size_t m = 0; m < n_subspaces_; m++) {
+      sum += table[m * kMaxCentroids + code[m]];
+    }
+    return sum;
+  }
+
+  size_t code_size() const { return n_subspaces_; }
+  size_t table_size() const { return n_subspaces_ * kMaxCentroids; }
+  bool is_trained() const { return n_centroids_ > 0; }
+
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+
+private:
+  size_t width(size_t m) const { return offsets_[m + 1] - offsets_[m]; }
+  const float *centroid(size_t m, size_t c) const {
+    return codebooks_.data() + n_centroids_ * offsets_[m] + c * width(m);
+  }
+  void set_layout(size_t dim, size_t n_subspaces);
+};
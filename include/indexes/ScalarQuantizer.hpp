@@ -0,0 +1,61 @@
+// include/indexes/ScalarQuantizer.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief 8-bit scalar quantizer (SQ8): each dimension d of a vector is
+ * coded as one byte, x ~ min[d] + step[d] * code, with [min, max] learned
+ * per dimension and split into 255 steps. Codes are 4x smaller than
+ * floats; distances to a query are computed on the codes directly,
+ * widened to float in SIMD registers.
+ *
+ * IVFIndex codes residuals (vector - centroid), whose range is much
+ * tighter than the vectors', and rewrites the query per list:
+ *   - L2:  |q - c - decode(code)|^2 = sum w[d] * (t[d] - code[d])^2
+ *          with t = l2_terms(q, c), w = step^2.
+ *   - dot: <q, decode(code)> = dot_offset(q) + sum a[d] * code[d]
+ *          with a = dot_terms(q).
+ */
+class ScalarQuantizer {
+private:
+  size_t dim_ = 0;
+  std::vector<float> min_;
+  std::vector<float> step_;    // (max - min) / 255; 1 for constant dims
+  std::vector<float> weights_; // step^2
+
+public:
+  ScalarQuantizer() = default;
+
+  /**
+   * @brief Quantizer covering [lo[d], hi[d]] in each dimension.
+   * @throws std::invalid_argument if lo and hi differ in length.
+   */
+  ScalarQuantizer(const std::vector<float> &lo, const std::vector<float> &hi);
+
+  size_t dimension() const { return dim_; }
+  size_t code_size() const { return dim_; }
+  bool is_trained() const { return dim_ > 0; }
+
+  /**
+   * @brief Writes the code of `vector - center` to `code` (code_size()
+   * bytes). `center` may be null. Values outside the range are clamped.
+   */
+  void encode(const float *vector, const float *center, uint8_t *code) const;
+
+  // L2 terms of query - center (dim floats to `terms`)
+  void l2_terms(const float *query, const float *center, float *terms) const;
+  float l2_distance(const float *terms, const uint8_t *code) const;
+
+  // Dot terms of the query (dim floats to `terms`), and the constant part
+  void dot_terms(const float *query, float *terms) const;
+  float dot_offset(const float *query) const;
+  float dot(const float *terms, const uint8_t *code) const;
+
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+};
@@ -0,0 +1,54 @@
+// include/storage/AttributeColumn.hpp
+
+#pragma once
+
+#include "storage/Predicate.hpp"
+#include "utils/Bitmap.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class AttributeType { Int64 = 0, Float = 1, String = 2 };
+
+/**
+ * @brief One typed per-vector attribute, stored column-wise.
+ * Row i holds the value for vector id i. Strings are dictionary-encoded:
+ * each row stores a 32-bit code into a table of distinct values, so
+ * string predicates compare integers in the scan loop.
+ */
+class AttributeColumn {
+private:
+  AttributeType type_ = AttributeType::Int64;
+  std::vector<int64_t> ints_;
+  std::vector<float> floats_;
+  std::vector<uint32_t> codes_;
+  std::vector<std::string> dictionary_;
+  std::unordered_map<std::string, uint32_t> dictionary_index_;
+
+public:
+  static AttributeColumn from_int64(std::vector<int64_t> values);
+  static AttributeColumn from_float(std::vector<float> values);
+  static AttributeColumn from_strings(const std::vector<std::string> &values);
+
+  AttributeType type() const { return type_; }
+  size_t size() const;
+
+  /**
+   * @brief Sets the bit of every row that satisfies the predicate.
+   * @throws std::invalid_argument if the predicate's values do not match
+   *         the column type (e.g. a range over a string column).
+   */
+  void match(const Predicate &predicate, Bitmap &out) const;
+
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+
+private:
+  void match_int64(const Predicate &predicate, Bitmap &out) const;
+  void match_float(const Predicate &predicate, Bitmap &out) const;
+  void match_string(const Predicate &predicate, Bitmap &out) const;
+};
@@ -0,0 +1,69 @@
+// include/storage/DatasetLoader.hpp
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// =========================================================
+// SECTION: Formats
+// =========================================================
+
+/**
+ * @brief On-disk vector formats.
+ *  - Fvecs / Bvecs / Ivecs: TEXMEX format (SIFT1M, GIST1M, BIGANN). Each
+ *    record is an int32 dimension followed by that many float32 / uint8 /
+ *    int32 components.
+ *  - Npy: NumPy .npy, 1D or 2D, C order, little-endian float32, float64,
+ *    uint8 or int32/int64 (integers only for ground truth).
+ */
+enum class DatasetFormat { Fvecs = 0, Bvecs = 1, Ivecs = 2, Npy = 3 };
+
+struct DatasetInfo {
+  DatasetFormat format = DatasetFormat::Fvecs;
+  size_t rows = 0;
+  size_t dim = 0;
+};
+
+/**
+ * @brief Picks the format from the file extension.
+ * @throws std::invalid_argument for an unknown extension.
+ */
+DatasetFormat dataset_format(const std::string &path);
+
+/**
+ * @brief Reads only the header(s) to report the shape of a file.
+ * @throws std::runtime_error for unreadable or malformed files.
+ */
+DatasetInfo probe_dataset(const std::string &path);
+
+// =========================================================
+// SECTION: Readers
+// Files are memory-mapped, so only the pages being converted are resident.
+// =========================================================
+
+/**
+ * @brief Receives `n_rows` contiguous rows of `dim` floats.
+ */
+using VectorSink =
+    std::function<void(const float *rows, size_t n_rows, size_t dim)>;
+
+/**
+ * @brief Streams the vectors of an .fvecs, .bvecs or .npy file into `sink`.
+ * Float32 .npy data is passed straight from the mapping in one call; other
+ * layouts are converted in fixed-size chunks, so memory stays bounded.
+ * @param max_rows Stop after this many rows (0 = all).
+ * @return Shape of what was read.
+ * @throws std::invalid_argument for integer files (use read_ivecs).
+ * @throws std::runtime_error for unreadable or malformed files.
+ */
+DatasetInfo read_vectors(const std::string &path, const VectorSink &sink,
+                         size_t max_rows = 0);
+
+/**
+ * @brief Reads an .ivecs (or integer .npy) file, typically ground-truth
+ * neighbor ids, one row per query.
+ */
+std::vector<std::vector<int>> read_ivecs(const std::string &path,
+                                         size_t max_rows = 0);
@@ -0,0 +1,19 @@
+// include/storage/MatrixView.hpp
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Non-owning view of a row-major float matrix (rows x dim).
+ * This is how indexes see the vectors: VectorStore keeps them in one
+ * contiguous buffer and hands out views, so row i is data + i * dim.
+ */
+struct MatrixView {
+  const float *data = nullptr;
+  size_t rows = 0;
+  size_t dim = 0;
+
+  const float *row(size_t i) const { return data + i * dim; }
+  size_t size() const { return rows; }
+  bool empty() const { return rows == 0; }
+};
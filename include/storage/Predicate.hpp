@@ -0,0 +1,38 @@
+// include/storage/Predicate.hpp
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+// A scalar attribute value: integer, floating point or string.
+using AttributeValue = std::variant<int64_t, double, std::string>;
+
+/**
+ * @brief A simple filter over one attribute column.
+ * Predicates are compiled into a Bitmap by VectorStore::evaluate() and the
+ * result is cached under key(), so repeating a predicate is O(1).
+ */
+struct Predicate {
+  enum class Op { Equal = 0, In = 1, Range = 2 };
+
+  std::string column;
+  Op op = Op::Equal;
+
+  // Equal: one value. In: any number of values. Range: {lo, hi}, inclusive.
+  std::vector<AttributeValue> values;
+
+  static Predicate equal(const std::string &column, AttributeValue value);
+  static Predicate in(const std::string &column,
+                      std::vector<AttributeValue> values);
+  static Predicate range(const std::string &column, AttributeValue lo,
+                         AttributeValue hi);
+
+  /**
+   * @brief Canonical string form, used as the cache key.
+   * Example: `tenant_id IN (i:1, i:7)`.
+   */
+  std::string key() const;
+};
@@ -0,0 +1,279 @@
+// include/storage/Snapshot.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+// =========================================================
+// SECTION: File layout
+// A snapshot is
+//   [FileHeader][section payloads, 4 KiB aligned][SectionEntry x count]
+// The header points at the trailing section directory; each entry gives a
+// section's offset, size and CRC32C, so sections can be verified and read
+// independently. Integers are in the writer's byte order, recorded in
+// `byte_order`. Files without the magic are the legacy (version 1) layout:
+// the same payloads back to back with no framing.
+// =========================================================
+
+constexpr char kSnapshotMagic[8] = {'V', 'E', 'G', 'A', 'M', 'D', 'B', '\0'};
+constexpr uint32_t kSnapshotVersion = 2;
+constexpr uint32_t kByteOrderMark = 0x01020304u;
+constexpr uint64_t kSectionAlignment = 4096;
+
+enum class SectionId : uint32_t {
+  Metadata = 1,   // Metric, index type and last applied WAL LSN
+  Vectors = 2,    // VectorStore rows
+  Index = 3,      // IndexBase::save() payload (trained indexes only)
+  Attributes = 4, // Attribute columns
+  Tombstones = 5, // Removed row ids, delta-varint encoded (if any)
+};
+
+std::string section_name(SectionId id);
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t flags; // Reserved, 0
+  uint32_t section_count;
+  uint64_t directory_offset;
+  uint32_t directory_crc;
+  uint32_t header_crc; // CRC32C of the fields above
+};
+static_assert(sizeof(FileHeader) == 40, "FileHeader must be packed");
+
+struct SectionEntry {
+  uint32_t id;
+  uint32_t flags; // Compression of the stored bytes (0 = raw)
+  uint64_t offset;
+  uint64_t size;
+  uint32_t crc;
+  uint32_t reserved;
+};
+static_assert(sizeof(SectionEntry) == 32, "SectionEntry must be packed");
+
+// =========================================================
+// SECTION: Options
+// =========================================================
+
+/**
+ * @brief Compression applied to the index and attribute sections (ids,
+ * and later codes). Vectors are stored raw: float data barely compresses
+ * and is the part that must load at disk speed.
+ *  - None: raw bytes.
+ *  - Zstd: zstd level 1. Requires a build with VEGAMDB_WITH_ZSTD.
+ */
+enum class Compression : uint32_t { None = 0, Zstd = 1 };
+
+bool compression_available(Compression compression);
+
+struct SaveOptions {
+  Compression compression = Compression::None;
+
+  // Serialize (and compress) the index and attribute sections on worker
+  // threads while the vectors are written. Costs a copy of those
+  // sections in memory; without it every section streams straight out.
+  bool parallel = true;
+};
+
+/**
+ * @brief Compresses a serialized section.
+ * @throws std::invalid_argument if the codec is not compiled in.
+ */
+std::vector<char> compress_section(std::vector<char> raw,
+                                   Compression compression);
+
+// =========================================================
+// SECTION: Writing
+// =========================================================
+
+/**
+ * @brief Forwards writes to another streambuf in large blocks while
+ * accumulating their CRC32C and length. Small writes (e.g. per-list
+ * headers) are gathered in a 1 MiB buffer; larger ones pass through.
+ */
+class ChecksumWriteBuf : public std::streambuf {
+private:
+  std::streambuf *target_ = nullptr;
+  std::vector<char> buffer_;
+  uint32_t crc_ = 0;
+  uint64_t size_ = 0;
+  bool failed_ = false;
+
+public:
+  ChecksumWriteBuf();
+  void reset(std::streambuf *target);
+  uint32_t crc() const { return crc_; }
+  uint64_t size() const { return size_; }
+  bool failed() const { return failed_; }
+
+protected:
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+  int_type overflow(int_type ch) override;
+  int sync() override;
+
+private:
+  bool flush_buffer();
+  bool write_through(const char *s, size_t n);
+};
+
+/**
+ * @brief std::ostream that appends to an in-memory buffer, for sections
+ * serialized off the writing thread.
+ */
+class MemoryWriteStream : public std::ostream {
+private:
+  class Buf : public std::streambuf {
+  public:
+    std::vector<char> bytes;
+
+  protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int_type overflow(int_type ch) override;
+  };
+  Buf buf_;
+
+public:
+  MemoryWriteStream();
+  std::vector<char> &bytes() { return buf_.bytes; }
+};
+
+/**
+ * @brief Writes a snapshot to a seekable stream, one section at a time:
+ *
+ *   SnapshotWriter writer(out);
+ *   store.save(writer.begin_section(SectionId::Vectors));
+ *   writer.end_section();
+ *   ...
+ *   writer.finish();
+ *
+ * Sections are checksummed as they stream out, so nothing is buffered.
+ */
+class SnapshotWriter {
+private:
+  std::ostream &out_;
+  uint64_t position_ = 0;
+  std::vector<SectionEntry> sections_;
+  ChecksumWriteBuf section_buf_;
+  std::ostream section_stream_;
+  bool in_section_ = false;
+
+public:
+  explicit SnapshotWriter(std::ostream &out);
+
+  std::ostream &begin_section(SectionId id);
+  void end_section();
+
+  /**
+   * @brief Writes an already serialized section in one call. `flags` is
+   * the Compression of `data`.
+   */
+  void add_section(SectionId id, const std::vector<char> &data,
+                   uint32_t flags = 0);
+
+  /**
+   * @brief Writes the section directory and the final header.
+   * @throws std::runtime_error if any write failed.
+   */
+  void finish();
+
+private:
+  void write_raw(const void *data, size_t size);
+  void pad_to(uint64_t alignment);
+};
+
+// =========================================================
+// SECTION: Reading
+// =========================================================
+
+/**
+ * @brief Read-only std::streambuf over a block of memory (e.g. a section
+ * of a mapped file).
+ */
+class MemoryReadBuf : public std::streambuf {
+public:
+  MemoryReadBuf(const char *data, size_t size);
+};
+
+/**
+ * @brief std::istream over one section's bytes.
+ */
+class SectionStream : public std::istream {
+private:
+  MemoryReadBuf buf_;
+
+public:
+  SectionStream(const char *data, size_t size);
+};
+
+/**
+ * @brief A section's uncompressed bytes: a view into the mapped file for
+ * raw sections, or an owned buffer for compressed ones.
+ */
+class SectionData {
+private:
+  std::vector<char> owned_;
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+
+public:
+  SectionData() = default;
+  SectionData(const char *data, size_t size) : data_(data), size_(size) {}
+  explicit SectionData(std::vector<char> owned)
+      : owned_(std::move(owned)), data_(owned_.data()), size_(owned_.size()) {}
+
+  SectionData(SectionData &&other) noexcept { *this = std::move(other); }
+  SectionData &operator=(SectionData &&other) noexcept {
+    bool owns = other.data_ == other.owned_.data();
+    owned_ = std::move(other.owned_);
+    data_ = owns ? owned_.data() : other.data_;
+    size_ = other.size_;
+    return *this;
+  }
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+};
+
+/**
+ * @brief Parses a snapshot held in memory (normally a MappedFile).
+ */
+class SnapshotReader {
+private:
+  const unsigned char *data_;
+  size_t size_;
+  FileHeader header_;
+  std::vector<SectionEntry> sections_;
+
+public:
+  static bool is_snapshot(const unsigned char *data, size_t size);
+
+  /**
+   * @brief Validates the header and section directory.
+   * @throws std::runtime_error for a corrupt or unsupported file.
+   */
+  SnapshotReader(const unsigned char *data, size_t size);
+
+  uint32_t version() const { return header_.version; }
+  const std::vector<SectionEntry> &sections() const { return sections_; }
+  const SectionEntry *find(SectionId id) const;
+
+  /**
+   * @brief Checks every section's CRC32C; large sections are checksummed
+   * by several threads.
+   * @throws std::runtime_error naming the first corrupt section.
+   */
+  void verify() const;
+
+  /**
+   * @brief Uncompressed bytes of a section (empty if `entry` is null).
+   * @throws std::runtime_error for an unknown or unavailable encoding.
+   */
+  SectionData section(const SectionEntry *entry) const;
+};
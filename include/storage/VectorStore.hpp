@@ -2,25 +2,157 @@
 
 #pragma once
 
+#include "storage/AttributeColumn.hpp"
+#include "storage/MatrixView.hpp"
+#include "storage/Predicate.hpp"
+#include "utils/Allocator.hpp"
+#include "utils/Bitmap.hpp"
+#include "utils/HugePages.hpp"
 #include <cstddef>
-#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class VectorStore {
 private:
-  std::vector<std::vector<float>> data_;
+  // All vectors in one row-major buffer (rows_ x dimension_). The
+  // default-init allocator lets bulk appends grow it without zero-filling
+  // memory that is about to be overwritten; once large, the buffer sits on
+  // huge pages (see utils/HugePages.hpp).
+  std::vector<float, DefaultInitAllocator<float, HugePageAllocator<float>>>
+      data_;
+  size_t rows_ = 0;
   int dimension_ = 0;
 
+  // Buffer and row count when the rows were last bound to NUMA nodes
+  const float *numa_placed_data_ = nullptr;
+  size_t numa_placed_rows_ = 0;
+
+  // External mode: rows live in a caller-owned buffer that is read in
+  // place. `external_owner_` keeps that buffer alive (e.g. a reference to
+  // the NumPy array); the store is read-only while attached.
+  const float *external_ = nullptr;
+  std::shared_ptr<const void> external_owner_;
+
+  // Cosine databases store unit-norm vectors; rows are normalized while
+  // being copied in, so ingest makes a single pass over the data.
+  bool normalize_on_insert_ = false;
+
+  // Tombstones: removed rows keep their ids and storage but never appear
+  // in results. Empty until the first removal; then one bit per row, set
+  // for rows that are still live.
+  Bitmap live_;
+
+  // Per-vector scalar attributes, keyed by column name
+  std::map<std::string, AttributeColumn> attributes_;
+
+  // Compiled predicate bitmaps, keyed by Predicate::key(). Cleared whenever
+  // vectors or attributes change.
+  mutable std::unordered_map<std::string, std::shared_ptr<const Bitmap>>
+      predicate_cache_;
+  mutable std::mutex predicate_cache_mutex_;
+
 public:
   void add(const std::vector<float> &vec);
+
+  /**
+   * @brief Appends n_vectors rows from a C-contiguous float32 block.
+   * Grows the buffer once and copies the whole block in; very large
+   * batches are copied by several threads.
+   * @throws std::invalid_argument if dim differs from the stored dimension.
+   */
   void add_vector_from_pointer(const float *arr, size_t n_vectors, size_t dim);
 
-  const std::vector<float> &get(int idx) const;
-  const std::vector<std::vector<float>> &data() const;
+  /**
+   * @brief Throws exactly what add_vector_from_pointer() would for a batch
+   * of width `dim`, without changing anything. Lets callers log an add
+   * before applying it.
+   */
+  void check_add(size_t dim) const;
+
+  // Pre-sizes the buffer for n_vectors more rows, so a load that arrives in
+  // chunks grows it once.
+  void reserve(size_t n_vectors, size_t dim);
+  // Drops the rows appended after the first n_rows, undoing a failed
+  // multi-chunk add. No-op if the store holds no more than n_rows.
+  void truncate(size_t n_rows);
+
+  /**
+   * @brief Wraps a caller-owned C-contiguous float32 block (n_vectors x
+   * dim) without copying it. `owner` is held until the store is cleared
+   * or reloaded. Subsequent adds throw. With normalize-on-insert (cosine)
+   * the rows cannot be rewritten, so they must already be unit-norm.
+   * @throws std::runtime_error if the store already holds vectors.
+   * @throws std::invalid_argument if normalization is required and a row
+   *         is not unit-norm.
+   */
+  void attach_external(const float *data, size_t n_vectors, size_t dim,
+                       std::shared_ptr<const void> owner);
+  bool is_external() const { return external_ != nullptr; }
+
+  // Drops every row, attribute and tombstone, and releases any external
+  // buffer.
+  void clear();
 
+  // Exchanges rows, tombstones, attributes and settings with `other`; both
+  // predicate caches are dropped. Lets a load fill a scratch store and
+  // commit it only once everything has decoded.
+  void swap(VectorStore &other);
+
+  const float *get(int idx) const;
+  MatrixView data() const;
+
+  // Rows ever added, including removed ones (ids are never reused)
   int size() const;
   int dimension() const;
 
-  void save(std::ofstream &out) const;
-  void load(std::ifstream &in);
-};
\ No newline at end of file
+  /**
+   * @brief Marks rows as removed. Ids that are already removed are
+   * skipped. Works on external stores too; only the tombstones change.
+   * @throws std::invalid_argument if any id is out of range (nothing is
+   *         removed then).
+   */
+  void remove(const std::vector<int> &ids);
+  bool is_deleted(int id) const;
+  size_t deleted_count() const;
+  std::vector<int> deleted_ids() const;
+
+  // Allow-list of live rows, or nullptr if nothing was ever removed
+  const Bitmap *live() const { return live_.size() > 0 ? &live_ : nullptr; }
+
+  void set_normalize_on_insert(bool normalize) {
+    normalize_on_insert_ = normalize;
+  }
+
+  // Attributes
+  void set_attribute(const std::string &name, AttributeColumn column);
+  bool has_attribute(const std::string &name) const;
+  std::vector<std::string> attribute_names() const;
+
+  /**
+   * @brief Compiles a predicate into a bitmap over vector ids.
+   * Rows without a value for the column (e.g. vectors added after the
+   * column was set) never match. Results are cached per predicate.
+   * @throws std::invalid_argument for an unknown column or a value whose
+   *         type does not fit the column.
+   */
+  std::shared_ptr<const Bitmap> evaluate(const Predicate &predicate) const;
+
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+  void save_attributes(std::ostream &out) const;
+  void load_attributes(std::istream &in);
+
+private:
+  void invalidate_predicate_cache();
+
+  // Binds row partitions to NUMA nodes when NUMA awareness is on. Skipped
+  // until the buffer moves or grows by an eighth, so a stream of small
+  // adds does not rescan the page tables every time.
+  void place_on_numa_nodes();
+};
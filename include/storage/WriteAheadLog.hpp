@@ -0,0 +1,112 @@
+// include/storage/WriteAheadLog.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// =========================================================
+// SECTION: Log layout
+// A log is an 8-byte magic followed by records
+//   [WalRecordHeader][payload]
+// Add payloads are count x dim float32 rows; Remove payloads are count
+// int32 ids. Every record is a multiple of 4 bytes, so payloads can be
+// read in place from a mapping. A crash mid-append leaves a short or
+// mismatching final record, which readers treat as the end of the log.
+// =========================================================
+
+constexpr char kWalMagic[8] = {'V', 'E', 'G', 'A', 'M', 'W', 'A', 'L'};
+
+enum class WalOp : uint32_t { Add = 1, Remove = 2 };
+
+struct WalRecordHeader {
+  uint64_t lsn;         // Log sequence number, strictly increasing
+  uint64_t count;       // Rows (Add) or ids (Remove)
+  uint32_t dim;         // Row width for Add; 0 for Remove
+  uint32_t op;          // WalOp
+  uint32_t payload_crc; // CRC32C of the payload
+  uint32_t header_crc;  // CRC32C of the fields above
+};
+static_assert(sizeof(WalRecordHeader) == 32, "WAL record header layout");
+
+/**
+ * @brief A decoded record. Pointers reference the log's mapping and are
+ * only valid during the replay callback.
+ */
+struct WalRecord {
+  uint64_t lsn = 0;
+  WalOp op = WalOp::Add;
+  size_t count = 0;
+  size_t dim = 0;
+  const float *vectors = nullptr; // Add: count x dim, row-major
+  const int *ids = nullptr;       // Remove: count ids
+};
+
+// =========================================================
+// SECTION: WriteAheadLog
+// =========================================================
+
+/**
+ * @brief Append-only log of mutations made since the last snapshot.
+ * VegamDB appends each add/remove before applying it; load() replays the
+ * records newer than the snapshot, and a save to the snapshot path
+ * empties the log.
+ */
+class WriteAheadLog {
+private:
+  std::string path_;
+  std::FILE *file_ = nullptr;
+  uint64_t size_ = 0; // Bytes of intact log
+  uint64_t last_lsn_ = 0;
+  bool sync_ = true;
+
+public:
+  /**
+   * @brief Opens (or creates) the log at `path` for appending. A torn
+   * final record left by a crash is truncated away. New records are
+   * numbered after both the log's last record and `min_lsn`.
+   * With `sync`, every append is fsynced before it returns; otherwise
+   * appends reach the OS (surviving a process crash, not a power loss).
+   * @throws std::runtime_error if the file cannot be opened or is not a
+   *         write-ahead log.
+   */
+  WriteAheadLog(const std::string &path, uint64_t min_lsn, bool sync);
+  ~WriteAheadLog();
+
+  WriteAheadLog(const WriteAheadLog &) = delete;
+  WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+  /**
+   * @brief Logs an add of n_vectors rows; returns the record's LSN.
+   * @throws std::runtime_error on I/O errors (the log is left as it was).
+   */
+  uint64_t append_add(const float *vectors, size_t n_vectors, size_t dim);
+  uint64_t append_remove(const std::vector<int> &ids);
+
+  /**
+   * @brief Drops every record once a snapshot has captured them. LSNs
+   * keep counting up from last_lsn().
+   */
+  void clear();
+
+  const std::string &path() const { return path_; }
+  uint64_t last_lsn() const { return last_lsn_; }
+  bool sync() const { return sync_; }
+
+  /**
+   * @brief Calls fn for each intact record in order, stopping at the first
+   * torn or corrupt one. Returns the byte length of the intact prefix
+   * (including the magic); 0 when even the magic is incomplete.
+   * @throws std::runtime_error if the file cannot be read or is not a
+   *         write-ahead log.
+   */
+  static uint64_t replay(const std::string &path,
+                         const std::function<void(const WalRecord &)> &fn);
+
+private:
+  uint64_t append(WalOp op, uint64_t count, uint32_t dim, const void *payload,
+                  size_t payload_bytes);
+};
@@ -0,0 +1,73 @@
+// include/utils/Allocator.hpp
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Allocator adaptor that default-initializes instead of
+ * value-initializing. `std::vector<float, DefaultInitAllocator<float>>`
+ * can then be resize()d without zero-filling memory that is about to be
+ * overwritten by a bulk copy.
+ */
+template <typename T, typename A = std::allocator<T>>
+class DefaultInitAllocator : public A {
+  using traits = std::allocator_traits<A>;
+
+public:
+  template <typename U> struct rebind {
+    using other =
+        DefaultInitAllocator<U, typename traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  template <typename U>
+  void construct(U *ptr) noexcept(
+      std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void *>(ptr)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&...args) {
+    traits::construct(static_cast<A &>(*this), ptr,
+                      std::forward<Args>(args)...);
+  }
+};
+
+/**
+ * @brief Allocator returning `Alignment`-byte aligned storage, e.g. for
+ * buffers handed to O_DIRECT reads, which must be sector aligned.
+ */
+template <typename T, size_t Alignment> class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T *ptr, size_t) noexcept {
+    ::operator delete(ptr, std::align_val_t(Alignment));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return false;
+  }
+};
@@ -0,0 +1,115 @@
+// include/utils/Bitmap.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+inline int count_trailing_zeros64(uint64_t x) {
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return static_cast<int>(idx);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+/**
+ * @brief Dense bitset over vector ids, used as a search allow-list.
+ * Bit i set means "row i may appear in the results". Ids outside the
+ * bitmap's range are treated as not allowed.
+ */
+class Bitmap {
+private:
+  std::vector<uint64_t> words_;
+  size_t size_ = 0;  // Number of addressable bits
+  size_t count_ = 0; // Number of set bits (cached)
+
+public:
+  Bitmap() = default;
+
+  /**
+   * @brief Creates an empty (all-zero) bitmap addressing n_bits ids.
+   */
+  explicit Bitmap(size_t n_bits);
+
+  /**
+   * @brief Builds a bitmap with exactly the given ids set.
+   * Negative ids are ignored. The bitmap grows to fit the largest id.
+   */
+  static Bitmap from_ids(const std::vector<int> &ids, size_t n_bits = 0);
+
+  void set(size_t id);
+  void reset(size_t id);
+
+  /**
+   * @brief Grows or shrinks the addressable range to n_bits. Ids added by
+   * growing are set to `value`.
+   */
+  void resize(size_t n_bits, bool value = false);
+
+  inline bool contains(size_t id) const {
+    if (id >= size_)
+      return false;
+    return (words_[id >> 6] >> (id & 63)) & 1ULL;
+  }
+
+  /** @brief Number of allowed ids. O(1). */
+  size_t count() const { return count_; }
+
+  /** @brief Number of addressable ids (one past the largest settable id). */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Calls fn(id) for every set bit in ascending order, skipping
+   * empty 64-bit words so sparse bitmaps iterate in O(count + size/64).
+   */
+  template <typename Fn> void for_each(Fn &&fn) const {
+    for (size_t w = 0; w < words_.size(); w++) {
+      uint64_t word = words_[w];
+      while (word) {
+        int bit = count_trailing_zeros64(word);
+        fn(static_cast<int>((w << 6) + bit));
+        word &= word - 1;
+      }
+    }
+  }
+
+  /**
+   * @brief for_each() restricted to ids in [begin, end), reading only the
+   * words that cover the range.
+   */
+  template <typename Fn>
+  void for_each_in(size_t begin, size_t end, Fn &&fn) const {
+    if (end > size_)
+      end = size_;
+    if (begin >= end)
+      return;
+    size_t last = (end - 1) >> 6;
+    for (size_t w = begin >> 6; w <= last; w++) {
+      uint64_t word = words_[w];
+      if (w == begin >> 6)
+        word &= ~0ULL << (begin & 63);
+      if (w == last && (end & 63) != 0)
+        word &= ~0ULL >> (64 - (end & 63));
+      while (word) {
+        int bit = count_trailing_zeros64(word);
+        fn(static_cast<int>((w << 6) + bit));
+        word &= word - 1;
+      }
+    }
+  }
+
+  std::vector<int> to_ids() const;
+
+  Bitmap operator&(const Bitmap &other) const;
+  Bitmap operator|(const Bitmap &other) const;
+
+private:
+  void recount();
+};
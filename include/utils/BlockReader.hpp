@@ -0,0 +1,76 @@
+// include/utils/BlockReader.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Unit of disk I/O: block offsets, lengths and buffer addresses are
+// multiples of this, as O_DIRECT requires
+constexpr size_t kSectorSize = 4096;
+
+struct BlockRequest {
+  uint64_t offset = 0;    // Multiple of kSectorSize
+  size_t length = 0;      // Multiple of kSectorSize
+  char *buffer = nullptr; // kSectorSize-aligned, `length` bytes
+};
+
+/**
+ * @brief Positional reads of sector-aligned blocks from one file; safe to
+ * use from several threads at once.
+ * On Linux the file is opened with O_DIRECT when the filesystem allows it
+ * (so a disk-resident index does not fill the page cache), and a batch is
+ * submitted through io_uring in one system call when the kernel supports
+ * it. Otherwise each block is read with pread(), or through a locked
+ * stream on platforms without it.
+ */
+class BlockReader {
+private:
+  class Ring;
+
+  std::string path_;
+  int fd_ = -1;
+  uint64_t size_ = 0;
+  bool direct_ = false;
+
+  // A ring is single-threaded; each read() borrows an idle one (creating
+  // it if none is free) and returns it afterwards
+  bool use_rings_ = false;
+  std::vector<std::unique_ptr<Ring>> idle_rings_;
+  std::mutex rings_mutex_;
+
+  // Fallback for platforms without pread()
+  std::ifstream stream_;
+  std::mutex stream_mutex_;
+
+public:
+  /**
+   * @param allow_io_uring Pass false to always use pread().
+   * @throws std::runtime_error if the file cannot be opened.
+   */
+  explicit BlockReader(const std::string &path, bool allow_io_uring = true);
+  ~BlockReader();
+
+  BlockReader(const BlockReader &) = delete;
+  BlockReader &operator=(const BlockReader &) = delete;
+
+  /**
+   * @brief Reads every request, returning once all buffers are filled.
+   * @throws std::runtime_error on an I/O error or a read past the end.
+   */
+  void read(BlockRequest *requests, size_t n_requests);
+
+  const std::string &path() const { return path_; }
+  uint64_t size() const { return size_; }
+  bool direct() const { return direct_; }
+  bool uses_io_uring() const { return use_rings_; }
+
+private:
+  std::unique_ptr<Ring> acquire_ring();
+  void release_ring(std::unique_ptr<Ring> ring);
+  void pread_block(const BlockRequest &request);
+};
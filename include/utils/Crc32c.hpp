@@ -0,0 +1,29 @@
+// include/utils/Crc32c.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// =========================================================
+// SECTION: CRC32C (Castagnoli)
+// Uses the SSE4.2 or ARMv8 CRC instructions when the build enables them
+// (-march=native), and a slice-by-8 table otherwise.
+// =========================================================
+
+/**
+ * @brief CRC32C of `size` bytes, continuing from a previous result `crc`
+ * (0 to start). crc32c("123456789", 9) == 0xE3069283.
+ */
+uint32_t crc32c(const void *data, size_t size, uint32_t crc = 0);
+
+/**
+ * @brief CRC of the concatenation A+B given crc(A), crc(B) and len(B).
+ * Lets large buffers be checksummed in parallel chunks.
+ */
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b);
+
+/**
+ * @brief crc32c() over large buffers, split across up to n_threads
+ * threads. Small buffers are checksummed inline.
+ */
+uint32_t crc32c_parallel(const void *data, size_t size, size_t n_threads);
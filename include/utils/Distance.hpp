@@ -0,0 +1,117 @@
+// include/utils/Distance.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =========================================================
+// SECTION: Metrics
+// =========================================================
+
+/**
+ * @brief Similarity metric used by an index.
+ * Every metric is expressed as a distance where smaller means closer, so
+ * all indexes can sort ascending regardless of metric:
+ *  - L2:           squared Euclidean distance.
+ *  - InnerProduct: negated inner product (maximum inner product search).
+ *  - Cosine:       1 - cosine similarity. Vectors and queries are
+ *                  normalized on insert, so this is 1 - dot(a, b).
+ */
+enum class Metric { L2 = 0, InnerProduct = 1, Cosine = 2 };
+
+std::string metric_name(Metric metric);
+
+/**
+ * @brief True for metrics that compare directions (IP, cosine). These use
+ * spherical k-means in IVF and angular splits in Annoy.
+ */
+inline bool is_angular(Metric metric) { return metric != Metric::L2; }
+
+// =========================================================
+// SECTION: Kernels
+// SIMD (AVX2/FMA or NEON) when available, scalar otherwise.
+// =========================================================
+
+/**
+ * @brief Squared Euclidean distance: sum((a - b)^2).
+ */
+float l2_distance_sqr(const float *a, const float *b, size_t dim);
+
+/**
+ * @brief Inner product: sum(a * b).
+ */
+float inner_product(const float *a, const float *b, size_t dim);
+
+/**
+ * @brief Distance between a and b under the given metric (smaller is
+ * closer). For Cosine both inputs must already be normalized.
+ */
+float compute_distance(Metric metric, const float *a, const float *b,
+                       size_t dim);
+
+// =========================================================
+// SECTION: Dispatch
+// =========================================================
+
+/**
+ * @brief A distance kernel: (a, b, dim) -> distance, smaller is closer.
+ */
+using DistanceFunction = float (*)(const float *a, const float *b, size_t dim);
+
+/**
+ * @brief Returns the kernel for a metric, specialized with a compile-time
+ * dimension when dim is a common embedding size (64, 96, 128, 256, 384,
+ * 512, 768, 1024, 1536) so its loops fully unroll. Other sizes get the
+ * generic runtime-dimension kernel.
+ * Resolve once per index (at build/load) and call through the pointer in
+ * scan loops instead of switching on the metric per comparison.
+ */
+DistanceFunction get_distance_function(Metric metric, size_t dim);
+
+// =========================================================
+// SECTION: Early abandoning
+// A scan that keeps a top-k only needs a candidate's exact distance if it
+// beats the current k-th best. Squared L2 only grows as dimensions are
+// added, so the bounded kernels stop once the partial sum passes the
+// bound. They check after every kAbandonBlock dimensions; a block order
+// that visits high-variance blocks first makes the bound trip sooner.
+// =========================================================
+
+constexpr size_t kAbandonBlock = 32;
+
+/**
+ * @brief A bounded kernel: (a, b, dim, bound, block_order) -> distance.
+ * Returns the exact distance when it is <= bound; otherwise any value
+ * > bound (the partial sum at which it stopped). `block_order`, when not
+ * null, lists the dim / kAbandonBlock whole blocks in the order to visit
+ * them (see block_order_by_variance()). Metrics whose partial sums are
+ * not monotone (IP, cosine) ignore the bound and the order.
+ */
+using BoundedDistanceFunction = float (*)(const float *a, const float *b,
+                                          size_t dim, float bound,
+                                          const uint32_t *block_order);
+
+/**
+ * @brief Bounded counterpart of get_distance_function(), with the same
+ * compile-time dimension specializations.
+ */
+BoundedDistanceFunction get_bounded_distance_function(Metric metric,
+                                                      size_t dim);
+
+/**
+ * @brief Orders the dim / kAbandonBlock whole blocks of `dim` so the
+ * highest-variance quarter is visited first, measured over up to
+ * `max_samples` evenly spaced rows of the row-major `data` (n_rows x dim).
+ * Returns an empty vector (natural order) when the variance is too evenly
+ * spread for reordering to pay off, or with fewer than two blocks or rows.
+ */
+std::vector<uint32_t> block_order_by_variance(const float *data,
+                                              size_t n_rows, size_t dim,
+                                              size_t max_samples);
+
+/**
+ * @brief Scales v to unit L2 norm in place. Zero vectors are left as-is.
+ */
+void normalize(float *v, size_t dim);
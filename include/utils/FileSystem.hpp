@@ -0,0 +1,39 @@
+// include/utils/FileSystem.hpp
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// =========================================================
+// SECTION: Durable file operations
+// POSIX systems get real fsync/rename semantics; elsewhere these fall back
+// to the portable calls and the durability guarantees are best-effort.
+// All of them throw std::runtime_error on failure.
+// =========================================================
+
+bool file_exists(const std::string &path);
+
+/**
+ * @brief Flushes a closed file's data and metadata to stable storage.
+ */
+void sync_file(const std::string &path);
+
+/**
+ * @brief Flushes an open stdio stream through to stable storage.
+ */
+void sync_stream(std::FILE *file);
+
+/**
+ * @brief Persists the directory entry of `path` (after a create or
+ * rename), so the name itself survives a crash. No-op off POSIX.
+ */
+void sync_parent_directory(const std::string &path);
+
+/**
+ * @brief Renames `from` over `to`. Atomic on POSIX: a reader (or a crash)
+ * sees either the old file or the new one, never a mix.
+ */
+void replace_file(const std::string &from, const std::string &to);
+
+void truncate_file(const std::string &path, uint64_t size);
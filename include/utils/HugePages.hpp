@@ -0,0 +1,94 @@
+// include/utils/HugePages.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// =========================================================
+// SECTION: Huge pages
+// Scans over tens of GB of vectors take a TLB miss every 4 KB page. Large
+// buffers (the vector store, IVF lists, HNSW adjacency) are therefore
+// mapped on 2 MB boundaries and backed by huge pages where the OS allows:
+//   Transparent: anonymous mmap + madvise(MADV_HUGEPAGE). The kernel
+//                backs the range with huge pages when it can, and falls
+//                back to 4 KB pages silently.
+//   Explicit:    mmap(MAP_HUGETLB) from the hugetlbfs pool reserved in
+//                /proc/sys/vm/nr_hugepages. Falls back to Transparent
+//                when the pool is empty.
+// Linux only; elsewhere every allocation uses operator new.
+// =========================================================
+
+enum class HugePages : uint32_t { Off = 0, Transparent = 1, Explicit = 2 };
+
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+/**
+ * @brief Sets how allocations made from now on are backed. Existing
+ * buffers keep their pages until they are reallocated. Defaults to
+ * Transparent.
+ */
+void set_huge_pages(HugePages mode);
+HugePages huge_pages();
+
+/**
+ * @brief What large allocations currently alive actually obtained.
+ */
+struct HugePageStatus {
+  HugePages mode = HugePages::Transparent;
+  bool supported = false;          // Built for Linux
+  uint64_t explicit_bytes = 0;     // Backed by hugetlbfs pages
+  uint64_t transparent_bytes = 0;  // madvise(MADV_HUGEPAGE) accepted
+  uint64_t regular_bytes = 0;      // Large buffers left on 4 KB pages
+  uint64_t explicit_fallbacks = 0; // Explicit requests the pool refused
+  // AnonHugePages of the whole process from /proc/self/smaps_rollup: how
+  // much transparent memory the kernel really backed with huge pages.
+  // -1 where unavailable.
+  int64_t anon_huge_bytes = -1;
+};
+
+HugePageStatus huge_page_status();
+
+// Page-granular allocation behind HugePageAllocator. `bytes` must be at
+// least kHugePageSize; it is rounded up to whole huge pages.
+void *huge_page_alloc(size_t bytes);
+void huge_page_free(void *ptr, size_t bytes) noexcept;
+
+/**
+ * @brief Allocator that maps buffers of kHugePageSize or more through
+ * huge_page_alloc(); smaller ones come from operator new. Which path a
+ * buffer took depends only on its size, so it is freed correctly even if
+ * the mode changed in between.
+ */
+template <typename T> class HugePageAllocator {
+public:
+  using value_type = T;
+
+  HugePageAllocator() = default;
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    size_t bytes = n * sizeof(T);
+    if (bytes >= kHugePageSize)
+      return static_cast<T *>(huge_page_alloc(bytes));
+    return static_cast<T *>(::operator new(bytes));
+  }
+
+  void deallocate(T *ptr, size_t n) noexcept {
+    size_t bytes = n * sizeof(T);
+    if (bytes >= kHugePageSize)
+      huge_page_free(ptr, bytes);
+    else
+      ::operator delete(ptr);
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U> &) const noexcept {
+    return false;
+  }
+};
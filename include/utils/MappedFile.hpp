@@ -0,0 +1,39 @@
+// include/utils/MappedFile.hpp
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read-only view of a whole file.
+ * Memory-mapped on POSIX systems (pages are faulted in on demand, so large
+ * files cost no up-front read); elsewhere the file is read into memory.
+ */
+class MappedFile {
+private:
+  const unsigned char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<unsigned char> buffer_; // Non-mmap fallback
+
+public:
+  /**
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const unsigned char *data() const { return data_; }
+  size_t size() const { return size_; }
+  // False when the file was read into memory instead
+  bool mapped() const { return mapped_; }
+
+  /**
+   * @brief Hints that the file will be read front to back once.
+   */
+  void advise_sequential() const;
+};
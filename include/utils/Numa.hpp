@@ -0,0 +1,91 @@
+// include/utils/Numa.hpp
+
+#pragma once
+#include "utils/Parallel.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// =========================================================
+// SECTION: NUMA placement and routing
+// On multi-socket machines a thread reading memory attached to another
+// socket pays the interconnect on every cache miss. With NUMA awareness
+// on (set_numa_aware), the rows of the vector store are split into one
+// contiguous partition per node, each partition's pages are bound to its
+// node, and large Flat/IVF scans run every partition on threads pinned to
+// that node before merging their top-k. With a single node, or with the
+// option off, nothing changes.
+//
+// VEGAMDB_NUMA_NODES=N in the environment splits the CPUs into N
+// pretend nodes (threads are pinned, memory is not bound), so the routing
+// can be exercised on a single-node machine.
+// =========================================================
+
+void set_numa_aware(bool enabled);
+bool numa_aware();
+
+// Nodes with CPUs (at least 1)
+size_t numa_node_count();
+
+// numa_aware() on a machine with more than one node
+bool numa_active();
+
+/**
+ * @brief Rows [first, second) of partition `node` when `rows` rows are
+ * split evenly across numa_node_count() partitions.
+ */
+std::pair<size_t, size_t> numa_partition(size_t rows, size_t node);
+
+/**
+ * @brief Binds each node's partition of a row-major rows x dim buffer to
+ * that node's memory, migrating pages already faulted in. Boundaries are
+ * rounded to huge pages, so buffers smaller than one huge page per node
+ * are left alone. No-op unless numa_active() on real nodes.
+ */
+void numa_bind_rows(const float *data, size_t rows, size_t dim);
+
+/**
+ * @brief Pins the calling thread to the CPUs of partition `node` for its
+ * lifetime, then restores the previous affinity.
+ */
+class NumaPin {
+private:
+  std::vector<unsigned char> saved_; // Previous CPU mask
+  bool pinned_ = false;
+
+public:
+  explicit NumaPin(size_t node);
+  ~NumaPin();
+
+  NumaPin(const NumaPin &) = delete;
+  NumaPin &operator=(const NumaPin &) = delete;
+};
+
+/**
+ * @brief NUMA-routed parallel_for_dynamic(): node n's items
+ * [0, node_items[n]) run on threads_per_node threads pinned to node n, as
+ * fn(worker, node, item). `worker` is in [0, nodes * threads_per_node),
+ * fixed per thread.
+ */
+template <typename Fn>
+void numa_for_dynamic(const std::vector<size_t> &node_items,
+                      size_t threads_per_node, Fn &&fn) {
+  size_t nodes = node_items.size();
+  threads_per_node = std::max<size_t>(1, threads_per_node);
+  std::unique_ptr<std::atomic<size_t>[]> next(
+      new std::atomic<size_t>[nodes]());
+  size_t n_workers = nodes * threads_per_node;
+
+  parallel_for(n_workers, n_workers, [&](size_t begin, size_t end) {
+    for (size_t worker = begin; worker < end; worker++) {
+      size_t node = worker / threads_per_node;
+      NumaPin pin(node);
+      size_t item;
+      while ((item = next[node].fetch_add(1, std::memory_order_relaxed)) <
+             node_items[node])
+        fn(worker, node, item);
+    }
+  });
+}
@@ -0,0 +1,86 @@
+// include/utils/Parallel.hpp
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Number of worker threads to use by default (hardware threads,
+ * at least 1).
+ */
+inline size_t default_num_threads() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+/**
+ * @brief Splits [0, n) into contiguous chunks and runs fn(begin, end) on
+ * each, using up to n_threads threads. The calling thread processes the
+ * first chunk itself; with n_threads <= 1 everything runs inline.
+ */
+template <typename Fn> void parallel_for(size_t n, size_t n_threads, Fn &&fn) {
+  n_threads = std::max<size_t>(1, std::min(n_threads, n));
+  if (n_threads == 1) {
+    if (n > 0)
+      fn(size_t(0), n);
+    return;
+  }
+
+  size_t chunk = (n + n_threads - 1) / n_threads;
+  std::vector<std::thread> workers;
+  workers.reserve(n_threads - 1);
+
+  for (size_t t = 1; t < n_threads; t++) {
+    size_t begin = t * chunk;
+    size_t end = std::min(n, begin + chunk);
+    if (begin >= end)
+      break;
+    workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+  }
+
+  fn(size_t(0), std::min(n, chunk));
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Runs fn(worker, item) for every item in [0, n_items) on up to
+ * n_threads threads. Items are handed out one at a time from a shared
+ * counter, so uneven items (e.g. IVF lists) still balance. `worker` is in
+ * [0, n_threads) and is fixed per thread, for indexing per-thread state.
+ */
+template <typename Fn>
+void parallel_for_dynamic(size_t n_items, size_t n_threads, Fn &&fn) {
+  n_threads = std::max<size_t>(1, std::min(n_threads, n_items));
+  std::atomic<size_t> next{0};
+  parallel_for(n_threads, n_threads, [&](size_t begin, size_t end) {
+    for (size_t worker = begin; worker < end; worker++) {
+      size_t item;
+      while ((item = next.fetch_add(1, std::memory_order_relaxed)) < n_items)
+        fn(worker, item);
+    }
+  });
+}
+
+// Single-query scans (Flat, IVF) touching fewer floats than this run on
+// the calling thread; larger ones give each thread at least
+// kFloatsPerScanThread, so thread start-up stays a small fraction of the
+// work.
+constexpr size_t kParallelScanFloats = size_t(1) << 21;
+constexpr size_t kFloatsPerScanThread = size_t(1) << 19;
+
+/**
+ * @brief Threads to use for one query that reads `n_floats` vector
+ * components.
+ */
+inline size_t scan_threads(size_t n_floats) {
+  if (n_floats < kParallelScanFloats)
+    return 1;
+  return std::max<size_t>(
+      1, std::min(default_num_threads(), n_floats / kFloatsPerScanThread));
+}
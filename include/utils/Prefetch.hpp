@@ -0,0 +1,74 @@
+// include/utils/Prefetch.hpp
+
+#pragma once
+#include "storage/MatrixView.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define VEGAMDB_PREFETCH(ptr)                                                  \
+  _mm_prefetch(reinterpret_cast<const char *>(ptr), _MM_HINT_T0)
+#else
+#define VEGAMDB_PREFETCH(ptr) __builtin_prefetch((ptr), 0, 3)
+#endif
+
+// =========================================================
+// SECTION: Gather scans
+// Scoring rows picked by an id list (an IVF list, Annoy candidates) walks
+// memory in a data-dependent order the hardware prefetcher cannot follow,
+// so every row is a cache miss. gather_scan() requests the row a few ids
+// ahead while the current one is scored. Id lists sorted ascending help
+// too: consecutive rows often share pages and cache lines.
+// =========================================================
+
+// Rows requested ahead of the one being scored
+constexpr size_t kPrefetchRows = 8;
+
+// Cache lines requested per row. The line prefetcher fetches the rest of
+// a long row once its head is touched.
+constexpr size_t kPrefetchLines = 8;
+
+constexpr size_t kCacheLine = 64;
+
+/**
+ * @brief Requests the leading cache lines of a `dim`-float row.
+ */
+inline void prefetch_row(const float *row, size_t dim) {
+  const char *p = reinterpret_cast<const char *>(row);
+  size_t lines =
+      std::min(kPrefetchLines, (dim * sizeof(float) + kCacheLine - 1) /
+                                   kCacheLine);
+  for (size_t i = 0; i < lines; i++)
+    VEGAMDB_PREFETCH(p + i * kCacheLine);
+}
+
+/**
+ * @brief Calls fn(id, row) for each of the `n` ids, prefetching the row
+ * kPrefetchRows ids ahead. `skip(id)` drops an id without scoring or
+ * prefetching it (e.g. one outside a filter).
+ */
+template <typename Id, typename Skip, typename Fn>
+void gather_scan(const MatrixView &data, const Id *ids, size_t n, Skip &&skip,
+                 Fn &&fn) {
+  size_t ahead = std::min(n, kPrefetchRows);
+  for (size_t i = 0; i < ahead; i++)
+    prefetch_row(data.row(ids[i]), data.dim);
+
+  for (size_t i = 0; i < n; i++) {
+    if (i + kPrefetchRows < n && !skip(ids[i + kPrefetchRows]))
+      prefetch_row(data.row(ids[i + kPrefetchRows]), data.dim);
+    if (!skip(ids[i]))
+      fn(ids[i], data.row(ids[i]));
+  }
+}
+
+/**
+ * @brief gather_scan() over every id.
+ */
+template <typename Id, typename Fn>
+void gather_scan(const MatrixView &data, const Id *ids, size_t n, Fn &&fn) {
+  gather_scan(
+      data, ids, n, [](Id) { return false; }, std::forward<Fn>(fn));
+}
@@ -0,0 +1,100 @@
+// include/utils/Progress.hpp
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// =========================================================
+// SECTION: Snapshots
+// =========================================================
+
+struct BuildPhaseTiming {
+  std::string name;
+  double seconds = 0.0;
+};
+
+/**
+ * @brief Point-in-time copy of a BuildProgress.
+ * `done` / `total` count work units of the current phase (k-means:
+ * vectors assigned across all iterations; Annoy: trees built).
+ */
+struct BuildProgressSnapshot {
+  bool running = false;
+  std::string index;
+  std::string phase;
+  uint64_t done = 0;
+  uint64_t total = 0;
+  double elapsed_seconds = 0.0;
+  std::vector<BuildPhaseTiming> phases; // Completed phases, in order
+
+  double fraction() const {
+    return total ? static_cast<double>(done) / total : 0.0;
+  }
+};
+
+using BuildProgressCallback = std::function<void(const BuildProgressSnapshot &)>;
+
+// =========================================================
+// SECTION: BuildProgress
+// =========================================================
+
+/**
+ * @brief Progress of a long-running index build.
+ * The builder calls begin_phase()/advance(); any other thread may call
+ * snapshot() at any time. advance() is a relaxed atomic add, so builders
+ * can report from hot loops. Phase changes take a mutex (they are rare).
+ *
+ * An optional callback runs on the building thread at every phase change
+ * and at most every kCallbackInterval during a phase.
+ */
+class BuildProgress {
+private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr std::chrono::milliseconds kCallbackInterval{200};
+
+  mutable std::mutex mutex_; // Guards everything below except the atomics
+  std::string index_;
+  std::string phase_;
+  std::vector<BuildPhaseTiming> phases_;
+  Clock::time_point build_start_;
+  Clock::time_point phase_start_;
+  BuildProgressCallback callback_;
+
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> done_{0};
+  std::atomic<uint64_t> total_{0};
+  std::atomic<int64_t> next_callback_ns_{0};
+
+public:
+  void set_callback(BuildProgressCallback callback);
+
+  /**
+   * @brief Resets all state and marks a build of `index` as running.
+   */
+  void start(const std::string &index);
+
+  /**
+   * @brief Closes the current phase (recording its time) and opens a new
+   * one with `total` work units.
+   */
+  void begin_phase(const std::string &name, uint64_t total);
+
+  void advance(uint64_t n = 1);
+
+  /**
+   * @brief Closes the last phase and marks the build as finished.
+   */
+  void finish();
+
+  BuildProgressSnapshot snapshot() const;
+
+private:
+  void close_phase_locked(Clock::time_point now);
+  BuildProgressSnapshot snapshot_locked(Clock::time_point now) const;
+  void notify(bool force);
+};
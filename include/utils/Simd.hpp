@@ -0,0 +1,35 @@
+// include/utils/Simd.hpp
+
+#pragma once
+
+// =========================================================
+// SIMD feature detection
+// Kernels are selected at compile time from the flags CMake passes
+// (-march=native, or /arch:AVX2 on MSVC). Distribution builds without
+// those flags fall back to the scalar loops, which -O3 still vectorizes
+// to SSE2.
+// =========================================================
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define VEGAMDB_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define VEGAMDB_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef VEGAMDB_AVX2
+/**
+ * @brief Horizontal sum of the 8 float lanes of an AVX register.
+ */
+inline float hsum256_ps(__m256 v) {
+  __m128 lo = _mm256_castps256_ps128(v);
+  __m128 hi = _mm256_extractf128_ps(v, 1);
+  lo = _mm_add_ps(lo, hi);
+  __m128 shuf = _mm_movehdup_ps(lo);
+  __m128 sums = _mm_add_ps(lo, shuf);
+  shuf = _mm_movehl_ps(shuf, sums);
+  sums = _mm_add_ss(sums, shuf);
+  return _mm_cvtss_f32(sums);
+}
+#endif
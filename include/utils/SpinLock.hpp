@@ -0,0 +1,50 @@
+// include/utils/SpinLock.hpp
+
+#pragma once
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define VEGAMDB_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__)
+#define VEGAMDB_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define VEGAMDB_CPU_RELAX() ((void)0)
+#endif
+
+/**
+ * @brief One-byte test-and-test-and-set lock for very short critical
+ * sections (e.g. editing one graph node's neighbor list). Spins on a
+ * plain load so waiters do not bounce the cache line, and yields the
+ * thread after a while in case the holder was descheduled. Satisfies
+ * Lockable, so it works with std::lock_guard.
+ */
+class SpinLock {
+private:
+  std::atomic<bool> locked_{false};
+
+  static constexpr int kSpinsBeforeYield = 64;
+
+public:
+  void lock() {
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+      int spins = 0;
+      while (locked_.load(std::memory_order_relaxed)) {
+        if (++spins < kSpinsBeforeYield) {
+          VEGAMDB_CPU_RELAX();
+        } else {
+          std::this_thread::yield();
+          spins = 0;
+        }
+      }
+    }
+  }
+
+  bool try_lock() {
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
+
+  void unlock() { locked_.store(false, std::memory_order_release); }
+};
@@ -0,0 +1,117 @@
+// include/utils/Stats.hpp
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =========================================================
+// SECTION: Per-query statistics
+// =========================================================
+
+/**
+ * @brief What one search did. Pass one to search() to have it filled in;
+ * counters are added to, so a zeroed object is expected.
+ *
+ * Phase times (microseconds):
+ *  - ranking_us: IVF centroid scoring + ordering, Annoy tree traversal,
+ *                HNSW graph search, DiskANN beam search (including its
+ *                disk reads).
+ *  - scan_us:    IVF list scan, Flat full scan, Annoy candidate scoring.
+ *  - rerank_us:  sorting/selecting the final top-k.
+ *  - total_us:   whole VegamDB::search call (not set by indexes).
+ */
+struct SearchStats {
+  uint64_t distance_computations = 0; // Vector and centroid distances
+  uint64_t lists_visited = 0;         // IVF inverted lists scanned
+  uint64_t nodes_visited = 0;         // Annoy margins; graph nodes expanded
+  uint64_t leaves_visited = 0;        // Annoy leaves collected
+  uint64_t candidates = 0;            // Vectors scored
+  uint64_t duplicates_removed = 0;    // Candidates seen in several leaves
+  bool filter_fallback = false;       // Selective filter took exact path
+
+  double ranking_us = 0.0;
+  double scan_us = 0.0;
+  double rerank_us = 0.0;
+  double total_us = 0.0;
+};
+
+// =========================================================
+// SECTION: Aggregates
+// Updated with relaxed atomics from concurrent searches; readers get a
+// consistent-enough snapshot for monitoring, never a torn counter.
+// =========================================================
+
+/**
+ * @brief Lock-free power-of-two histogram. Bucket 0 counts zeros and
+ * bucket i (i >= 1) counts values in [2^(i-1), 2^i).
+ */
+class Log2Histogram {
+public:
+  static constexpr size_t kBuckets = 40;
+
+private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+
+public:
+  void record(uint64_t value);
+  std::vector<uint64_t> counts() const;
+  void reset();
+};
+
+/**
+ * @brief Point-in-time copy of SearchStatsAggregator. Sums are over all
+ * recorded queries; histograms are Log2Histogram bucket counts.
+ */
+struct SearchStatsSummary {
+  uint64_t queries = 0;
+  uint64_t distance_computations = 0;
+  uint64_t lists_visited = 0;
+  uint64_t nodes_visited = 0;
+  uint64_t leaves_visited = 0;
+  uint64_t candidates = 0;
+  uint64_t duplicates_removed = 0;
+  uint64_t filter_fallbacks = 0;
+
+  double ranking_us = 0.0;
+  double scan_us = 0.0;
+  double rerank_us = 0.0;
+  double total_us = 0.0;
+
+  std::vector<uint64_t> latency_histogram_us;
+  std::vector<uint64_t> distance_histogram;
+
+  /**
+   * @brief Approximate latency percentile (p in [0, 100]) in microseconds:
+   * the upper edge of the histogram bucket holding that rank.
+   */
+  double latency_percentile_us(double p) const;
+};
+
+class SearchStatsAggregator {
+private:
+  std::atomic<uint64_t> queries_{0};
+  std::atomic<uint64_t> distance_computations_{0};
+  std::atomic<uint64_t> lists_visited_{0};
+  std::atomic<uint64_t> nodes_visited_{0};
+  std::atomic<uint64_t> leaves_visited_{0};
+  std::atomic<uint64_t> candidates_{0};
+  std::atomic<uint64_t> duplicates_removed_{0};
+  std::atomic<uint64_t> filter_fallbacks_{0};
+
+  // Times are summed in nanoseconds so they fit integer atomics
+  std::atomic<uint64_t> ranking_ns_{0};
+  std::atomic<uint64_t> scan_ns_{0};
+  std::atomic<uint64_t> rerank_ns_{0};
+  std::atomic<uint64_t> total_ns_{0};
+
+  Log2Histogram latency_us_;
+  Log2Histogram distances_;
+
+public:
+  void record(const SearchStats &stats);
+  SearchStatsSummary summary() const;
+  void reset();
+};
@@ -0,0 +1,36 @@
+// include/utils/Timer.hpp
+
+#pragma once
+#include <chrono>
+
+/**
+ * @brief Splits elapsed wall time into consecutive phases.
+ * A disabled timer never reads the clock, so instrumented code paths cost
+ * nothing when no one asked for timings.
+ */
+class PhaseTimer {
+private:
+  using Clock = std::chrono::steady_clock;
+  bool enabled_;
+  Clock::time_point last_;
+
+public:
+  explicit PhaseTimer(bool enabled = true) : enabled_(enabled) {
+    if (enabled_)
+      last_ = Clock::now();
+  }
+
+  /**
+   * @brief Microseconds since the previous lap (or construction); starts
+   * the next phase. Returns 0 when disabled.
+   */
+  double lap() {
+    if (!enabled_)
+      return 0.0;
+    Clock::time_point now = Clock::now();
+    double elapsed =
+        std::chrono::duration<double, std::micro>(now - last_).count();
+    last_ = now;
+    return elapsed;
+  }
+};
@@ -0,0 +1,56 @@
+// include/utils/TopK.hpp
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Keeps the k smallest (distance, id) pairs pushed into it.
+ * A max-heap of the current best k: a rejected candidate costs one
+ * comparison, an accepted one O(log k). Ties are broken by id, so the
+ * result does not depend on the order candidates arrive in (e.g. how a
+ * scan was split across threads).
+ */
+class TopK {
+private:
+  size_t k_;
+  std::vector<std::pair<float, int>> heap_;
+
+public:
+  explicit TopK(size_t k) : k_(k) { heap_.reserve(k); }
+
+  size_t size() const { return heap_.size(); }
+
+  // Distance a candidate must beat to be kept
+  float threshold() const {
+    return heap_.size() < k_ ? std::numeric_limits<float>::infinity()
+                             : heap_.front().first;
+  }
+
+  void push(int id, float distance) {
+    std::pair<float, int> item{distance, id};
+    if (heap_.size() < k_) {
+      heap_.push_back(item);
+      std::push_heap(heap_.begin(), heap_.end());
+    } else if (k_ > 0 && item < heap_.front()) {
+      std::pop_heap(heap_.begin(), heap_.end());
+      heap_.back() = item;
+      std::push_heap(heap_.begin(), heap_.end());
+    }
+  }
+
+  void merge(const TopK &other) {
+    for (const auto &item : other.heap_) {
+      push(item.second, item.first);
+    }
+  }
+
+  // The kept pairs, closest first. Leaves this object empty.
+  std::vector<std::pair<float, int>> take_sorted() {
+    std::sort_heap(heap_.begin(), heap_.end());
+    return std::move(heap_);
+  }
+};
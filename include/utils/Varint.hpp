@@ -0,0 +1,87 @@
+// include/utils/Varint.hpp
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// =========================================================
+// SECTION: LEB128 varints
+// Used to delta-encode id lists on disk: ids within an inverted list are
+// mostly ascending, so deltas fit in one or two bytes instead of four.
+// =========================================================
+
+inline void append_varint(std::vector<char> &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Decodes one varint at `p`, returning the position after it.
+ * @throws std::runtime_error if the input ends mid-varint.
+ */
+inline const char *read_varint(const char *p, const char *end,
+                               uint64_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (p == end)
+      throw std::runtime_error("Truncated varint");
+    uint8_t byte = static_cast<uint8_t>(*p++);
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return p;
+  }
+  throw std::runtime_error("Malformed varint");
+}
+
+// Maps signed deltas to unsigned so small negatives stay small
+inline uint64_t zigzag_encode(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+/**
+ * @brief Appends varint(n) then zigzag-varint deltas of ids[0, n).
+ */
+inline void append_delta_ids(std::vector<char> &out, const int *ids,
+                             size_t n) {
+  append_varint(out, n);
+  int64_t prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    append_varint(out, zigzag_encode(ids[i] - prev));
+    prev = ids[i];
+  }
+}
+
+inline void append_delta_ids(std::vector<char> &out,
+                             const std::vector<int> &ids) {
+  append_delta_ids(out, ids.data(), ids.size());
+}
+
+/**
+ * @brief Inverse of append_delta_ids.
+ */
+inline const char *read_delta_ids(const char *p, const char *end,
+                                  std::vector<int> &ids) {
+  uint64_t size = 0;
+  p = read_varint(p, end, size);
+  // Every id takes at least one byte, which bounds a corrupt size
+  if (size > static_cast<uint64_t>(end - p))
+    throw std::runtime_error("Corrupt id list");
+  ids.resize(size);
+  int64_t prev = 0;
+  for (uint64_t i = 0; i < size; i++) {
+    uint64_t delta = 0;
+    p = read_varint(p, end, delta);
+    prev += zigzag_decode(delta);
+    ids[i] = static_cast<int>(prev);
+  }
+  return p;
+}
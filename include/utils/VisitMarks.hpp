@@ -0,0 +1,43 @@
+// include/utils/VisitMarks.hpp
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Per-thread visited set over [0, n) that clears in O(1) by
+ * bumping an epoch instead of zeroing. Used by the graph searches.
+ */
+class VisitMarks {
+private:
+  std::vector<uint32_t> marks_;
+  uint32_t epoch_ = 0;
+
+public:
+  explicit VisitMarks(size_t n) : marks_(n, 0) {}
+
+  size_t size() const { return marks_.size(); }
+
+  // Grows the id range; new ids start unvisited
+  void resize(size_t n) {
+    if (n > marks_.size())
+      marks_.resize(n, 0);
+  }
+
+  void reset() {
+    if (++epoch_ == 0) {
+      std::fill(marks_.begin(), marks_.end(), 0);
+      epoch_ = 1;
+    }
+  }
+
+  // True the first time `id` is seen since reset()
+  bool visit(uint32_t id) {
+    if (marks_[id] == epoch_)
+      return false;
+    marks_[id] = epoch_;
+    return true;
+  }
+};
@@ -0,0 +1,527 @@
+// src/ShardedVegamDB.cpp
+
+#include "ShardedVegamDB.hpp"
+#include "indexes/FlatIndex.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Timer.hpp"
+#include "utils/TopK.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using ReadLock = std::shared_lock<std::shared_mutex>;
+using WriteLock = std::unique_lock<std::shared_mutex>;
+
+namespace {
+
+constexpr uint32_t kManifestMagic = 0x48534756; // "VGSH"
+// v2 adds the generation; v1 manifests name their shards without one
+constexpr uint32_t kManifestVersion = 2;
+
+uint64_t splitmix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+size_t route_id(size_t id, ShardPolicy policy, size_t n_shards,
+                size_t range_size) {
+  if (policy == ShardPolicy::Range)
+    return (id / range_size) % n_shards;
+  return splitmix64(id) % n_shards;
+}
+
+// Generation 0 is a v1 manifest's layout
+std::string shard_path(const std::string &filename, uint64_t generation,
+                       size_t shard) {
+  if (generation == 0)
+    return filename + ".shard" + std::to_string(shard);
+  return filename + ".g" + std::to_string(generation) + ".shard" +
+         std::to_string(shard);
+}
+
+/**
+ * @brief Runs fn(shard) for each listed shard on its own thread (up to
+ * the core count). An exception would otherwise terminate a worker
+ * thread, so each is kept and the first one rethrown once all are done.
+ */
+template <typename Fn>
+void for_each_shard(const std::vector<size_t> &shards, Fn &&fn) {
+  std::vector<std::exception_ptr> errors(shards.size());
+  parallel_for_dynamic(shards.size(), default_num_threads(),
+                       [&](size_t, size_t item) {
+                         try {
+                           fn(shards[item]);
+                         } catch (...) {
+                           errors[item] = std::current_exception();
+                         }
+                       });
+  for (const auto &error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+template <typename T> void write_pod(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void read_pod(std::istream &in, T &value) {
+  in.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+struct Manifest {
+  uint32_t n_shards = 0;
+  uint32_t policy = 0;
+  uint32_t metric = 0;
+  uint64_t range_size = 0;
+  uint64_t rows = 0;
+  int32_t dim = 0;
+  uint64_t generation = 0;
+};
+
+Manifest read_manifest(const std::string &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Cannot open " + filename);
+
+  uint32_t magic = 0, version = 0;
+  Manifest m;
+  read_pod(in, magic);
+  read_pod(in, version);
+  read_pod(in, m.n_shards);
+  read_pod(in, m.policy);
+  read_pod(in, m.metric);
+  read_pod(in, m.range_size);
+  read_pod(in, m.rows);
+  read_pod(in, m.dim);
+  if (version >= 2)
+    read_pod(in, m.generation);
+  if (!in || magic != kManifestMagic)
+    throw std::runtime_error("ShardedVegamDB::load: " + filename +
+                             " is not a shard manifest");
+  if (version == 0 || version > kManifestVersion || m.n_shards == 0 ||
+      m.range_size == 0 ||
+      m.policy > static_cast<uint32_t>(ShardPolicy::Range) ||
+      (version >= 2 && m.generation == 0))
+    throw std::runtime_error("ShardedVegamDB::load: unsupported manifest " +
+                             filename);
+
+  if (m.metric > static_cast<uint32_t>(Metric::Cosine))
+    throw std::runtime_error("ShardedVegamDB::load: unsupported manifest " +
+                             filename);
+  return m;
+}
+
+} // namespace
+
+ShardedVegamDB::ShardedVegamDB(size_t n_shards, ShardPolicy policy,
+                               Metric metric, size_t range_size)
+    : policy_(policy), range_size_(range_size), metric_(metric) {
+  if (n_shards == 0)
+    throw std::invalid_argument("ShardedVegamDB needs at least one shard");
+  if (range_size == 0)
+    throw std::invalid_argument("ShardedVegamDB: range_size must be > 0");
+
+  for (size_t i = 0; i < n_shards; i++)
+    this->shards_.push_back(std::make_shared<VegamDB>(metric));
+  this->global_ids_.resize(n_shards);
+}
+
+// =========================================================
+// SECTION: Routing
+// =========================================================
+
+size_t ShardedVegamDB::route(size_t id) const {
+  return route_id(id, this->policy_, this->shards_.size(), this->range_size_);
+}
+
+void ShardedVegamDB::assign_ids(size_t first, size_t end) {
+  this->shard_of_.reserve(end);
+  this->local_of_.reserve(end);
+  for (size_t id = first; id < end; id++) {
+    size_t shard = route(id);
+    this->shard_of_.push_back(static_cast<uint32_t>(shard));
+    this->local_of_.push_back(
+        static_cast<int>(this->global_ids_[shard].size()));
+    this->global_ids_[shard].push_back(static_cast<int>(id));
+  }
+}
+
+void ShardedVegamDB::reset_mapping() {
+  this->shard_of_.clear();
+  this->local_of_.clear();
+  this->global_ids_.assign(this->shards_.size(), {});
+  this->dimension_ = 0;
+}
+
+size_t ShardedVegamDB::shard_count() const {
+  ReadLock lock(this->mutex_);
+  return this->shards_.size();
+}
+
+ShardPolicy ShardedVegamDB::policy() const {
+  ReadLock lock(this->mutex_);
+  return this->policy_;
+}
+
+size_t ShardedVegamDB::range_size() const {
+  ReadLock lock(this->mutex_);
+  return this->range_size_;
+}
+
+Metric ShardedVegamDB::metric() const {
+  ReadLock lock(this->mutex_);
+  return this->metric_;
+}
+
+std::shared_ptr<VegamDB> ShardedVegamDB::shard(size_t i) const {
+  ReadLock lock(this->mutex_);
+  if (i >= this->shards_.size())
+    throw std::out_of_range("Shard " + std::to_string(i) + " of " +
+                            std::to_string(this->shards_.size()));
+  return this->shards_[i];
+}
+
+size_t ShardedVegamDB::shard_of(int id) const {
+  ReadLock lock(this->mutex_);
+  if (id < 0 || static_cast<size_t>(id) >= this->shard_of_.size())
+    throw std::out_of_range("No vector with id " + std::to_string(id));
+  return this->shard_of_[id];
+}
+
+int ShardedVegamDB::global_id(size_t shard, int local_id) const {
+  ReadLock lock(this->mutex_);
+  if (shard >= this->global_ids_.size() || local_id < 0 ||
+      static_cast<size_t>(local_id) >= this->global_ids_[shard].size())
+    throw std::out_of_range("No row " + std::to_string(local_id) +
+                            " in shard " + std::to_string(shard));
+  return this->global_ids_[shard][local_id];
+}
+
+// =========================================================
+// SECTION: Data
+// =========================================================
+
+void ShardedVegamDB::add_vector(const std::vector<float> &vec) {
+  add_vector_np(vec.data(), 1, vec.size());
+}
+
+void ShardedVegamDB::add_vector_np(const float *arr, size_t n_vectors,
+                                   size_t dim) {
+  WriteLock lock(this->mutex_);
+  // Checked up front: a shard failing half-way would desync the mapping
+  if (!this->shard_of_.empty() &&
+      dim != static_cast<size_t>(this->dimension_)) {
+    throw std::invalid_argument(
+        "Vector dimension mismatch: store has " +
+        std::to_string(this->dimension_) + ", got " + std::to_string(dim));
+  }
+  if (n_vectors == 0)
+    return;
+
+  size_t first = this->shard_of_.size();
+  std::vector<std::vector<float>> batches(this->shards_.size());
+  for (size_t row = 0; row < n_vectors; row++) {
+    std::vector<float> &batch = batches[route(first + row)];
+    batch.insert(batch.end(), arr + row * dim, arr + (row + 1) * dim);
+  }
+
+  std::vector<size_t> targets;
+  for (size_t s = 0; s < batches.size(); s++) {
+    if (!batches[s].empty())
+      targets.push_back(s);
+  }
+  for_each_shard(targets, [&](size_t s) {
+    this->shards_[s]->add_vector_np(batches[s].data(),
+                                    batches[s].size() / dim, dim);
+  });
+
+  this->dimension_ = static_cast<int>(dim);
+  assign_ids(first, first + n_vectors);
+}
+
+int ShardedVegamDB::size() const {
+  ReadLock lock(this->mutex_);
+  return static_cast<int>(this->shard_of_.size());
+}
+
+int ShardedVegamDB::dimension() const {
+  ReadLock lock(this->mutex_);
+  return this->dimension_;
+}
+
+void ShardedVegamDB::remove(const std::vector<int> &ids) {
+  ReadLock lock(this->mutex_);
+  size_t n = this->shard_of_.size();
+  std::vector<std::vector<int>> local(this->shards_.size());
+  for (int id : ids) {
+    if (id < 0 || static_cast<size_t>(id) >= n)
+      throw std::invalid_argument("Cannot remove id " + std::to_string(id) +
+                                  ": database has " + std::to_string(n) +
+                                  " vectors");
+    local[this->shard_of_[id]].push_back(this->local_of_[id]);
+  }
+  for (size_t s = 0; s < local.size(); s++) {
+    if (!local[s].empty())
+      this->shards_[s]->remove(local[s]);
+  }
+}
+
+bool ShardedVegamDB::is_deleted(int id) const {
+  ReadLock lock(this->mutex_);
+  if (id < 0 || static_cast<size_t>(id) >= this->shard_of_.size())
+    return false;
+  return this->shards_[this->shard_of_[id]]->is_deleted(this->local_of_[id]);
+}
+
+size_t ShardedVegamDB::deleted_count() const {
+  ReadLock lock(this->mutex_);
+  size_t total = 0;
+  for (const auto &shard : this->shards_)
+    total += shard->deleted_count();
+  return total;
+}
+
+// =========================================================
+// SECTION: Index management
+// =========================================================
+
+void ShardedVegamDB::set_index(
+    const std::function<std::unique_ptr<IndexBase>()> &make_index) {
+  ReadLock lock(this->mutex_);
+  for (auto &shard : this->shards_)
+    shard->set_index(make_index());
+}
+
+void ShardedVegamDB::build_index() {
+  ReadLock lock(this->mutex_);
+  std::vector<size_t> targets;
+  for (size_t s = 0; s < this->shards_.size(); s++) {
+    if (!this->global_ids_[s].empty())
+      targets.push_back(s);
+  }
+  for_each_shard(targets, [&](size_t s) { build_shard_locked(s); });
+}
+
+void ShardedVegamDB::build_shard(size_t i) {
+  ReadLock lock(this->mutex_);
+  if (i >= this->shards_.size())
+    throw std::out_of_range("Shard " + std::to_string(i) + " of " +
+                            std::to_string(this->shards_.size()));
+  build_shard_locked(i);
+}
+
+void ShardedVegamDB::build_shard_locked(size_t i) {
+  VegamDB &db = *this->shards_[i];
+  if (!db.get_index())
+    db.set_index(std::make_unique<FlatIndex>(this->metric_));
+  db.build_index();
+}
+
+// =========================================================
+// SECTION: Search
+// =========================================================
+
+SearchResults ShardedVegamDB::search(const std::vector<float> &query, int k,
+                                     const SearchParams *params,
+                                     const Bitmap *filter,
+                                     SearchStats *stats) {
+  PhaseTimer timer;
+  ReadLock lock(this->mutex_);
+  if (!this->shard_of_.empty() &&
+      query.size() != static_cast<size_t>(this->dimension_))
+    throw std::invalid_argument(
+        "Query dimension mismatch: store has " +
+        std::to_string(this->dimension_) + ", got " +
+        std::to_string(query.size()));
+  size_t n_shards = this->shards_.size();
+
+  // Translate the global allow-list into one local allow-list per shard
+  std::vector<Bitmap> filters;
+  if (filter) {
+    filters.reserve(n_shards);
+    for (size_t s = 0; s < n_shards; s++)
+      filters.emplace_back(this->global_ids_[s].size());
+    size_t n = this->shard_of_.size();
+    filter->for_each([&](int id) {
+      if (static_cast<size_t>(id) < n)
+        filters[this->shard_of_[id]].set(this->local_of_[id]);
+    });
+  }
+
+  std::vector<size_t> targets;
+  for (size_t s = 0; s < n_shards; s++) {
+    if (!this->global_ids_[s].empty() && (!filter || filters[s].count() > 0))
+      targets.push_back(s);
+  }
+
+  std::vector<SearchResults> partial(n_shards);
+  std::vector<SearchStats> shard_stats(n_shards);
+  for_each_shard(targets, [&](size_t s) {
+    partial[s] = this->shards_[s]->search(query, k, params,
+                                          filter ? &filters[s] : nullptr,
+                                          &shard_stats[s]);
+  });
+
+  TopK top(static_cast<size_t>(std::max(k, 0)));
+  SearchStats query_stats;
+  for (size_t s : targets) {
+    const std::vector<int> &global = this->global_ids_[s];
+    for (size_t j = 0; j < partial[s].ids.size(); j++)
+      top.push(global[partial[s].ids[j]], partial[s].distances[j]);
+
+    const SearchStats &part = shard_stats[s];
+    query_stats.distance_computations += part.distance_computations;
+    query_stats.lists_visited += part.lists_visited;
+    query_stats.nodes_visited += part.nodes_visited;
+    query_stats.leaves_visited += part.leaves_visited;
+    query_stats.candidates += part.candidates;
+    query_stats.duplicates_removed += part.duplicates_removed;
+    query_stats.filter_fallback |= part.filter_fallback;
+    // Shards run concurrently: the slowest one bounds each phase
+    query_stats.ranking_us = std::max(query_stats.ranking_us, part.ranking_us);
+    query_stats.scan_us = std::max(query_stats.scan_us, part.scan_us);
+    query_stats.rerank_us = std::max(query_stats.rerank_us, part.rerank_us);
+  }
+
+  SearchResults results;
+  for (const auto &item : top.take_sorted()) {
+    results.ids.push_back(item.second);
+    results.distances.push_back(item.first);
+  }
+
+  query_stats.total_us = timer.lap();
+  this->search_stats_.record(query_stats);
+  if (stats)
+    *stats = query_stats;
+  return results;
+}
+
+SearchStatsSummary ShardedVegamDB::search_stats() const {
+  return this->search_stats_.summary();
+}
+
+void ShardedVegamDB::reset_search_stats() { this->search_stats_.reset(); }
+
+// =========================================================
+// SECTION: Persistence
+// The manifest records the layout; the shards are ordinary VegamDB
+// snapshots. The id mapping is not stored: replaying the routing over
+// the saved row count reproduces it, and each shard's row count is
+// checked against it.
+//
+// Each save is a new generation: its shards go to fresh files named
+// after it, and the manifest naming them is renamed over the old one
+// last. Until that rename the old manifest and its shards are untouched,
+// so a crash at any point leaves one complete snapshot or the other.
+// =========================================================
+
+void ShardedVegamDB::save(const std::string &filename,
+                          const SaveOptions &options) {
+  ReadLock lock(this->mutex_);
+
+  // The generation after the one on disk, if there is a readable one
+  bool has_previous = false;
+  Manifest previous;
+  try {
+    previous = read_manifest(filename);
+    has_previous = true;
+  } catch (const std::runtime_error &) {
+    // None yet, or unreadable: nothing to clean up afterwards
+  }
+  uint64_t generation = has_previous ? previous.generation + 1 : 1;
+
+  std::vector<size_t> all(this->shards_.size());
+  for (size_t s = 0; s < all.size(); s++)
+    all[s] = s;
+  std::string temp = filename + ".tmp";
+  try {
+    for_each_shard(all, [&](size_t s) {
+      this->shards_[s]->save(shard_path(filename, generation, s), options);
+    });
+
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("ShardedVegamDB::save: cannot open " + temp);
+    write_pod(out, kManifestMagic);
+    write_pod(out, kManifestVersion);
+    write_pod(out, static_cast<uint32_t>(this->shards_.size()));
+    write_pod(out, static_cast<uint32_t>(this->policy_));
+    write_pod(out, static_cast<uint32_t>(this->metric_));
+    write_pod(out, static_cast<uint64_t>(this->range_size_));
+    write_pod(out, static_cast<uint64_t>(this->shard_of_.size()));
+    write_pod(out, static_cast<int32_t>(this->dimension_));
+    write_pod(out, generation);
+    out.close();
+    if (!out)
+      throw std::runtime_error("ShardedVegamDB::save: cannot write " + temp);
+
+    sync_file(temp);
+    replace_file(temp, filename);
+    sync_parent_directory(filename);
+  } catch (...) {
+    // The old manifest still names the old shards; drop the new ones
+    std::remove(temp.c_str());
+    for (size_t s : all)
+      std::remove(shard_path(filename, generation, s).c_str());
+    throw;
+  }
+
+  // Nothing names the previous generation any more
+  if (has_previous) {
+    for (size_t s = 0; s < previous.n_shards; s++)
+      std::remove(shard_path(filename, previous.generation, s).c_str());
+  }
+}
+
+void ShardedVegamDB::load(const std::string &filename) {
+  Manifest m = read_manifest(filename);
+
+  // Load into fresh shards, so a failure leaves this database untouched
+  std::vector<std::shared_ptr<VegamDB>> shards;
+  for (uint32_t s = 0; s < m.n_shards; s++)
+    shards.push_back(
+        std::make_shared<VegamDB>(static_cast<Metric>(m.metric)));
+  std::vector<size_t> all(m.n_shards);
+  for (size_t s = 0; s < all.size(); s++)
+    all[s] = s;
+  for_each_shard(all, [&](size_t s) {
+    shards[s]->load(shard_path(filename, m.generation, s));
+  });
+
+  std::vector<size_t> expected(m.n_shards, 0);
+  for (uint64_t id = 0; id < m.rows; id++)
+    expected[route_id(id, static_cast<ShardPolicy>(m.policy), m.n_shards,
+                      m.range_size)]++;
+  for (size_t s = 0; s < m.n_shards; s++) {
+    size_t actual = shards[s]->size();
+    if (actual != expected[s])
+      throw std::runtime_error("ShardedVegamDB::load: shard " +
+                               std::to_string(s) + " has " +
+                               std::to_string(actual) +
+                               " vectors, manifest expects " +
+                               std::to_string(expected[s]));
+  }
+
+  WriteLock lock(this->mutex_);
+  this->shards_ = std::move(shards);
+  this->policy_ = static_cast<ShardPolicy>(m.policy);
+  this->metric_ = static_cast<Metric>(m.metric);
+  this->range_size_ = m.range_size;
+  reset_mapping();
+  assign_ids(0, m.rows);
+  this->dimension_ = m.dim;
+}
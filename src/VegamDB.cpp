@@ -2,72 +2,687 @@
 
 #include "VegamDB.hpp"
 #include "indexes/AnnoyIndex.hpp"
+#include "indexes/DiskANNIndex.hpp"
 #include "indexes/FlatIndex.hpp"
+#include "indexes/HNSWIndex.hpp"
 #include "indexes/IVFIndex.hpp"
 #include "indexes/IndexBase.hpp"
+#include "storage/AttributeColumn.hpp"
+#include "storage/DatasetLoader.hpp"
+#include "storage/Snapshot.hpp"
+#include "storage/WriteAheadLog.hpp"
+#include "utils/Distance.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/Timer.hpp"
+#include "utils/Varint.hpp"
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+VegamDB::VegamDB(Metric metric) : metric_(metric) {
+  this->store_.set_normalize_on_insert(metric == Metric::Cosine);
+}
+
+using ReadLock = std::shared_lock<std::shared_mutex>;
+using WriteLock = std::unique_lock<std::shared_mutex>;
 
 void VegamDB::add_vector(const std::vector<float> &vec) {
-  this->store_.add(vec);
+  add_vector_np(vec.data(), 1, vec.size());
 }
 
 void VegamDB::add_vector_np(const float *arr, size_t n_vectors, size_t dim) {
+  WriteLock lock(this->mutex_);
+  if (this->wal_ && n_vectors > 0) {
+    // Validate first: a logged record must replay cleanly
+    this->store_.check_add(dim);
+    this->applied_lsn_ = this->wal_->append_add(arr, n_vectors, dim);
+  }
+  size_t first = this->store_.size();
   this->store_.add_vector_from_pointer(arr, n_vectors, dim);
+  index_added_rows(lock, first);
+}
+
+void VegamDB::index_added_rows(WriteLock &lock, size_t first) {
+  IndexBase *index = this->index_.get();
+  size_t end = this->store_.size();
+  if (!index || !index->supports_add() || !index->is_trained() ||
+      first >= end)
+    return;
+
+  // Grow the index while still exclusive, then link the rows in under
+  // the reader lock so searches and other adds run alongside
+  index->reserve(end);
+  uint64_t generation = this->index_generation_;
+  lock.unlock();
+  ReadLock read_lock(this->mutex_);
+  // A rebuild in between already covers the rows; a new index is either
+  // untrained or was built over them
+  if (this->index_generation_ != generation)
+    return;
+  index->add(this->store_.data(), first, end);
+}
+
+size_t VegamDB::add_from_file(const std::string &path, size_t max_rows) {
+  WriteLock lock(this->mutex_);
+  DatasetInfo info = probe_dataset(path);
+  size_t first = this->store_.size();
+  size_t rows = max_rows > 0 ? std::min(info.rows, max_rows) : info.rows;
+  this->store_.reserve(rows, info.dim);
+
+  // The file is added whole or not at all: chunks are staged in the store
+  // and logged as one record once the last has been read
+  DatasetInfo read;
+  try {
+    read = read_vectors(
+        path,
+        [this](const float *arr, size_t n_vectors, size_t dim) {
+          this->store_.add_vector_from_pointer(arr, n_vectors, dim);
+        },
+        max_rows);
+    size_t end = this->store_.size();
+    if (this->wal_ && end > first)
+      this->applied_lsn_ = this->wal_->append_add(
+          this->store_.get(first), end - first, this->store_.dimension());
+  } catch (...) {
+    this->store_.truncate(first);
+    throw;
+  }
+  index_added_rows(lock, first);
+  return read.rows;
+}
+
+void VegamDB::attach_external(const float *arr, size_t n_vectors, size_t dim,
+                              std::shared_ptr<const void> owner) {
+  WriteLock lock(this->mutex_);
+  // The log cannot replay rows it does not own
+  if (this->wal_)
+    throw std::runtime_error(
+        "attach_external cannot be used with a write-ahead log");
+  this->store_.attach_external(arr, n_vectors, dim, std::move(owner));
+}
+
+bool VegamDB::is_external() const {
+  ReadLock lock(this->mutex_);
+  return this->store_.is_external();
+}
+
+int VegamDB::size() const {
+  ReadLock lock(this->mutex_);
+  return this->store_.size();
+}
+
+Metric VegamDB::metric() const {
+  ReadLock lock(this->mutex_);
+  return this->metric_;
+}
+
+int VegamDB::dimension() const {
+  ReadLock lock(this->mutex_);
+  return this->store_.dimension();
+}
+
+void VegamDB::remove(const std::vector<int> &ids) {
+  WriteLock lock(this->mutex_);
+  for (int id : ids) {
+    if (id < 0 || id >= this->store_.size())
+      throw std::invalid_argument("Cannot remove id " + std::to_string(id) +
+                                  ": database has " +
+                                  std::to_string(this->store_.size()) +
+                                  " vectors");
+  }
+  if (this->wal_ && !ids.empty())
+    this->applied_lsn_ = this->wal_->append_remove(ids);
+  this->store_.remove(ids);
+}
+
+bool VegamDB::is_deleted(int id) const {
+  ReadLock lock(this->mutex_);
+  return this->store_.is_deleted(id);
+}
+
+size_t VegamDB::deleted_count() const {
+  ReadLock lock(this->mutex_);
+  return this->store_.deleted_count();
+}
+
+void VegamDB::set_int_attribute(const std::string &name,
+                                const std::vector<int64_t> &values) {
+  WriteLock lock(this->mutex_);
+  check_attribute_length(values.size());
+  this->store_.set_attribute(name, AttributeColumn::from_int64(values));
+}
+
+void VegamDB::set_float_attribute(const std::string &name,
+                                  const std::vector<float> &values) {
+  WriteLock lock(this->mutex_);
+  check_attribute_length(values.size());
+  this->store_.set_attribute(name, AttributeColumn::from_float(values));
+}
+
+void VegamDB::set_string_attribute(const std::string &name,
+                                   const std::vector<std::string> &values) {
+  WriteLock lock(this->mutex_);
+  check_attribute_length(values.size());
+  this->store_.set_attribute(name, AttributeColumn::from_strings(values));
+}
+
+std::vector<std::string> VegamDB::attribute_names() const {
+  ReadLock lock(this->mutex_);
+  return this->store_.attribute_names();
+}
+
+std::shared_ptr<const Bitmap>
+VegamDB::evaluate(const Predicate &predicate) const {
+  ReadLock lock(this->mutex_);
+  return this->store_.evaluate(predicate);
 }
 
-int VegamDB::size() const { return this->store_.size(); }
-int VegamDB::dimension() const { return this->store_.dimension(); }
+void VegamDB::check_attribute_length(size_t n_values) const {
+  if (n_values > static_cast<size_t>(this->store_.size())) {
+    throw std::invalid_argument(
+        "Attribute has more values than there are vectors");
+  }
+}
 
 void VegamDB::set_index(std::unique_ptr<IndexBase> index) {
+  WriteLock lock(this->mutex_);
+  set_index_locked(std::move(index));
+}
+
+void VegamDB::set_index_locked(std::unique_ptr<IndexBase> index) {
+  // The database's metric is authoritative for every index it hosts
+  index->set_metric(this->metric_);
   this->index_ = std::move(index);
+  this->index_generation_++;
 }
 
-void VegamDB::build_index() { this->index_->build(this->store_.data()); }
+void VegamDB::build_index() {
+  WriteLock lock(this->mutex_);
+  if (!this->index_)
+    throw std::runtime_error("No index configured; call set_index() first");
+  build_index_locked();
+}
+
+void VegamDB::build_index_locked() {
+  this->index_generation_++;
+  this->build_progress_.start(this->index_->name());
+  try {
+    this->index_->build(this->store_.data(), &this->build_progress_);
+  } catch (...) {
+    this->build_progress_.finish();
+    throw;
+  }
+  this->build_progress_.finish();
+}
 
 IndexBase *VegamDB::get_index() { return this->index_.get(); }
 
+std::vector<size_t> VegamDB::ivf_list_sizes() const {
+  ReadLock lock(this->mutex_);
+  return ivf_index_locked().list_sizes();
+}
+
+ListSizeStats VegamDB::ivf_list_size_stats() const {
+  ReadLock lock(this->mutex_);
+  return ivf_index_locked().list_size_stats();
+}
+
+const IVFIndex &VegamDB::ivf_index_locked() const {
+  auto ivf = dynamic_cast<const IVFIndex *>(this->index_.get());
+  if (!ivf)
+    throw std::runtime_error("The current index is not an IVF index");
+  return *ivf;
+}
+
+BuildProgressSnapshot VegamDB::build_progress() const {
+  return this->build_progress_.snapshot();
+}
+
+void VegamDB::set_build_callback(BuildProgressCallback callback) {
+  this->build_progress_.set_callback(std::move(callback));
+}
+
 SearchResults VegamDB::search(const std::vector<float> &query, int k,
-                              const SearchParams *params) {
-  SearchResults results;
-  if (this->index_) {
+                              const SearchParams *params, const Bitmap *filter,
+                              SearchStats *stats) {
+  // Always collected: the aggregate counters need every query
+  SearchStats query_stats;
+  PhaseTimer timer;
+  SearchResults results =
+      search_prepared(query, k, params, filter, &query_stats);
 
-    if (this->index_->is_trained()) {
-      results = this->index_->search(this->store_.data(), query, k, params);
-      return results;
+  query_stats.total_us = timer.lap();
+  this->search_stats_.record(query_stats);
+  if (stats)
+    *stats = query_stats;
+  return results;
+}
+
+SearchResults VegamDB::search_prepared(const std::vector<float> &query, int k,
+                                       const SearchParams *params,
+                                       const Bitmap *filter,
+                                       SearchStats *stats) {
+  Bitmap scratch;
+  // Cosine compares unit vectors; normalize the query like stored rows.
+  // A load() can change the metric, so it is read under the lock.
+  std::vector<float> normalized;
+  auto prepare = [&]() -> const std::vector<float> & {
+    check_query_locked(query);
+    if (this->metric_ != Metric::Cosine)
+      return query;
+    normalized = query;
+    normalize(normalized.data(), normalized.size());
+    return normalized;
+  };
+
+  {
+    ReadLock lock(this->mutex_);
+    const std::vector<float> &prepared = prepare();
+    if (this->index_ && this->index_->is_trained()) {
+      return this->index_->search(this->store_.data(), prepared, k, params,
+                                  live_filter(filter, scratch), stats);
     }
+  }
 
-    build_index();
-    results = this->index_->search(this->store_.data(), query, k, params);
-    return results;
+  // First search on an unbuilt index: build (or create a flat index) under
+  // the writer lock, and answer this query while still holding it
+  WriteLock lock(this->mutex_);
+  const std::vector<float> &prepared = prepare();
+  if (!this->index_) {
+    auto flat_index = std::unique_ptr<IndexBase>(new FlatIndex(metric_));
+    set_index_locked(std::move(flat_index));
+    build_index_locked(); // Resolves the kernel and block order
+  } else if (!this->index_->is_trained()) {
+    build_index_locked();
   }
 
-  auto flat_index = std::unique_ptr<IndexBase>(new FlatIndex());
-  set_index(std::move(flat_index));
-  build_index();
+  return this->index_->search(this->store_.data(), prepared, k, params,
+                              live_filter(filter, scratch), stats);
+}
 
-  results = this->index_->search(this->store_.data(), query, k, params);
-  return results;
+void VegamDB::check_query_locked(const std::vector<float> &query) const {
+  // Kernels stride through the store by the query's length
+  if (this->store_.size() > 0 &&
+      query.size() != static_cast<size_t>(this->store_.dimension()))
+    throw std::invalid_argument(
+        "Query dimension mismatch: store has " +
+        std::to_string(this->store_.dimension()) + ", got " +
+        std::to_string(query.size()));
+}
+
+const Bitmap *VegamDB::live_filter(const Bitmap *filter,
+                                   Bitmap &scratch) const {
+  const Bitmap *live = this->store_.live();
+  if (!live)
+    return filter;
+  if (!filter)
+    return live;
+  scratch = *filter & *live;
+  return &scratch;
+}
+
+SearchResults VegamDB::search(const std::vector<float> &query, int k,
+                              const SearchParams *params,
+                              const Predicate &where, SearchStats *stats) {
+  std::shared_ptr<const Bitmap> allowed = evaluate(where);
+  return search(query, k, params, allowed.get(), stats);
+}
+
+SearchStatsSummary VegamDB::search_stats() const {
+  return this->search_stats_.summary();
+}
+
+void VegamDB::reset_search_stats() { this->search_stats_.reset(); }
+
+// =========================================================
+// SECTION: Persistence
+// Snapshots use the sectioned, checksummed layout in Snapshot.hpp. Files
+// written before it (no magic) are read by load_legacy().
+// =========================================================
+
+namespace {
+
+void write_string(std::ostream &out, const std::string &value) {
+  int len = value.size();
+  out.write(reinterpret_cast<const char *>(&len), sizeof(int));
+  out.write(value.data(), len);
+}
+
+std::string read_string(std::istream &in) {
+  int len = 0;
+  in.read(reinterpret_cast<char *>(&len), sizeof(int));
+  if (!in || len < 0)
+    throw std::runtime_error("VegamDB::load: corrupt string");
+  std::string value(len, '\0');
+  in.read(&value[0], len);
+  return value;
+}
+
+// Empty placeholder of the named type; load() fills in its parameters
+std::unique_ptr<IndexBase> make_index(const std::string &name, int dim) {
+  if (name == "IVFIndex")
+    return std::make_unique<IVFIndex>(0, dim);
+  if (name == "AnnoyIndex")
+    return std::make_unique<AnnoyIndex>(dim, 0, 0);
+  if (name == "HNSWIndex")
+    return std::make_unique<HNSWIndex>();
+  if (name == "DiskANNIndex")
+    return std::make_unique<DiskANNIndex>(dim, std::string());
+  return std::make_unique<FlatIndex>();
 }
 
-void VegamDB::save(const std::string &filename) {
-  std::ofstream outfile(filename, std::ios::binary | std::ios::out);
-  this->store_.save(outfile);
+void check_section(const std::istream &in, SectionId id) {
+  if (!in)
+    throw std::runtime_error("VegamDB::load: section '" + section_name(id) +
+                             "' is truncated");
+}
+
+} // namespace
+
+void VegamDB::save(const std::string &filename, const SaveOptions &options) {
+  if (!compression_available(options.compression))
+    throw std::invalid_argument(
+        "VegamDB::save: compression not supported by this build");
+
+  std::lock_guard<std::mutex> save_lock(this->save_mutex_);
+  ReadLock lock(this->mutex_);
+
+  // Write beside the target and rename over it once durable: a crash at
+  // any point leaves either the previous snapshot or the new one
+  std::string temp = filename + ".tmp";
+  try {
+    std::ofstream outfile(temp,
+                          std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!outfile)
+      throw std::runtime_error("VegamDB::save: cannot open " + temp);
+    write_snapshot(outfile, options);
+    outfile.close();
+    if (!outfile)
+      throw std::runtime_error("VegamDB::save: cannot write " + temp);
 
-  // Write index type name (length-prefixed string)
-  if (this->index_) {
-    std::string index_name = this->index_->name();
-    int name_len = index_name.size();
-    outfile.write(reinterpret_cast<const char *>(&name_len), sizeof(int));
-    outfile.write(index_name.data(), name_len);
-    this->index_->save(outfile);
+    sync_file(temp);
+    replace_file(temp, filename);
+    sync_parent_directory(filename);
+  } catch (...) {
+    std::remove(temp.c_str());
+    throw;
   }
+
+  // Checkpoint: every logged record is now in the snapshot
+  if (this->wal_ && this->wal_snapshot_ == filename)
+    this->wal_->clear();
+}
+
+void VegamDB::write_snapshot(std::ostream &outfile,
+                             const SaveOptions &options) const {
+  // An untrained index has nothing to persist; it is rebuilt on demand
+  bool save_index = this->index_ && this->index_->is_trained();
+
+  // Index and attributes are serialized to memory when they need
+  // compressing, and on worker threads (overlapping the vector write) when
+  // parallel. Otherwise they stream straight to the file.
+  bool buffered =
+      options.parallel || options.compression != Compression::None;
+  std::launch policy =
+      options.parallel ? std::launch::async : std::launch::deferred;
+  uint32_t flags = static_cast<uint32_t>(options.compression);
+
+  std::future<std::vector<char>> index_bytes;
+  std::future<std::vector<char>> attribute_bytes;
+  if (buffered) {
+    if (save_index) {
+      index_bytes = std::async(policy, [this, &options] {
+        MemoryWriteStream out;
+        this->index_->save(out);
+        return compress_section(std::move(out.bytes()), options.compression);
+      });
+    }
+    attribute_bytes = std::async(policy, [this, &options] {
+      MemoryWriteStream out;
+      this->store_.save_attributes(out);
+      return compress_section(std::move(out.bytes()), options.compression);
+    });
+  }
+
+  SnapshotWriter writer(outfile);
+
+  std::ostream &meta = writer.begin_section(SectionId::Metadata);
+  int metric = static_cast<int>(this->metric_);
+  meta.write(reinterpret_cast<const char *>(&metric), sizeof(int));
+  write_string(meta, save_index ? this->index_->name() : std::string());
+  meta.write(reinterpret_cast<const char *>(&this->applied_lsn_),
+             sizeof(uint64_t));
+  writer.end_section();
+
+  this->store_.save(writer.begin_section(SectionId::Vectors));
+  writer.end_section();
+
+  if (save_index) {
+    if (buffered) {
+      writer.add_section(SectionId::Index, index_bytes.get(), flags);
+    } else {
+      this->index_->save(writer.begin_section(SectionId::Index));
+      writer.end_section();
+    }
+  }
+
+  if (buffered) {
+    writer.add_section(SectionId::Attributes, attribute_bytes.get(), flags);
+  } else {
+    this->store_.save_attributes(writer.begin_section(SectionId::Attributes));
+    writer.end_section();
+  }
+
+  if (this->store_.deleted_count() > 0) {
+    std::vector<char> tombstones;
+    append_delta_ids(tombstones, this->store_.deleted_ids());
+    writer.add_section(SectionId::Tombstones, tombstones);
+  }
+
+  writer.finish();
 }
 
 void VegamDB::load(const std::string &filename) {
-  std::ifstream infile(filename, std::ios::binary | std::ios::in);
-  this->store_.load(infile);
+  WriteLock lock(this->mutex_);
+  std::string wal_path = filename + ".wal";
+  bool has_snapshot = file_exists(filename);
+  bool has_wal = file_exists(wal_path);
+  if (!has_snapshot && !has_wal)
+    throw std::runtime_error("Cannot open " + filename);
+
+  // A throw anywhere below leaves this database as it was
+  LoadedState loaded;
+  // Without a snapshot (crashed before the first save) everything is in
+  // the log, replayed into an empty store
+  loaded.metric = this->metric_;
+  if (has_snapshot) {
+    // Replayed adds need an owned store
+    load_snapshot(filename, !has_wal, loaded);
+  }
+  loaded.store.set_normalize_on_insert(loaded.metric == Metric::Cosine);
+  if (loaded.index)
+    loaded.index->set_metric(loaded.metric);
+
+  if (has_wal) {
+    size_t first = loaded.store.size();
+    replay_wal(wal_path, loaded);
+    // Link replayed rows into an index that takes incremental adds
+    IndexBase *index = loaded.index.get();
+    size_t end = loaded.store.size();
+    if (index && index->supports_add() && index->is_trained() &&
+        first < end) {
+      index->reserve(end);
+      index->add(loaded.store.data(), first, end);
+    }
+  }
+
+  commit_loaded(loaded);
+
+  // A log attached to another snapshot does not describe the loaded state
+  if (this->wal_ && this->wal_snapshot_ != filename)
+    this->wal_.reset();
+}
+
+void VegamDB::replay_wal(const std::string &path, LoadedState &loaded) {
+  WriteAheadLog::replay(path, [&loaded](const WalRecord &record) {
+    // Records up to the snapshot's LSN are already in it
+    if (record.lsn <= loaded.applied_lsn)
+      return;
+    try {
+      if (record.op == WalOp::Add) {
+        loaded.store.add_vector_from_pointer(record.vectors, record.count,
+                                             record.dim);
+      } else {
+        loaded.store.remove(
+            std::vector<int>(record.ids, record.ids + record.count));
+      }
+    } catch (const std::invalid_argument &e) {
+      throw std::runtime_error("VegamDB::load: cannot replay log record " +
+                               std::to_string(record.lsn) + ": " + e.what());
+    }
+    loaded.applied_lsn = record.lsn;
+  });
+}
+
+void VegamDB::enable_wal(const std::string &snapshot_path, bool sync) {
+  WriteLock lock(this->mutex_);
+  if (this->store_.is_external())
+    throw std::runtime_error(
+        "A write-ahead log cannot be used with an external buffer");
+
+  auto wal = std::make_unique<WriteAheadLog>(snapshot_path + ".wal",
+                                             this->applied_lsn_, sync);
+  if (wal->last_lsn() > this->applied_lsn_)
+    throw std::runtime_error(
+        wal->path() + " holds changes this database has not applied; "
+                      "load() the snapshot first");
+  this->wal_ = std::move(wal);
+  this->wal_snapshot_ = snapshot_path;
+}
+
+void VegamDB::disable_wal() {
+  WriteLock lock(this->mutex_);
+  this->wal_.reset();
+  this->wal_snapshot_.clear();
+}
+
+bool VegamDB::wal_enabled() const {
+  ReadLock lock(this->mutex_);
+  return this->wal_ != nullptr;
+}
+
+void VegamDB::load_snapshot(const std::string &filename, bool map_vectors,
+                            LoadedState &loaded) const {
+  auto file = std::make_shared<MappedFile>(filename);
+
+  if (!SnapshotReader::is_snapshot(file->data(), file->size())) {
+    std::ifstream infile(filename, std::ios::binary | std::ios::in);
+    load_legacy(infile, loaded);
+    return;
+  }
+
+  // Every checksum is checked before any state is replaced
+  SnapshotReader reader(file->data(), file->size());
+  reader.verify();
+
+  const SectionEntry *meta_entry = reader.find(SectionId::Metadata);
+  const SectionEntry *vectors_entry = reader.find(SectionId::Vectors);
+  if (!meta_entry || !vectors_entry)
+    throw std::runtime_error("VegamDB::load: snapshot has no vectors");
+
+  SectionData meta_data = reader.section(meta_entry);
+  SectionStream meta(meta_data.data(), meta_data.size());
+  int metric = static_cast<int>(Metric::L2);
+  meta.read(reinterpret_cast<char *>(&metric), sizeof(int));
+  std::string index_name = read_string(meta);
+  check_section(meta, SectionId::Metadata);
+  // Snapshots written before the write-ahead log end here
+  uint64_t applied_lsn = 0;
+  if (meta.peek() != std::char_traits<char>::eof())
+    meta.read(reinterpret_cast<char *>(&applied_lsn), sizeof(uint64_t));
+  check_section(meta, SectionId::Metadata);
+
+  // The index is decoded into a fresh object on another thread while the
+  // vectors are read; sections are independent, so nothing is shared
+  const SectionEntry *index_entry = reader.find(SectionId::Index);
+  std::future<std::unique_ptr<IndexBase>> index;
+  if (!index_name.empty() && index_entry) {
+    auto decode = [&reader, index_entry, &index_name] {
+      SectionData data = reader.section(index_entry);
+      SectionStream in(data.data(), data.size());
+      // Placeholder parameters; load() reads the real ones
+      std::unique_ptr<IndexBase> decoded = make_index(index_name, 0);
+      decoded->load(in);
+      check_section(in, SectionId::Index);
+      return decoded;
+    };
+    index = std::async(std::launch::async, decode);
+  }
+
+  SectionData vectors_data = reader.section(vectors_entry);
+  SectionStream vectors(vectors_data.data(), vectors_data.size());
+  VectorStore &store = loaded.store;
+  // A disk-resident index keeps its rows on disk: the store serves them
+  // from the mapped snapshot rather than copying them into memory, and is
+  // read-only like an attached buffer
+  int32_t shape[2] = {0, 0}; // rows, cols
+  if (vectors_data.size() >= sizeof(shape))
+    std::memcpy(shape, vectors_data.data(), sizeof(shape));
+  size_t mapped_rows = static_cast<size_t>(std::max(shape[0], 0));
+  size_t mapped_dim = static_cast<size_t>(std::max(shape[1], 0));
+  if (map_vectors && index_name == "DiskANNIndex" && file->mapped() &&
+      vectors_entry->flags == 0 && mapped_rows > 0 && mapped_dim > 0 &&
+      vectors_data.size() ==
+          sizeof(shape) + mapped_rows * mapped_dim * sizeof(float)) {
+    store.attach_external(
+        reinterpret_cast<const float *>(vectors_data.data() + sizeof(shape)),
+        mapped_rows, mapped_dim, file);
+  } else {
+    store.load(vectors);
+    check_section(vectors, SectionId::Vectors);
+  }
+
+  // Attributes are optional; an absent section loads as no columns
+  SectionData attr_data = reader.section(reader.find(SectionId::Attributes));
+  SectionStream attributes(attr_data.data(), attr_data.size());
+  store.load_attributes(attributes);
+
+  if (const SectionEntry *entry = reader.find(SectionId::Tombstones)) {
+    SectionData data = reader.section(entry);
+    std::vector<int> deleted;
+    read_delta_ids(data.data(), data.data() + data.size(), deleted);
+    try {
+      store.remove(deleted);
+    } catch (const std::invalid_argument &) {
+      throw std::runtime_error("VegamDB::load: corrupt tombstones");
+    }
+  }
+
+  if (index.valid()) {
+    loaded.index = index.get();
+    loaded.index->after_load(store.data());
+  }
+  loaded.applied_lsn = applied_lsn;
+  loaded.metric = static_cast<Metric>(metric);
+}
+
+void VegamDB::load_legacy(std::istream &infile, LoadedState &loaded) const {
+  VectorStore &store = loaded.store;
+  store.load(infile);
 
   // Read index type name and construct the right index
   int name_len = 0;
@@ -76,17 +691,28 @@ void VegamDB::load(const std::string &filename) {
   if (name_len > 0) {
     std::string index_name(name_len, '\0');
     infile.read(&index_name[0], name_len);
-    int dim = this->store_.dimension();
 
-    if (index_name == "IVFIndex") {
-      // Construct with dummy params — load() will overwrite them
-      this->index_ = std::make_unique<IVFIndex>(0, dim);
-    } else if (index_name == "AnnoyIndex") {
-      this->index_ = std::make_unique<AnnoyIndex>(dim, 0, 0);
-    } else {
-      this->index_ = std::make_unique<FlatIndex>();
-    }
-
-    this->index_->load(infile);
+    // Construct with dummy params — load() will overwrite them
+    loaded.index = make_index(index_name, store.dimension());
+    loaded.index->load(infile);
+    loaded.index->after_load(store.data());
   }
-}
\ No newline at end of file
+
+  store.load_attributes(infile);
+
+  // Files written before metrics existed are L2
+  int metric = static_cast<int>(Metric::L2);
+  infile.read(reinterpret_cast<char *>(&metric), sizeof(int));
+
+  loaded.applied_lsn = 0;
+  loaded.metric = static_cast<Metric>(metric);
+}
+
+void VegamDB::commit_loaded(LoadedState &loaded) {
+  // Swapped, not moved: the store holds a mutex
+  this->store_.swap(loaded.store);
+  this->index_ = std::move(loaded.index);
+  this->applied_lsn_ = loaded.applied_lsn;
+  this->metric_ = loaded.metric;
+  this->index_generation_++;
+}
@@ -1,23 +1,201 @@
 // src/bindings.cpp
 
+#include "ShardedVegamDB.hpp"
 #include "VegamDB.hpp"
 #include "indexes/AnnoyIndex.hpp"
+#include "indexes/DiskANNIndex.hpp"
 #include "indexes/FlatIndex.hpp"
+#include "indexes/HNSWIndex.hpp"
 #include "indexes/IVFIndex.hpp"
 #include "indexes/IndexBase.hpp"
 #include "indexes/KMeans.hpp"
+#include "storage/DatasetLoader.hpp"
+#include "storage/Predicate.hpp"
+#include "storage/Snapshot.hpp"
+#include "utils/Bitmap.hpp"
+#include "utils/Distance.hpp"
+#include "utils/HugePages.hpp"
+#include "utils/Numa.hpp"
+#include "utils/Progress.hpp"
+#include "utils/Stats.hpp"
+#include <algorithm>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <pybind11/cast.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace py = pybind11;
 
+namespace {
+
+// Shared by VegamDB and ShardedVegamDB.add_vector_numpy
+template <typename Db> void add_numpy(Db &self, py::array input_array) {
+  if (input_array.ndim() != 1 && input_array.ndim() != 2) {
+    throw std::runtime_error("Number of dimensions must be 1/2D");
+  }
+
+  // Fast path: a C-contiguous float32 buffer is copied straight
+  // into the store. Anything else needs a converted temporary
+  // first, which doubles the copy, so say so.
+  using FloatArray =
+      py::array_t<float, py::array::c_style | py::array::forcecast>;
+  bool is_float32 = input_array.dtype().is(py::dtype::of<float>());
+  bool is_contiguous = input_array.flags() & py::array::c_style;
+  if (!is_float32 || !is_contiguous) {
+    if (PyErr_WarnEx(PyExc_RuntimeWarning,
+                     "add_vector_numpy: input is not a "
+                     "C-contiguous float32 array; converting "
+                     "(extra copy). Pass "
+                     "np.ascontiguousarray(x, dtype=np.float32) "
+                     "to avoid it.",
+                     1) != 0) {
+      throw py::error_already_set();
+    }
+  }
+  FloatArray array = FloatArray::ensure(input_array);
+  if (!array) {
+    throw py::error_already_set();
+  }
+
+  size_t n_vectors = array.ndim() == 1 ? 1 : array.shape(0);
+  size_t dim = array.ndim() == 1 ? array.shape(0) : array.shape(1);
+  // `array` keeps the buffer alive while the GIL is released
+  py::gil_scoped_release release;
+  self.add_vector_np(array.data(), n_vectors, dim);
+}
+
+// Build progress handed from the building thread, which holds the
+// database's writer lock, to the thread that calls into Python
+class ProgressQueue {
+private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::vector<BuildProgressSnapshot> pending_;
+  bool closed_ = false;
+
+public:
+  void push(const BuildProgressSnapshot &snapshot) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.push_back(snapshot);
+    }
+    ready_.notify_one();
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    ready_.notify_one();
+  }
+
+  // Waits for snapshots or close() and moves the pending ones to `out`.
+  // Returns true once the queue is closed and drained.
+  bool wait(std::vector<BuildProgressSnapshot> &out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return closed_ || !pending_.empty(); });
+    out.swap(pending_);
+    pending_.clear();
+    return closed_;
+  }
+};
+
+} // namespace
+
 PYBIND11_MODULE(_vegamdb, m) {
 
   m.doc() = "A high-performance Vector Database plugin written in C++";
 
+  // ---- Metric ----
+  py::enum_<Metric>(m, "Metric", R"(Similarity metric of a database.
+
+All metrics are reported as distances where smaller is closer:
+    L2: squared Euclidean distance.
+    IP: negated inner product (maximum inner product search).
+    COSINE: 1 - cosine similarity. Vectors are normalized on insert.
+)")
+      .value("L2", Metric::L2)
+      .value("IP", Metric::InnerProduct)
+      .value("COSINE", Metric::Cosine);
+
+  py::enum_<Compression>(m, "Compression", R"(Compression for VegamDB.save().
+
+Applies to the index and attribute sections; vectors are stored raw.
+    NONE: No compression (IVF ids are still delta-encoded).
+    ZSTD: zstd level 1. Only in builds with VEGAMDB_WITH_ZSTD; check
+        compression_available().
+)")
+      .value("NONE", Compression::None)
+      .value("ZSTD", Compression::Zstd);
+
+  m.def("compression_available", &compression_available,
+        py::arg("compression"),
+        "True if this build can write and read the given Compression.");
+
+  // ---- Huge pages ----
+  py::enum_<HugePages>(m, "HugePages", R"(Backing for large buffers.
+
+Applies to buffers of 2 MB or more: the vector store, IVF lists and HNSW
+adjacency. Linux only; elsewhere every mode behaves like OFF.
+    OFF: Regular 4 KB pages.
+    TRANSPARENT: madvise(MADV_HUGEPAGE) on 2 MB aligned mappings (default).
+    EXPLICIT: MAP_HUGETLB pages from the pool reserved in
+        /proc/sys/vm/nr_hugepages; falls back to TRANSPARENT when empty.
+)")
+      .value("OFF", HugePages::Off)
+      .value("TRANSPARENT", HugePages::Transparent)
+      .value("EXPLICIT", HugePages::Explicit);
+
+  py::class_<HugePageStatus>(m, "HugePageStatus", R"(
+What the live large buffers obtained, from huge_page_status().
+
+Attributes:
+    mode: Current HugePages mode.
+    supported: False on platforms without huge page support.
+    explicit_bytes: Bytes backed by hugetlbfs pages.
+    transparent_bytes: Bytes the kernel accepted madvise(MADV_HUGEPAGE) for.
+    regular_bytes: Bytes of large buffers left on regular pages.
+    explicit_fallbacks: EXPLICIT allocations the pool could not serve.
+    anon_huge_bytes: Transparent huge page memory of the whole process as
+        reported by the kernel, or -1 if unavailable.
+)")
+      .def_readonly("mode", &HugePageStatus::mode)
+      .def_readonly("supported", &HugePageStatus::supported)
+      .def_readonly("explicit_bytes", &HugePageStatus::explicit_bytes)
+      .def_readonly("transparent_bytes", &HugePageStatus::transparent_bytes)
+      .def_readonly("regular_bytes", &HugePageStatus::regular_bytes)
+      .def_readonly("explicit_fallbacks", &HugePageStatus::explicit_fallbacks)
+      .def_readonly("anon_huge_bytes", &HugePageStatus::anon_huge_bytes);
+
+  m.def("set_huge_pages", &set_huge_pages, py::arg("mode"),
+        "Set the HugePages mode for buffers allocated from now on. Existing "
+        "buffers keep their pages until they are reallocated.");
+  m.def("huge_page_status", &huge_page_status,
+        "Report how the live large buffers are backed (HugePageStatus).");
+
+  // ---- NUMA ----
+  m.def("set_numa_aware", &set_numa_aware, py::arg("enabled"),
+        R"(Split stored vectors into one partition per NUMA node.
+
+Each partition's pages are bound to its node as vectors are added or
+loaded, and large Flat and IVF scans run each partition on threads pinned
+to that node before merging the results. A no-op on single-node machines.
+Off by default.)");
+  m.def("numa_nodes", &numa_node_count,
+        "Number of NUMA nodes with CPUs (1 on single-node machines).");
+
   // ---- Return type ----
   py::class_<SearchResults>(m, "SearchResults",
                             R"(Container returned by VegamDB.search().
@@ -31,6 +209,173 @@ Attributes:
       .def_readonly("distances", &SearchResults::distances,
                     "List of distances corresponding to each neighbor.");
 
+  // ---- Statistics ----
+  py::class_<SearchStats>(m, "SearchStats",
+                          R"(Statistics for a single search.
+
+Pass an instance as VegamDB.search(..., stats=s); it is overwritten with
+what that query did. Times are in microseconds.
+
+Attributes:
+    distance_computations: Vector and centroid distances computed.
+    lists_visited: IVF inverted lists scanned.
+    nodes_visited: Annoy internal nodes evaluated / HNSW nodes expanded /
+        DiskANN nodes read.
+    leaves_visited: Annoy leaves collected.
+    candidates: Vectors scored.
+    duplicates_removed: Candidates found in more than one leaf.
+    filter_fallback: True if a selective filter took the exact path.
+    ranking_us: IVF centroid ranking / Annoy, HNSW or DiskANN traversal.
+    scan_us: List scan (IVF), full scan (Flat), candidate scoring (Annoy).
+    rerank_us: Selecting the final top-k.
+    total_us: Whole search call.
+)")
+      .def(py::init<>())
+      .def_readonly("distance_computations",
+                    &SearchStats::distance_computations)
+      .def_readonly("lists_visited", &SearchStats::lists_visited)
+      .def_readonly("nodes_visited", &SearchStats::nodes_visited)
+      .def_readonly("leaves_visited", &SearchStats::leaves_visited)
+      .def_readonly("candidates", &SearchStats::candidates)
+      .def_readonly("duplicates_removed", &SearchStats::duplicates_removed)
+      .def_readonly("filter_fallback", &SearchStats::filter_fallback)
+      .def_readonly("ranking_us", &SearchStats::ranking_us)
+      .def_readonly("scan_us", &SearchStats::scan_us)
+      .def_readonly("rerank_us", &SearchStats::rerank_us)
+      .def_readonly("total_us", &SearchStats::total_us)
+      .def("__repr__", [](const SearchStats &s) {
+        return "SearchStats(distance_computations=" +
+               std::to_string(s.distance_computations) +
+               ", candidates=" + std::to_string(s.candidates) +
+               ", total_us=" + std::to_string(s.total_us) + ")";
+      });
+
+  py::class_<SearchStatsSummary>(m, "SearchStatsSummary", R"(
+Aggregate statistics from VegamDB.search_stats().
+
+Counters and times (microseconds) are sums over `queries` searches.
+Histograms are power-of-two buckets: bucket 0 counts zeros and bucket i
+counts values in [2**(i-1), 2**i).
+)")
+      .def_readonly("queries", &SearchStatsSummary::queries)
+      .def_readonly("distance_computations",
+                    &SearchStatsSummary::distance_computations)
+      .def_readonly("lists_visited", &SearchStatsSummary::lists_visited)
+      .def_readonly("nodes_visited", &SearchStatsSummary::nodes_visited)
+      .def_readonly("leaves_visited", &SearchStatsSummary::leaves_visited)
+      .def_readonly("candidates", &SearchStatsSummary::candidates)
+      .def_readonly("duplicates_removed",
+                    &SearchStatsSummary::duplicates_removed)
+      .def_readonly("filter_fallbacks", &SearchStatsSummary::filter_fallbacks)
+      .def_readonly("ranking_us", &SearchStatsSummary::ranking_us)
+      .def_readonly("scan_us", &SearchStatsSummary::scan_us)
+      .def_readonly("rerank_us", &SearchStatsSummary::rerank_us)
+      .def_readonly("total_us", &SearchStatsSummary::total_us)
+      .def_readonly("latency_histogram_us",
+                    &SearchStatsSummary::latency_histogram_us)
+      .def_readonly("distance_histogram",
+                    &SearchStatsSummary::distance_histogram)
+      .def("latency_percentile_us",
+           &SearchStatsSummary::latency_percentile_us, py::arg("p"),
+           "Approximate latency percentile (p in [0, 100]): the upper edge "
+           "of the histogram bucket holding that rank.");
+
+  py::class_<BuildProgressSnapshot>(m, "BuildProgress", R"(
+Progress of the current or last VegamDB.build_index() call.
+
+Attributes:
+    running: True while a build is in progress.
+    index: Name of the index being built.
+    phase: Current phase ("kmeans" for IVF, "trees" for Annoy, "graph"
+        for HNSW, "pq", "graph" and "write" for DiskANN; empty when
+        finished).
+    done, total: Work units of the current phase (k-means: vectors
+        assigned across all iterations; Annoy: trees built; HNSW: vectors
+        inserted; DiskANN: subspaces trained, node insertions, nodes
+        written).
+    fraction: done / total (0 if total is 0).
+    elapsed_seconds: Time since the build started (its duration once
+        finished).
+    phases: Completed phases as (name, seconds) tuples.
+)")
+      .def_readonly("running", &BuildProgressSnapshot::running)
+      .def_readonly("index", &BuildProgressSnapshot::index)
+      .def_readonly("phase", &BuildProgressSnapshot::phase)
+      .def_readonly("done", &BuildProgressSnapshot::done)
+      .def_readonly("total", &BuildProgressSnapshot::total)
+      .def_property_readonly("fraction", &BuildProgressSnapshot::fraction)
+      .def_readonly("elapsed_seconds",
+                    &BuildProgressSnapshot::elapsed_seconds)
+      .def_property_readonly("phases",
+                             [](const BuildProgressSnapshot &s) {
+                               py::list phases;
+                               for (const auto &phase : s.phases) {
+                                 phases.append(
+                                     py::make_tuple(phase.name, phase.seconds));
+                               }
+                               return phases;
+                             })
+      .def("__repr__", [](const BuildProgressSnapshot &s) {
+        return "<BuildProgress " + s.index + " phase='" + s.phase +
+               "' done=" + std::to_string(s.done) + "/" +
+               std::to_string(s.total) +
+               (s.running ? " running>" : " finished>");
+      });
+
+  // ---- Filtering ----
+  py::class_<Bitmap>(m, "Bitmap",
+                     R"(Allow-list of vector ids for filtered search.
+
+Only ids contained in the bitmap can appear in search results. The filter
+is applied inside the index scan, so k results are returned whenever at
+least k ids are allowed.
+
+Example:
+    allowed = Bitmap([3, 17, 42])
+    results = db.search(query, k=5, filter=allowed)
+)")
+      .def(py::init<>(), "Create an empty bitmap.")
+      .def(py::init([](const std::vector<int> &ids) {
+             return Bitmap::from_ids(ids);
+           }),
+           py::arg("ids"), "Create a bitmap with the given ids set.")
+      .def("add", &Bitmap::set, py::arg("id"), "Allow the given id.")
+      .def("remove", &Bitmap::reset, py::arg("id"),
+           "Disallow the given id.")
+      .def("to_list", &Bitmap::to_ids,
+           "Return the allowed ids in ascending order.")
+      .def("__len__", &Bitmap::count)
+      .def("__contains__",
+           [](const Bitmap &self, long long id) {
+             return id >= 0 && self.contains(static_cast<size_t>(id));
+           })
+      .def("__and__",
+           [](const Bitmap &self, const Bitmap &other) { return self & other; })
+      .def("__or__", [](const Bitmap &self, const Bitmap &other) {
+        return self | other;
+      });
+
+  py::class_<Predicate>(m, "Predicate",
+                        R"(Filter over a per-vector attribute column.
+
+Predicates are compiled into a Bitmap inside the engine and cached, so
+filtered queries never call back into Python per candidate.
+
+Example:
+    db.set_int_attribute("tenant_id", tenant_ids)
+    results = db.search(query, k=5, filter=Predicate.eq("tenant_id", 7))
+)")
+      .def_static("eq", &Predicate::equal, py::arg("column"),
+                  py::arg("value"), "Rows whose value equals `value`.")
+      .def_static("isin", &Predicate::in, py::arg("column"),
+                  py::arg("values"), "Rows whose value is one of `values`.")
+      .def_static("range", &Predicate::range, py::arg("column"),
+                  py::arg("lo"), py::arg("hi"),
+                  "Rows whose numeric value lies in [lo, hi] (inclusive).")
+      .def("__repr__", [](const Predicate &self) {
+        return "Predicate(" + self.key() + ")";
+      });
+
   // ---- SearchParams hierarchy ----
   py::class_<SearchParams>(m, "SearchParams",
                            "Base class for index-specific search parameters.");
@@ -41,6 +386,11 @@ Attributes:
 Attributes:
     n_probe (int): Number of clusters to probe during search.
         Higher values improve recall at the cost of speed. Default: 1.
+    coarse_ef (int): Candidate list size when an HNSW coarse quantizer
+        ranks the clusters. 0 (default) uses max(64, 8 * n_probe).
+    rerank_factor (int): With SQ8 storage, re-score the best
+        k * rerank_factor candidates with the full vectors. 0 (default)
+        returns the approximate code distances.
 
 Example:
     params = IVFSearchParams()
@@ -49,7 +399,13 @@ Example:
 )")
       .def(py::init<>())
       .def_readwrite("n_probe", &IVFSearchParams::n_probe,
-                     "Number of clusters to probe during search (default: 1).");
+                     "Number of clusters to probe during search (default: 1).")
+      .def_readwrite("coarse_ef", &IVFSearchParams::coarse_ef,
+                     "Candidate list size of the HNSW coarse quantizer "
+                     "(0: automatic).")
+      .def_readwrite("rerank_factor", &IVFSearchParams::rerank_factor,
+                     "SQ8 storage: candidates re-scored exactly, as a "
+                     "multiple of k (0: no re-rank).");
 
   py::class_<AnnoyIndexParams, SearchParams>(
       m, "AnnoyIndexParams",
@@ -74,6 +430,43 @@ Example:
                      &AnnoyIndexParams::use_priority_queue,
                      "Use priority queue (True) or greedy (False) search.");
 
+  py::class_<DiskANNSearchParams, SearchParams>(
+      m, "DiskANNSearchParams",
+      R"(Search parameters for the DiskANN index.
+
+Attributes:
+    search_list (int): Candidate list size L (raised to k if smaller, and
+        scaled by 1 / the fraction of ids a filter allows). Higher
+        values improve recall at the cost of more disk reads.
+    beam_width (int): Nodes read from disk per round trip. Default: 4.
+
+Example:
+    params = DiskANNSearchParams()
+    params.search_list = 200
+    results = db.search(query, k=10, params=params)
+)")
+      .def(py::init<>())
+      .def_readwrite("search_list", &DiskANNSearchParams::search_list,
+                     "Candidate list size L (default: 100).")
+      .def_readwrite("beam_width", &DiskANNSearchParams::beam_width,
+                     "Nodes read from disk per round trip (default: 4).");
+
+  py::class_<HNSWSearchParams, SearchParams>(m, "HNSWSearchParams",
+                                             R"(Search parameters for the HNSW index.
+
+Attributes:
+    ef_search (int): Candidate list size at query time (raised to k if
+        smaller). Higher values improve recall at the cost of speed.
+
+Example:
+    params = HNSWSearchParams()
+    params.ef_search = 200
+    results = db.search(query, k=10, params=params)
+)")
+      .def(py::init<>())
+      .def_readwrite("ef_search", &HNSWSearchParams::ef_search,
+                     "Candidate list size at query time (default: 50).");
+
   // ---- Index hierarchy ----
   py::class_<IndexBase>(m, "IndexBase",
                         "Abstract base class for all index types.");
@@ -81,55 +474,238 @@ Example:
   py::class_<FlatIndex, IndexBase>(
       m, "FlatIndex",
       "Brute-force flat index for exact nearest neighbor search.")
-      .def(py::init<>());
+      .def(py::init<Metric>(), py::arg("metric") = Metric::L2);
+
+  py::enum_<CoarseQuantizer>(m, "CoarseQuantizer",
+                             R"(How an IVF index ranks its clusters.
+
+    FLAT: Score every centroid and keep the n_probe closest (exact).
+    HNSW: Search an HNSW graph over the centroids; sublinear in
+        n_clusters, worth it from about 16k clusters.
+)")
+      .value("FLAT", CoarseQuantizer::Flat)
+      .value("HNSW", CoarseQuantizer::HNSW);
+
+  py::enum_<IVFStorage>(m, "IVFStorage",
+                        R"(What an IVF index stores in its lists.
+
+    FULL: Ids only; scans read the full vectors.
+    SQ8: Each vector's residual to its centroid as one byte per
+        dimension. Scans read 4x fewer bytes; distances are approximate
+        unless IVFSearchParams.rerank_factor re-scores them.
+)")
+      .value("FULL", IVFStorage::Full)
+      .value("SQ8", IVFStorage::SQ8);
+
+  py::class_<ListSizeStats>(m, "ListSizeStats",
+                            R"(Distribution of IVF list sizes, in rows.
+
+A query scans the lists it probes, so max and the upper percentiles bound
+its tail latency. imbalance is max / mean (1.0 is perfectly even).
+)")
+      .def_readonly("lists", &ListSizeStats::lists)
+      .def_readonly("empty", &ListSizeStats::empty)
+      .def_readonly("min", &ListSizeStats::min)
+      .def_readonly("max", &ListSizeStats::max)
+      .def_readonly("mean", &ListSizeStats::mean)
+      .def_readonly("stddev", &ListSizeStats::stddev)
+      .def_readonly("p50", &ListSizeStats::p50)
+      .def_readonly("p90", &ListSizeStats::p90)
+      .def_readonly("p99", &ListSizeStats::p99)
+      .def_readonly("imbalance", &ListSizeStats::imbalance)
+      .def("__repr__", [](const ListSizeStats &s) {
+        return "ListSizeStats(lists=" + std::to_string(s.lists) +
+               ", min=" + std::to_string(s.min) +
+               ", p50=" + std::to_string(s.p50) +
+               ", p99=" + std::to_string(s.p99) +
+               ", max=" + std::to_string(s.max) +
+               ", imbalance=" + std::to_string(s.imbalance) + ")";
+      });
 
   py::class_<IVFIndex, IndexBase>(
       m, "IVFIndex",
       "Inverted File Index using K-Means clustering for approximate search.")
-      .def(py::init<int, int, int, int>(), py::arg("n_clusters"),
-           py::arg("dimension"), py::arg("max_iters") = 50,
-           py::arg("n_probe") = 1);
+      .def(py::init<int, int, int, int, Metric, CoarseQuantizer,
+                    IVFStorage, float, int>(),
+           py::arg("n_clusters"), py::arg("dimension"),
+           py::arg("max_iters") = 50, py::arg("n_probe") = 1,
+           py::arg("metric") = Metric::L2,
+           py::arg("coarse_quantizer") = CoarseQuantizer::Flat,
+           py::arg("storage") = IVFStorage::Full,
+           py::arg("max_list_factor") = 0.0f, py::arg("spill") = 1)
+      .def("list_sizes", &IVFIndex::list_sizes,
+           "Rows in each list, in list order (empty before build).")
+      .def("list_size_stats", &IVFIndex::list_size_stats,
+           "Summary of the list size distribution (see ListSizeStats).");
 
   py::class_<AnnoyIndex, IndexBase>(
       m, "AnnoyIndex",
       "Approximate Nearest Neighbors using random projection trees.")
-      .def(py::init<int, int, int, int, bool>(), py::arg("dimension"),
-           py::arg("num_trees"), py::arg("k_leaf"), py::arg("search_k") = -1,
-           py::arg("use_priority_queue") = true);
+      .def(py::init<int, int, int, int, bool, Metric>(),
+           py::arg("dimension"), py::arg("num_trees"), py::arg("k_leaf"),
+           py::arg("search_k") = -1, py::arg("use_priority_queue") = true,
+           py::arg("metric") = Metric::L2);
+
+  py::class_<HNSWIndex, IndexBase>(
+      m, "HNSWIndex",
+      "In-memory HNSW graph with concurrent, incremental inserts.")
+      .def(py::init<int, int, int, Metric>(), py::arg("M") = 16,
+           py::arg("ef_construction") = 200, py::arg("ef_search") = 50,
+           py::arg("metric") = Metric::L2);
+
+  py::class_<DiskANNIndex, IndexBase>(
+      m, "DiskANNIndex",
+      "Disk-resident Vamana graph searched with PQ-guided beam search.")
+      .def(py::init<int, const std::string &, int, int, float, int, int, int,
+                    Metric>(),
+           py::arg("dimension"), py::arg("graph_path"),
+           py::arg("max_degree") = 64, py::arg("build_list") = 100,
+           py::arg("alpha") = 1.2f, py::arg("search_list") = 100,
+           py::arg("beam_width") = 4, py::arg("pq_subspaces") = 0,
+           py::arg("metric") = Metric::L2)
+      .def_property_readonly("graph_path", &DiskANNIndex::path,
+                             "File holding the graph and full vectors.")
+      .def_property_readonly("uses_io_uring", &DiskANNIndex::uses_io_uring,
+                             "True if disk reads are batched with io_uring.");
 
   // ---- VegamDB (the orchestrator) ----
-  py::class_<VegamDB>(
+  // Shared holder: ShardedVegamDB.shard() hands out shards it co-owns
+  py::class_<VegamDB, std::shared_ptr<VegamDB>>(
       m, "VegamDB",
       "A high-performance vector database with pluggable index types.")
-      .def(py::init<>(), "Create a new empty VegamDB instance.")
+      .def(py::init<Metric>(), py::arg("metric") = Metric::L2,
+           "Create a new empty VegamDB instance using the given metric.")
+      .def("metric", &VegamDB::metric,
+           "Return the similarity metric of the database.")
       .def("dimension", &VegamDB::dimension,
+           py::call_guard<py::gil_scoped_release>(),
            "Return the dimensionality of stored vectors (0 if empty).")
       .def("add_vector", &VegamDB::add_vector, py::arg("vec"),
+           py::call_guard<py::gil_scoped_release>(),
            "Add a single vector as a Python list of floats.")
 
       .def(
           "add_vector_numpy",
-          [](VegamDB &self, py::array_t<float> input_array) {
-            py::buffer_info buf = input_array.request();
-            if (buf.ndim == 1) {
-              float *data_ptr = static_cast<float *>(buf.ptr);
-              size_t dim = buf.size;
-              self.add_vector_np(data_ptr, 1, dim);
-            } else if (buf.ndim == 2) {
-              float *data_ptr = static_cast<float *>(buf.ptr);
-              size_t n_vectors = buf.shape[0];
-              size_t dim = buf.shape[1];
-              self.add_vector_np(data_ptr, n_vectors, dim);
-            } else {
-              throw std::runtime_error("Number of dimensions must be 1/2D");
-            }
+          [](VegamDB &self, py::array input_array) {
+            add_numpy(self, std::move(input_array));
           },
           py::arg("input_array"),
-          "Add a single vector from a 1D NumPy float32 array or a 2D Numpy "
-          "Array(zero-copy).")
+          "Add vectors from a 1D (one vector) or 2D (one per row) NumPy "
+          "array. A C-contiguous float32 array is copied once, directly into "
+          "the store; other dtypes or layouts are converted first and emit a "
+          "RuntimeWarning.")
+      .def("add_from_file", &VegamDB::add_from_file, py::arg("path"),
+           py::arg("max_rows") = 0,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Add vectors from an .fvecs, .bvecs or .npy file.
+
+The file is memory-mapped and streamed into the store in C++, without a
+NumPy round trip. bvecs/uint8 and float64 data are converted to float32.
+The file is added whole or not at all: if reading fails part way, no rows
+are added or logged.
+
+Args:
+    path: Path ending in .fvecs, .bvecs or .npy.
+    max_rows: Read at most this many vectors (0 = all).
+
+Returns:
+    Number of vectors added.
+)")
+      .def(
+          "attach_numpy",
+          [](VegamDB &self, py::array array) {
+            // Wrapping in place only works for the exact layout the
+            // kernels read; converting would defeat the purpose.
+            bool is_float32 = array.dtype().is(py::dtype::of<float>());
+            bool is_contiguous = array.flags() & py::array::c_style;
+            if (array.ndim() != 2 || !is_float32 || !is_contiguous) {
+              throw std::invalid_argument(
+                  "attach_numpy needs a 2D C-contiguous float32 array");
+            }
+
+            // Hold a reference to the array (or memmap) for as long as the
+            // store uses its memory. The last owner may be released from
+            // C++, so reacquire the GIL before dropping the reference.
+            std::shared_ptr<const void> owner(
+                new py::object(array), [](const void *ptr) {
+                  py::gil_scoped_acquire gil;
+                  delete static_cast<const py::object *>(ptr);
+                });
+            const float *data = static_cast<const float *>(array.data());
+            size_t rows = array.shape(0);
+            size_t dim = array.shape(1);
+            py::gil_scoped_release release;
+            self.attach_external(data, rows, dim, std::move(owner));
+          },
+          py::arg("array"),
+          "Search a 2D C-contiguous float32 array (or np.memmap) in place "
+          "without copying it. The database keeps a reference to the array "
+          "and becomes read-only. For COSINE the rows must already be "
+          "unit-norm.")
+      .def("is_external", &VegamDB::is_external,
+           py::call_guard<py::gil_scoped_release>(),
+           "True if the database wraps an array attached with "
+           "attach_numpy().")
 
       .def("size", &VegamDB::size,
-           "Return the number of vectors stored in the database.")
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the number of vectors stored in the database, "
+           "including removed ones (ids are never reused).")
+
+      // ---- Removal ----
+      .def("remove", &VegamDB::remove, py::arg("ids"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Remove vectors by id. Removed vectors never appear in search "
+           "results; their ids are not reused. Raises ValueError for an "
+           "out-of-range id.")
+      .def("is_deleted", &VegamDB::is_deleted, py::arg("id"),
+           py::call_guard<py::gil_scoped_release>(),
+           "True if the vector with this id was removed.")
+      .def("deleted_count", &VegamDB::deleted_count,
+           py::call_guard<py::gil_scoped_release>(),
+           "Number of removed vectors.")
+
+      // ---- Attributes ----
+      .def(
+          "set_int_attribute",
+          [](VegamDB &self, const std::string &name,
+             py::array_t<int64_t, py::array::c_style | py::array::forcecast>
+                 values) {
+            const int64_t *ptr = values.data();
+            std::vector<int64_t> column(ptr, ptr + values.size());
+            py::gil_scoped_release release;
+            self.set_int_attribute(name, std::move(column));
+          },
+          py::arg("name"), py::arg("values"),
+          "Set an int64 attribute column (one value per vector).")
+      .def(
+          "set_float_attribute",
+          [](VegamDB &self, const std::string &name,
+             py::array_t<float, py::array::c_style | py::array::forcecast>
+                 values) {
+            const float *ptr = values.data();
+            std::vector<float> column(ptr, ptr + values.size());
+            py::gil_scoped_release release;
+            self.set_float_attribute(name, std::move(column));
+          },
+          py::arg("name"), py::arg("values"),
+          "Set a float attribute column (one value per vector).")
+      .def("set_string_attribute", &VegamDB::set_string_attribute,
+           py::arg("name"), py::arg("values"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Set a string/enum attribute column (one value per vector). "
+           "Values are dictionary-encoded.")
+      .def("attribute_names", &VegamDB::attribute_names,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the names of all attribute columns.")
+      .def(
+          "evaluate",
+          [](const VegamDB &self, const Predicate &predicate) {
+            py::gil_scoped_release release;
+            return Bitmap(*self.evaluate(predicate));
+          },
+          py::arg("predicate"),
+          "Compile a predicate into a Bitmap of matching vector ids.")
 
       // Factory lambdas: pybind11 v2.11.1 can't directly bind functions taking
       // unique_ptr<AbstractBase> as a parameter. These lambdas construct the
@@ -137,24 +713,98 @@ Example:
       // transfer issue.
       .def(
           "use_flat_index",
-          [](VegamDB &self) { self.set_index(std::make_unique<FlatIndex>()); },
+          [](VegamDB &self) {
+            self.set_index(std::make_unique<FlatIndex>(self.metric()));
+          },
+          py::call_guard<py::gil_scoped_release>(),
           "Set the index to brute-force flat search (exact, no training "
           "needed).")
 
       .def(
           "use_ivf_index",
-          [](VegamDB &self, int n_clusters, int max_iters, int n_probe) {
+          [](VegamDB &self, int n_clusters, int max_iters, int n_probe,
+             CoarseQuantizer coarse_quantizer, IVFStorage storage,
+             float max_list_factor, int spill) {
             self.set_index(std::make_unique<IVFIndex>(
-                n_clusters, self.dimension(), max_iters, n_probe));
+                n_clusters, self.dimension(), max_iters, n_probe,
+                self.metric(), coarse_quantizer, storage, max_list_factor,
+                spill));
           },
           py::arg("n_clusters"), py::arg("max_iters") = 50,
           py::arg("n_probe") = 1,
+          py::arg("coarse_quantizer") = CoarseQuantizer::Flat,
+          py::arg("storage") = IVFStorage::Full,
+          py::arg("max_list_factor") = 0.0f, py::arg("spill") = 1,
+          py::call_guard<py::gil_scoped_release>(),
           R"(Set the index to IVF (Inverted File Index) for approximate search.
 
 Args:
     n_clusters: Number of Voronoi cells (clusters) for partitioning.
     max_iters: Maximum K-Means iterations for training (default: 50).
     n_probe: Number of clusters to search at query time (default: 1).
+    coarse_quantizer: CoarseQuantizer.HNSW ranks clusters with a graph
+        over the centroids instead of scoring them all (default: FLAT).
+    storage: IVFStorage.SQ8 keeps 8-bit residual codes in the lists and
+        scans those instead of the vectors (default: FULL).
+    max_list_factor: Balanced k-means: no list holds more than
+        max(1, factor) times the mean list size. 0 (default) leaves
+        list sizes to plain k-means.
+    spill: Lists each vector is stored in: its own cluster plus the
+        spill - 1 next-closest ones (default: 1). Vectors near cluster
+        boundaries are then found with a smaller n_probe, at spill times
+        the id (and SQ8 code) memory; repeats are dropped at search time.
+)")
+
+      .def(
+          "use_hnsw_index",
+          [](VegamDB &self, int M, int ef_construction, int ef_search) {
+            self.set_index(std::make_unique<HNSWIndex>(M, ef_construction,
+                                                       ef_search,
+                                                       self.metric()));
+          },
+          py::arg("M") = 16, py::arg("ef_construction") = 200,
+          py::arg("ef_search") = 50, py::call_guard<py::gil_scoped_release>(),
+          R"(Set the index to HNSW (Hierarchical Navigable Small World).
+
+Once built, the index stays current: add_vector_numpy() links new
+vectors into the graph (on all cores for large batches) before it
+returns, while searches from other threads keep running.
+
+Args:
+    M: Links per node per layer; layer 0 gets 2 * M (default: 16).
+    ef_construction: Candidate list size while inserting (default: 200).
+    ef_search: Default candidate list size at query time (default: 50).
+)")
+
+      .def(
+          "use_diskann_index",
+          [](VegamDB &self, const std::string &graph_path, int max_degree,
+             int build_list, float alpha, int search_list, int beam_width,
+             int pq_subspaces) {
+            self.set_index(std::make_unique<DiskANNIndex>(
+                self.dimension(), graph_path, max_degree, build_list, alpha,
+                search_list, beam_width, pq_subspaces, self.metric()));
+          },
+          py::arg("graph_path"), py::arg("max_degree") = 64,
+          py::arg("build_list") = 100, py::arg("alpha") = 1.2f,
+          py::arg("search_list") = 100, py::arg("beam_width") = 4,
+          py::arg("pq_subspaces") = 0,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Set the index to a disk-resident DiskANN (Vamana) graph.
+
+build_index() writes the graph, with a full-precision copy of every
+vector, to `graph_path` in 4 KiB-aligned blocks. Only PQ codes stay in
+memory. Searches read nodes from that file, so it must stay in place;
+save() records its path.
+
+Args:
+    graph_path: File to write the graph to.
+    max_degree: Neighbors per node R (default: 64).
+    build_list: Candidate list size during construction (default: 100).
+    alpha: Pruning slack; > 1 keeps long-range edges (default: 1.2).
+    search_list: Default candidate list size L at query time.
+    beam_width: Default nodes read per disk round trip.
+    pq_subspaces: PQ bytes per vector held in memory (0: dimension / 4).
 )")
 
       .def(
@@ -163,10 +813,11 @@ Args:
              bool use_priority_queue) {
             self.set_index(std::make_unique<AnnoyIndex>(
                 self.dimension(), num_trees, k_leaf, search_k,
-                use_priority_queue));
+                use_priority_queue, self.metric()));
           },
           py::arg("num_trees"), py::arg("k_leaf"), py::arg("search_k") = -1,
           py::arg("use_priority_queue") = true,
+          py::call_guard<py::gil_scoped_release>(),
           R"(Set the index to Annoy (Approximate Nearest Neighbors Oh Yeah).
 
 Args:
@@ -176,24 +827,378 @@ Args:
     use_priority_queue: Use priority queue (True) or greedy (False) search.
 )")
 
-      .def("build_index", &VegamDB::build_index,
-           "Explicitly build/train the current index on stored vectors.")
-      .def("search", &VegamDB::search, py::arg("query"), py::arg("k"),
-           py::arg("params") = nullptr,
-           R"(Search for the k nearest neighbors of a query vector.
+      .def(
+          "build_index",
+          [](VegamDB &self, py::object callback) {
+            if (callback.is_none()) {
+              py::gil_scoped_release release;
+              self.build_index();
+              return;
+            }
+            // The build holds the writer lock. Calling into Python from the
+            // building thread would wait for the GIL while a Python thread
+            // holding it may be waiting for that lock, so the building
+            // thread only queues snapshots and this thread, which holds no
+            // lock, passes them to the callback.
+            ProgressQueue queue;
+            self.set_build_callback([&queue](const BuildProgressSnapshot &s) {
+              queue.push(s);
+            });
+            std::exception_ptr error;
+            std::thread builder([&] {
+              try {
+                self.build_index();
+              } catch (...) {
+                error = std::current_exception();
+              }
+              queue.close();
+            });
+
+            bool done = false;
+            while (!done) {
+              std::vector<BuildProgressSnapshot> batch;
+              {
+                py::gil_scoped_release release;
+                done = queue.wait(batch);
+              }
+              // An exception cannot abort the build half-way, so report it
+              // and carry on
+              for (const auto &snapshot : batch) {
+                try {
+                  callback(snapshot);
+                } catch (py::error_already_set &e) {
+                  e.discard_as_unraisable("build_index callback");
+                }
+              }
+            }
+            {
+              py::gil_scoped_release release;
+              builder.join();
+            }
+            self.set_build_callback(nullptr);
+            if (error)
+              std::rethrow_exception(error);
+          },
+          py::arg("callback") = py::none(),
+          R"(Explicitly build/train the current index on stored vectors.
+
+The GIL is released while building, so other Python threads can poll
+build_progress() (searches wait for the build to finish).
+
+Args:
+    callback: Optional callable taking a BuildProgress. Called on the
+        calling thread at each phase change and at most every 200 ms
+        during a phase, while the build runs on a worker thread.
+)")
+      .def("ivf_list_sizes", &VegamDB::ivf_list_sizes,
+           py::call_guard<py::gil_scoped_release>(),
+           "Rows in each list of the current IVF index, in list order. "
+           "Raises RuntimeError if the index is not IVF.")
+      .def("ivf_list_size_stats", &VegamDB::ivf_list_size_stats,
+           py::call_guard<py::gil_scoped_release>(),
+           "Summary of the current IVF index's list sizes (see "
+           "ListSizeStats). Raises RuntimeError if the index is not IVF.")
+      .def("build_progress", &VegamDB::build_progress,
+           "Return a BuildProgress snapshot of the current or last build. "
+           "Does not wait for a running build.")
+      .def(
+          "search",
+          [](VegamDB &self, const std::vector<float> &query, int k,
+             const SearchParams *params, py::object filter,
+             SearchStats *stats) {
+            // Convert the filter while holding the GIL, then search
+            // without it so Python threads can query in parallel
+            if (filter.is_none()) {
+              py::gil_scoped_release release;
+              return self.search(query, k, params, nullptr, stats);
+            }
+            if (py::isinstance<Bitmap>(filter)) {
+              const Bitmap &allowed = filter.cast<const Bitmap &>();
+              py::gil_scoped_release release;
+              return self.search(query, k, params, &allowed, stats);
+            }
+            if (py::isinstance<Predicate>(filter)) {
+              const Predicate &where = filter.cast<const Predicate &>();
+              py::gil_scoped_release release;
+              return self.search(query, k, params, where, stats);
+            }
+            Bitmap allowed = Bitmap::from_ids(filter.cast<std::vector<int>>());
+            py::gil_scoped_release release;
+            return self.search(query, k, params, &allowed, stats);
+          },
+          py::arg("query"), py::arg("k"), py::arg("params") = nullptr,
+          py::arg("filter") = py::none(), py::arg("stats") = nullptr,
+          R"(Search for the k nearest neighbors of a query vector.
 
 Args:
     query: 1D list of floats representing the query vector.
     k: Number of nearest neighbors to return.
-    params: Optional IVFSearchParams or AnnoyIndexParams.
+    params: Optional IVFSearchParams, AnnoyIndexParams,
+        HNSWSearchParams or DiskANNSearchParams.
+    filter: Optional allow-list: a Bitmap, a list of ids, or a Predicate
+        over an attribute column. Only allowed ids are returned. Very
+        selective filters are answered by an exact scan over the allowed
+        ids.
+    stats: Optional SearchStats, overwritten with this query's counters
+        and phase timings.
 
 Returns:
     SearchResults with .ids (list[int]) and .distances (list[float]).
 )")
-      .def("save", &VegamDB::save, py::arg("filename"),
-           "Save the database (vectors + index) to a binary file.")
+      .def("search_stats", &VegamDB::search_stats,
+           "Aggregate statistics over all searches since creation or the "
+           "last reset_search_stats(). Safe to call while searching.")
+      .def("reset_search_stats", &VegamDB::reset_search_stats,
+           "Zero the aggregate search statistics.")
+      .def(
+          "save",
+          [](VegamDB &self, const std::string &filename,
+             Compression compression, bool parallel) {
+            SaveOptions options;
+            options.compression = compression;
+            options.parallel = parallel;
+            self.save(filename, options);
+          },
+          py::arg("filename"), py::arg("compression") = Compression::None,
+          py::arg("parallel") = true,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Save the database (vectors + index) to a binary file.
+
+Each section is checksummed (CRC32C) and written in large blocks. The
+snapshot goes to a temp file that is fsynced and renamed over
+`filename`, so a crash leaves either the old or the new file. Saving to
+the path given to enable_wal() empties the write-ahead log.
+
+Args:
+    filename: Destination path.
+    compression: Compression for the index and attribute sections.
+        Raises ValueError if this build does not support it.
+    parallel: Serialize the index and attributes on worker threads while
+        the vectors are written (uses memory for a copy of them).
+)")
       .def("load", &VegamDB::load, py::arg("filename"),
-           "Load a database (vectors + index) from a binary file.");
+           py::call_guard<py::gil_scoped_release>(),
+           "Load a database (vectors + index) from a binary file, then "
+           "replay `filename`.wal if it exists. Raises RuntimeError if the "
+           "file is corrupt, truncated or missing.")
+      .def("enable_wal", &VegamDB::enable_wal, py::arg("snapshot_path"),
+           py::arg("sync") = true, py::call_guard<py::gil_scoped_release>(),
+           R"(Log every later add/remove to `snapshot_path`.wal.
+
+Each call is appended to the log before it is applied; load() replays
+the records the snapshot does not contain, and save(snapshot_path)
+empties the log. When reopening a database, load() it before enabling
+the log. Attribute changes are not logged.
+
+Args:
+    snapshot_path: The snapshot file this log belongs to.
+    sync: fsync the log on every call (survives power loss). When False,
+        writes only reach the OS (survives a process crash).
+)")
+      .def("disable_wal", &VegamDB::disable_wal,
+           py::call_guard<py::gil_scoped_release>(),
+           "Stop logging adds and removes.")
+      .def("wal_enabled", &VegamDB::wal_enabled,
+           py::call_guard<py::gil_scoped_release>(),
+           "True if a write-ahead log is enabled.");
+
+  // ---- ShardedVegamDB ----
+  py::enum_<ShardPolicy>(m, "ShardPolicy",
+                         R"(How ShardedVegamDB assigns ids to shards.
+
+    HASH: A hash of the id picks the shard; every batch spreads evenly.
+    RANGE: Runs of `range_size` consecutive ids go to the shards in turn.
+)")
+      .value("HASH", ShardPolicy::Hash)
+      .value("RANGE", ShardPolicy::Range);
+
+  py::class_<ShardedVegamDB>(m, "ShardedVegamDB",
+                             R"(Vectors partitioned across independent shards.
+
+Each shard is a VegamDB with its own index. Batches of vectors are
+routed to their shards and added in parallel, build_index() builds all
+shards in parallel, and search() queries every shard concurrently and
+merges their top-k. Ids are global, in insertion order.
+)")
+      .def(py::init<size_t, ShardPolicy, Metric, size_t>(),
+           py::arg("n_shards"), py::arg("policy") = ShardPolicy::Hash,
+           py::arg("metric") = Metric::L2, py::arg("range_size") = 4096,
+           "Create an empty database with `n_shards` shards. Raises "
+           "ValueError if n_shards or range_size is 0.")
+      .def("metric", &ShardedVegamDB::metric,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the similarity metric of the database.")
+      .def("policy", &ShardedVegamDB::policy,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the ShardPolicy ids are routed by.")
+      .def("shard_count", &ShardedVegamDB::shard_count,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the number of shards.")
+      .def("shard", &ShardedVegamDB::shard, py::arg("i"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Return shard `i` as a VegamDB, e.g. to give it its own index. "
+           "Its ids are local; global_id() translates them. After load(), "
+           "a shard fetched before it is detached from this database. "
+           "Raises IndexError if i is out of range.")
+      .def("shard_of", &ShardedVegamDB::shard_of, py::arg("id"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the shard holding global id `id`.")
+      .def("global_id", &ShardedVegamDB::global_id, py::arg("shard"),
+           py::arg("local_id"), py::call_guard<py::gil_scoped_release>(),
+           "Translate a shard's local id into the global id.")
+      .def("dimension", &ShardedVegamDB::dimension,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the dimensionality of stored vectors (0 if empty).")
+      .def("add_vector", &ShardedVegamDB::add_vector, py::arg("vec"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Add a single vector as a Python list of floats.")
+      .def(
+          "add_vector_numpy",
+          [](ShardedVegamDB &self, py::array input_array) {
+            add_numpy(self, std::move(input_array));
+          },
+          py::arg("input_array"),
+          "Add vectors from a 1D or 2D NumPy array. Rows are routed to "
+          "their shards and each shard's rows are added on its own thread.")
+      .def("remove", &ShardedVegamDB::remove, py::arg("ids"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Tombstone vectors by global id. Raises ValueError for an "
+           "out-of-range id.")
+      .def("is_deleted", &ShardedVegamDB::is_deleted, py::arg("id"),
+           py::call_guard<py::gil_scoped_release>(),
+           "True if the vector with this id was removed.")
+      .def("deleted_count", &ShardedVegamDB::deleted_count,
+           py::call_guard<py::gil_scoped_release>(),
+           "Number of removed vectors.")
+      .def(
+          "use_flat_index",
+          [](ShardedVegamDB &self) {
+            Metric metric = self.metric();
+            self.set_index(
+                [metric] { return std::make_unique<FlatIndex>(metric); });
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          "Give every shard a brute-force flat index.")
+      .def(
+          "use_ivf_index",
+          [](ShardedVegamDB &self, int n_clusters, int max_iters,
+             int n_probe, CoarseQuantizer coarse_quantizer,
+             IVFStorage storage, float max_list_factor, int spill) {
+            Metric metric = self.metric();
+            int dim = self.dimension();
+            self.set_index([=] {
+              return std::make_unique<IVFIndex>(
+                  n_clusters, dim, max_iters, n_probe, metric,
+                  coarse_quantizer, storage, max_list_factor, spill);
+            });
+          },
+          py::arg("n_clusters"), py::arg("max_iters") = 50,
+          py::arg("n_probe") = 1,
+          py::arg("coarse_quantizer") = CoarseQuantizer::Flat,
+          py::arg("storage") = IVFStorage::Full,
+          py::arg("max_list_factor") = 0.0f, py::arg("spill") = 1,
+          py::call_guard<py::gil_scoped_release>(),
+          "Give every shard an IVF index with `n_clusters` clusters of its "
+          "own (see VegamDB.use_ivf_index).")
+      .def(
+          "use_hnsw_index",
+          [](ShardedVegamDB &self, int M, int ef_construction,
+             int ef_search) {
+            Metric metric = self.metric();
+            self.set_index([=] {
+              return std::make_unique<HNSWIndex>(M, ef_construction,
+                                                 ef_search, metric);
+            });
+          },
+          py::arg("M") = 16, py::arg("ef_construction") = 200,
+          py::arg("ef_search") = 50,
+          py::call_guard<py::gil_scoped_release>(),
+          "Give every shard an HNSW graph of its own (see "
+          "VegamDB.use_hnsw_index).")
+      .def(
+          "use_annoy_index",
+          [](ShardedVegamDB &self, int num_trees, int k_leaf, int search_k,
+             bool use_priority_queue) {
+            Metric metric = self.metric();
+            int dim = self.dimension();
+            self.set_index([=] {
+              return std::make_unique<AnnoyIndex>(dim, num_trees, k_leaf,
+                                                  search_k,
+                                                  use_priority_queue, metric);
+            });
+          },
+          py::arg("num_trees"), py::arg("k_leaf"), py::arg("search_k") = -1,
+          py::arg("use_priority_queue") = true,
+          py::call_guard<py::gil_scoped_release>(),
+          "Give every shard an Annoy forest of its own (see "
+          "VegamDB.use_annoy_index).")
+      .def("build_index", &ShardedVegamDB::build_index,
+           py::call_guard<py::gil_scoped_release>(),
+           "Build every non-empty shard in parallel. Shards without an "
+           "index get a flat one.")
+      .def("build_shard", &ShardedVegamDB::build_shard, py::arg("i"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Build (or rebuild) shard `i` only; the others keep serving.")
+      .def(
+          "search",
+          [](ShardedVegamDB &self, const std::vector<float> &query, int k,
+             const SearchParams *params, py::object filter,
+             SearchStats *stats) {
+            if (filter.is_none()) {
+              py::gil_scoped_release release;
+              return self.search(query, k, params, nullptr, stats);
+            }
+            if (py::isinstance<Bitmap>(filter)) {
+              const Bitmap &allowed = filter.cast<const Bitmap &>();
+              py::gil_scoped_release release;
+              return self.search(query, k, params, &allowed, stats);
+            }
+            Bitmap allowed = Bitmap::from_ids(filter.cast<std::vector<int>>());
+            py::gil_scoped_release release;
+            return self.search(query, k, params, &allowed, stats);
+          },
+          py::arg("query"), py::arg("k"), py::arg("params") = nullptr,
+          py::arg("filter") = py::none(), py::arg("stats") = nullptr,
+          R"(Search all shards concurrently and merge their top-k.
+
+Args:
+    query: 1D list of floats representing the query vector.
+    k: Number of nearest neighbors to return.
+    params: Optional search parameters, passed to every shard.
+    filter: Optional allow-list of global ids: a Bitmap or a list.
+    stats: Optional SearchStats. Counters are summed over shards; phase
+        times are the slowest shard's.
+
+Returns:
+    SearchResults with global ids, closest first.
+)")
+      .def("search_stats", &ShardedVegamDB::search_stats,
+           "Aggregate statistics over all searches since creation or the "
+           "last reset_search_stats().")
+      .def("reset_search_stats", &ShardedVegamDB::reset_search_stats,
+           "Zero the aggregate search statistics.")
+      .def(
+          "save",
+          [](ShardedVegamDB &self, const std::string &filename,
+             Compression compression) {
+            SaveOptions options;
+            options.compression = compression;
+            self.save(filename, options);
+          },
+          py::arg("filename"), py::arg("compression") = Compression::None,
+          py::call_guard<py::gil_scoped_release>(),
+          "Save every shard, in parallel, to `filename`.g<N>.shard<i> for a "
+          "new generation N, then a manifest to `filename`, then delete the "
+          "previous generation. A crash mid-save leaves the previous "
+          "snapshot loadable.")
+      .def("load", &ShardedVegamDB::load, py::arg("filename"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Load a database saved by save(), replacing this one's shards "
+           "and configuration. Raises RuntimeError if a file is missing or "
+           "a shard does not match the manifest.")
+      .def("size", &ShardedVegamDB::size,
+           py::call_guard<py::gil_scoped_release>(),
+           "Return the number of vectors added, over all shards.");
 
   // ---- KMeans (standalone utility) ----
   py::class_<KMeansIndex>(m, "KMeansIndex",
@@ -204,9 +1209,32 @@ Returns:
                     "List of clusters, each containing vector indices.");
 
   py::class_<KMeans>(m, "KMeans", "Standalone K-Means clustering utility.")
-      .def(py::init<int, int, int>(), py::arg("n_clusters"),
+      .def(py::init<int, int, int, Metric, float>(), py::arg("n_clusters"),
            py::arg("dimension"), py::arg("max_iters"),
+           py::arg("metric") = Metric::L2,
+           py::arg("max_bucket_factor") = 0.0f,
            "Create a KMeans instance with given parameters.")
-      .def("train", &KMeans::train, py::arg("data"),
+      .def("train",
+           py::overload_cast<const std::vector<std::vector<float>> &>(
+               &KMeans::train),
+           py::arg("data"),
            "Train K-Means on the provided data and return a KMeansIndex.");
+
+  // ---- Dataset files ----
+  m.def(
+      "read_ivecs",
+      [](const std::string &path, size_t max_rows) {
+        std::vector<std::vector<int>> rows = read_ivecs(path, max_rows);
+        size_t n = rows.size();
+        size_t dim = n ? rows[0].size() : 0;
+        py::array_t<int32_t> result({n, dim});
+        int32_t *out = result.mutable_data();
+        for (size_t i = 0; i < n; i++) {
+          std::copy(rows[i].begin(), rows[i].end(), out + i * dim);
+        }
+        return result;
+      },
+      py::arg("path"), py::arg("max_rows") = 0,
+      "Read an .ivecs (or integer .npy) file, e.g. ground-truth neighbor "
+      "ids, as an int32 array of shape (n_rows, dim).");
 }
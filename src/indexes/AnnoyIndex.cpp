@@ -1,10 +1,17 @@
 // src/indexes/AnnoyIndex.cpp
 
 #include "indexes/AnnoyIndex.hpp"
+#include "indexes/FlatIndex.hpp"
 #include "indexes/IndexBase.hpp"
+#include "utils/Distance.hpp"
 #include "utils/Math.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Prefetch.hpp"
+#include "utils/Timer.hpp"
+#include "utils/TopK.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <limits>
 #include <numeric>
@@ -13,10 +20,21 @@
 #include <utility>
 #include <vector>
 
+namespace {
+// Rows sampled to rank dimension blocks for early abandoning
+constexpr size_t kBlockOrderSamples = 4096;
+
+void append_bytes(std::vector<char> &out, const void *data, size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  out.insert(out.end(), bytes, bytes + size);
+}
+} // namespace
+
 AnnoyIndex::AnnoyIndex(int dimension, int num_trees, int k_leaf, int search_k,
-                       bool use_priority_queue)
+                       bool use_priority_queue, Metric metric)
     : dimension(dimension), num_trees(num_trees), k_leaf(k_leaf),
       use_priority_queue(use_priority_queue) {
+  this->metric_ = metric;
   if (search_k == -1) {
     this->search_k = num_trees * k_leaf;
   } else {
@@ -40,15 +58,18 @@ AnnoyIndex::~AnnoyIndex() {
 //   delete node;
 // }
 
-void AnnoyIndex::create_hyperplane_for_split(
-    const std::vector<std::vector<float>> &data, std::vector<int> &indices,
-    HyperPlane *hyperplane, std::mt19937 &rng) {
+void AnnoyIndex::create_hyperplane_for_split(const MatrixView &data,
+                                             std::vector<int> &indices,
+                                             HyperPlane *hyperplane,
+                                             std::mt19937 &rng) {
   std::shuffle(indices.begin(), indices.end(), rng);
   int point_a_idx = indices[0];
   int point_b_idx = indices[1];
 
-  std::vector<float> point_a = data[point_a_idx];
-  std::vector<float> point_b = data[point_b_idx];
+  std::vector<float> point_a(data.row(point_a_idx),
+                             data.row(point_a_idx) + dimension);
+  std::vector<float> point_b(data.row(point_b_idx),
+                             data.row(point_b_idx) + dimension);
 
   // std::uniform_int_distribution<> dist(0, indices.size() - 1);
   // int db_idx_a, db_idx_b;
@@ -65,6 +86,18 @@ void AnnoyIndex::create_hyperplane_for_split(
   // std::vector<float> point_a = data[db_idx_a];
   // std::vector<float> point_b = data[db_idx_b];
 
+  if (is_angular(metric_)) {
+    // Angular split: a hyperplane through the origin separating the two
+    // directions, so the split depends on angle rather than magnitude.
+    normalize(point_a.data(), dimension);
+    normalize(point_b.data(), dimension);
+    for (int i = 0; i < dimension; i++) {
+      hyperplane->w[i] = point_a[i] - point_b[i];
+    }
+    hyperplane->bias = 0.0f;
+    return;
+  }
+
   for (int i = 0; i < dimension; i++) {
     float temp = point_a[i] - point_b[i];
     hyperplane->w[i] = temp;
@@ -74,23 +107,15 @@ void AnnoyIndex::create_hyperplane_for_split(
   hyperplane->bias *= -1.0;
 }
 
-float AnnoyIndex::get_margin(HyperPlane *hyperplane,
-                             const std::vector<float> &x) {
+float AnnoyIndex::get_margin(HyperPlane *hyperplane, const float *x) {
   // Substitute the point in the hyperplane equation
-  float sum = 0;
-
-  for (int i = 0; i < dimension; i++) {
-    sum += x[i] * hyperplane->w[i];
-  };
-
-  sum += hyperplane->bias;
-
-  return sum;
+  return inner_product(x, hyperplane->w.data(), dimension) +
+         hyperplane->bias;
 }
 
-AnnoyNode *
-AnnoyIndex::build_tree_recursive(const std::vector<std::vector<float>> &data,
-                                 std::vector<int> &indices, std::mt19937 &rng) {
+AnnoyNode *AnnoyIndex::build_tree_recursive(const MatrixView &data,
+                                             std::vector<int> &indices,
+                                             std::mt19937 &rng) {
 
   AnnoyNode *node = new AnnoyNode(dimension);
 
@@ -106,8 +131,7 @@ AnnoyIndex::build_tree_recursive(const std::vector<std::vector<float>> &data,
   create_hyperplane_for_split(data, indices, node->hyperplane, rng);
 
   for (int i = 0; i < indices.size(); i++) {
-    const std::vector<float> &x = data[indices[i]];
-    float margin = get_margin(node->hyperplane, x);
+    float margin = get_margin(node->hyperplane, data.row(indices[i]));
 
     if (margin > 0) {
       left_indices.push_back(indices[i]);
@@ -132,7 +156,7 @@ AnnoyIndex::build_tree_recursive(const std::vector<std::vector<float>> &data,
   return node;
 }
 
-void AnnoyIndex::build(const std::vector<std::vector<float>> &data) {
+void AnnoyIndex::build(const MatrixView &data, BuildProgress *progress) {
   // empty existing roots
   // if (!this->roots.empty()) {
   //   for (int i = 0; i < this->roots.size(); i++) {
@@ -145,8 +169,13 @@ void AnnoyIndex::build(const std::vector<std::vector<float>> &data) {
   }
 
   roots.clear();
+  resolve_distance(dimension);
+  block_order_ = block_order_by_variance(data.data, data.size(), dimension,
+                                         kBlockOrderSamples);
 
   this->roots.resize(this->num_trees);
+  if (progress)
+    progress->begin_phase("trees", num_trees);
 
   for (int i = 0; i < num_trees; i++) {
     std::mt19937 rng = get_random_engine();
@@ -156,14 +185,18 @@ void AnnoyIndex::build(const std::vector<std::vector<float>> &data) {
     std::iota(indices.begin(), indices.end(), 0);
 
     this->roots[i] = build_tree_recursive(data, indices, rng);
+    if (progress)
+      progress->advance();
   }
 }
 
-SearchResults AnnoyIndex::search(const std::vector<std::vector<float>> &data,
+SearchResults AnnoyIndex::search(const MatrixView &data,
                                  const std::vector<float> &query, int k,
-                                 const SearchParams *params) {
+                                 const SearchParams *params,
+                                 const Bitmap *filter, SearchStats *stats) {
 
   SearchResults results;
+  PhaseTimer timer(stats != nullptr);
 
   if (!is_trained()) {
     return results;
@@ -174,11 +207,37 @@ SearchResults AnnoyIndex::search(const std::vector<std::vector<float>> &data,
 
   if (params) {
     auto annoy_params = dynamic_cast<const AnnoyIndexParams *>(params);
-    effective_search_k = annoy_params->search_k;
-    effective_use_pq = annoy_params->use_priority_queue;
+    if (annoy_params) {
+      effective_search_k = annoy_params->search_k;
+      effective_use_pq = annoy_params->use_priority_queue;
+    }
   }
 
+  // Adaptive fallback: when no more ids are allowed than the candidate budget,
+  // scoring the allow-list directly is exact and no slower than traversal.
+  if (filter && filter->count() <= effective_search_k) {
+    if (stats)
+      stats->filter_fallback = true;
+    return FlatIndex::search_allowed(data, query, k, *filter, metric_, stats,
+                                     block_order(query.size()));
+  }
+
+  // Only allowed ids enter the candidate set, so a filtered search keeps
+  // exploring leaves until search_k allowed candidates are collected.
   std::vector<int> candidates;
+  size_t nodes_visited = 0;
+  size_t leaves_visited = 0;
+  auto collect_bucket = [&](const std::vector<int> &bucket) {
+    leaves_visited++;
+    if (!filter) {
+      candidates.insert(candidates.end(), bucket.begin(), bucket.end());
+      return;
+    }
+    for (int id : bucket) {
+      if (filter->contains(id))
+        candidates.push_back(id);
+    }
+  };
 
   if (effective_use_pq) {
     // --- Priority queue approach (Spotify-style) ---
@@ -196,13 +255,13 @@ SearchResults AnnoyIndex::search(const std::vector<std::vector<float>> &data,
       pq.pop();
 
       if (node->is_leaf()) {
-        candidates.insert(candidates.end(), node->bucket.begin(),
-                          node->bucket.end());
+        collect_bucket(node->bucket);
 
         continue;
       }
 
-      float margin = get_margin(node->hyperplane, query);
+      float margin = get_margin(node->hyperplane, query.data());
+      nodes_visited++;
 
       pq.push({std::min(distance, margin), node->left});
       pq.push({std::min(distance, -1.0f * margin), node->right});
@@ -213,7 +272,8 @@ SearchResults AnnoyIndex::search(const std::vector<std::vector<float>> &data,
       AnnoyNode *curr = roots[i];
 
       while (!curr->is_leaf()) {
-        float margin = get_margin(curr->hyperplane, query);
+        float margin = get_margin(curr->hyperplane, query.data());
+        nodes_visited++;
 
         if (margin >= 0.0) {
           curr = curr->left;
@@ -222,43 +282,56 @@ SearchResults AnnoyIndex::search(const std::vector<std::vector<float>> &data,
         }
       }
 
-      candidates.insert(candidates.end(), curr->bucket.begin(),
-                        curr->bucket.end());
+      collect_bucket(curr->bucket);
     }
   }
 
+  size_t collected = candidates.size();
   std::sort(candidates.begin(), candidates.end());
   auto last = std::unique(candidates.begin(), candidates.end());
   candidates.erase(last, candidates.end());
 
-  std::vector<std::pair<int, float>> candidate_scores;
-  candidate_scores.resize(candidates.size());
-
-  for (int i = 0; i < candidates.size(); i++) {
-    int vector_idx = candidates[i];
-    float distance = euclidean_distance_squared(query, data[vector_idx]);
-
-    candidate_scores[i] = {vector_idx, distance};
+  if (stats) {
+    stats->ranking_us += timer.lap();
+    stats->nodes_visited += nodes_visited;
+    stats->leaves_visited += leaves_visited;
+    stats->duplicates_removed += collected - candidates.size();
   }
 
-  std::sort(candidate_scores.begin(), candidate_scores.end(),
-            [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
-              return a.second < b.second;
-            });
-
-  int min_k = std::min(k, static_cast<int>(candidate_scores.size()));
+  // Re-rank into a top-k; candidates that cannot make it stop early
+  TopK top(std::max(k, 0));
+  size_t dim = query.size();
+  BoundedDistanceFunction distance_fn = bounded_distance_for(dim);
+  const uint32_t *order = block_order(dim);
+
+  // `candidates` is sorted by id, i.e. by row position, so the gather
+  // walks the store forwards with the next rows already requested
+  gather_scan(data, candidates.data(), candidates.size(),
+              [&](int vector_idx, const float *row) {
+                float distance = distance_fn(query.data(), row, dim,
+                                             top.threshold(), order);
+                top.push(vector_idx, distance);
+              });
+
+  if (stats) {
+    stats->scan_us += timer.lap();
+    stats->distance_computations += candidates.size();
+    stats->candidates += candidates.size();
+  }
 
-  for (int i = 0; i < min_k; i++) {
-    results.ids.push_back(candidate_scores[i].first);
-    results.distances.push_back(candidate_scores[i].second);
+  for (const auto &scored : top.take_sorted()) {
+    results.ids.push_back(scored.second);
+    results.distances.push_back(scored.first);
   }
 
+  if (stats)
+    stats->rerank_us += timer.lap();
   return results;
 }
 
 bool AnnoyIndex::is_trained() const { return !roots.empty(); }
 
-void AnnoyIndex::save(std::ofstream &out) const {
+void AnnoyIndex::save(std::ostream &out) const {
   // Write metadata
   out.write(reinterpret_cast<const char *>(&use_priority_queue), sizeof(bool));
   out.write(reinterpret_cast<const char *>(&num_trees), sizeof(int));
@@ -266,50 +339,69 @@ void AnnoyIndex::save(std::ofstream &out) const {
   out.write(reinterpret_cast<const char *>(&k_leaf), sizeof(int));
   out.write(reinterpret_cast<const char *>(&search_k), sizeof(int));
 
-  // Write each tree
-  for (int i = 0; i < num_trees; i++) {
-    save_node(out, roots[i]);
+  // Serialize a batch of trees into separate buffers in parallel, then
+  // write each with one call instead of several tiny writes per node.
+  // Batching by thread count bounds the extra memory.
+  size_t n_threads = default_num_threads();
+  std::vector<std::vector<char>> buffers(
+      std::min<size_t>(n_threads, num_trees));
+  for (size_t first = 0; first < static_cast<size_t>(num_trees);
+       first += buffers.size()) {
+    size_t batch = std::min(buffers.size(), num_trees - first);
+    parallel_for(batch, n_threads, [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; t++) {
+        buffers[t].clear();
+        save_node(buffers[t], roots[first + t]);
+      }
+    });
+    for (size_t t = 0; t < batch; t++)
+      out.write(buffers[t].data(), buffers[t].size());
   }
 }
 
-void AnnoyIndex::save_node(std::ofstream &out, AnnoyNode *node) const {
+void AnnoyIndex::save_node(std::vector<char> &out, AnnoyNode *node) const {
   if (!node)
     return;
 
   bool leaf = node->is_leaf();
-  out.write(reinterpret_cast<const char *>(&leaf), sizeof(bool));
+  append_bytes(out, &leaf, sizeof(bool));
 
   if (leaf) {
     int bucket_size = node->bucket.size();
-    out.write(reinterpret_cast<const char *>(&bucket_size), sizeof(int));
-    out.write(reinterpret_cast<const char *>(node->bucket.data()),
-              bucket_size * sizeof(int));
+    append_bytes(out, &bucket_size, sizeof(int));
+    append_bytes(out, node->bucket.data(), bucket_size * sizeof(int));
   } else {
     // Write hyperplane
-    out.write(reinterpret_cast<const char *>(node->hyperplane->w.data()),
-              dimension * sizeof(float));
-    out.write(reinterpret_cast<const char *>(&node->hyperplane->bias),
-              sizeof(float));
+    append_bytes(out, node->hyperplane->w.data(), dimension * sizeof(float));
+    append_bytes(out, &node->hyperplane->bias, sizeof(float));
     // Recurse — pre-order guarantees left is written before right
     save_node(out, node->left);
     save_node(out, node->right);
   }
 }
 
-void AnnoyIndex::load(std::ifstream &in) {
+void AnnoyIndex::load(std::istream &in) {
   in.read(reinterpret_cast<char *>(&use_priority_queue), sizeof(bool));
   in.read(reinterpret_cast<char *>(&num_trees), sizeof(int));
   in.read(reinterpret_cast<char *>(&dimension), sizeof(int));
   in.read(reinterpret_cast<char *>(&k_leaf), sizeof(int));
   in.read(reinterpret_cast<char *>(&search_k), sizeof(int));
 
+  resolve_distance(dimension);
   roots.resize(num_trees);
   for (int i = 0; i < num_trees; i++) {
     roots[i] = load_node(in);
   }
 }
 
-AnnoyNode *AnnoyIndex::load_node(std::ifstream &in) {
+void AnnoyIndex::after_load(const MatrixView &data) {
+  if (data.empty() || data.dim != static_cast<size_t>(dimension))
+    return;
+  block_order_ = block_order_by_variance(data.data, data.size(), dimension,
+                                         kBlockOrderSamples);
+}
+
+AnnoyNode *AnnoyIndex::load_node(std::istream &in) {
   AnnoyNode *node = new AnnoyNode(dimension);
 
   bool leaf;
@@ -0,0 +1,705 @@
+// src/indexes/DiskANNIndex.cpp
+
+#include "indexes/DiskANNIndex.hpp"
+#include "indexes/IndexBase.hpp"
+#include "utils/Allocator.hpp"
+#include "utils/BlockReader.hpp"
+#include "utils/Distance.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/Math.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Timer.hpp"
+#include "utils/TopK.hpp"
+#include "utils/VisitMarks.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// =========================================================
+// SECTION: Graph file layout
+// Sector 0 holds a GraphFileHeader. Node blocks follow from sector 1:
+//   [float32 vector x dim][uint32 degree][uint32 neighbors x max_degree]
+// Small blocks are packed several per sector (never straddling one), and
+// large ones start on their own sector, so reading a node is always one
+// sector-aligned request.
+// =========================================================
+
+namespace {
+
+constexpr char kGraphMagic[8] = {'V', 'E', 'G', 'A', 'M', 'D', 'A', 'N'};
+constexpr uint32_t kGraphVersion = 1;
+
+struct GraphFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dimension;
+  uint64_t n_nodes;
+  uint32_t max_degree;
+  uint32_t entry_point;
+};
+
+// PQ codebooks are trained on a sample; 40 points per centroid is plenty
+constexpr size_t kPQTrainSamples = 40 * ProductQuantizer::kMaxCentroids;
+constexpr int kPQTrainIters = 15;
+
+// Sectors buffered per write while laying out the graph file
+constexpr size_t kWriteSectors = 256;
+
+// Mutexes guarding adjacency lists during the parallel build; node i
+// uses stripe i % kLockStripes
+constexpr size_t kLockStripes = 4096;
+
+struct Candidate {
+  float distance;
+  uint32_t id;
+  bool expanded;
+};
+
+/**
+ * @brief Bounded list of the closest candidates seen, sorted by distance.
+ */
+class CandidateList {
+private:
+  std::vector<Candidate> items_;
+  size_t capacity_;
+
+public:
+  explicit CandidateList(size_t capacity) : capacity_(capacity) {
+    items_.reserve(capacity + 1);
+  }
+
+  void insert(uint32_t id, float distance) {
+    if (items_.size() == capacity_ && distance >= items_.back().distance)
+      return;
+    auto pos = std::upper_bound(
+        items_.begin(), items_.end(), distance,
+        [](float d, const Candidate &c) { return d < c.distance; });
+    items_.insert(pos, Candidate{distance, id, false});
+    if (items_.size() > capacity_)
+      items_.pop_back();
+  }
+
+  // Marks and returns the closest unexpanded candidate; false when every
+  // candidate has been expanded
+  bool pop_unexpanded(Candidate &out) {
+    for (Candidate &c : items_) {
+      if (!c.expanded) {
+        c.expanded = true;
+        out = c;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/**
+ * @brief In-memory Vamana graph under construction.
+ */
+class VamanaBuilder {
+private:
+  const MatrixView &data_;
+  DistanceFunction distance_;
+  size_t max_degree_;
+  size_t build_list_;
+  std::vector<std::vector<uint32_t>> graph_;
+  std::vector<std::mutex> locks_;
+
+public:
+  VamanaBuilder(const MatrixView &data, DistanceFunction distance,
+                size_t max_degree, size_t build_list)
+      : data_(data), distance_(distance), max_degree_(max_degree),
+        build_list_(build_list), graph_(data.size()), locks_(kLockStripes) {}
+
+  float distance(uint32_t a, uint32_t b) const {
+    return distance_(data_.row(a), data_.row(b), data_.dim);
+  }
+
+  std::vector<uint32_t> neighbors(uint32_t id) {
+    std::lock_guard<std::mutex> lock(locks_[id % kLockStripes]);
+    return graph_[id];
+  }
+
+  // Point closest to the dataset mean; every search starts here
+  uint32_t medoid() const {
+    std::vector<double> sum(data_.dim, 0.0);
+    for (size_t i = 0; i < data_.size(); i++) {
+      const float *row = data_.row(i);
+      for (size_t d = 0; d < data_.dim; d++) {
+        sum[d] += row[d];
+      }
+    }
+    std::vector<float> mean(data_.dim);
+    for (size_t d = 0; d < data_.dim; d++) {
+      mean[d] = static_cast<float>(sum[d] / data_.size());
+    }
+
+    uint32_t best = 0;
+    float best_distance = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < data_.size(); i++) {
+      float d = l2_distance_sqr(mean.data(), data_.row(i), data_.dim);
+      if (d < best_distance) {
+        best_distance = d;
+        best = static_cast<uint32_t>(i);
+      }
+    }
+    return best;
+  }
+
+  // Greedy search for `id`'s vector from `entry`; every expanded node is
+  // appended to `expanded` as a pruning candidate
+  void search(uint32_t id, uint32_t entry, VisitMarks &marks,
+              std::vector<Candidate> &expanded) {
+    CandidateList list(build_list_);
+    marks.reset();
+    marks.visit(entry);
+    list.insert(entry, distance(id, entry));
+
+    Candidate current;
+    while (list.pop_unexpanded(current)) {
+      expanded.push_back(current);
+      for (uint32_t neighbor : neighbors(current.id)) {
+        if (marks.visit(neighbor))
+          list.insert(neighbor, distance(id, neighbor));
+      }
+    }
+  }
+
+  /**
+   * @brief Alpha-robust prune: scans candidates by distance to `id` and
+   * keeps one unless an already kept neighbor is closer to it by a factor
+   * of alpha, so edges spread across directions.
+   */
+  std::vector<uint32_t> prune(uint32_t id, std::vector<Candidate> &candidates,
+                              float alpha) const {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) {
+                return a.distance < b.distance;
+              });
+
+    std::vector<uint32_t> kept;
+    kept.reserve(max_degree_);
+    for (const Candidate &c : candidates) {
+      if (kept.size() == max_degree_)
+        break;
+      if (c.id == id)
+        continue;
+
+      bool dominated = false;
+      for (uint32_t k : kept) {
+        if (k == c.id || alpha * distance(k, c.id) <= c.distance) {
+          dominated = true;
+          break;
+        }
+      }
+      if (!dominated)
+        kept.push_back(c.id);
+    }
+    return kept;
+  }
+
+  void insert(uint32_t id, uint32_t entry, float alpha, VisitMarks &marks,
+              std::vector<Candidate> &candidates) {
+    candidates.clear();
+    search(id, entry, marks, candidates);
+    for (uint32_t neighbor : neighbors(id)) {
+      candidates.push_back(Candidate{distance(id, neighbor), neighbor, true});
+    }
+    std::vector<uint32_t> kept = prune(id, candidates, alpha);
+    {
+      std::lock_guard<std::mutex> lock(locks_[id % kLockStripes]);
+      graph_[id] = kept;
+    }
+
+    // Back edges; a full list is re-pruned outside its lock
+    for (uint32_t neighbor : kept) {
+      std::vector<uint32_t> list;
+      {
+        std::lock_guard<std::mutex> lock(locks_[neighbor % kLockStripes]);
+        std::vector<uint32_t> &edges = graph_[neighbor];
+        if (std::find(edges.begin(), edges.end(), id) != edges.end())
+          continue;
+        if (edges.size() < max_degree_) {
+          edges.push_back(id);
+          continue;
+        }
+        list = edges;
+      }
+
+      std::vector<Candidate> back;
+      back.reserve(list.size() + 1);
+      for (uint32_t other : list) {
+        back.push_back(Candidate{distance(neighbor, other), other, true});
+      }
+      back.push_back(Candidate{distance(neighbor, id), id, true});
+      std::vector<uint32_t> pruned = prune(neighbor, back, alpha);
+
+      std::lock_guard<std::mutex> lock(locks_[neighbor % kLockStripes]);
+      graph_[neighbor] = std::move(pruned);
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> &graph() { return graph_; }
+};
+
+} // namespace
+
+// =========================================================
+// SECTION: DiskANNIndex
+// =========================================================
+
+DiskANNIndex::DiskANNIndex(int dimension, const std::string &graph_path,
+                           int max_degree, int build_list, float alpha,
+                           int search_list, int beam_width, int pq_subspaces,
+                           Metric metric)
+    : dimension(dimension), graph_path(graph_path), max_degree(max_degree),
+      build_list(build_list), alpha(alpha), pq_subspaces(pq_subspaces),
+      search_list(search_list), beam_width(beam_width) {
+  this->metric_ = metric;
+}
+
+void DiskANNIndex::build(const MatrixView &data, BuildProgress *progress) {
+  if (this->graph_path.empty())
+    throw std::invalid_argument("DiskANNIndex: graph_path is empty");
+  if (this->max_degree < 1 || this->build_list < 1 || this->alpha < 1.0f)
+    throw std::invalid_argument(
+        "DiskANNIndex: need max_degree >= 1, build_list >= 1, alpha >= 1");
+
+  this->reader.reset();
+  this->codes.clear();
+  this->n_nodes = 0;
+  if (data.empty())
+    return;
+
+  this->dimension = data.dim;
+  resolve_distance(data.dim);
+
+  // Compressed copies for navigation
+  size_t subspaces = this->pq_subspaces > 0
+                         ? static_cast<size_t>(this->pq_subspaces)
+                         : std::max<size_t>(1, data.dim / 4);
+  this->pq = ProductQuantizer(data.dim, std::min(subspaces, data.dim));
+  this->pq.train(data, kPQTrainSamples, kPQTrainIters, progress);
+  this->codes.resize(data.size() * this->pq.code_size());
+  this->pq.encode(data, this->codes.data());
+
+  // Vamana: a pass with alpha = 1 builds a tight graph, a second pass
+  // with the configured alpha adds the long-range edges
+  VamanaBuilder builder(data, this->distance_, this->max_degree,
+                        std::max(this->build_list, this->max_degree));
+  uint32_t entry = builder.medoid();
+
+  std::vector<uint32_t> order(data.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937 rng = get_random_engine();
+  std::shuffle(order.begin(), order.end(), rng);
+
+  // Pruning by alpha * distance only makes sense for non-negative
+  // distances; inner product uses plain (alpha = 1) pruning
+  float final_alpha = this->metric_ == Metric::InnerProduct ? 1.0f : alpha;
+  if (progress)
+    progress->begin_phase("graph", 2 * data.size());
+
+  for (float pass_alpha : {1.0f, final_alpha}) {
+    parallel_for(order.size(), default_num_threads(),
+                 [&](size_t begin, size_t end) {
+                   VisitMarks marks(data.size());
+                   std::vector<Candidate> candidates;
+                   for (size_t i = begin; i < end; i++) {
+                     builder.insert(order[i], entry, pass_alpha, marks,
+                                    candidates);
+                     if (progress)
+                       progress->advance();
+                   }
+                 });
+  }
+
+  this->entry_point = entry;
+  this->n_nodes = data.size();
+  write_graph(data, builder.graph(), progress);
+  open_graph();
+}
+
+void DiskANNIndex::write_graph(const MatrixView &data,
+                               const std::vector<std::vector<uint32_t>> &graph,
+                               BuildProgress *progress) const {
+  size_t bytes = data.dim * sizeof(float) +
+                 (1 + static_cast<size_t>(this->max_degree)) * sizeof(uint32_t);
+  size_t per_sector = bytes <= kSectorSize ? kSectorSize / bytes : 0;
+  size_t per_node = per_sector ? 0 : (bytes + kSectorSize - 1) / kSectorSize;
+
+  // Written beside the target and renamed, like snapshots
+  std::string temp = this->graph_path + ".tmp";
+  std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("DiskANNIndex: cannot create " + temp);
+
+  std::vector<char> buffer(kWriteSectors * kSectorSize, 0);
+  GraphFileHeader header;
+  std::memcpy(header.magic, kGraphMagic, sizeof(kGraphMagic));
+  header.version = kGraphVersion;
+  header.dimension = static_cast<uint32_t>(data.dim);
+  header.n_nodes = data.size();
+  header.max_degree = static_cast<uint32_t>(this->max_degree);
+  header.entry_point = this->entry_point;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  out.write(buffer.data(), kSectorSize);
+
+  if (progress)
+    progress->begin_phase("write", data.size());
+
+  // Fill whole sectors in the buffer and flush it when full
+  size_t sector_nodes = per_sector ? per_sector : 1;
+  size_t sector_span = per_sector ? 1 : per_node;
+  size_t n_blocks = (data.size() + sector_nodes - 1) / sector_nodes;
+  size_t blocks_per_write = std::max<size_t>(1, kWriteSectors / sector_span);
+  for (size_t first = 0; first < n_blocks; first += blocks_per_write) {
+    size_t blocks = std::min(blocks_per_write, n_blocks - first);
+    std::fill(buffer.begin(), buffer.end(), 0);
+    for (size_t b = 0; b < blocks; b++) {
+      char *block = buffer.data() + b * sector_span * kSectorSize;
+      for (size_t s = 0; s < sector_nodes; s++) {
+        size_t id = (first + b) * sector_nodes + s;
+        if (id >= data.size())
+          break;
+        char *node = block + s * bytes;
+        std::memcpy(node, data.row(id), data.dim * sizeof(float));
+        uint32_t degree = graph[id].size();
+        std::memcpy(node + data.dim * sizeof(float), &degree,
+                    sizeof(uint32_t));
+        std::memcpy(node + data.dim * sizeof(float) + sizeof(uint32_t),
+                    graph[id].data(), degree * sizeof(uint32_t));
+      }
+    }
+    out.write(buffer.data(), blocks * sector_span * kSectorSize);
+    if (progress)
+      progress->advance(std::min(blocks * sector_nodes,
+                                 data.size() - first * sector_nodes));
+  }
+
+  out.close();
+  if (!out) {
+    std::remove(temp.c_str());
+    throw std::runtime_error("DiskANNIndex: cannot write " + temp);
+  }
+  sync_file(temp);
+  replace_file(temp, this->graph_path);
+  sync_parent_directory(this->graph_path);
+}
+
+void DiskANNIndex::open_graph() {
+  auto file = std::make_unique<BlockReader>(this->graph_path);
+
+  std::vector<char, AlignedAllocator<char, kSectorSize>> sector(kSectorSize);
+  BlockRequest request;
+  request.offset = 0;
+  request.length = kSectorSize;
+  request.buffer = sector.data();
+  file->read(&request, 1);
+
+  GraphFileHeader header;
+  std::memcpy(&header, sector.data(), sizeof(header));
+  if (std::memcmp(header.magic, kGraphMagic, sizeof(kGraphMagic)) != 0 ||
+      header.version != kGraphVersion)
+    throw std::runtime_error(this->graph_path + " is not a DiskANN graph");
+  if (header.n_nodes != this->n_nodes ||
+      header.dimension != static_cast<uint32_t>(this->dimension) ||
+      header.max_degree != static_cast<uint32_t>(this->max_degree))
+    throw std::runtime_error(this->graph_path +
+                             " does not match the index (rebuilt since?)");
+
+  this->node_bytes = this->dimension * sizeof(float) +
+                     (1 + static_cast<size_t>(this->max_degree)) *
+                         sizeof(uint32_t);
+  this->nodes_per_sector =
+      this->node_bytes <= kSectorSize ? kSectorSize / this->node_bytes : 0;
+  this->sectors_per_node =
+      this->nodes_per_sector
+          ? 0
+          : (this->node_bytes + kSectorSize - 1) / kSectorSize;
+
+  uint64_t blocks =
+      this->nodes_per_sector
+          ? (this->n_nodes + this->nodes_per_sector - 1) /
+                this->nodes_per_sector
+          : this->n_nodes;
+  if (file->size() < (1 + blocks * (block_length() / kSectorSize)) *
+                         kSectorSize)
+    throw std::runtime_error(this->graph_path + " is truncated");
+
+  this->reader = std::move(file);
+}
+
+uint64_t DiskANNIndex::block_offset(uint64_t id) const {
+  uint64_t sector = this->nodes_per_sector
+                        ? 1 + id / this->nodes_per_sector
+                        : 1 + id * this->sectors_per_node;
+  return sector * kSectorSize;
+}
+
+size_t DiskANNIndex::block_length() const {
+  return this->nodes_per_sector ? kSectorSize
+                                : this->sectors_per_node * kSectorSize;
+}
+
+size_t DiskANNIndex::offset_in_block(uint64_t id) const {
+  return this->nodes_per_sector
+             ? (id % this->nodes_per_sector) * this->node_bytes
+             : 0;
+}
+
+SearchResults DiskANNIndex::search(const MatrixView &data,
+                                   const std::vector<float> &query, int k,
+                                   const SearchParams *params,
+                                   const Bitmap *filter, SearchStats *stats) {
+  SearchResults results;
+  PhaseTimer timer(stats != nullptr);
+  if (!is_trained() || k <= 0)
+    return results;
+
+  int list_size = this->search_list;
+  int width = this->beam_width;
+  if (auto disk_params = dynamic_cast<const DiskANNSearchParams *>(params)) {
+    list_size = disk_params->search_list;
+    width = disk_params->beam_width;
+  }
+  list_size = std::max(list_size, k);
+  width = std::max(width, 1);
+
+  if (filter) {
+    // The list ranks every node the walk passes, allowed or not, so a
+    // filter keeping a fraction f of the graph leaves it about
+    // f * list_size candidates. Widen it by 1/f to keep list_size.
+    size_t allowed = std::max<size_t>(filter->count(), 1);
+    uint64_t widened = std::min<uint64_t>(
+        static_cast<uint64_t>(list_size) * this->n_nodes /
+            std::min<uint64_t>(allowed, this->n_nodes),
+        this->n_nodes);
+    list_size = std::max(list_size, static_cast<int>(widened));
+
+    // Reading every allowed block is then no costlier than the walk
+    if (filter->count() <= static_cast<size_t>(list_size))
+      return search_allowed(query, k, *filter, stats);
+  }
+
+  std::vector<float> table(this->pq.table_size());
+  this->pq.compute_table(query.data(), this->metric_, table.data());
+  size_t code_size = this->pq.code_size();
+  auto pq_distance = [&](uint32_t id) {
+    return this->pq.table_distance(table.data(),
+                                   this->codes.data() + id * code_size);
+  };
+
+  size_t dim = query.size();
+  DistanceFunction distance_fn = distance_for(dim);
+  size_t block = block_length();
+  std::vector<char, AlignedAllocator<char, kSectorSize>> buffer(width *
+                                                                block);
+  std::vector<BlockRequest> requests(width);
+  std::vector<uint32_t> beam;
+  beam.reserve(width);
+
+  CandidateList list(list_size);
+  std::unordered_set<uint32_t> visited;
+  visited.insert(this->entry_point);
+  list.insert(this->entry_point, pq_distance(this->entry_point));
+
+  // Full-precision distances of every node read; reranked at the end
+  std::vector<std::pair<float, int>> scored;
+  size_t pq_computations = 1;
+
+  while (true) {
+    beam.clear();
+    Candidate next;
+    while (beam.size() < static_cast<size_t>(width) &&
+           list.pop_unexpanded(next)) {
+      beam.push_back(next.id);
+    }
+    if (beam.empty())
+      break;
+
+    // One batched read per round trip
+    for (size_t b = 0; b < beam.size(); b++) {
+      requests[b].offset = block_offset(beam[b]);
+      requests[b].length = block;
+      requests[b].buffer = buffer.data() + b * block;
+    }
+    this->reader->read(requests.data(), beam.size());
+
+    for (size_t b = 0; b < beam.size(); b++) {
+      const char *node = buffer.data() + b * block + offset_in_block(beam[b]);
+      const float *vector = reinterpret_cast<const float *>(node);
+      uint32_t degree;
+      std::memcpy(&degree, node + dim * sizeof(float), sizeof(uint32_t));
+      const uint32_t *neighbors = reinterpret_cast<const uint32_t *>(
+          node + dim * sizeof(float) + sizeof(uint32_t));
+      degree = std::min<uint32_t>(degree, this->max_degree);
+
+      if (!filter || filter->contains(beam[b]))
+        scored.push_back({distance_fn(query.data(), vector, dim),
+                          static_cast<int>(beam[b])});
+      for (uint32_t i = 0; i < degree; i++) {
+        uint32_t neighbor = neighbors[i];
+        if (neighbor < this->n_nodes && visited.insert(neighbor).second) {
+          list.insert(neighbor, pq_distance(neighbor));
+          pq_computations++;
+        }
+      }
+    }
+
+    if (stats)
+      stats->nodes_visited += beam.size();
+  }
+
+  if (stats) {
+    stats->ranking_us += timer.lap();
+    stats->distance_computations += pq_computations + scored.size();
+    stats->candidates += scored.size();
+  }
+
+  // Every allowed node on the path is a candidate; too few means the
+  // filter excluded most of the graph region, so answer exactly instead
+  if (filter && scored.size() < static_cast<size_t>(k)) {
+    return search_allowed(query, k, *filter, stats);
+  }
+
+  size_t n_results = std::min(scored.size(), static_cast<size_t>(k));
+  std::partial_sort(scored.begin(), scored.begin() + n_results, scored.end());
+  for (size_t i = 0; i < n_results; i++) {
+    results.ids.push_back(scored[i].second);
+    results.distances.push_back(scored[i].first);
+  }
+
+  if (stats)
+    stats->rerank_us += timer.lap();
+  return results;
+}
+
+SearchResults DiskANNIndex::search_allowed(const std::vector<float> &query,
+                                           int k, const Bitmap &filter,
+                                           SearchStats *stats) const {
+  // Blocks per batched read; nodes sharing a block are read once
+  constexpr size_t kBatchBlocks = 64;
+
+  PhaseTimer timer(stats != nullptr);
+  size_t dim = query.size();
+  DistanceFunction distance_fn = distance_for(dim);
+  size_t block = block_length();
+  std::vector<char, AlignedAllocator<char, kSectorSize>> buffer(kBatchBlocks *
+                                                                block);
+  std::vector<BlockRequest> requests;
+  requests.reserve(kBatchBlocks);
+  std::vector<std::pair<uint32_t, size_t>> pending; // (id, request)
+
+  TopK top(k);
+  size_t computations = 0;
+  auto flush = [&] {
+    if (requests.empty())
+      return;
+    this->reader->read(requests.data(), requests.size());
+    for (const auto &item : pending) {
+      const char *node =
+          buffer.data() + item.second * block + offset_in_block(item.first);
+      top.push(static_cast<int>(item.first),
+               distance_fn(query.data(), reinterpret_cast<const float *>(node),
+                           dim));
+    }
+    computations += pending.size();
+    requests.clear();
+    pending.clear();
+  };
+
+  // Ids past the graph were added after the build and are not searchable
+  filter.for_each_in(0, this->n_nodes, [&](int id) {
+    uint64_t offset = block_offset(id);
+    if (requests.empty() || requests.back().offset != offset) {
+      if (requests.size() == kBatchBlocks)
+        flush();
+      BlockRequest request;
+      request.offset = offset;
+      request.length = block;
+      request.buffer = buffer.data() + requests.size() * block;
+      requests.push_back(request);
+    }
+    pending.push_back({static_cast<uint32_t>(id), requests.size() - 1});
+  });
+  flush();
+
+  SearchResults results;
+  for (const auto &item : top.take_sorted()) {
+    results.ids.push_back(item.second);
+    results.distances.push_back(item.first);
+  }
+  if (stats) {
+    stats->filter_fallback = true;
+    stats->distance_computations += computations;
+    stats->candidates += computations;
+    stats->ranking_us += timer.lap();
+  }
+  return results;
+}
+
+bool DiskANNIndex::is_trained() const { return this->reader != nullptr; }
+
+void DiskANNIndex::save(std::ostream &out) const {
+  int path_len = this->graph_path.size();
+  out.write(reinterpret_cast<const char *>(&path_len), sizeof(int));
+  out.write(this->graph_path.data(), path_len);
+
+  out.write(reinterpret_cast<const char *>(&dimension), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&max_degree), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&build_list), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&alpha), sizeof(float));
+  out.write(reinterpret_cast<const char *>(&pq_subspaces), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&search_list), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&beam_width), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&n_nodes), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char *>(&entry_point), sizeof(uint32_t));
+
+  this->pq.save(out);
+  out.write(reinterpret_cast<const char *>(this->codes.data()),
+            this->codes.size());
+}
+
+void DiskANNIndex::load(std::istream &in) {
+  int path_len = 0;
+  in.read(reinterpret_cast<char *>(&path_len), sizeof(int));
+  if (!in || path_len < 0)
+    throw std::runtime_error("DiskANNIndex::load: corrupt header");
+  this->graph_path.assign(path_len, '\0');
+  in.read(&this->graph_path[0], path_len);
+
+  in.read(reinterpret_cast<char *>(&dimension), sizeof(int));
+  in.read(reinterpret_cast<char *>(&max_degree), sizeof(int));
+  in.read(reinterpret_cast<char *>(&build_list), sizeof(int));
+  in.read(reinterpret_cast<char *>(&alpha), sizeof(float));
+  in.read(reinterpret_cast<char *>(&pq_subspaces), sizeof(int));
+  in.read(reinterpret_cast<char *>(&search_list), sizeof(int));
+  in.read(reinterpret_cast<char *>(&beam_width), sizeof(int));
+  in.read(reinterpret_cast<char *>(&n_nodes), sizeof(uint64_t));
+  in.read(reinterpret_cast<char *>(&entry_point), sizeof(uint32_t));
+  if (!in || dimension <= 0 || max_degree <= 0)
+    throw std::runtime_error("DiskANNIndex::load: corrupt header");
+
+  this->pq.load(in);
+  this->codes.resize(this->n_nodes * this->pq.code_size());
+  in.read(reinterpret_cast<char *>(this->codes.data()), this->codes.size());
+
+  resolve_distance(dimension);
+  this->reader.reset();
+  if (this->n_nodes > 0)
+    open_graph();
+}
@@ -2,52 +2,163 @@
 
 #include "indexes/FlatIndex.hpp"
 #include "indexes/IndexBase.hpp"
-#include "utils/Math.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Numa.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Timer.hpp"
+#include "utils/TopK.hpp"
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
-SearchResults FlatIndex::search(const std::vector<std::vector<float>> &data,
-                                const std::vector<float> &query, int k,
-                                const SearchParams *params) {
+namespace {
+
+// Rows sampled to rank dimension blocks for early abandoning
+constexpr size_t kBlockOrderSamples = 4096;
+
+/**
+ * @brief Exact top-k over every row, or only the rows set in `allowed`.
+ * Large scans are split into blocks of rows shared out to several threads
+ * (each NUMA node's threads take its own rows); each keeps its own top-k
+ * and they are merged at the end, so ties resolve by id either way.
+ */
+SearchResults scan_exact(const MatrixView &data,
+                         const std::vector<float> &query, int k,
+                         const Bitmap *allowed,
+                         BoundedDistanceFunction distance_fn,
+                         const uint32_t *order, SearchStats *stats) {
   SearchResults results;
-  results.ids.reserve(k);
-  results.distances.reserve(k);
+  if (k <= 0)
+    return results;
 
+  PhaseTimer timer(stats != nullptr);
   size_t size = data.size();
+  size_t dim = query.size();
+  size_t scanned_rows = allowed ? std::min(allowed->count(), size) : size;
 
-  std::vector<std::pair<int, float>> scores;
-  scores.reserve(size);
+  size_t n_threads = scan_threads(scanned_rows * dim);
+  size_t block_rows = std::max<size_t>(1, kFloatsPerScanThread / 4 / dim);
+  auto push_row = [&](TopK &top, size_t i) {
+    // Rows that cannot enter the top-k stop after a few blocks
+    float distance =
+        distance_fn(data.row(i), query.data(), dim, top.threshold(), order);
+    top.push(static_cast<int>(i), distance);
+  };
+  // Allowed rows each worker scored, for the stats
+  std::vector<size_t> computed;
+  auto scan_rows = [&](size_t worker, TopK &top, size_t begin, size_t end) {
+    if (!allowed) {
+      for (size_t i = begin; i < end; i++)
+        push_row(top, i);
+      return;
+    }
+    // Only the bitmap words covering the block are read
+    size_t count = 0;
+    allowed->for_each_in(begin, end, [&](int i) {
+      push_row(top, static_cast<size_t>(i));
+      count++;
+    });
+    computed[worker] += count;
+  };
 
-  for (int i = 0; i < size; i++) {
-    float distance = euclidean_distance_squared(data[i], query);
-    scores.push_back({i, distance});
+  std::vector<TopK> partial;
+  if (n_threads > 1 && numa_active()) {
+    size_t nodes = numa_node_count();
+    std::vector<size_t> node_blocks(nodes);
+    for (size_t node = 0; node < nodes; node++) {
+      auto rows = numa_partition(size, node);
+      node_blocks[node] = (rows.second - rows.first + block_rows - 1) /
+                          block_rows;
+    }
+    size_t per_node = std::max<size_t>(1, n_threads / nodes);
+    partial.assign(nodes * per_node, TopK(k));
+    computed.assign(partial.size(), 0);
+    numa_for_dynamic(node_blocks, per_node,
+                     [&](size_t worker, size_t node, size_t block) {
+                       auto rows = numa_partition(size, node);
+                       size_t begin = rows.first + block * block_rows;
+                       size_t end = std::min(rows.second, begin + block_rows);
+                       scan_rows(worker, partial[worker], begin, end);
+                     });
+  } else {
+    size_t n_blocks = (size + block_rows - 1) / block_rows;
+    partial.assign(std::max<size_t>(1, std::min(n_threads, n_blocks)),
+                   TopK(k));
+    computed.assign(partial.size(), 0);
+    parallel_for_dynamic(n_blocks, n_threads,
+                         [&](size_t worker, size_t block) {
+                           size_t begin = block * block_rows;
+                           size_t end = std::min(size, begin + block_rows);
+                           scan_rows(worker, partial[worker], begin, end);
+                         });
   }
 
-  std::sort(scores.begin(), scores.end(),
-            [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
-              return a.second < b.second;
-            });
+  if (stats) {
+    size_t scanned = size;
+    if (allowed) {
+      scanned = 0;
+      for (size_t count : computed)
+        scanned += count;
+    }
+    stats->scan_us += timer.lap();
+    stats->distance_computations += scanned;
+    stats->candidates += scanned;
+  }
 
-  int min_k = std::min(k, (int)scores.size());
-  for (int i = 0; i < min_k; i++) {
-    results.ids.push_back(scores[i].first);
-    results.distances.push_back(scores[i].second);
+  for (size_t t = 1; t < partial.size(); t++) {
+    partial[0].merge(partial[t]);
+  }
+  for (const auto &scored : partial[0].take_sorted()) {
+    results.ids.push_back(scored.second);
+    results.distances.push_back(scored.first);
   }
 
+  if (stats)
+    stats->rerank_us += timer.lap();
   return results;
 }
 
-void FlatIndex::build(const std::vector<std::vector<float>> &data) {
-  // No-op: Flat search has no index to build
+} // namespace
+
+FlatIndex::FlatIndex(Metric metric) { this->metric_ = metric; }
+
+SearchResults FlatIndex::search(const MatrixView &data,
+                                const std::vector<float> &query, int k,
+                                const SearchParams *params,
+                                const Bitmap *filter, SearchStats *stats) {
+  size_t dim = query.size();
+  return scan_exact(data, query, k, filter, bounded_distance_for(dim),
+                    block_order(dim), stats);
+}
+
+SearchResults FlatIndex::search_allowed(const MatrixView &data,
+                                        const std::vector<float> &query, int k,
+                                        const Bitmap &allowed, Metric metric,
+                                        SearchStats *stats,
+                                        const uint32_t *order) {
+  return scan_exact(data, query, k, &allowed,
+                    get_bounded_distance_function(metric, query.size()),
+                    order, stats);
+}
+
+void FlatIndex::build(const MatrixView &data, BuildProgress *progress) {
+  // Nothing to train; pick the distance kernel for this dimension and
+  // rank its blocks so the scan's early abandoning trips sooner
+  if (data.empty())
+    return;
+  resolve_distance(data.dim);
+  block_order_ = block_order_by_variance(data.data, data.size(), data.dim,
+                                         kBlockOrderSamples);
 }
 bool FlatIndex::is_trained() const {
   return true; // Always "ready" — no training needed
 }
-void FlatIndex::save(std::ofstream &out) const {
+void FlatIndex::save(std::ostream &out) const {
   // No-op: No index state to persist
 }
-void FlatIndex::load(std::ifstream &in) {
+void FlatIndex::load(std::istream &in) {
   // No-op: No index state to restore
-}
\ No newline at end of file
+}
+void FlatIndex::after_load(const MatrixView &data) { build(data); }
\ No newline at end of file
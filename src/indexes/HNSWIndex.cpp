@@ -0,0 +1,592 @@
+// src/indexes/HNSWIndex.cpp
+
+#include "indexes/HNSWIndex.hpp"
+#include "indexes/FlatIndex.hpp"
+#include "indexes/IndexBase.hpp"
+#include "utils/Math.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/SpinLock.hpp"
+#include "utils/Timer.hpp"
+#include "utils/VisitMarks.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kNoEntry = std::numeric_limits<uint64_t>::max();
+
+// Layers above this are never assigned (a 1-in-M^16 event anyway)
+constexpr int kMaxLevel = 16;
+
+// add() batches smaller than this are linked on the calling thread
+constexpr size_t kParallelAddRows = 64;
+
+uint64_t pack_entry(int level, uint32_t id) {
+  return (static_cast<uint64_t>(level) << 32) | id;
+}
+
+int entry_level(uint64_t entry) { return static_cast<int>(entry >> 32); }
+
+uint32_t entry_id(uint64_t entry) { return static_cast<uint32_t>(entry); }
+
+uint64_t splitmix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+} // namespace
+
+HNSWIndex::HNSWIndex(int M, int ef_construction, int ef_search, Metric metric)
+    : M(M), ef_construction(ef_construction), ef_search(ef_search) {
+  this->metric_ = metric;
+  this->entry.store(kNoEntry);
+}
+
+// =========================================================
+// SECTION: Storage
+// =========================================================
+
+size_t HNSWIndex::max_links(int layer) const {
+  return layer == 0 ? 2 * static_cast<size_t>(M) : static_cast<size_t>(M);
+}
+
+uint32_t *HNSWIndex::links(uint32_t id, int layer) {
+  if (layer == 0)
+    return this->level0.data() + id * (1 + max_links(0));
+  return this->upper[id].data() + (layer - 1) * (1 + max_links(layer));
+}
+
+const uint32_t *HNSWIndex::links(uint32_t id, int layer) const {
+  return const_cast<HNSWIndex *>(this)->links(id, layer);
+}
+
+void HNSWIndex::copy_links(uint32_t id, int layer,
+                           std::vector<uint32_t> &out) {
+  std::lock_guard<SpinLock> lock(this->locks[id]);
+  const uint32_t *list = links(id, layer);
+  out.assign(list + 1, list + 1 + list[0]);
+}
+
+void HNSWIndex::clear_graph() {
+  this->capacity = 0;
+  this->level0.clear();
+  this->levels.clear();
+  this->upper.clear();
+  this->locks.reset();
+  this->n_inserted.store(0);
+  this->entry.store(kNoEntry);
+  std::lock_guard<std::mutex> lock(this->marks_mutex);
+  this->marks_pool.clear();
+}
+
+void HNSWIndex::reserve(size_t n_rows) {
+  std::unique_lock<std::shared_mutex> lock(this->graph_mutex);
+  if (n_rows <= this->capacity)
+    return;
+
+  // Grow geometrically so a stream of small adds reallocates rarely
+  size_t new_capacity = std::max(n_rows, this->capacity + this->capacity / 2);
+  this->level0.resize(new_capacity * (1 + max_links(0)), 0);
+  this->levels.resize(new_capacity, -1);
+  this->upper.resize(new_capacity);
+  // Nobody holds a lock here (see IndexBase::reserve), so fresh ones do
+  this->locks.reset(new SpinLock[new_capacity]);
+  this->capacity = new_capacity;
+}
+
+std::unique_ptr<VisitMarks> HNSWIndex::acquire_marks() {
+  std::unique_ptr<VisitMarks> marks;
+  {
+    std::lock_guard<std::mutex> lock(this->marks_mutex);
+    if (!this->marks_pool.empty()) {
+      marks = std::move(this->marks_pool.back());
+      this->marks_pool.pop_back();
+    }
+  }
+  if (!marks)
+    marks = std::make_unique<VisitMarks>(this->capacity);
+  marks->resize(this->capacity);
+  return marks;
+}
+
+void HNSWIndex::release_marks(std::unique_ptr<VisitMarks> marks) {
+  std::lock_guard<std::mutex> lock(this->marks_mutex);
+  this->marks_pool.push_back(std::move(marks));
+}
+
+// =========================================================
+// SECTION: Graph search
+// =========================================================
+
+int HNSWIndex::random_level(uint32_t id) const {
+  // Hashing the id instead of sharing an engine keeps concurrent inserts
+  // lock-free and makes a row's layer independent of insertion order
+  uint64_t bits = splitmix64(this->level_seed ^ id);
+  double u = static_cast<double>((bits >> 11) + 1) * 0x1.0p-53; // (0, 1]
+  double level = -std::log(u) / std::log(static_cast<double>(this->M));
+  return std::min(static_cast<int>(level), kMaxLevel);
+}
+
+uint32_t HNSWIndex::greedy_step(const MatrixView &data, const float *query,
+                                uint32_t current, float &current_distance,
+                                int layer, SearchStats *stats) {
+  std::vector<uint32_t> neighbors;
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    copy_links(current, layer, neighbors);
+    for (uint32_t neighbor : neighbors) {
+      float d = this->distance_(query, data.row(neighbor), data.dim);
+      if (d < current_distance) {
+        current_distance = d;
+        current = neighbor;
+        moved = true;
+      }
+    }
+    if (stats) {
+      stats->nodes_visited++;
+      stats->distance_computations += neighbors.size();
+    }
+  }
+  return current;
+}
+
+std::vector<HNSWIndex::Scored>
+HNSWIndex::search_layer(const MatrixView &data, const float *query,
+                        uint32_t start, float start_distance, int layer,
+                        size_t ef, VisitMarks &marks, const Bitmap *filter,
+                        SearchStats *stats) {
+  // Closest unexpanded node on top; farthest kept result on top
+  std::priority_queue<Scored, std::vector<Scored>, std::greater<Scored>>
+      frontier;
+  std::priority_queue<Scored> best;
+
+  marks.reset();
+  marks.visit(start);
+  frontier.push({start_distance, start});
+  if (!filter || filter->contains(start))
+    best.push({start_distance, start});
+
+  std::vector<uint32_t> neighbors;
+  uint64_t expanded = 0;
+  uint64_t computed = 0;
+  while (!frontier.empty()) {
+    Scored current = frontier.top();
+    if (best.size() >= ef && current.first > best.top().first)
+      break;
+    frontier.pop();
+    expanded++;
+
+    copy_links(current.second, layer, neighbors);
+    for (uint32_t neighbor : neighbors) {
+      if (!marks.visit(neighbor))
+        continue;
+      float d = this->distance_(query, data.row(neighbor), data.dim);
+      computed++;
+      if (best.size() < ef || d < best.top().first) {
+        frontier.push({d, neighbor});
+        if (!filter || filter->contains(neighbor)) {
+          best.push({d, neighbor});
+          if (best.size() > ef)
+            best.pop();
+        }
+      }
+    }
+  }
+
+  if (stats) {
+    stats->nodes_visited += expanded;
+    stats->distance_computations += computed;
+  }
+
+  std::vector<Scored> results(best.size());
+  for (size_t i = results.size(); i-- > 0;) {
+    results[i] = best.top();
+    best.pop();
+  }
+  return results;
+}
+
+// =========================================================
+// SECTION: Insertion
+// =========================================================
+
+void HNSWIndex::select_neighbors(const MatrixView &data,
+                                 std::vector<Scored> &candidates,
+                                 size_t max_count) const {
+  if (candidates.size() <= max_count)
+    return;
+
+  // `candidates` is sorted closest first
+  std::vector<Scored> kept;
+  kept.reserve(max_count);
+  for (const Scored &candidate : candidates) {
+    if (kept.size() == max_count)
+      break;
+    bool diverse = true;
+    for (const Scored &other : kept) {
+      float d = this->distance_(data.row(candidate.second),
+                                data.row(other.second), data.dim);
+      if (d < candidate.first) {
+        diverse = false;
+        break;
+      }
+    }
+    if (diverse)
+      kept.push_back(candidate);
+  }
+  candidates = std::move(kept);
+}
+
+void HNSWIndex::link_back(const MatrixView &data, uint32_t neighbor,
+                          uint32_t id, int layer) {
+  size_t limit = max_links(layer);
+  std::lock_guard<SpinLock> lock(this->locks[neighbor]);
+  uint32_t *list = links(neighbor, layer);
+  uint32_t count = list[0];
+  for (uint32_t i = 1; i <= count; i++) {
+    if (list[i] == id)
+      return;
+  }
+  if (count < limit) {
+    list[1 + count] = id;
+    list[0] = count + 1;
+    return;
+  }
+
+  // Full: keep the most diverse `limit` of the old links plus the new one
+  const float *base = data.row(neighbor);
+  std::vector<Scored> candidates;
+  candidates.reserve(count + 1);
+  for (uint32_t i = 1; i <= count; i++) {
+    candidates.push_back(
+        {this->distance_(base, data.row(list[i]), data.dim), list[i]});
+  }
+  candidates.push_back({this->distance_(base, data.row(id), data.dim), id});
+  std::sort(candidates.begin(), candidates.end());
+  select_neighbors(data, candidates, limit);
+
+  list[0] = candidates.size();
+  for (size_t i = 0; i < candidates.size(); i++) {
+    list[1 + i] = candidates[i].second;
+  }
+}
+
+void HNSWIndex::insert(const MatrixView &data, uint32_t id,
+                       VisitMarks &marks) {
+  int level;
+  {
+    std::lock_guard<SpinLock> lock(this->locks[id]);
+    if (this->levels[id] >= 0)
+      return; // Already linked (overlapping add() calls)
+    level = random_level(id);
+    this->upper[id].assign(level * (1 + max_links(1)), 0);
+    this->levels[id] = level;
+  }
+
+  // Inserts that raise the top layer hold the entry lock throughout, so
+  // the new entry node is fully linked before it is published
+  std::unique_lock<std::mutex> top(this->entry_mutex, std::defer_lock);
+  uint64_t current_entry = this->entry.load(std::memory_order_acquire);
+  if (current_entry == kNoEntry || level > entry_level(current_entry)) {
+    top.lock();
+    current_entry = this->entry.load(std::memory_order_acquire);
+    if (current_entry == kNoEntry) {
+      this->entry.store(pack_entry(level, id), std::memory_order_release);
+      this->n_inserted.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (level <= entry_level(current_entry))
+      top.unlock();
+  }
+
+  const float *vector = data.row(id);
+  uint32_t current = entry_id(current_entry);
+  int top_level = entry_level(current_entry);
+  float current_distance =
+      this->distance_(vector, data.row(current), data.dim);
+  for (int layer = top_level; layer > level; layer--) {
+    current = greedy_step(data, vector, current, current_distance, layer,
+                          nullptr);
+  }
+
+  for (int layer = std::min(level, top_level); layer >= 0; layer--) {
+    std::vector<Scored> candidates =
+        search_layer(data, vector, current, current_distance, layer,
+                     this->ef_construction, marks, nullptr, nullptr);
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [id](const Scored &c) {
+                                      return c.second == id;
+                                    }),
+                     candidates.end());
+    if (candidates.empty())
+      continue;
+    current = candidates[0].second;
+    current_distance = candidates[0].first;
+    select_neighbors(data, candidates, this->M);
+
+    {
+      // A concurrent insert may already have linked back to this node
+      // on this layer; keep those links while there is room
+      std::lock_guard<SpinLock> lock(this->locks[id]);
+      uint32_t *list = links(id, layer);
+      std::vector<uint32_t> existing(list + 1, list + 1 + list[0]);
+      size_t count = 0;
+      for (const Scored &c : candidates) {
+        list[1 + count++] = c.second;
+      }
+      for (uint32_t other : existing) {
+        if (count == max_links(layer))
+          break;
+        if (std::none_of(candidates.begin(), candidates.end(),
+                         [other](const Scored &c) {
+                           return c.second == other;
+                         }))
+          list[1 + count++] = other;
+      }
+      list[0] = count;
+    }
+
+    for (const Scored &c : candidates) {
+      link_back(data, c.second, id, layer);
+    }
+  }
+
+  if (top.owns_lock())
+    this->entry.store(pack_entry(level, id), std::memory_order_release);
+  this->n_inserted.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =========================================================
+// SECTION: IndexBase
+// =========================================================
+
+void HNSWIndex::build(const MatrixView &data, BuildProgress *progress) {
+  if (this->M < 2 || this->ef_construction < 1)
+    throw std::invalid_argument(
+        "HNSWIndex: need M >= 2 and ef_construction >= 1");
+
+  this->trained = false;
+  clear_graph();
+  this->dimension = data.dim;
+  resolve_distance(data.dim);
+  // Left untrained, so VegamDB builds again once there are rows
+  if (data.empty())
+    return;
+
+  std::mt19937 rng = get_random_engine();
+  this->level_seed = (static_cast<uint64_t>(rng()) << 32) | rng();
+  reserve(data.size());
+
+  if (progress)
+    progress->begin_phase("graph", data.size());
+
+  // Rows are linked concurrently, exactly as later add() calls are
+  parallel_for(data.size(), default_num_threads(),
+               [&](size_t begin, size_t end) {
+                 std::unique_ptr<VisitMarks> marks = acquire_marks();
+                 for (size_t i = begin; i < end; i++) {
+                   insert(data, static_cast<uint32_t>(i), *marks);
+                   if (progress)
+                     progress->advance();
+                 }
+                 release_marks(std::move(marks));
+               });
+
+  this->trained = true;
+}
+
+void HNSWIndex::add(const MatrixView &data, size_t begin, size_t end) {
+  if (!this->trained)
+    throw std::logic_error("HNSWIndex::add: build() the index first");
+  if (data.dim != static_cast<size_t>(this->dimension))
+    throw std::invalid_argument("HNSWIndex::add: dimension mismatch");
+  end = std::min(end, data.size());
+  if (begin >= end)
+    return;
+  // Growing swaps the node arrays under running searches, so it is the
+  // caller's job, done while searches are excluded
+  if (end > this->capacity)
+    throw std::logic_error("HNSWIndex::add: reserve() the rows first");
+
+  std::shared_lock<std::shared_mutex> lock(this->graph_mutex);
+  size_t n = end - begin;
+  size_t n_threads = n >= kParallelAddRows ? default_num_threads() : 1;
+  parallel_for(n, n_threads, [&](size_t first, size_t last) {
+    std::unique_ptr<VisitMarks> marks = acquire_marks();
+    for (size_t i = first; i < last; i++) {
+      insert(data, static_cast<uint32_t>(begin + i), *marks);
+    }
+    release_marks(std::move(marks));
+  });
+}
+
+SearchResults HNSWIndex::search(const MatrixView &data,
+                                const std::vector<float> &query, int k,
+                                const SearchParams *params,
+                                const Bitmap *filter, SearchStats *stats) {
+  SearchResults results;
+  PhaseTimer timer(stats != nullptr);
+  if (!is_trained() || k <= 0)
+    return results;
+
+  int ef = this->ef_search;
+  if (auto hnsw_params = dynamic_cast<const HNSWSearchParams *>(params))
+    ef = hnsw_params->ef_search;
+  ef = std::max(ef, k);
+
+  // A filter allowing no more ids than the list holds is answered exactly
+  if (filter && filter->count() <= static_cast<size_t>(ef)) {
+    if (stats)
+      stats->filter_fallback = true;
+    return FlatIndex::search_allowed(data, query, k, *filter, metric_, stats);
+  }
+
+  uint64_t current_entry = this->entry.load(std::memory_order_acquire);
+  if (current_entry == kNoEntry)
+    return results;
+
+  uint32_t current = entry_id(current_entry);
+  float current_distance =
+      this->distance_(query.data(), data.row(current), data.dim);
+  for (int layer = entry_level(current_entry); layer > 0; layer--) {
+    current = greedy_step(data, query.data(), current, current_distance,
+                          layer, stats);
+  }
+
+  std::unique_ptr<VisitMarks> marks = acquire_marks();
+  std::vector<Scored> found =
+      search_layer(data, query.data(), current, current_distance, 0, ef,
+                   *marks, filter, stats);
+  release_marks(std::move(marks));
+
+  if (stats) {
+    stats->ranking_us += timer.lap();
+    stats->candidates += found.size();
+  }
+
+  // The filter excluded most of the region searched; answer exactly
+  if (filter && found.size() < static_cast<size_t>(k)) {
+    if (stats)
+      stats->filter_fallback = true;
+    return FlatIndex::search_allowed(data, query, k, *filter, metric_, stats);
+  }
+
+  size_t n_results = std::min(found.size(), static_cast<size_t>(k));
+  for (size_t i = 0; i < n_results; i++) {
+    results.ids.push_back(static_cast<int>(found[i].second));
+    results.distances.push_back(found[i].first);
+  }
+  return results;
+}
+
+bool HNSWIndex::is_trained() const { return this->trained; }
+
+void HNSWIndex::save(std::ostream &out) const {
+  // Waits for running add() calls so every saved list is complete
+  std::unique_lock<std::shared_mutex> lock(this->graph_mutex);
+
+  uint64_t n_nodes = this->capacity;
+  while (n_nodes > 0 && this->levels[n_nodes - 1] < 0) {
+    n_nodes--;
+  }
+  uint64_t entry_point = this->entry.load();
+
+  out.write(reinterpret_cast<const char *>(&M), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&ef_construction), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&ef_search), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&dimension), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&level_seed), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char *>(&n_nodes), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char *>(&entry_point), sizeof(uint64_t));
+
+  out.write(reinterpret_cast<const char *>(this->levels.data()),
+            n_nodes * sizeof(int));
+  out.write(reinterpret_cast<const char *>(this->level0.data()),
+            n_nodes * (1 + max_links(0)) * sizeof(uint32_t));
+  for (uint64_t i = 0; i < n_nodes; i++) {
+    if (this->levels[i] > 0)
+      out.write(reinterpret_cast<const char *>(this->upper[i].data()),
+                this->upper[i].size() * sizeof(uint32_t));
+  }
+}
+
+void HNSWIndex::load(std::istream &in) {
+  uint64_t n_nodes = 0;
+  uint64_t entry_point = kNoEntry;
+  in.read(reinterpret_cast<char *>(&M), sizeof(int));
+  in.read(reinterpret_cast<char *>(&ef_construction), sizeof(int));
+  in.read(reinterpret_cast<char *>(&ef_search), sizeof(int));
+  in.read(reinterpret_cast<char *>(&dimension), sizeof(int));
+  in.read(reinterpret_cast<char *>(&level_seed), sizeof(uint64_t));
+  in.read(reinterpret_cast<char *>(&n_nodes), sizeof(uint64_t));
+  in.read(reinterpret_cast<char *>(&entry_point), sizeof(uint64_t));
+  if (!in || M < 2 || dimension < 0 ||
+      (entry_point != kNoEntry && entry_id(entry_point) >= n_nodes))
+    throw std::runtime_error("HNSWIndex::load: corrupt header");
+
+  clear_graph();
+  reserve(n_nodes);
+  in.read(reinterpret_cast<char *>(this->levels.data()),
+          n_nodes * sizeof(int));
+  in.read(reinterpret_cast<char *>(this->level0.data()),
+          n_nodes * (1 + max_links(0)) * sizeof(uint32_t));
+
+  size_t inserted = 0;
+  for (uint64_t i = 0; i < n_nodes && in; i++) {
+    int level = this->levels[i];
+    if (level > kMaxLevel || level < -1)
+      throw std::runtime_error("HNSWIndex::load: corrupt node level");
+    if (level < 0)
+      continue;
+    inserted++;
+    this->upper[i].resize(level * (1 + max_links(1)));
+    in.read(reinterpret_cast<char *>(this->upper[i].data()),
+            this->upper[i].size() * sizeof(uint32_t));
+  }
+  if (!in)
+    throw std::runtime_error("HNSWIndex::load: truncated graph");
+
+  this->n_inserted.store(inserted);
+  this->entry.store(entry_point);
+  resolve_distance(this->dimension);
+  this->trained = true;
+}
+
+void HNSWIndex::after_load(const MatrixView &data) {
+  if (!this->trained || data.empty() ||
+      data.dim != static_cast<size_t>(this->dimension))
+    return;
+  reserve(data.size());
+
+  std::vector<uint32_t> missing;
+  for (size_t i = 0; i < data.size(); i++) {
+    if (this->levels[i] < 0)
+      missing.push_back(static_cast<uint32_t>(i));
+  }
+  size_t n_threads =
+      missing.size() >= kParallelAddRows ? default_num_threads() : 1;
+  parallel_for(missing.size(), n_threads, [&](size_t first, size_t last) {
+    std::unique_ptr<VisitMarks> marks = acquire_marks();
+    for (size_t i = first; i < last; i++) {
+      insert(data, missing[i], *marks);
+    }
+    release_marks(std::move(marks));
+  });
+}
@@ -1,133 +1,659 @@
 // src/indexes//IVFIndex.cpp
 
 #include "indexes/IVFIndex.hpp"
+#include "indexes/FlatIndex.hpp"
 #include "indexes/IndexBase.hpp"
 #include "indexes/KMeans.hpp"
-#include "utils/Math.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Numa.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/Prefetch.hpp"
+#include "utils/Timer.hpp"
+#include "utils/TopK.hpp"
+#include "utils/Varint.hpp"
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
-#include <fstream>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
-IVFIndex::IVFIndex(int n_clusters, int dimension, int max_iters, int n_probe)
+namespace {
+// Shape of the coarse graph. There are few centroids, so wide lists are
+// cheap and keep the ranking close to exact: with ef = 8 * n_probe about
+// 93% of the true closest lists are found on 65536 random centroids.
+constexpr int kCoarseM = 32;
+constexpr int kCoarseEfConstruction = 200;
+constexpr int kCoarseEfSearch = 64;
+constexpr int kCoarseEfPerProbe = 8;
+} // namespace
+
+IVFIndex::IVFIndex(int n_clusters, int dimension, int max_iters, int n_probe,
+                   Metric metric, CoarseQuantizer quantizer,
+                   IVFStorage storage, float max_list_factor, int spill)
     : n_clusters(n_clusters), dimension(dimension), max_iters(max_iters),
-      n_probe(n_probe) {}
+      n_probe(n_probe), quantizer(quantizer), storage(storage),
+      max_list_factor(max_list_factor), spill(spill) {
+  if (max_list_factor < 0.0f)
+    throw std::invalid_argument("IVFIndex: max_list_factor must be >= 0");
+  if (spill < 1)
+    throw std::invalid_argument("IVFIndex: spill must be >= 1");
+  this->metric_ = metric;
+}
+
+std::vector<std::pair<float, int>>
+IVFIndex::rank_lists(const std::vector<float> &query, size_t n, int coarse_ef,
+                     SearchStats *stats) {
+  size_t n_lists = n_centroids();
+  size_t dim = dimension;
+  n = std::min(n, n_lists);
+  std::vector<std::pair<float, int>> ranked;
+  if (n == 0)
+    return ranked;
+
+  if (coarse_graph && n < n_lists) {
+    HNSWSearchParams params;
+    params.ef_search =
+        coarse_ef > 0 ? coarse_ef
+                      : std::max(kCoarseEfSearch,
+                                 kCoarseEfPerProbe * static_cast<int>(n));
+    // Counters only; the caller times the whole ranking phase
+    SearchStats graph_stats;
+    SearchResults found = coarse_graph->search(centroid_view(), query, n,
+                                               &params, nullptr, &graph_stats);
+    for (size_t i = 0; i < found.ids.size(); i++)
+      ranked.push_back({found.distances[i], found.ids[i]});
+    if (stats) {
+      stats->distance_computations += graph_stats.distance_computations;
+      stats->nodes_visited += graph_stats.nodes_visited;
+    }
+    return ranked;
+  }
 
-SearchResults IVFIndex::search(const std::vector<std::vector<float>> &data,
+  if (n == n_lists) {
+    DistanceFunction distance_fn = distance_for(dim);
+    ranked.resize(n_lists);
+    for (size_t i = 0; i < n_lists; i++)
+      ranked[i] = {distance_fn(&centroids[i * dim], query.data(), dim),
+                   static_cast<int>(i)};
+    std::sort(ranked.begin(), ranked.end());
+  } else {
+    // Partial selection: a centroid only has to beat the n-th best so far,
+    // so the bounded kernel drops most of them after a few blocks
+    BoundedDistanceFunction bounded_fn = bounded_distance_for(dim);
+    const uint32_t *order = block_order(dim);
+    TopK top(n);
+    for (size_t i = 0; i < n_lists; i++)
+      top.push(static_cast<int>(i),
+               bounded_fn(&centroids[i * dim], query.data(), dim,
+                          top.threshold(), order));
+    ranked = top.take_sorted();
+  }
+  if (stats)
+    stats->distance_computations += n_lists;
+  return ranked;
+}
+
+SearchResults IVFIndex::search(const MatrixView &data,
                                const std::vector<float> &query, int k,
-                               const SearchParams *params) {
+                               const SearchParams *params,
+                               const Bitmap *filter, SearchStats *stats) {
   SearchResults results;
+  PhaseTimer timer(stats != nullptr);
 
-  size_t centroids_size = centroids.size();
-  std::vector<std::pair<int, float>> centroid_scores;
-  centroid_scores.resize(centroids_size);
+  size_t n_lists = n_centroids();
   int effective_nprobe = this->n_probe; // Way 1: member default
+  int coarse_ef = 0;
+  int rerank_factor = 0;
 
   if (params) {
     auto ivf_params = dynamic_cast<const IVFSearchParams *>(params);
-    if (ivf_params)
+    if (ivf_params) {
       effective_nprobe = ivf_params->n_probe; // Way 2 wins
+      coarse_ef = ivf_params->coarse_ef;
+      rerank_factor = ivf_params->rerank_factor;
+    }
   }
 
-  int min_probe = std::min(effective_nprobe, static_cast<int>(centroids_size));
+  int min_probe = std::min(effective_nprobe, static_cast<int>(n_lists));
+  size_t dim = query.size();
+  std::vector<std::pair<float, int>> centroid_scores =
+      rank_lists(query, std::max(min_probe, 0), coarse_ef, stats);
+  min_probe = static_cast<int>(centroid_scores.size());
 
-  for (int i = 0; i < centroids_size; i++) {
-    float centroid_distance = euclidean_distance_squared(centroids[i], query);
-    centroid_scores[i] = {i, centroid_distance};
+  if (stats)
+    stats->ranking_us += timer.lap();
+
+  size_t probe_rows = 0;
+  for (int i = 0; i < min_probe; i++) {
+    probe_rows += list_size(centroid_scores[i].second);
   }
 
-  std::sort(centroid_scores.begin(), centroid_scores.end(),
-            [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
-              return a.second < b.second;
-            });
+  if (filter) {
+    // Adaptive fallback: if the allow-list is no larger than what the probed
+    // lists would scan anyway, an exact scan over the allowed ids is both
+    // cheaper and gives perfect recall.
+    if (filter->count() <= probe_rows) {
+      if (stats)
+        stats->filter_fallback = true;
+      return FlatIndex::search_allowed(data, query, k, *filter, metric_,
+                                       stats, block_order(query.size()));
+    }
+  }
 
-  std::vector<std::pair<int, float>> candidate_scores;
+  if (k <= 0)
+    return results;
 
-  for (int i = 0; i < min_probe; i++) {
-    int centroid_idx = centroid_scores[i].first;
-    for (int j = 0; j < inverted_index[centroid_idx].size(); j++) {
-      int vector_id = inverted_index[centroid_idx][j];
-      float dist = euclidean_distance_squared(data[vector_id], query);
-      candidate_scores.push_back({vector_id, dist});
+  BoundedDistanceFunction bounded_fn = bounded_distance_for(dim);
+  const uint32_t *order = block_order(dim);
+
+  // SQ8 lists are scored on their codes; with a re-rank the scan keeps
+  // more candidates than k for the exact pass to choose from
+  bool codes = storage == IVFStorage::SQ8 && sq.dimension() == dim;
+  bool rerank = codes && rerank_factor > 0;
+  int keep = rerank ? k * rerank_factor : k;
+  // A spilled id fills at most `spill` slots, so heaps of keep * spill
+  // still hold the best `keep` distinct ids once repeats are dropped
+  size_t slots = static_cast<size_t>(keep) * std::max(spill, 1);
+
+  // Dot metrics: the query's terms and constant part do not depend on the
+  // list, only its dot product with the centroid does
+  std::vector<float> dot_terms;
+  float dot_offset = 0.0f;
+  if (codes && metric_ != Metric::L2) {
+    dot_terms.resize(dim);
+    sq.dot_terms(query.data(), dot_terms.data());
+    dot_offset = sq.dot_offset(query.data());
+  }
+
+  // Scores list positions [first, last) of `list` from their codes
+  auto scan_codes = [&](int list, size_t first, size_t last, TopK &top) {
+    size_t scored = 0;
+    const uint8_t *code = list_codes.data() + first * dim;
+    const float *center = &centroids[static_cast<size_t>(list) * dim];
+    if (metric_ == Metric::L2) {
+      std::vector<float> terms(dim);
+      sq.l2_terms(query.data(), center, terms.data());
+      for (size_t p = first; p < last; p++, code += dim) {
+        int vector_id = list_ids[p];
+        if (filter && !filter->contains(vector_id))
+          continue;
+        top.push(vector_id, sq.l2_distance(terms.data(), code));
+        scored++;
+      }
+    } else {
+      float base = dot_offset;
+      for (size_t d = 0; d < dim; d++)
+        base += query[d] * center[d];
+      float bias = metric_ == Metric::Cosine ? 1.0f : 0.0f;
+      for (size_t p = first; p < last; p++, code += dim) {
+        int vector_id = list_ids[p];
+        if (filter && !filter->contains(vector_id))
+          continue;
+        top.push(vector_id, bias - (base + sq.dot(dot_terms.data(), code)));
+        scored++;
+      }
+    }
+    return scored;
+  };
+
+  // Scores ids[0, n) into `top`; returns the number of vectors scored.
+  // Lists hold ids in ascending order (k-means assigns rows in order), and
+  // the rows ahead are prefetched while the current one is scored.
+  auto scan_ids = [&](int list, const int *ids, size_t n, TopK &top) {
+    if (codes) {
+      size_t first = ids - list_ids.data();
+      return scan_codes(list, first, first + n, top);
+    }
+    size_t scored = 0;
+    auto skip = [&](int id) { return filter && !filter->contains(id); };
+    gather_scan(data, ids, n, skip, [&](int vector_id, const float *row) {
+      // Bounded by the current k-th best, so far rows stop early
+      top.push(vector_id, bounded_fn(row, query.data(), dim, top.threshold(),
+                                     order));
+      scored++;
+    });
+    return scored;
+  };
+  auto scan_list = [&](int list, TopK &top) {
+    return scan_ids(list, list_begin(list), list_size(list), top);
+  };
+
+  // Many or long probed lists are shared out to several threads, one list
+  // at a time; each keeps its own top-k and they are merged at the end
+  int lists = std::max(min_probe, 0);
+  // Codes are a quarter of the floats' size
+  size_t n_threads = scan_threads(probe_rows * dim / (codes ? 4 : 1));
+  std::vector<TopK> partial;
+  std::vector<size_t> scored;
+  if (n_threads > 1 && numa_active()) {
+    // Every node's threads scan the probed lists, restricted to the ids in
+    // that node's row partition: a sorted list's ids for one partition are
+    // a contiguous run
+    size_t nodes = numa_node_count();
+    size_t per_node = std::max<size_t>(1, n_threads / nodes);
+    partial.assign(nodes * per_node, TopK(slots));
+    scored.assign(partial.size(), 0);
+    std::vector<size_t> node_lists(nodes, lists);
+    numa_for_dynamic(node_lists, per_node,
+                     [&](size_t worker, size_t node, size_t i) {
+                       int list = centroid_scores[i].second;
+                       auto rows = numa_partition(data.size(), node);
+                       const int *first = list_begin(list);
+                       const int *last = first + list_size(list);
+                       first = std::lower_bound(first, last,
+                                               static_cast<int>(rows.first));
+                       last = std::lower_bound(first, last,
+                                              static_cast<int>(rows.second));
+                       scored[worker] += scan_ids(list, first, last - first,
+                                                  partial[worker]);
+                     });
+  } else {
+    partial.assign(std::max<size_t>(1, std::min<size_t>(n_threads, lists)),
+                   TopK(slots));
+    scored.assign(partial.size(), 0);
+    parallel_for_dynamic(lists, n_threads, [&](size_t worker, size_t i) {
+      scored[worker] += scan_list(centroid_scores[i].second, partial[worker]);
+    });
+  }
+
+  size_t n_scored = 0;
+  for (size_t count : scored) {
+    n_scored += count;
+  }
+  for (size_t t = 1; t < partial.size(); t++) {
+    partial[0].merge(partial[t]);
+  }
+
+  // With a filter, the probed lists may hold fewer than k allowed ids, so
+  // keep probing the next-closest lists until k candidates are found. The
+  // rest are ranked exactly; a graph ranking may have ordered them
+  // differently, so lists already scanned are skipped.
+  if (filter && n_scored < slots &&
+      static_cast<size_t>(lists) < n_lists) {
+    std::vector<char> scanned(n_lists, 0);
+    for (const auto &scored_list : centroid_scores)
+      scanned[scored_list.second] = 1;
+    std::vector<std::pair<float, int>> all_lists =
+        rank_lists(query, n_lists, 0, stats);
+    for (size_t i = 0; i < n_lists && n_scored < slots; i++) {
+      if (scanned[all_lists[i].second])
+        continue;
+      n_scored += scan_list(all_lists[i].second, partial[0]);
+      lists++;
     }
   }
 
-  std::sort(candidate_scores.begin(), candidate_scores.end(),
-            [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
-              return a.second < b.second;
-            });
+  if (stats) {
+    stats->scan_us += timer.lap();
+    stats->lists_visited += lists;
+    stats->distance_computations += n_scored;
+    stats->candidates += n_scored;
+  }
 
-  int min_k = std::min(k, static_cast<int>(candidate_scores.size()));
+  std::vector<std::pair<float, int>> candidates = partial[0].take_sorted();
+  if (spill > 1) {
+    // Keep each id's first (closest) entry. SQ8 codes of a spilled row
+    // differ per list, so its repeats need not be adjacent.
+    std::unordered_set<int> seen;
+    size_t kept = 0;
+    for (const auto &candidate : candidates) {
+      if (seen.insert(candidate.second).second)
+        candidates[kept++] = candidate;
+    }
+    if (stats)
+      stats->duplicates_removed += candidates.size() - kept;
+    candidates.resize(std::min<size_t>(kept, keep));
+  }
+  if (rerank) {
+    // Exact distances for the shortlist, from the full vectors
+    DistanceFunction distance_fn = distance_for(dim);
+    TopK top(k);
+    for (const auto &candidate : candidates)
+      top.push(candidate.second,
+               distance_fn(data.row(candidate.second), query.data(), dim));
+    if (stats)
+      stats->distance_computations += candidates.size();
+    candidates = top.take_sorted();
+  }
 
-  for (int i = 0; i < min_k; i++) {
-    results.ids.push_back({candidate_scores[i].first});
-    results.distances.push_back({candidate_scores[i].second});
+  for (const auto &candidate : candidates) {
+    results.ids.push_back(candidate.second);
+    results.distances.push_back(candidate.first);
   }
 
+  if (stats)
+    stats->rerank_us += timer.lap();
   return results;
 }
 
-void IVFIndex::build(const std::vector<std::vector<float>> &data) {
-  KMeans kmeans_trainer(n_clusters, max_iters, dimension);
+void IVFIndex::build(const MatrixView &data, BuildProgress *progress) {
+  // Angular metrics train spherical k-means (unit-norm centroids)
+  KMeans kmeans_trainer(n_clusters, max_iters, dimension, metric_,
+                        max_list_factor);
+
+  KMeansIndex index = kmeans_trainer.train(data, progress);
+
+  centroids.clear();
+  centroids.reserve(index.centroids.size() * dimension);
+  for (const auto &centroid : index.centroids)
+    centroids.insert(centroids.end(), centroid.begin(), centroid.end());
+  resolve_distance(dimension);
+  update_block_order();
+  if (spill > 1)
+    spill_buckets(data, index.buckets);
+  set_lists(index.buckets);
+  build_coarse_graph(progress);
+  encode_lists(data, progress);
+}
+
+void IVFIndex::spill_buckets(const MatrixView &data,
+                             std::vector<std::vector<int>> &buckets) const {
+  size_t rows = data.size();
+  size_t dim = dimension;
+  size_t n_lists = n_centroids();
+  size_t extra = std::min<size_t>(spill, n_lists) - 1;
+  if (extra == 0 || rows == 0)
+    return;
+
+  std::vector<int> home(rows, -1);
+  for (size_t list = 0; list < buckets.size(); list++) {
+    for (int id : buckets[list])
+      home[id] = static_cast<int>(list);
+  }
+
+  // The closest lists besides each row's own, found as in rank_lists()
+  std::vector<int> spilled(rows * extra, -1);
+  BoundedDistanceFunction bounded_fn = bounded_distance_for(dim);
+  const uint32_t *order = block_order(dim);
+  parallel_for(rows, default_num_threads(), [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      TopK top(extra + 1);
+      for (size_t i = 0; i < n_lists; i++)
+        top.push(static_cast<int>(i),
+                 bounded_fn(&centroids[i * dim], data.row(row), dim,
+                            top.threshold(), order));
+      size_t slot = 0;
+      for (const auto &list : top.take_sorted()) {
+        if (list.second != home[row] && slot < extra)
+          spilled[row * extra + slot++] = list.second;
+      }
+    }
+  });
+
+  // Refilled in id order, so every list stays sorted
+  for (auto &bucket : buckets)
+    bucket.clear();
+  for (size_t row = 0; row < rows; row++) {
+    if (home[row] >= 0)
+      buckets[home[row]].push_back(static_cast<int>(row));
+    for (size_t slot = 0; slot < extra; slot++) {
+      int list = spilled[row * extra + slot];
+      if (list >= 0)
+        buckets[list].push_back(static_cast<int>(row));
+    }
+  }
+}
+
+void IVFIndex::encode_lists(const MatrixView &data, BuildProgress *progress) {
+  sq = ScalarQuantizer();
+  list_codes.clear();
+  list_codes.shrink_to_fit();
+  if (storage != IVFStorage::SQ8 || n_centroids() == 0)
+    return;
 
-  KMeansIndex index = kmeans_trainer.train(data);
+  size_t dim = dimension;
+  size_t n_lists = n_centroids();
+  size_t n_threads = default_num_threads();
+  if (progress)
+    progress->begin_phase("sq8", 2 * list_ids.size());
 
-  centroids = index.centroids;
-  inverted_index = index.buckets;
+  // Per-dimension residual range, one running min/max per worker
+  std::vector<std::vector<float>> lo(
+      n_threads, std::vector<float>(dim, std::numeric_limits<float>::max()));
+  std::vector<std::vector<float>> hi(
+      n_threads, std::vector<float>(dim, std::numeric_limits<float>::lowest()));
+  parallel_for_dynamic(n_lists, n_threads, [&](size_t worker, size_t list) {
+    const float *center = &centroids[list * dim];
+    for (size_t p = list_offsets[list]; p < list_offsets[list + 1]; p++) {
+      const float *row = data.row(list_ids[p]);
+      for (size_t d = 0; d < dim; d++) {
+        float residual = row[d] - center[d];
+        lo[worker][d] = std::min(lo[worker][d], residual);
+        hi[worker][d] = std::max(hi[worker][d], residual);
+      }
+    }
+    if (progress)
+      progress->advance(list_size(list));
+  });
+  for (size_t t = 1; t < n_threads; t++) {
+    for (size_t d = 0; d < dim; d++) {
+      lo[0][d] = std::min(lo[0][d], lo[t][d]);
+      hi[0][d] = std::max(hi[0][d], hi[t][d]);
+    }
+  }
+  sq = ScalarQuantizer(lo[0], hi[0]);
+
+  list_codes.resize(list_ids.size() * dim);
+  parallel_for_dynamic(n_lists, n_threads, [&](size_t, size_t list) {
+    const float *center = &centroids[list * dim];
+    for (size_t p = list_offsets[list]; p < list_offsets[list + 1]; p++)
+      sq.encode(data.row(list_ids[p]), center, &list_codes[p * dim]);
+    if (progress)
+      progress->advance(list_size(list));
+  });
+}
+
+void IVFIndex::build_coarse_graph(BuildProgress *progress) {
+  coarse_graph.reset();
+  if (quantizer != CoarseQuantizer::HNSW || n_centroids() == 0)
+    return;
+  coarse_graph = std::make_unique<HNSWIndex>(kCoarseM, kCoarseEfConstruction,
+                                             kCoarseEfSearch, metric_);
+  coarse_graph->build(centroid_view(), progress);
+}
+
+void IVFIndex::set_lists(const std::vector<std::vector<int>> &lists) {
+  list_offsets.assign(1, 0);
+  for (const auto &list : lists)
+    list_offsets.push_back(list_offsets.back() + list.size());
+
+  list_ids.clear();
+  list_ids.reserve(list_offsets.back());
+  for (const auto &list : lists)
+    list_ids.insert(list_ids.end(), list.begin(), list.end());
+}
+
+std::vector<size_t> IVFIndex::list_sizes() const {
+  std::vector<size_t> sizes;
+  for (size_t i = 0; i + 1 < list_offsets.size(); i++)
+    sizes.push_back(list_size(static_cast<int>(i)));
+  return sizes;
+}
+
+ListSizeStats IVFIndex::list_size_stats() const {
+  ListSizeStats summary;
+  std::vector<size_t> sizes = list_sizes();
+  if (sizes.empty())
+    return summary;
+
+  std::sort(sizes.begin(), sizes.end());
+  size_t n = sizes.size();
+  summary.lists = n;
+  summary.empty = std::count(sizes.begin(), sizes.end(), size_t(0));
+  summary.min = sizes.front();
+  summary.max = sizes.back();
+  double total = 0.0;
+  for (size_t size : sizes)
+    total += size;
+  summary.mean = total / n;
+  double variance = 0.0;
+  for (size_t size : sizes)
+    variance += (size - summary.mean) * (size - summary.mean);
+  summary.stddev = std::sqrt(variance / n);
+  // Nearest-rank percentiles
+  auto percentile = [&](double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * n));
+    return sizes[std::min(n, std::max<size_t>(rank, 1)) - 1];
+  };
+  summary.p50 = percentile(50);
+  summary.p90 = percentile(90);
+  summary.p99 = percentile(99);
+  summary.imbalance = summary.mean > 0.0 ? summary.max / summary.mean : 0.0;
+  return summary;
+}
+
+void IVFIndex::update_block_order() {
+  block_order_ = block_order_by_variance(centroids.data(), n_centroids(),
+                                         dimension, n_centroids());
 }
 
 bool IVFIndex::is_trained() const {
-  if (centroids.size() == 0 || inverted_index.size() == 0) {
+  if (n_centroids() == 0 || list_offsets.size() <= 1) {
     return false;
   }
   return true;
 }
 
-void IVFIndex::save(std::ofstream &out) const {
+namespace {
+// Leading int of the delta-encoded layout. Older files start with n_probe
+// (never negative) and store lists as raw int32 arrays.
+constexpr int kDeltaIdsLayout = -2;
+// Delta-encoded lists plus the coarse quantizer: its kind after n_probe,
+// and after the lists a flag followed by the graph when there is one
+constexpr int kCoarseQuantizerLayout = -3;
+// As -3, plus the list storage after the quantizer kind and, for SQ8,
+// the quantizer ranges and the codes after the graph
+constexpr int kStorageLayout = -4;
+// As -4, plus the spill count after the storage kind
+constexpr int kSpillLayout = -5;
+} // namespace
+
+void IVFIndex::save(std::ostream &out) const {
   if (!is_trained())
     return;
 
+  int layout = kSpillLayout;
+  out.write(reinterpret_cast<const char *>(&layout), sizeof(int));
   out.write(reinterpret_cast<const char *>(&n_probe), sizeof(int));
+  int quantizer_kind = static_cast<int>(quantizer);
+  out.write(reinterpret_cast<const char *>(&quantizer_kind), sizeof(int));
+  int storage_kind = static_cast<int>(storage);
+  out.write(reinterpret_cast<const char *>(&storage_kind), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&spill), sizeof(int));
 
-  int num_centroids = centroids.size();
+  int num_centroids = n_centroids();
   out.write(reinterpret_cast<const char *>(&num_centroids), sizeof(int));
   out.write(reinterpret_cast<const char *>(&dimension), sizeof(int));
+  out.write(reinterpret_cast<const char *>(centroids.data()),
+            centroids.size() * sizeof(float));
 
-  for (const auto &centroid : centroids) {
-    out.write(reinterpret_cast<const char *>(centroid.data()),
-              dimension * sizeof(float));
-  }
+  // All lists are encoded into one block and written at once
+  std::vector<char> encoded;
+  for (int i = 0; i < num_centroids; i++)
+    append_delta_ids(encoded, list_begin(i), list_size(i));
 
-  for (int i = 0; i < num_centroids; i++) {
-    int bucket_size = inverted_index[i].size();
+  uint64_t encoded_size = encoded.size();
+  out.write(reinterpret_cast<const char *>(&encoded_size), sizeof(uint64_t));
+  out.write(encoded.data(), encoded.size());
 
-    out.write(reinterpret_cast<const char *>(&bucket_size), sizeof(int));
-    out.write(reinterpret_cast<const char *>(inverted_index[i].data()),
-              bucket_size * sizeof(int));
+  uint8_t has_graph = coarse_graph != nullptr;
+  out.write(reinterpret_cast<const char *>(&has_graph), sizeof(uint8_t));
+  if (has_graph)
+    coarse_graph->save(out);
+
+  if (storage == IVFStorage::SQ8) {
+    sq.save(out);
+    uint64_t code_bytes = list_codes.size();
+    out.write(reinterpret_cast<const char *>(&code_bytes), sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(list_codes.data()), code_bytes);
   }
 }
 
-void IVFIndex::load(std::ifstream &in) {
-  in.read(reinterpret_cast<char *>(&n_probe), sizeof(int));
+void IVFIndex::load(std::istream &in) {
+  int first = 0;
+  in.read(reinterpret_cast<char *>(&first), sizeof(int));
+  bool with_spill = first == kSpillLayout;
+  bool with_storage = first == kStorageLayout || with_spill;
+  bool with_quantizer = first == kCoarseQuantizerLayout || with_storage;
+  bool delta_ids = first == kDeltaIdsLayout || with_quantizer;
+  if (delta_ids)
+    in.read(reinterpret_cast<char *>(&n_probe), sizeof(int));
+  else
+    n_probe = first;
+  int quantizer_kind = static_cast<int>(CoarseQuantizer::Flat);
+  if (with_quantizer)
+    in.read(reinterpret_cast<char *>(&quantizer_kind), sizeof(int));
+  quantizer = static_cast<CoarseQuantizer>(quantizer_kind);
+  int storage_kind = static_cast<int>(IVFStorage::Full);
+  if (with_storage)
+    in.read(reinterpret_cast<char *>(&storage_kind), sizeof(int));
+  storage = static_cast<IVFStorage>(storage_kind);
+  spill = 1;
+  if (with_spill)
+    in.read(reinterpret_cast<char *>(&spill), sizeof(int));
   in.read(reinterpret_cast<char *>(&n_clusters), sizeof(int));
   in.read(reinterpret_cast<char *>(&dimension), sizeof(int));
+  if (!in || n_clusters < 0 || dimension < 0)
+    return; // The caller reports the truncated stream
+
+  resolve_distance(dimension);
+  centroids.assign(static_cast<size_t>(n_clusters) * dimension, 0.0f);
+  in.read(reinterpret_cast<char *>(centroids.data()),
+          centroids.size() * sizeof(float));
+  update_block_order();
+  coarse_graph.reset();
+  sq = ScalarQuantizer();
+  list_codes.clear();
+
+  std::vector<std::vector<int>> lists(n_clusters);
+  if (delta_ids) {
+    uint64_t encoded_size = 0;
+    in.read(reinterpret_cast<char *>(&encoded_size), sizeof(uint64_t));
+    std::vector<char> encoded(encoded_size);
+    in.read(encoded.data(), encoded_size);
+    if (!in)
+      return; // The caller reports the truncated stream
 
-  centroids.resize(n_clusters);
+    const char *p = encoded.data();
+    const char *end = p + encoded.size();
+    for (int i = 0; i < n_clusters; i++)
+      p = read_delta_ids(p, end, lists[i]);
+  } else {
+    for (int i = 0; i < n_clusters; i++) {
+      int bucket_size;
+      in.read(reinterpret_cast<char *>(&bucket_size), sizeof(int));
 
-  for (int i = 0; i < n_clusters; i++) {
-    centroids[i].resize(dimension);
-    in.read(reinterpret_cast<char *>(centroids[i].data()),
-            dimension * sizeof(float));
+      lists[i].resize(bucket_size);
+      in.read(reinterpret_cast<char *>(lists[i].data()),
+              bucket_size * sizeof(int));
+    }
   }
+  set_lists(lists);
 
-  inverted_index.resize(n_clusters);
-  for (int i = 0; i < n_clusters; i++) {
-    int bucket_size;
-    in.read(reinterpret_cast<char *>(&bucket_size), sizeof(int));
+  if (with_quantizer) {
+    uint8_t has_graph = 0;
+    in.read(reinterpret_cast<char *>(&has_graph), sizeof(uint8_t));
+    if (in && has_graph) {
+      coarse_graph = std::make_unique<HNSWIndex>(
+          kCoarseM, kCoarseEfConstruction, kCoarseEfSearch, metric_);
+      coarse_graph->load(in);
+    }
+  }
 
-    inverted_index[i].resize(bucket_size);
-    in.read(reinterpret_cast<char *>(inverted_index[i].data()),
-            bucket_size * sizeof(int));
+  if (storage == IVFStorage::SQ8 && in) {
+    sq.load(in);
+    uint64_t code_bytes = 0;
+    in.read(reinterpret_cast<char *>(&code_bytes), sizeof(uint64_t));
+    if (!in || code_bytes != list_ids.size() * sq.code_size() ||
+        sq.dimension() != static_cast<size_t>(dimension))
+      throw std::runtime_error("IVFIndex::load: corrupt SQ8 codes");
+    list_codes.resize(code_bytes);
+    in.read(reinterpret_cast<char *>(list_codes.data()), code_bytes);
   }
 }
\ No newline at end of file
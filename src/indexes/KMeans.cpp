@@ -1,15 +1,30 @@
 #include "indexes/KMeans.hpp"
+#include "utils/Distance.hpp"
 #include "utils/Math.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Vectors assigned between progress updates
+constexpr int kProgressBlock = 4096;
+} // namespace
 
 // =========================================================
 // SECTION: Constructor
 // =========================================================
 
-KMeans::KMeans(int k, int max_iters, int dimension)
-    : k(k), max_iters(max_iters), dimension(dimension) {}
+KMeans::KMeans(int k, int max_iters, int dimension, Metric metric,
+               float max_bucket_factor)
+    : k(k), max_iters(max_iters), dimension(dimension), metric(metric),
+      max_bucket_factor(max_bucket_factor) {
+  if (max_bucket_factor < 0.0f)
+    throw std::invalid_argument("KMeans: max_bucket_factor must be >= 0");
+}
 
 // =========================================================
 // SECTION: Main Training Logic
@@ -23,7 +38,7 @@ KMeans::KMeans(int k, int max_iters, int dimension)
 // 3. Update Step (Centroid -> Average of Points)
 // 4. Repeat until max_iters
 // =========================================================
-KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
+KMeansIndex KMeans::train(const MatrixView &data, BuildProgress *progress) {
   KMeansIndex index;
 
   // Safety Check: Cannot find K clusters if we have fewer than K data points
@@ -37,6 +52,9 @@ KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
   // 2. Initialize Starting Positions
   // We pick K random points from the data to be the starting centroids
   init_centroids(data, index);
+  if (progress)
+    progress->begin_phase("kmeans",
+                          static_cast<uint64_t>(max_iters) * data.size());
 
   // 3. The Training Loop
   for (int iter = 0; iter < max_iters; iter++) {
@@ -47,7 +65,7 @@ KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
 
     // Step B: Assignment Phase
     // Loop through all data points and assign them to the closest centroid
-    assign_points_to_buckets(data, index);
+    assign_points_to_buckets(data, index, progress);
 
     // Step C: Update Phase
     // Move centroids to the mathematical center (mean) of their buckets
@@ -57,6 +75,22 @@ KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
   return index;
 }
 
+KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
+  std::vector<float> packed;
+  packed.reserve(data.size() * dimension);
+  for (const auto &row : data) {
+    if (row.size() != static_cast<size_t>(dimension))
+      throw std::invalid_argument("KMeans: vector dimension mismatch");
+    packed.insert(packed.end(), row.begin(), row.end());
+  }
+
+  MatrixView view;
+  view.data = packed.data();
+  view.rows = data.size();
+  view.dim = dimension;
+  return train(view);
+}
+
 // =========================================================
 // SECTION: Helper Implementations
 // =========================================================
@@ -65,8 +99,7 @@ KMeansIndex KMeans::train(const std::vector<std::vector<float>> &data) {
 // Helper 1: Initialization
 // strategy: Random Partitioning (Shuffle indices and pick K Centroids)
 // =========================================================
-void KMeans::init_centroids(const std::vector<std::vector<float>> &data,
-                            KMeansIndex &index) {
+void KMeans::init_centroids(const MatrixView &data, KMeansIndex &index) {
   // std::random_device rd;  // Hardware source of entropy
   // std::mt19937 gen(rd()); // Mersenne Twister engine
 
@@ -81,7 +114,10 @@ void KMeans::init_centroids(const std::vector<std::vector<float>> &data,
 
   // Pick the first K indices as our initial centroids
   for (int i = 0; i < k; i++) {
-    index.centroids[i] = data[indices[i]];
+    const float *row = data.row(indices[i]);
+    index.centroids[i].assign(row, row + dimension);
+    if (is_angular(metric))
+      normalize(index.centroids[i].data(), dimension);
   }
 }
 
@@ -90,8 +126,17 @@ void KMeans::init_centroids(const std::vector<std::vector<float>> &data,
 // Finds the nearest centroid for every data point
 // Time Complexity: O(N * K * Dimension)
 // =========================================================
-void KMeans::assign_points_to_buckets(
-    const std::vector<std::vector<float>> &data, KMeansIndex &index) {
+void KMeans::assign_points_to_buckets(const MatrixView &data,
+                                      KMeansIndex &index,
+                                      BuildProgress *progress) {
+  // Spherical k-means: nearest centroid = largest inner product, which the
+  // (negated) InnerProduct kernel turns into a smallest distance
+  DistanceFunction distance_fn = get_distance_function(
+      is_angular(metric) ? Metric::InnerProduct : Metric::L2, dimension);
+
+  std::vector<int> assignment(data.size());
+  std::vector<float> distances(data.size());
+
   // Iterate through every vector in the dataset
   for (int i = 0; i < data.size(); i++) {
     int best_centroid_index = -1;
@@ -99,7 +144,7 @@ void KMeans::assign_points_to_buckets(
 
     // Compare against all K centroids to find the closest one
     for (int j = 0; j < k; j++) {
-      float d = euclidean_distance_squared(data[i], index.centroids[j]);
+      float d = distance_fn(data.row(i), index.centroids[j].data(), dimension);
       if (d < min_dist) {
         min_dist = d;
         best_centroid_index = j;
@@ -108,8 +153,23 @@ void KMeans::assign_points_to_buckets(
 
     // Record the assignment
     // "Vector i belongs to Cluster j"
-    index.buckets[best_centroid_index].push_back(i);
+    assignment[i] = best_centroid_index;
+    distances[i] = min_dist;
+
+    // Report in blocks so the shared counter stays off the hot path
+    if (progress && (i + 1) % kProgressBlock == 0)
+      progress->advance(kProgressBlock);
   }
+  if (progress)
+    progress->advance(data.size() % kProgressBlock);
+
+  size_t cap = bucket_cap(data.size());
+  if (cap > 0)
+    cap_buckets(data, index, cap, assignment, distances);
+
+  // Filled in id order, so every bucket is sorted
+  for (int i = 0; i < data.size(); i++)
+    index.buckets[assignment[i]].push_back(i);
 }
 
 // =========================================================
@@ -117,8 +177,7 @@ void KMeans::assign_points_to_buckets(
 // Calculates the new mean position for each centroid.
 // Uses Row-Wise Access for CPU Cache Optimization.
 // =========================================================
-void KMeans::update_centroids(const std::vector<std::vector<float>> &data,
-                              KMeansIndex &index) {
+void KMeans::update_centroids(const MatrixView &data, KMeansIndex &index) {
   // Iterate through buckets
   for (int i = 0; i < k; i++) {
     // Edge Case: If a cluster is empty (no points assigned), skip update.
@@ -134,8 +193,9 @@ void KMeans::update_centroids(const std::vector<std::vector<float>> &data,
     // Instead of looping Dimensions first, we loop Vectors first.
     // This ensures we read contiguous blocks of memory (cache friendly).
     for (int vector_id : index.buckets[i]) {
+      const float *row = data.row(vector_id);
       for (int d = 0; d < dimension; d++) {
-        new_center[d] += data[vector_id][d];
+        new_center[d] += row[d];
       }
     }
 
@@ -146,7 +206,90 @@ void KMeans::update_centroids(const std::vector<std::vector<float>> &data,
       new_center[d] /= count;
     }
 
+    // Spherical k-means projects the mean back onto the unit sphere
+    if (is_angular(metric))
+      normalize(new_center.data(), dimension);
+
     // 3. Update the official centroid position
     index.centroids[i] = new_center;
   }
-}
\ No newline at end of file
+
+  // Balanced k-means also splits its largest buckets: each empty cluster
+  // is re-seeded on a point of one of them, so the next assignment step
+  // divides that bucket between the two centroids
+  if (max_bucket_factor <= 0.0f)
+    return;
+  std::vector<int> by_size(k);
+  std::iota(by_size.begin(), by_size.end(), 0);
+  std::sort(by_size.begin(), by_size.end(), [&](int a, int b) {
+    return index.buckets[a].size() > index.buckets[b].size();
+  });
+  size_t donor = 0;
+  for (int i = 0; i < k; i++) {
+    if (!index.buckets[i].empty())
+      continue;
+    const auto &largest = index.buckets[by_size[donor++]];
+    if (largest.size() < 2)
+      break;
+    const float *row = data.row(largest[largest.size() / 2]);
+    index.centroids[i].assign(row, row + dimension);
+    if (is_angular(metric))
+      normalize(index.centroids[i].data(), dimension);
+  }
+}
+
+// =========================================================
+// Helper 4: Balancing
+// Greedy capacity-constrained assignment. Each over-full bucket keeps
+// its `cap` closest points; the evicted ones, closest to their first
+// choice first, take the nearest centroid that still has room.
+// Time Complexity: O(evicted * K * Dimension)
+// =========================================================
+size_t KMeans::bucket_cap(size_t rows) const {
+  if (max_bucket_factor <= 0.0f || k <= 0)
+    return 0;
+  double mean = static_cast<double>(rows) / k;
+  return static_cast<size_t>(
+      std::ceil(mean * std::max(1.0f, max_bucket_factor)));
+}
+
+void KMeans::cap_buckets(const MatrixView &data, const KMeansIndex &index,
+                         size_t cap, std::vector<int> &assignment,
+                         const std::vector<float> &distances) {
+  std::vector<std::vector<int>> members(k);
+  for (int i = 0; i < data.size(); i++)
+    members[assignment[i]].push_back(i);
+
+  auto closer = [&](int a, int b) { return distances[a] < distances[b]; };
+  std::vector<size_t> counts(k);
+  std::vector<int> evicted;
+  for (int j = 0; j < k; j++) {
+    auto &bucket = members[j];
+    if (bucket.size() > cap) {
+      std::nth_element(bucket.begin(), bucket.begin() + cap, bucket.end(),
+                       closer);
+      evicted.insert(evicted.end(), bucket.begin() + cap, bucket.end());
+    }
+    counts[j] = std::min(bucket.size(), cap);
+  }
+  std::sort(evicted.begin(), evicted.end(), closer);
+
+  DistanceFunction distance_fn = get_distance_function(
+      is_angular(metric) ? Metric::InnerProduct : Metric::L2, dimension);
+  for (int i : evicted) {
+    int best_centroid_index = -1;
+    float min_dist = std::numeric_limits<float>::max();
+    for (int j = 0; j < k; j++) {
+      if (counts[j] >= cap)
+        continue;
+      float d = distance_fn(data.row(i), index.centroids[j].data(), dimension);
+      if (best_centroid_index < 0 || d < min_dist) {
+        min_dist = d;
+        best_centroid_index = j;
+      }
+    }
+    // cap * k >= rows, so some bucket always has room
+    assignment[i] = best_centroid_index;
+    counts[best_centroid_index]++;
+  }
+}
@@ -0,0 +1,129 @@
+// src/indexes/ProductQuantizer.cpp
+
+#include "indexes/ProductQuantizer.hpp"
+#include "indexes/KMeans.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+ProductQuantizer::ProductQuantizer(size_t dim, size_t n_subspaces) {
+  if (n_subspaces == 0 || n_subspaces > dim)
+    throw std::invalid_argument(
+        "ProductQuantizer: need 1 <= n_subspaces <= dimension");
+  set_layout(dim, n_subspaces);
+}
+
+void ProductQuantizer::set_layout(size_t dim, size_t n_subspaces) {
+  this->dim_ = dim;
+  this->n_subspaces_ = n_subspaces;
+  this->offsets_.assign(n_subspaces + 1, 0);
+  size_t base = dim / n_subspaces;
+  size_t extra = dim % n_subspaces;
+  for (size_t m = 0; m < n_subspaces; m++) {
+    this->offsets_[m + 1] = this->offsets_[m] + base + (m < extra ? 1 : 0);
+  }
+}
+
+void ProductQuantizer::train(const MatrixView &data, size_t max_samples,
+                             int max_iters, BuildProgress *progress) {
+  if (data.empty())
+    return;
+
+  // Evenly spaced rows: deterministic and spread over the whole dataset
+  size_t n_samples = std::min(data.size(), max_samples);
+  double step = static_cast<double>(data.size()) / n_samples;
+  this->n_centroids_ = std::min(kMaxCentroids, n_samples);
+  this->codebooks_.assign(this->n_centroids_ * this->dim_, 0.0f);
+
+  if (progress)
+    progress->begin_phase("pq", this->n_subspaces_);
+
+  std::vector<float> slice;
+  for (size_t m = 0; m < this->n_subspaces_; m++) {
+    size_t w = width(m);
+    slice.resize(n_samples * w);
+    for (size_t i = 0; i < n_samples; i++) {
+      const float *row = data.row(static_cast<size_t>(i * step));
+      std::copy(row + this->offsets_[m], row + this->offsets_[m] + w,
+                slice.data() + i * w);
+    }
+
+    MatrixView view;
+    view.data = slice.data();
+    view.rows = n_samples;
+    view.dim = w;
+    KMeans kmeans(this->n_centroids_, max_iters, w, Metric::L2);
+    KMeansIndex trained = kmeans.train(view);
+
+    float *book = this->codebooks_.data() + this->n_centroids_ * offsets_[m];
+    for (size_t c = 0; c < trained.centroids.size(); c++) {
+      std::copy(trained.centroids[c].begin(), trained.centroids[c].end(),
+                book + c * w);
+    }
+    if (progress)
+      progress->advance();
+  }
+}
+
+void ProductQuantizer::encode(const MatrixView &data, uint8_t *codes) const {
+  auto encode_rows = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const float *row = data.row(i);
+      uint8_t *code = codes + i * this->n_subspaces_;
+      for (size_t m = 0; m < this->n_subspaces_; m++) {
+        const float *slice = row + this->offsets_[m];
+        float best = std::numeric_limits<float>::max();
+        code[m] = 0;
+        for (size_t c = 0; c < this->n_centroids_; c++) {
+          float d = l2_distance_sqr(slice, centroid(m, c), width(m));
+          if (d < best) {
+            best = d;
+            code[m] = static_cast<uint8_t>(c);
+          }
+        }
+      }
+    }
+  };
+  parallel_for(data.size(), default_num_threads(), encode_rows);
+}
+
+void ProductQuantizer::compute_table(const float *query, Metric metric,
+                                     float *table) const {
+  for (size_t m = 0; m < this->n_subspaces_; m++) {
+    const float *slice = query + this->offsets_[m];
+    float *row = table + m * kMaxCentroids;
+    for (size_t c = 0; c < this->n_centroids_; c++) {
+      row[c] = metric == Metric::L2
+                   ? l2_distance_sqr(slice, centroid(m, c), width(m))
+                   : -inner_product(slice, centroid(m, c), width(m));
+    }
+  }
+}
+
+void ProductQuantizer::save(std::ostream &out) const {
+  uint64_t header[3] = {this->dim_, this->n_subspaces_, this->n_centroids_};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(this->codebooks_.data()),
+            this->codebooks_.size() * sizeof(float));
+}
+
+void ProductQuantizer::load(std::istream &in) {
+  uint64_t header[3] = {0, 0, 0};
+  in.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (!in || header[1] == 0 || header[1] > header[0] ||
+      header[2] > kMaxCentroids)
+    throw std::runtime_error("ProductQuantizer::load: corrupt header");
+
+  set_layout(header[0], header[1]);
+  this->n_centroids_ = header[2];
+  this->codebooks_.resize(this->n_centroids_ * this->dim_);
+  in.read(reinterpret_cast<char *>(this->codebooks_.data()),
+          this->codebooks_.size() * sizeof(float));
+}
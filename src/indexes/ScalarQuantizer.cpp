@@ -0,0 +1,180 @@
+// src/indexes/ScalarQuantizer.cpp
+
+#include "indexes/ScalarQuantizer.hpp"
+#include "utils/Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// sum w[d] * (t[d] - code[d])^2
+float sq8_weighted_l2(const float *t, const float *w, const uint8_t *code,
+                      size_t n) {
+  size_t i = 0;
+  float sum = 0.0f;
+
+#if defined(VEGAMDB_AVX2)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (; i + 16 <= n; i += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(code + i));
+    __m256 c0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    __m256 c1 =
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(t + i), c0);
+    __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(t + i + 8), c1);
+    acc0 = _mm256_fmadd_ps(_mm256_mul_ps(d0, d0), _mm256_loadu_ps(w + i),
+                           acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_mul_ps(d1, d1), _mm256_loadu_ps(w + i + 8),
+                           acc1);
+  }
+  sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(VEGAMDB_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= n; i += 8) {
+    uint16x8_t wide = vmovl_u8(vld1_u8(code + i));
+    float32x4_t c0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+    float32x4_t c1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide)));
+    float32x4_t d0 = vsubq_f32(vld1q_f32(t + i), c0);
+    float32x4_t d1 = vsubq_f32(vld1q_f32(t + i + 4), c1);
+    acc0 = vfmaq_f32(acc0, vmulq_f32(d0, d0), vld1q_f32(w + i));
+    acc1 = vfmaq_f32(acc1, vmulq_f32(d1, d1), vld1q_f32(w + i + 4));
+  }
+  sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+
+  for (; i < n; i++) {
+    float diff = t[i] - code[i];
+    sum += w[i] * diff * diff;
+  }
+  return sum;
+}
+
+// sum a[d] * code[d]
+float sq8_dot(const float *a, const uint8_t *code, size_t n) {
+  size_t i = 0;
+  float sum = 0.0f;
+
+#if defined(VEGAMDB_AVX2)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (; i + 16 <= n; i += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(code + i));
+    __m256 c0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    __m256 c1 =
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), c0, acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), c1, acc1);
+  }
+  sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(VEGAMDB_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= n; i += 8) {
+    uint16x8_t wide = vmovl_u8(vld1_u8(code + i));
+    acc0 = vfmaq_f32(acc0, vld1q_f32(a + i),
+                     vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide))));
+    acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4),
+                     vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide))));
+  }
+  sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+
+  for (; i < n; i++) {
+    sum += a[i] * code[i];
+  }
+  return sum;
+}
+
+} // namespace
+
+ScalarQuantizer::ScalarQuantizer(const std::vector<float> &lo,
+                                 const std::vector<float> &hi) {
+  if (lo.size() != hi.size())
+    throw std::invalid_argument("ScalarQuantizer: range length mismatch");
+  this->dim_ = lo.size();
+  this->min_ = lo;
+  this->step_.resize(this->dim_);
+  this->weights_.resize(this->dim_);
+  for (size_t d = 0; d < this->dim_; d++) {
+    float range = hi[d] - lo[d];
+    this->step_[d] = range > 0.0f ? range / 255.0f : 1.0f;
+    this->weights_[d] = this->step_[d] * this->step_[d];
+  }
+}
+
+void ScalarQuantizer::encode(const float *vector, const float *center,
+                             uint8_t *code) const {
+  for (size_t d = 0; d < this->dim_; d++) {
+    float value = center ? vector[d] - center[d] : vector[d];
+    float level = std::round((value - this->min_[d]) / this->step_[d]);
+    code[d] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, level)));
+  }
+}
+
+void ScalarQuantizer::l2_terms(const float *query, const float *center,
+                               float *terms) const {
+  for (size_t d = 0; d < this->dim_; d++) {
+    float value = center ? query[d] - center[d] : query[d];
+    terms[d] = (value - this->min_[d]) / this->step_[d];
+  }
+}
+
+float ScalarQuantizer::l2_distance(const float *terms,
+                                   const uint8_t *code) const {
+  return sq8_weighted_l2(terms, this->weights_.data(), code, this->dim_);
+}
+
+void ScalarQuantizer::dot_terms(const float *query, float *terms) const {
+  for (size_t d = 0; d < this->dim_; d++) {
+    terms[d] = query[d] * this->step_[d];
+  }
+}
+
+float ScalarQuantizer::dot_offset(const float *query) const {
+  float sum = 0.0f;
+  for (size_t d = 0; d < this->dim_; d++) {
+    sum += query[d] * this->min_[d];
+  }
+  return sum;
+}
+
+float ScalarQuantizer::dot(const float *terms, const uint8_t *code) const {
+  return sq8_dot(terms, code, this->dim_);
+}
+
+void ScalarQuantizer::save(std::ostream &out) const {
+  uint64_t dim = this->dim_;
+  out.write(reinterpret_cast<const char *>(&dim), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char *>(this->min_.data()),
+            dim * sizeof(float));
+  out.write(reinterpret_cast<const char *>(this->step_.data()),
+            dim * sizeof(float));
+}
+
+void ScalarQuantizer::load(std::istream &in) {
+  uint64_t dim = 0;
+  in.read(reinterpret_cast<char *>(&dim), sizeof(uint64_t));
+  if (!in || dim > (uint64_t(1) << 20))
+    throw std::runtime_error("ScalarQuantizer::load: corrupt header");
+  this->dim_ = dim;
+  this->min_.resize(dim);
+  this->step_.resize(dim);
+  in.read(reinterpret_cast<char *>(this->min_.data()), dim * sizeof(float));
+  in.read(reinterpret_cast<char *>(this->step_.data()), dim * sizeof(float));
+  if (!in)
+    throw std::runtime_error("ScalarQuantizer::load: truncated");
+  this->weights_.resize(dim);
+  for (size_t d = 0; d < dim; d++) {
+    this->weights_[d] = this->step_[d] * this->step_[d];
+  }
+}
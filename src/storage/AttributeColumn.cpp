@@ -0,0 +1,292 @@
+// src/storage/AttributeColumn.cpp
+
+#include "storage/AttributeColumn.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+// Numeric view of a predicate value. Callers check require_numeric() first.
+double to_double(const AttributeValue &value) {
+  if (auto v = std::get_if<int64_t>(&value))
+    return static_cast<double>(*v);
+  return std::get<double>(value);
+}
+
+void require_numeric(const Predicate &predicate) {
+  for (const auto &value : predicate.values) {
+    if (std::holds_alternative<std::string>(value)) {
+      throw std::invalid_argument("Column '" + predicate.column +
+                                  "' is numeric; got a string value");
+    }
+  }
+}
+
+void require_arity(const Predicate &predicate) {
+  if (predicate.op == Predicate::Op::Equal && predicate.values.size() != 1) {
+    throw std::invalid_argument("'=' predicate needs exactly one value");
+  }
+  if (predicate.op == Predicate::Op::Range && predicate.values.size() != 2) {
+    throw std::invalid_argument(
+        "Range predicate needs a lower and upper bound");
+  }
+}
+
+} // namespace
+
+AttributeColumn AttributeColumn::from_int64(std::vector<int64_t> values) {
+  AttributeColumn column;
+  column.type_ = AttributeType::Int64;
+  column.ints_ = std::move(values);
+  return column;
+}
+
+AttributeColumn AttributeColumn::from_float(std::vector<float> values) {
+  AttributeColumn column;
+  column.type_ = AttributeType::Float;
+  column.floats_ = std::move(values);
+  return column;
+}
+
+AttributeColumn
+AttributeColumn::from_strings(const std::vector<std::string> &values) {
+  AttributeColumn column;
+  column.type_ = AttributeType::String;
+  column.codes_.reserve(values.size());
+
+  for (const auto &value : values) {
+    auto it = column.dictionary_index_.find(value);
+    if (it == column.dictionary_index_.end()) {
+      uint32_t code = column.dictionary_.size();
+      column.dictionary_.push_back(value);
+      it = column.dictionary_index_.emplace(value, code).first;
+    }
+    column.codes_.push_back(it->second);
+  }
+
+  return column;
+}
+
+size_t AttributeColumn::size() const {
+  switch (type_) {
+  case AttributeType::Int64:
+    return ints_.size();
+  case AttributeType::Float:
+    return floats_.size();
+  case AttributeType::String:
+    return codes_.size();
+  }
+  return 0;
+}
+
+void AttributeColumn::match(const Predicate &predicate, Bitmap &out) const {
+  require_arity(predicate);
+
+  switch (type_) {
+  case AttributeType::Int64:
+    match_int64(predicate, out);
+    break;
+  case AttributeType::Float:
+    match_float(predicate, out);
+    break;
+  case AttributeType::String:
+    match_string(predicate, out);
+    break;
+  }
+}
+
+void AttributeColumn::match_int64(const Predicate &predicate,
+                                  Bitmap &out) const {
+  require_numeric(predicate);
+  size_t rows = ints_.size();
+
+  if (predicate.op == Predicate::Op::Range) {
+    const auto &lo = predicate.values[0];
+    const auto &hi = predicate.values[1];
+
+    // Compare in the integer domain when possible to stay exact above 2^53
+    if (std::holds_alternative<int64_t>(lo) &&
+        std::holds_alternative<int64_t>(hi)) {
+      int64_t lo_i = std::get<int64_t>(lo);
+      int64_t hi_i = std::get<int64_t>(hi);
+      for (size_t i = 0; i < rows; i++) {
+        if (ints_[i] >= lo_i && ints_[i] <= hi_i)
+          out.set(i);
+      }
+      return;
+    }
+
+    double lo_d = to_double(lo);
+    double hi_d = to_double(hi);
+    for (size_t i = 0; i < rows; i++) {
+      double v = static_cast<double>(ints_[i]);
+      if (v >= lo_d && v <= hi_d)
+        out.set(i);
+    }
+    return;
+  }
+
+  // Equal / In: keep only values that are exactly representable as int64
+  std::vector<int64_t> wanted;
+  for (const auto &value : predicate.values) {
+    if (auto v = std::get_if<int64_t>(&value)) {
+      wanted.push_back(*v);
+    } else {
+      double d = std::get<double>(value);
+      if (d >= -9.2e18 && d <= 9.2e18 &&
+          d == static_cast<double>(static_cast<int64_t>(d)))
+        wanted.push_back(static_cast<int64_t>(d));
+    }
+  }
+
+  std::sort(wanted.begin(), wanted.end());
+  wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+  if (wanted.size() == 1) {
+    int64_t target = wanted[0];
+    for (size_t i = 0; i < rows; i++) {
+      if (ints_[i] == target)
+        out.set(i);
+    }
+  } else if (!wanted.empty()) {
+    for (size_t i = 0; i < rows; i++) {
+      if (std::binary_search(wanted.begin(), wanted.end(), ints_[i]))
+        out.set(i);
+    }
+  }
+}
+
+void AttributeColumn::match_float(const Predicate &predicate,
+                                  Bitmap &out) const {
+  require_numeric(predicate);
+  size_t rows = floats_.size();
+
+  if (predicate.op == Predicate::Op::Range) {
+    double lo = to_double(predicate.values[0]);
+    double hi = to_double(predicate.values[1]);
+    for (size_t i = 0; i < rows; i++) {
+      double v = floats_[i];
+      if (v >= lo && v <= hi)
+        out.set(i);
+    }
+    return;
+  }
+
+  // Values are compared at float precision, matching what is stored
+  std::vector<float> wanted;
+  for (const auto &value : predicate.values) {
+    wanted.push_back(static_cast<float>(to_double(value)));
+  }
+
+  for (size_t i = 0; i < rows; i++) {
+    if (std::find(wanted.begin(), wanted.end(), floats_[i]) != wanted.end())
+      out.set(i);
+  }
+}
+
+void AttributeColumn::match_string(const Predicate &predicate,
+                                   Bitmap &out) const {
+  if (predicate.op == Predicate::Op::Range) {
+    throw std::invalid_argument("Range predicates are not supported on "
+                                "string column '" +
+                                predicate.column + "'");
+  }
+
+  // Translate the wanted strings to dictionary codes once, then the scan
+  // only does a table lookup per row.
+  std::vector<char> wanted(dictionary_.size(), 0);
+  bool any = false;
+  for (const auto &value : predicate.values) {
+    auto s = std::get_if<std::string>(&value);
+    if (!s) {
+      throw std::invalid_argument("Column '" + predicate.column +
+                                  "' holds strings; got a numeric value");
+    }
+    auto it = dictionary_index_.find(*s);
+    if (it != dictionary_index_.end()) {
+      wanted[it->second] = 1;
+      any = true;
+    }
+  }
+
+  if (!any)
+    return;
+
+  for (size_t i = 0; i < codes_.size(); i++) {
+    if (wanted[codes_[i]])
+      out.set(i);
+  }
+}
+
+void AttributeColumn::save(std::ostream &out) const {
+  int type = static_cast<int>(type_);
+  int64_t rows = size();
+  out.write(reinterpret_cast<const char *>(&type), sizeof(int));
+  out.write(reinterpret_cast<const char *>(&rows), sizeof(int64_t));
+
+  switch (type_) {
+  case AttributeType::Int64:
+    out.write(reinterpret_cast<const char *>(ints_.data()),
+              rows * sizeof(int64_t));
+    break;
+  case AttributeType::Float:
+    out.write(reinterpret_cast<const char *>(floats_.data()),
+              rows * sizeof(float));
+    break;
+  case AttributeType::String: {
+    int dict_size = dictionary_.size();
+    out.write(reinterpret_cast<const char *>(&dict_size), sizeof(int));
+    for (const auto &value : dictionary_) {
+      int len = value.size();
+      out.write(reinterpret_cast<const char *>(&len), sizeof(int));
+      out.write(value.data(), len);
+    }
+    out.write(reinterpret_cast<const char *>(codes_.data()),
+              rows * sizeof(uint32_t));
+    break;
+  }
+  }
+}
+
+void AttributeColumn::load(std::istream &in) {
+  int type;
+  int64_t rows;
+  in.read(reinterpret_cast<char *>(&type), sizeof(int));
+  in.read(reinterpret_cast<char *>(&rows), sizeof(int64_t));
+  type_ = static_cast<AttributeType>(type);
+
+  switch (type_) {
+  case AttributeType::Int64:
+    ints_.resize(rows);
+    in.read(reinterpret_cast<char *>(ints_.data()), rows * sizeof(int64_t));
+    break;
+  case AttributeType::Float:
+    floats_.resize(rows);
+    in.read(reinterpret_cast<char *>(floats_.data()), rows * sizeof(float));
+    break;
+  case AttributeType::String: {
+    int dict_size;
+    in.read(reinterpret_cast<char *>(&dict_size), sizeof(int));
+    dictionary_.resize(dict_size);
+    dictionary_index_.clear();
+    for (int i = 0; i < dict_size; i++) {
+      int len;
+      in.read(reinterpret_cast<char *>(&len), sizeof(int));
+      dictionary_[i].resize(len);
+      in.read(&dictionary_[i][0], len);
+      dictionary_index_.emplace(dictionary_[i], i);
+    }
+    codes_.resize(rows);
+    in.read(reinterpret_cast<char *>(codes_.data()), rows * sizeof(uint32_t));
+    break;
+  }
+  }
+}
@@ -0,0 +1,344 @@
+// src/storage/DatasetLoader.cpp
+
+#include "storage/DatasetLoader.hpp"
+#include "utils/MappedFile.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rows converted per sink call for non-float32 or prefixed layouts
+constexpr size_t kChunkRows = 16384;
+
+enum class ElementType { Float32, Float64, UInt8, Int32, Int64 };
+
+size_t element_size(ElementType type) {
+  switch (type) {
+  case ElementType::Float32:
+  case ElementType::Int32:
+    return 4;
+  case ElementType::Float64:
+  case ElementType::Int64:
+    return 8;
+  case ElementType::UInt8:
+    return 1;
+  }
+  return 1;
+}
+
+bool is_integer(ElementType type) {
+  return type == ElementType::Int32 || type == ElementType::Int64;
+}
+
+/**
+ * @brief Where the rows are inside the file. Row i starts at
+ * offset + i * stride; TEXMEX files carry a 4-byte dimension prefix
+ * (`prefix`) in front of each row's payload.
+ */
+struct Layout {
+  DatasetInfo info;
+  ElementType element = ElementType::Float32;
+  size_t offset = 0;
+  size_t stride = 0;
+  size_t prefix = 0;
+};
+
+bool ends_with(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// =========================================================
+// SECTION: TEXMEX (.fvecs / .bvecs / .ivecs)
+// =========================================================
+
+Layout parse_vecs(const MappedFile &file, DatasetFormat format,
+                  const std::string &path) {
+  Layout layout;
+  layout.info.format = format;
+  layout.element = format == DatasetFormat::Bvecs   ? ElementType::UInt8
+                   : format == DatasetFormat::Ivecs ? ElementType::Int32
+                                                    : ElementType::Float32;
+  layout.prefix = sizeof(int32_t);
+
+  if (file.size() == 0)
+    return layout;
+
+  if (file.size() < sizeof(int32_t))
+    throw std::runtime_error("Truncated vector file: " + path);
+
+  int32_t dim;
+  std::memcpy(&dim, file.data(), sizeof(int32_t));
+  if (dim <= 0)
+    throw std::runtime_error("Invalid dimension in " + path);
+
+  layout.info.dim = dim;
+  layout.stride = layout.prefix + dim * element_size(layout.element);
+  if (file.size() % layout.stride != 0) {
+    throw std::runtime_error("Size of " + path +
+                             " is not a multiple of its record size");
+  }
+  layout.info.rows = file.size() / layout.stride;
+  return layout;
+}
+
+// =========================================================
+// SECTION: NumPy (.npy)
+// Header: magic "\x93NUMPY", version, header length, then a Python dict
+// literal such as {'descr': '<f4', 'fortran_order': False, 'shape': (n, d), }
+// =========================================================
+
+std::string header_value(const std::string &header, const std::string &key) {
+  size_t pos = header.find("'" + key + "'");
+  if (pos == std::string::npos)
+    return "";
+  pos = header.find(':', pos);
+  if (pos == std::string::npos)
+    return "";
+  size_t begin = header.find_first_not_of(' ', pos + 1);
+  if (begin == std::string::npos)
+    return "";
+
+  // Quoted string, tuple, or bare word (True/False)
+  char open = header[begin];
+  size_t end;
+  if (open == '\'') {
+    end = header.find('\'', begin + 1);
+    return end == std::string::npos ? ""
+                                    : header.substr(begin + 1, end - begin - 1);
+  }
+  if (open == '(') {
+    end = header.find(')', begin);
+    return end == std::string::npos ? ""
+                                    : header.substr(begin + 1, end - begin - 1);
+  }
+  end = header.find_first_of(",}", begin);
+  return header.substr(begin, end - begin);
+}
+
+Layout parse_npy(const MappedFile &file, const std::string &path) {
+  const unsigned char *data = file.data();
+  if (file.size() < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0)
+    throw std::runtime_error("Not a .npy file: " + path);
+
+  uint8_t major = data[6];
+  size_t header_len, header_start;
+  if (major == 1) {
+    uint16_t len;
+    std::memcpy(&len, data + 8, sizeof(len));
+    header_len = len;
+    header_start = 10;
+  } else {
+    if (file.size() < 12)
+      throw std::runtime_error("Truncated .npy header: " + path);
+    uint32_t len;
+    std::memcpy(&len, data + 8, sizeof(len));
+    header_len = len;
+    header_start = 12;
+  }
+  if (header_start + header_len > file.size())
+    throw std::runtime_error("Truncated .npy header: " + path);
+
+  std::string header(reinterpret_cast<const char *>(data + header_start),
+                     header_len);
+
+  Layout layout;
+  layout.info.format = DatasetFormat::Npy;
+  layout.offset = header_start + header_len;
+
+  std::string descr = header_value(header, "descr");
+  if (descr == "<f4" || descr == "=f4") {
+    layout.element = ElementType::Float32;
+  } else if (descr == "<f8" || descr == "=f8") {
+    layout.element = ElementType::Float64;
+  } else if (descr == "|u1" || descr == "<u1") {
+    layout.element = ElementType::UInt8;
+  } else if (descr == "<i4" || descr == "=i4") {
+    layout.element = ElementType::Int32;
+  } else if (descr == "<i8" || descr == "=i8") {
+    layout.element = ElementType::Int64;
+  } else {
+    throw std::runtime_error("Unsupported .npy dtype '" + descr +
+                             "' in " + path);
+  }
+
+  if (header_value(header, "fortran_order") == "True")
+    throw std::runtime_error("Fortran-ordered .npy is not supported: " + path);
+
+  // "n, d" for 2D, "d," for a single vector
+  std::vector<size_t> shape;
+  std::string dims = header_value(header, "shape");
+  size_t pos = 0;
+  while (pos < dims.size()) {
+    size_t next = dims.find(',', pos);
+    std::string token = dims.substr(pos, next == std::string::npos
+                                             ? std::string::npos
+                                             : next - pos);
+    token.erase(std::remove(token.begin(), token.end(), ' '), token.end());
+    if (!token.empty())
+      shape.push_back(std::stoull(token));
+    if (next == std::string::npos)
+      break;
+    pos = next + 1;
+  }
+
+  if (shape.size() == 1) {
+    layout.info.rows = 1;
+    layout.info.dim = shape[0];
+  } else if (shape.size() == 2) {
+    layout.info.rows = shape[0];
+    layout.info.dim = shape[1];
+  } else {
+    throw std::runtime_error(".npy array must be 1D or 2D: " + path);
+  }
+
+  layout.stride = layout.info.dim * element_size(layout.element);
+  if (layout.offset + layout.info.rows * layout.stride > file.size())
+    throw std::runtime_error("Truncated .npy data: " + path);
+  return layout;
+}
+
+Layout parse_layout(const MappedFile &file, DatasetFormat format,
+                    const std::string &path) {
+  if (format == DatasetFormat::Npy)
+    return parse_npy(file, path);
+  return parse_vecs(file, format, path);
+}
+
+// Copies one record's payload to `out` as float, validating the TEXMEX
+// dimension prefix on the way.
+void convert_row(const unsigned char *record, const Layout &layout,
+                 float *out, const std::string &path) {
+  if (layout.prefix) {
+    int32_t dim;
+    std::memcpy(&dim, record, sizeof(int32_t));
+    if (static_cast<size_t>(dim) != layout.info.dim)
+      throw std::runtime_error("Inconsistent dimension in " + path);
+  }
+
+  const unsigned char *payload = record + layout.prefix;
+  size_t dim = layout.info.dim;
+  switch (layout.element) {
+  case ElementType::Float32:
+    std::memcpy(out, payload, dim * sizeof(float));
+    break;
+  case ElementType::UInt8:
+    for (size_t d = 0; d < dim; d++)
+      out[d] = payload[d];
+    break;
+  case ElementType::Float64:
+    for (size_t d = 0; d < dim; d++) {
+      double value;
+      std::memcpy(&value, payload + d * sizeof(double), sizeof(double));
+      out[d] = static_cast<float>(value);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace
+
+DatasetFormat dataset_format(const std::string &path) {
+  if (ends_with(path, ".fvecs"))
+    return DatasetFormat::Fvecs;
+  if (ends_with(path, ".bvecs"))
+    return DatasetFormat::Bvecs;
+  if (ends_with(path, ".ivecs"))
+    return DatasetFormat::Ivecs;
+  if (ends_with(path, ".npy"))
+    return DatasetFormat::Npy;
+  throw std::invalid_argument(
+      "Unknown dataset format (expected .fvecs/.bvecs/.ivecs/.npy): " + path);
+}
+
+DatasetInfo probe_dataset(const std::string &path) {
+  DatasetFormat format = dataset_format(path);
+  MappedFile file(path);
+  return parse_layout(file, format, path).info;
+}
+
+DatasetInfo read_vectors(const std::string &path, const VectorSink &sink,
+                         size_t max_rows) {
+  DatasetFormat format = dataset_format(path);
+  MappedFile file(path);
+  Layout layout = parse_layout(file, format, path);
+  if (is_integer(layout.element)) {
+    throw std::invalid_argument(path +
+                                " holds integer ids; use read_ivecs instead");
+  }
+
+  size_t rows = layout.info.rows;
+  if (max_rows > 0)
+    rows = std::min(rows, max_rows);
+  layout.info.rows = rows;
+  if (rows == 0)
+    return layout.info;
+
+  file.advise_sequential();
+  const unsigned char *base = file.data() + layout.offset;
+  size_t dim = layout.info.dim;
+
+  // Contiguous float32 rows: hand the mapping over as-is
+  if (layout.prefix == 0 && layout.element == ElementType::Float32) {
+    sink(reinterpret_cast<const float *>(base), rows, dim);
+    return layout.info;
+  }
+
+  std::vector<float> chunk(std::min(rows, kChunkRows) * dim);
+  for (size_t begin = 0; begin < rows; begin += kChunkRows) {
+    size_t end = std::min(rows, begin + kChunkRows);
+    for (size_t i = begin; i < end; i++) {
+      convert_row(base + i * layout.stride, layout,
+                  chunk.data() + (i - begin) * dim, path);
+    }
+    sink(chunk.data(), end - begin, dim);
+  }
+  return layout.info;
+}
+
+std::vector<std::vector<int>> read_ivecs(const std::string &path,
+                                         size_t max_rows) {
+  DatasetFormat format = dataset_format(path);
+  MappedFile file(path);
+  Layout layout = parse_layout(file, format, path);
+  if (!is_integer(layout.element))
+    throw std::invalid_argument(path + " does not hold integer ids");
+
+  size_t rows = layout.info.rows;
+  if (max_rows > 0)
+    rows = std::min(rows, max_rows);
+
+  std::vector<std::vector<int>> result(rows);
+  const unsigned char *base = file.data() + layout.offset;
+  for (size_t i = 0; i < rows; i++) {
+    const unsigned char *record = base + i * layout.stride;
+    if (layout.prefix) {
+      int32_t dim;
+      std::memcpy(&dim, record, sizeof(int32_t));
+      if (static_cast<size_t>(dim) != layout.info.dim)
+        throw std::runtime_error("Inconsistent dimension in " + path);
+    }
+
+    const unsigned char *payload = record + layout.prefix;
+    result[i].resize(layout.info.dim);
+    for (size_t d = 0; d < layout.info.dim; d++) {
+      if (layout.element == ElementType::Int64) {
+        int64_t value;
+        std::memcpy(&value, payload + d * sizeof(int64_t), sizeof(int64_t));
+        result[i][d] = static_cast<int>(value);
+      } else {
+        int32_t value;
+        std::memcpy(&value, payload + d * sizeof(int32_t), sizeof(int32_t));
+        result[i][d] = value;
+      }
+    }
+  }
+  return result;
+}
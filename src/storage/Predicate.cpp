@@ -0,0 +1,60 @@
+// src/storage/Predicate.cpp
+
+#include "storage/Predicate.hpp"
+#include <sstream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+Predicate Predicate::equal(const std::string &column, AttributeValue value) {
+  Predicate predicate;
+  predicate.column = column;
+  predicate.op = Op::Equal;
+  predicate.values.push_back(std::move(value));
+  return predicate;
+}
+
+Predicate Predicate::in(const std::string &column,
+                        std::vector<AttributeValue> values) {
+  Predicate predicate;
+  predicate.column = column;
+  predicate.op = Op::In;
+  predicate.values = std::move(values);
+  return predicate;
+}
+
+Predicate Predicate::range(const std::string &column, AttributeValue lo,
+                           AttributeValue hi) {
+  Predicate predicate;
+  predicate.column = column;
+  predicate.op = Op::Range;
+  predicate.values.push_back(std::move(lo));
+  predicate.values.push_back(std::move(hi));
+  return predicate;
+}
+
+std::string Predicate::key() const {
+  static const char *op_names[] = {"=", "IN", "BETWEEN"};
+
+  std::ostringstream ss;
+  ss.precision(17);
+  ss << column << ' ' << op_names[static_cast<int>(op)] << " (";
+
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i > 0)
+      ss << ", ";
+    // Type tags keep 1 (int), 1.0 (float) and "1" (string) distinct
+    if (auto v = std::get_if<int64_t>(&values[i])) {
+      ss << "i:" << *v;
+    } else if (auto v = std::get_if<double>(&values[i])) {
+      ss << "f:" << *v;
+    } else {
+      const std::string &s = std::get<std::string>(values[i]);
+      ss << "s" << s.size() << ':' << s;
+    }
+  }
+
+  ss << ')';
+  return ss.str();
+}
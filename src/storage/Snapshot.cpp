@@ -0,0 +1,355 @@
+// src/storage/Snapshot.cpp
+
+#include "storage/Snapshot.hpp"
+#include "utils/Crc32c.hpp"
+#include "utils/Parallel.hpp"
+#ifdef VEGAMDB_WITH_ZSTD
+#include <zstd.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+std::string section_name(SectionId id) {
+  switch (id) {
+  case SectionId::Metadata:
+    return "metadata";
+  case SectionId::Vectors:
+    return "vectors";
+  case SectionId::Index:
+    return "index";
+  case SectionId::Attributes:
+    return "attributes";
+  case SectionId::Tombstones:
+    return "tombstones";
+  }
+  return "section " + std::to_string(static_cast<uint32_t>(id));
+}
+
+namespace {
+
+// Block size for section writes
+constexpr size_t kWriteChunk = size_t(1) << 20;
+
+// Fast setting: compression must not make snapshots CPU-bound
+constexpr int kZstdLevel = 1;
+
+uint32_t header_checksum(const FileHeader &header) {
+  return crc32c(&header, offsetof(FileHeader, header_crc));
+}
+
+} // namespace
+
+// =========================================================
+// SECTION: Compression
+// =========================================================
+
+bool compression_available(Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return true;
+  case Compression::Zstd:
+#ifdef VEGAMDB_WITH_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+std::vector<char> compress_section(std::vector<char> raw,
+                                   Compression compression) {
+  if (!compression_available(compression))
+    throw std::invalid_argument(
+        "This build of VegamDB does not support the requested compression "
+        "(rebuild with VEGAMDB_WITH_ZSTD=ON)");
+  if (compression == Compression::None)
+    return raw;
+
+#ifdef VEGAMDB_WITH_ZSTD
+  std::vector<char> out(ZSTD_compressBound(raw.size()));
+  size_t n = ZSTD_compress(out.data(), out.size(), raw.data(), raw.size(),
+                           kZstdLevel);
+  if (ZSTD_isError(n))
+    throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(n));
+  out.resize(n);
+  return out;
+#else
+  return raw;
+#endif
+}
+
+namespace {
+std::vector<char> decompress_section(const char *data, size_t size,
+                                     uint32_t flags) {
+  if (flags != static_cast<uint32_t>(Compression::Zstd))
+    throw std::runtime_error("Snapshot section has an unknown encoding");
+#ifdef VEGAMDB_WITH_ZSTD
+  unsigned long long raw_size = ZSTD_getFrameContentSize(data, size);
+  if (raw_size == ZSTD_CONTENTSIZE_ERROR ||
+      raw_size == ZSTD_CONTENTSIZE_UNKNOWN)
+    throw std::runtime_error("Snapshot section is not a valid zstd frame");
+  std::vector<char> out(raw_size);
+  size_t n = ZSTD_decompress(out.data(), out.size(), data, size);
+  if (ZSTD_isError(n) || n != raw_size)
+    throw std::runtime_error("Snapshot section failed to decompress");
+  return out;
+#else
+  (void)data;
+  (void)size;
+  throw std::runtime_error("Snapshot uses zstd compression, which this "
+                           "build does not support (VEGAMDB_WITH_ZSTD)");
+#endif
+}
+} // namespace
+
+// =========================================================
+// SECTION: Writing
+// =========================================================
+
+ChecksumWriteBuf::ChecksumWriteBuf() { buffer_.reserve(kWriteChunk); }
+
+void ChecksumWriteBuf::reset(std::streambuf *target) {
+  target_ = target;
+  buffer_.clear();
+  crc_ = 0;
+  size_ = 0;
+  failed_ = false;
+}
+
+std::streamsize ChecksumWriteBuf::xsputn(const char *s, std::streamsize n) {
+  size_t count = static_cast<size_t>(n);
+  if (buffer_.size() + count <= kWriteChunk) {
+    buffer_.insert(buffer_.end(), s, s + count);
+    return n;
+  }
+  if (!flush_buffer())
+    return 0;
+  if (count < kWriteChunk) {
+    buffer_.assign(s, s + count);
+    return n;
+  }
+  return write_through(s, count) ? n : 0;
+}
+
+ChecksumWriteBuf::int_type ChecksumWriteBuf::overflow(int_type ch) {
+  if (traits_type::eq_int_type(ch, traits_type::eof()))
+    return traits_type::not_eof(ch);
+  char c = traits_type::to_char_type(ch);
+  return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+int ChecksumWriteBuf::sync() { return flush_buffer() ? 0 : -1; }
+
+bool ChecksumWriteBuf::flush_buffer() {
+  bool ok = write_through(buffer_.data(), buffer_.size());
+  buffer_.clear();
+  return ok;
+}
+
+bool ChecksumWriteBuf::write_through(const char *s, size_t n) {
+  if (n == 0)
+    return !failed_;
+  std::streamsize written = target_->sputn(s, n);
+  crc_ = crc32c(s, static_cast<size_t>(written), crc_);
+  size_ += static_cast<uint64_t>(written);
+  if (static_cast<size_t>(written) != n)
+    failed_ = true;
+  return !failed_;
+}
+
+std::streamsize MemoryWriteStream::Buf::xsputn(const char *s,
+                                               std::streamsize n) {
+  bytes.insert(bytes.end(), s, s + n);
+  return n;
+}
+
+MemoryWriteStream::Buf::int_type
+MemoryWriteStream::Buf::overflow(int_type ch) {
+  if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    bytes.push_back(traits_type::to_char_type(ch));
+  return traits_type::not_eof(ch);
+}
+
+MemoryWriteStream::MemoryWriteStream() : std::ostream(nullptr) {
+  rdbuf(&buf_);
+}
+
+SnapshotWriter::SnapshotWriter(std::ostream &out)
+    : out_(out), section_stream_(nullptr) {
+  // Placeholder; finish() rewrites it once the directory is known
+  FileHeader header{};
+  write_raw(&header, sizeof(header));
+}
+
+std::ostream &SnapshotWriter::begin_section(SectionId id) {
+  if (in_section_)
+    throw std::logic_error("SnapshotWriter: section already open");
+  pad_to(kSectionAlignment);
+
+  SectionEntry entry{};
+  entry.id = static_cast<uint32_t>(id);
+  entry.offset = position_;
+  sections_.push_back(entry);
+
+  section_buf_.reset(out_.rdbuf());
+  section_stream_.rdbuf(&section_buf_);
+  section_stream_.clear();
+  in_section_ = true;
+  return section_stream_;
+}
+
+void SnapshotWriter::end_section() {
+  if (!in_section_)
+    throw std::logic_error("SnapshotWriter: no open section");
+  section_stream_.flush();
+  SectionEntry &entry = sections_.back();
+  entry.size = section_buf_.size();
+  entry.crc = section_buf_.crc();
+  position_ += entry.size;
+  if (!section_stream_ || section_buf_.failed())
+    out_.setstate(std::ios::badbit);
+  in_section_ = false;
+}
+
+void SnapshotWriter::add_section(SectionId id, const std::vector<char> &data,
+                                 uint32_t flags) {
+  if (in_section_)
+    throw std::logic_error("SnapshotWriter: section already open");
+  pad_to(kSectionAlignment);
+
+  SectionEntry entry{};
+  entry.id = static_cast<uint32_t>(id);
+  entry.flags = flags;
+  entry.offset = position_;
+  entry.size = data.size();
+  entry.crc = crc32c_parallel(data.data(), data.size(), default_num_threads());
+  sections_.push_back(entry);
+  write_raw(data.data(), data.size());
+}
+
+void SnapshotWriter::finish() {
+  if (in_section_)
+    end_section();
+  pad_to(alignof(SectionEntry));
+
+  FileHeader header{};
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.byte_order = kByteOrderMark;
+  header.section_count = static_cast<uint32_t>(sections_.size());
+  header.directory_offset = position_;
+  header.directory_crc =
+      crc32c(sections_.data(), sections_.size() * sizeof(SectionEntry));
+  header.header_crc = header_checksum(header);
+
+  write_raw(sections_.data(), sections_.size() * sizeof(SectionEntry));
+  out_.seekp(0);
+  out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out_.flush();
+
+  if (!out_)
+    throw std::runtime_error("SnapshotWriter: write failed");
+}
+
+void SnapshotWriter::write_raw(const void *data, size_t size) {
+  out_.write(static_cast<const char *>(data), size);
+  position_ += size;
+}
+
+void SnapshotWriter::pad_to(uint64_t alignment) {
+  static const char zeros[kSectionAlignment] = {};
+  uint64_t padding = (alignment - position_ % alignment) % alignment;
+  write_raw(zeros, padding);
+}
+
+// =========================================================
+// SECTION: Reading
+// =========================================================
+
+MemoryReadBuf::MemoryReadBuf(const char *data, size_t size) {
+  // The get area is never written through; streambuf just wants char*
+  char *begin = const_cast<char *>(data);
+  setg(begin, begin, begin + size);
+}
+
+SectionStream::SectionStream(const char *data, size_t size)
+    : std::istream(nullptr), buf_(data, size) {
+  rdbuf(&buf_);
+}
+
+bool SnapshotReader::is_snapshot(const unsigned char *data, size_t size) {
+  return size >= sizeof(kSnapshotMagic) &&
+         std::memcmp(data, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0;
+}
+
+SnapshotReader::SnapshotReader(const unsigned char *data, size_t size)
+    : data_(data), size_(size) {
+  if (!is_snapshot(data, size) || size < sizeof(FileHeader))
+    throw std::runtime_error("Not a VegamDB snapshot");
+  std::memcpy(&header_, data, sizeof(header_));
+
+  if (header_.byte_order != kByteOrderMark)
+    throw std::runtime_error(
+        "Snapshot was written on a machine with a different byte order");
+  if (header_.header_crc != header_checksum(header_))
+    throw std::runtime_error("Snapshot header is corrupt (checksum mismatch)");
+  if (header_.version > kSnapshotVersion)
+    throw std::runtime_error("Snapshot version " +
+                             std::to_string(header_.version) +
+                             " is newer than this build supports");
+
+  uint64_t directory_bytes =
+      uint64_t(header_.section_count) * sizeof(SectionEntry);
+  if (header_.directory_offset > size_ ||
+      directory_bytes > size_ - header_.directory_offset)
+    throw std::runtime_error("Snapshot is truncated");
+
+  sections_.resize(header_.section_count);
+  std::memcpy(sections_.data(), data_ + header_.directory_offset,
+              directory_bytes);
+  if (crc32c(sections_.data(), directory_bytes) != header_.directory_crc)
+    throw std::runtime_error(
+        "Snapshot section directory is corrupt (checksum mismatch)");
+
+  for (const SectionEntry &entry : sections_) {
+    if (entry.offset > size_ || entry.size > size_ - entry.offset)
+      throw std::runtime_error("Snapshot is truncated");
+  }
+}
+
+const SectionEntry *SnapshotReader::find(SectionId id) const {
+  for (const SectionEntry &entry : sections_) {
+    if (entry.id == static_cast<uint32_t>(id))
+      return &entry;
+  }
+  return nullptr;
+}
+
+SectionData SnapshotReader::section(const SectionEntry *entry) const {
+  if (!entry)
+    return SectionData();
+  const char *data = reinterpret_cast<const char *>(data_ + entry->offset);
+  if (entry->flags == static_cast<uint32_t>(Compression::None))
+    return SectionData(data, entry->size);
+  return SectionData(decompress_section(data, entry->size, entry->flags));
+}
+
+void SnapshotReader::verify() const {
+  size_t n_threads = default_num_threads();
+  for (const SectionEntry &entry : sections_) {
+    uint32_t crc =
+        crc32c_parallel(data_ + entry.offset, entry.size, n_threads);
+    if (crc != entry.crc) {
+      throw std::runtime_error(
+          "Snapshot section '" + section_name(SectionId(entry.id)) +
+          "' is corrupt (checksum mismatch)");
+    }
+  }
+}
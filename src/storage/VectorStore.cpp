@@ -1,73 +1,342 @@
 // src/storage/VectorStore.cpp
 
 #include "storage/VectorStore.hpp"
+#include "utils/Distance.hpp"
+#include "utils/Numa.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
-#include <fstream>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
-void VectorStore::add(const std::vector<float> &vec) {
-  if (data_.empty()) {
-    this->dimension_ = vec.size();
-  }
+namespace {
+// Bound on cached predicate bitmaps; each costs size()/8 bytes.
+constexpr size_t kMaxCachedPredicates = 64;
+
+// Batches above this many bytes are copied by several threads; each thread
+// gets at least kBytesPerCopyThread so small batches stay single-threaded.
+constexpr size_t kParallelCopyBytes = size_t(64) << 20;
+constexpr size_t kBytesPerCopyThread = size_t(16) << 20;
+} // namespace
 
-  this->data_.push_back(vec);
+void VectorStore::add(const std::vector<float> &vec) {
+  add_vector_from_pointer(vec.data(), 1, vec.size());
 }
 
 void VectorStore::add_vector_from_pointer(const float *arr, size_t n_vectors,
                                           size_t dim) {
+  check_add(dim);
+  if (n_vectors == 0)
+    return;
 
-  if (data_.empty()) {
+  if (this->rows_ == 0)
     this->dimension_ = dim;
+
+  // One resize for the whole batch; existing rows move at most once
+  size_t offset = this->rows_ * dim;
+  this->data_.resize(offset + n_vectors * dim);
+  float *dst = this->data_.data() + offset;
+
+  bool normalize_rows = this->normalize_on_insert_;
+  auto copy_rows = [&](size_t begin, size_t end) {
+    std::memcpy(dst + begin * dim, arr + begin * dim,
+                (end - begin) * dim * sizeof(float));
+    if (normalize_rows) {
+      for (size_t i = begin; i < end; i++) {
+        normalize(dst + i * dim, dim);
+      }
+    }
+  };
+
+  size_t bytes = n_vectors * dim * sizeof(float);
+  size_t n_threads = 1;
+  if (bytes >= kParallelCopyBytes) {
+    n_threads = std::min(default_num_threads(), bytes / kBytesPerCopyThread);
   }
+  parallel_for(n_vectors, n_threads, copy_rows);
+
+  this->rows_ += n_vectors;
+  if (this->live_.size() > 0)
+    this->live_.resize(this->rows_, true);
+  invalidate_predicate_cache();
+  place_on_numa_nodes();
+}
 
-  for (int i = 0; i < n_vectors; i++) {
-    std::vector<float> temp(arr + i * dim, arr + i * dim + dim);
+void VectorStore::place_on_numa_nodes() {
+  if (!numa_active() || is_external())
+    return;
+  if (this->data_.data() == this->numa_placed_data_ &&
+      this->rows_ < this->numa_placed_rows_ + this->numa_placed_rows_ / 8)
+    return;
+  numa_bind_rows(this->data_.data(), this->rows_, this->dimension_);
+  this->numa_placed_data_ = this->data_.data();
+  this->numa_placed_rows_ = this->rows_;
+}
 
-    this->data_.push_back(temp);
+void VectorStore::check_add(size_t dim) const {
+  if (is_external()) {
+    throw std::runtime_error(
+        "Store wraps an external buffer and is read-only");
+  }
+
+  if (this->rows_ > 0 && dim != static_cast<size_t>(this->dimension_)) {
+    throw std::invalid_argument(
+        "Vector dimension mismatch: store has " +
+        std::to_string(this->dimension_) + ", got " + std::to_string(dim));
   }
 }
 
-const std::vector<float> &VectorStore::get(int idx) const {
-  return this->data_[idx];
+void VectorStore::attach_external(const float *data, size_t n_vectors,
+                                  size_t dim,
+                                  std::shared_ptr<const void> owner) {
+  if (this->rows_ > 0) {
+    throw std::runtime_error(
+        "Cannot attach an external buffer to a non-empty store");
+  }
+
+  if (this->normalize_on_insert_) {
+    // The rows are not ours to rewrite, so verify instead of normalizing
+    std::atomic<bool> unit_norm{true};
+    auto check_rows = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end && unit_norm; i++) {
+        const float *row = data + i * dim;
+        float norm_sqr = inner_product(row, row, dim);
+        if (norm_sqr != 0.0f && std::fabs(norm_sqr - 1.0f) > 1e-3f)
+          unit_norm = false;
+      }
+    };
+    parallel_for(n_vectors, default_num_threads(), check_rows);
+    if (!unit_norm) {
+      throw std::invalid_argument(
+          "Cosine databases need unit-norm rows in an external buffer");
+    }
+  }
+
+  this->data_.clear();
+  this->data_.shrink_to_fit();
+  this->external_ = data;
+  this->external_owner_ = std::move(owner);
+  this->rows_ = n_vectors;
+  this->dimension_ = dim;
+  this->live_ = Bitmap();
+  invalidate_predicate_cache();
 }
 
-const std::vector<std::vector<float>> &VectorStore::data() const {
-  return this->data_;
+void VectorStore::truncate(size_t n_rows) {
+  if (is_external() || n_rows >= this->rows_)
+    return;
+  this->data_.resize(n_rows * this->dimension_);
+  this->rows_ = n_rows;
+  this->numa_placed_rows_ = std::min(this->numa_placed_rows_, n_rows);
+  if (this->live_.size() > 0)
+    this->live_.resize(this->rows_);
+  invalidate_predicate_cache();
 }
 
-int VectorStore::size() const { return this->data_.size(); }
+void VectorStore::clear() {
+  this->data_.clear();
+  this->data_.shrink_to_fit();
+  this->external_ = nullptr;
+  this->external_owner_.reset();
+  this->rows_ = 0;
+  this->dimension_ = 0;
+  this->live_ = Bitmap();
+  this->attributes_.clear();
+  invalidate_predicate_cache();
+}
+
+void VectorStore::swap(VectorStore &other) {
+  using std::swap;
+  swap(this->data_, other.data_);
+  swap(this->rows_, other.rows_);
+  swap(this->dimension_, other.dimension_);
+  swap(this->numa_placed_data_, other.numa_placed_data_);
+  swap(this->numa_placed_rows_, other.numa_placed_rows_);
+  swap(this->external_, other.external_);
+  swap(this->external_owner_, other.external_owner_);
+  swap(this->normalize_on_insert_, other.normalize_on_insert_);
+  swap(this->live_, other.live_);
+  swap(this->attributes_, other.attributes_);
+  invalidate_predicate_cache();
+  other.invalidate_predicate_cache();
+}
+
+void VectorStore::reserve(size_t n_vectors, size_t dim) {
+  if (is_external())
+    return;
+  this->data_.reserve(this->data_.size() + n_vectors * dim);
+}
+
+const float *VectorStore::get(int idx) const {
+  return data().row(idx);
+}
+
+MatrixView VectorStore::data() const {
+  MatrixView view;
+  view.data = this->external_ ? this->external_ : this->data_.data();
+  view.rows = this->rows_;
+  view.dim = this->dimension_;
+  return view;
+}
+
+int VectorStore::size() const { return this->rows_; }
 
 int VectorStore::dimension() const { return this->dimension_; }
 
-void VectorStore::save(std::ofstream &out) const {
-  int rows = this->data_.size(); // # vectors
+void VectorStore::remove(const std::vector<int> &ids) {
+  for (int id : ids) {
+    if (id < 0 || static_cast<size_t>(id) >= this->rows_) {
+      throw std::invalid_argument("Cannot remove id " + std::to_string(id) +
+                                  ": store has " +
+                                  std::to_string(this->rows_) + " vectors");
+    }
+  }
 
-  // Guard Clause: If DB is empty, don't create a file. Just return.
-  if (rows == 0)
-    return;
+  if (this->live_.size() == 0 && !ids.empty())
+    this->live_.resize(this->rows_, true);
+  for (int id : ids) {
+    this->live_.reset(id);
+  }
+}
 
-  int cols = this->data_[0].size(); // Dimensions
+bool VectorStore::is_deleted(int id) const {
+  return id >= 0 && static_cast<size_t>(id) < this->live_.size() &&
+         !this->live_.contains(id);
+}
+
+size_t VectorStore::deleted_count() const {
+  return this->live_.size() - this->live_.count();
+}
+
+std::vector<int> VectorStore::deleted_ids() const {
+  std::vector<int> ids;
+  ids.reserve(deleted_count());
+  for (size_t id = 0; id < this->live_.size(); id++) {
+    if (!this->live_.contains(id))
+      ids.push_back(static_cast<int>(id));
+  }
+  return ids;
+}
+
+void VectorStore::set_attribute(const std::string &name,
+                                AttributeColumn column) {
+  this->attributes_[name] = std::move(column);
+  invalidate_predicate_cache();
+}
+
+bool VectorStore::has_attribute(const std::string &name) const {
+  return this->attributes_.count(name) > 0;
+}
+
+std::vector<std::string> VectorStore::attribute_names() const {
+  std::vector<std::string> names;
+  for (const auto &entry : this->attributes_) {
+    names.push_back(entry.first);
+  }
+  return names;
+}
+
+std::shared_ptr<const Bitmap>
+VectorStore::evaluate(const Predicate &predicate) const {
+  std::string key = predicate.key();
+
+  {
+    std::lock_guard<std::mutex> lock(predicate_cache_mutex_);
+    auto it = predicate_cache_.find(key);
+    if (it != predicate_cache_.end())
+      return it->second;
+  }
+
+  auto column = this->attributes_.find(predicate.column);
+  if (column == this->attributes_.end()) {
+    throw std::invalid_argument("Unknown attribute column '" +
+                                predicate.column + "'");
+  }
+
+  auto bitmap = std::make_shared<Bitmap>(this->rows_);
+  column->second.match(predicate, *bitmap);
+
+  std::lock_guard<std::mutex> lock(predicate_cache_mutex_);
+  if (predicate_cache_.size() >= kMaxCachedPredicates)
+    predicate_cache_.clear();
+  predicate_cache_[key] = bitmap;
+  return bitmap;
+}
+
+void VectorStore::invalidate_predicate_cache() {
+  std::lock_guard<std::mutex> lock(predicate_cache_mutex_);
+  predicate_cache_.clear();
+}
+
+void VectorStore::save(std::ostream &out) const {
+  // An empty store still writes its (0, dim) header so load() stays in step
+  int rows = this->rows_;      // # vectors
+  int cols = this->dimension_; // Dimensions
 
   out.write(reinterpret_cast<const char *>(&rows), sizeof(int));
   out.write(reinterpret_cast<const char *>(&cols), sizeof(int));
 
-  for (const auto &vector : data_) {
-    out.write(reinterpret_cast<const char *>(vector.data()),
-              dimension_ * sizeof(float));
-  }
+  // Rows are contiguous, so the whole matrix goes out in one write
+  out.write(reinterpret_cast<const char *>(data().data),
+            this->rows_ * this->dimension_ * sizeof(float));
 }
 
-void VectorStore::load(std::ifstream &in) {
+void VectorStore::load(std::istream &in) {
   int rows, cols;
   in.read(reinterpret_cast<char *>(&rows), sizeof(int));
   in.read(reinterpret_cast<char *>(&cols), sizeof(int));
+  if (!in || rows < 0 || cols < 0)
+    throw std::runtime_error("VectorStore::load: corrupt vector header");
+
+  // A loaded store always owns its rows
+  this->external_ = nullptr;
+  this->external_owner_.reset();
 
   this->dimension_ = cols;
-  data_.resize(rows);
+  this->rows_ = rows;
+  this->live_ = Bitmap();
+  this->data_.resize(static_cast<size_t>(rows) * cols);
+  in.read(reinterpret_cast<char *>(this->data_.data()),
+          this->data_.size() * sizeof(float));
+  invalidate_predicate_cache();
+  place_on_numa_nodes();
+}
 
-  for (int i = 0; i < rows; i++) {
-    data_[i].resize(dimension_);
-    in.read(reinterpret_cast<char *>(data_[i].data()),
-            dimension_ * sizeof(float));
+void VectorStore::save_attributes(std::ostream &out) const {
+  int n_columns = this->attributes_.size();
+  out.write(reinterpret_cast<const char *>(&n_columns), sizeof(int));
+
+  for (const auto &entry : this->attributes_) {
+    int name_len = entry.first.size();
+    out.write(reinterpret_cast<const char *>(&name_len), sizeof(int));
+    out.write(entry.first.data(), name_len);
+    entry.second.save(out);
+  }
+}
+
+void VectorStore::load_attributes(std::istream &in) {
+  this->attributes_.clear();
+  invalidate_predicate_cache();
+
+  // Files written before attributes existed simply end here
+  int n_columns = 0;
+  if (!in.read(reinterpret_cast<char *>(&n_columns), sizeof(int)))
+    return;
+
+  for (int i = 0; i < n_columns; i++) {
+    int name_len;
+    in.read(reinterpret_cast<char *>(&name_len), sizeof(int));
+    std::string name(name_len, '\0');
+    in.read(&name[0], name_len);
+    this->attributes_[name].load(in);
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,176 @@
+// src/storage/WriteAheadLog.cpp
+
+#include "storage/WriteAheadLog.hpp"
+#include "utils/Crc32c.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint32_t header_checksum(const WalRecordHeader &header) {
+  return crc32c(&header, offsetof(WalRecordHeader, header_crc));
+}
+
+uint32_t payload_checksum(const void *payload, size_t bytes) {
+  return crc32c_parallel(payload, bytes, default_num_threads());
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string &path, uint64_t min_lsn,
+                             bool sync)
+    : path_(path), last_lsn_(min_lsn), sync_(sync) {
+  bool existed = file_exists(path);
+  if (existed) {
+    this->size_ = replay(path, [this](const WalRecord &record) {
+      this->last_lsn_ = std::max(this->last_lsn_, record.lsn);
+    });
+    // Drop a torn tail so new records are not hidden behind it
+    truncate_file(path, this->size_);
+  }
+
+  this->file_ = std::fopen(path.c_str(), "ab");
+  if (!this->file_)
+    throw std::runtime_error("Cannot open write-ahead log " + path);
+
+  try {
+    if (this->size_ == 0) {
+      if (std::fwrite(kWalMagic, sizeof(kWalMagic), 1, this->file_) != 1)
+        throw std::runtime_error("Cannot write write-ahead log " + path);
+      sync_stream(this->file_);
+      this->size_ = sizeof(kWalMagic);
+    }
+    if (!existed)
+      sync_parent_directory(path);
+  } catch (...) {
+    std::fclose(this->file_);
+    throw;
+  }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  if (this->file_)
+    std::fclose(this->file_);
+}
+
+uint64_t WriteAheadLog::append_add(const float *vectors, size_t n_vectors,
+                                   size_t dim) {
+  return append(WalOp::Add, n_vectors, static_cast<uint32_t>(dim), vectors,
+                n_vectors * dim * sizeof(float));
+}
+
+uint64_t WriteAheadLog::append_remove(const std::vector<int> &ids) {
+  return append(WalOp::Remove, ids.size(), 0, ids.data(),
+                ids.size() * sizeof(int));
+}
+
+uint64_t WriteAheadLog::append(WalOp op, uint64_t count, uint32_t dim,
+                               const void *payload, size_t payload_bytes) {
+  WalRecordHeader header;
+  header.lsn = this->last_lsn_ + 1;
+  header.count = count;
+  header.dim = dim;
+  header.op = static_cast<uint32_t>(op);
+  header.payload_crc = payload_checksum(payload, payload_bytes);
+  header.header_crc = header_checksum(header);
+
+  bool ok = std::fwrite(&header, sizeof(header), 1, this->file_) == 1 &&
+            std::fwrite(payload, 1, payload_bytes, this->file_) ==
+                payload_bytes;
+  try {
+    if (ok && this->sync_)
+      sync_stream(this->file_);
+    else if (ok)
+      ok = std::fflush(this->file_) == 0;
+  } catch (const std::runtime_error &) {
+    ok = false;
+  }
+
+  if (!ok) {
+    // Cut the partial record; a failed rollback leaves a torn tail, which
+    // the next open truncates anyway
+    std::fflush(this->file_);
+    std::clearerr(this->file_);
+    try {
+      truncate_file(this->path_, this->size_);
+    } catch (const std::runtime_error &) {
+    }
+    throw std::runtime_error("Cannot append to write-ahead log " +
+                             this->path_);
+  }
+
+  this->size_ += sizeof(header) + payload_bytes;
+  return ++this->last_lsn_;
+}
+
+void WriteAheadLog::clear() {
+  std::fflush(this->file_);
+  truncate_file(this->path_, sizeof(kWalMagic));
+  sync_stream(this->file_);
+  this->size_ = sizeof(kWalMagic);
+}
+
+uint64_t
+WriteAheadLog::replay(const std::string &path,
+                      const std::function<void(const WalRecord &)> &fn) {
+  MappedFile file(path);
+  file.advise_sequential();
+  const unsigned char *data = file.data();
+  uint64_t size = file.size();
+
+  if (size < sizeof(kWalMagic))
+    return 0;
+  if (std::memcmp(data, kWalMagic, sizeof(kWalMagic)) != 0)
+    throw std::runtime_error(path + " is not a VegamDB write-ahead log");
+
+  uint64_t pos = sizeof(kWalMagic);
+  uint64_t last_lsn = 0;
+  while (size - pos >= sizeof(WalRecordHeader)) {
+    WalRecordHeader header;
+    std::memcpy(&header, data + pos, sizeof(header));
+    if (header_checksum(header) != header.header_crc)
+      break;
+
+    uint64_t width;
+    if (header.op == static_cast<uint32_t>(WalOp::Add))
+      width = header.dim;
+    else if (header.op == static_cast<uint32_t>(WalOp::Remove))
+      width = 1;
+    else
+      break;
+
+    uint64_t available = size - pos - sizeof(header);
+    if (width > 0 && header.count > available / (width * 4))
+      break;
+    uint64_t payload_bytes = header.count * width * 4;
+    const unsigned char *payload = data + pos + sizeof(header);
+    if (payload_checksum(payload, payload_bytes) != header.payload_crc ||
+        header.lsn <= last_lsn)
+      break;
+
+    WalRecord record;
+    record.lsn = header.lsn;
+    record.op = static_cast<WalOp>(header.op);
+    record.count = header.count;
+    record.dim = header.dim;
+    if (record.op == WalOp::Add)
+      record.vectors = reinterpret_cast<const float *>(payload);
+    else
+      record.ids = reinterpret_cast<const int *>(payload);
+    fn(record);
+
+    last_lsn = header.lsn;
+    pos += sizeof(header) + payload_bytes;
+  }
+  return pos;
+}
@@ -0,0 +1,105 @@
+// src/utils/Bitmap.cpp
+
+#include "utils/Bitmap.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+Bitmap::Bitmap(size_t n_bits) : words_((n_bits + 63) / 64, 0), size_(n_bits) {}
+
+Bitmap Bitmap::from_ids(const std::vector<int> &ids, size_t n_bits) {
+  size_t max_id = 0;
+  for (int id : ids) {
+    if (id >= 0)
+      max_id = std::max(max_id, static_cast<size_t>(id) + 1);
+  }
+
+  Bitmap bitmap(std::max(n_bits, max_id));
+  for (int id : ids) {
+    if (id >= 0)
+      bitmap.set(id);
+  }
+  return bitmap;
+}
+
+void Bitmap::set(size_t id) {
+  if (id >= size_) {
+    size_ = id + 1;
+    words_.resize((size_ + 63) / 64, 0);
+  }
+
+  uint64_t mask = 1ULL << (id & 63);
+  if (!(words_[id >> 6] & mask)) {
+    words_[id >> 6] |= mask;
+    count_++;
+  }
+}
+
+void Bitmap::reset(size_t id) {
+  if (id >= size_)
+    return;
+
+  uint64_t mask = 1ULL << (id & 63);
+  if (words_[id >> 6] & mask) {
+    words_[id >> 6] &= ~mask;
+    count_--;
+  }
+}
+
+void Bitmap::resize(size_t n_bits, bool value) {
+  size_t old_size = size_;
+  words_.resize((n_bits + 63) / 64, 0);
+  size_ = n_bits;
+
+  if (n_bits < old_size) {
+    // Clear bits past the new end so they cannot reappear on a later grow
+    if (n_bits & 63)
+      words_.back() &= (1ULL << (n_bits & 63)) - 1;
+    recount();
+    return;
+  }
+
+  if (value) {
+    for (size_t id = old_size; id < n_bits; id++) {
+      words_[id >> 6] |= 1ULL << (id & 63);
+    }
+    count_ += n_bits - old_size;
+  }
+}
+
+std::vector<int> Bitmap::to_ids() const {
+  std::vector<int> ids;
+  ids.reserve(count_);
+  for_each([&](int id) { ids.push_back(id); });
+  return ids;
+}
+
+Bitmap Bitmap::operator&(const Bitmap &other) const {
+  Bitmap result(std::min(size_, other.size_));
+  for (size_t w = 0; w < result.words_.size(); w++) {
+    result.words_[w] = words_[w] & other.words_[w];
+  }
+  result.recount();
+  return result;
+}
+
+Bitmap Bitmap::operator|(const Bitmap &other) const {
+  const Bitmap &longer = size_ >= other.size_ ? *this : other;
+  const Bitmap &shorter = size_ >= other.size_ ? other : *this;
+
+  Bitmap result = longer;
+  for (size_t w = 0; w < shorter.words_.size(); w++) {
+    result.words_[w] |= shorter.words_[w];
+  }
+  result.recount();
+  return result;
+}
+
+void Bitmap::recount() {
+  count_ = 0;
+  for (uint64_t word : words_) {
+    count_ += std::bitset<64>(word).count();
+  }
+}
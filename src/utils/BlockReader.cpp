@@ -0,0 +1,312 @@
+// src/utils/BlockReader.cpp
+
+#include "utils/BlockReader.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VEGAMDB_HAS_PREAD 1
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define VEGAMDB_HAS_IO_URING 1
+#endif
+#endif
+
+// =========================================================
+// SECTION: io_uring
+// A minimal ring driven through the raw system calls (no liburing): one
+// READ submission per block, then a wait for all completions.
+// =========================================================
+
+#if defined(VEGAMDB_HAS_IO_URING)
+
+class BlockReader::Ring {
+public:
+  static constexpr unsigned kEntries = 64;
+
+private:
+  int ring_fd_ = -1;
+  void *sq_ptr_ = MAP_FAILED;
+  void *cq_ptr_ = MAP_FAILED;
+  size_t sq_bytes_ = 0;
+  size_t cq_bytes_ = 0;
+  io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+  size_t sqes_bytes_ = 0;
+
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+
+public:
+  Ring() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(
+        ::syscall(__NR_io_uring_setup, kEntries, &params));
+    if (ring_fd_ < 0)
+      return;
+
+    sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_bytes_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+
+    sq_ptr_ = ::mmap(nullptr, sq_bytes_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED)
+      return;
+    cq_ptr_ = single_mmap
+                  ? sq_ptr_
+                  : ::mmap(nullptr, cq_bytes_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd_,
+                           IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED)
+      return;
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(
+        ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED)
+      return;
+
+    char *sq = static_cast<char *>(sq_ptr_);
+    char *cq = static_cast<char *>(cq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  }
+
+  ~Ring() {
+    if (sqes_ != MAP_FAILED)
+      ::munmap(sqes_, sqes_bytes_);
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_)
+      ::munmap(cq_ptr_, cq_bytes_);
+    if (sq_ptr_ != MAP_FAILED)
+      ::munmap(sq_ptr_, sq_bytes_);
+    if (ring_fd_ >= 0)
+      ::close(ring_fd_);
+  }
+
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+
+  bool ok() const { return cqes_ != nullptr; }
+
+  /**
+   * @brief Reads up to kEntries requests. Results are returned per
+   * request in `results` (bytes read, or -errno).
+   */
+  void read(int fd, const BlockRequest *requests, size_t n,
+            int *results) {
+    unsigned tail = *sq_tail_; // Only this thread produces
+    for (size_t i = 0; i < n; i++) {
+      unsigned idx = tail & *sq_mask_;
+      io_uring_sqe *sqe = &sqes_[idx];
+      std::memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uint64_t>(requests[i].buffer);
+      sqe->len = static_cast<uint32_t>(requests[i].length);
+      sqe->off = requests[i].offset;
+      sqe->user_data = i;
+      sq_array_[idx] = idx;
+      tail++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    size_t submitted = 0;
+    size_t completed = 0;
+    while (completed < n) {
+      int ret = static_cast<int>(
+          ::syscall(__NR_io_uring_enter, ring_fd_, n - submitted,
+                    n - completed, IORING_ENTER_GETEVENTS, nullptr, 0));
+      if (ret < 0) {
+        if (errno == EINTR)
+          continue;
+        throw std::runtime_error("io_uring_enter failed: " +
+                                 std::string(std::strerror(errno)));
+      }
+      submitted += ret;
+
+      unsigned head = *cq_head_;
+      unsigned ready = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != ready; head++) {
+        const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+        results[cqe.user_data] = cqe.res;
+        completed++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+  }
+};
+
+#else
+
+class BlockReader::Ring {
+public:
+  static constexpr unsigned kEntries = 64;
+  bool ok() const { return false; }
+  void read(int, const BlockRequest *, size_t, int *) {}
+};
+
+#endif
+
+// =========================================================
+// SECTION: BlockReader
+// =========================================================
+
+BlockReader::BlockReader(const std::string &path, bool allow_io_uring)
+    : path_(path) {
+#if defined(VEGAMDB_HAS_PREAD)
+#if defined(O_DIRECT)
+  this->fd_ = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+  this->direct_ = this->fd_ >= 0;
+#endif
+  if (this->fd_ < 0)
+    this->fd_ = ::open(path.c_str(), O_RDONLY);
+  if (this->fd_ < 0)
+    throw std::runtime_error("Cannot open " + path);
+#if defined(__APPLE__)
+  ::fcntl(this->fd_, F_NOCACHE, 1);
+#endif
+
+  struct stat st;
+  if (::fstat(this->fd_, &st) != 0) {
+    ::close(this->fd_);
+    throw std::runtime_error("Cannot stat " + path);
+  }
+  this->size_ = static_cast<uint64_t>(st.st_size);
+
+  // Some filesystems accept O_DIRECT at open but reject the reads;
+  // probe once and fall back to buffered I/O
+  if (this->direct_ && this->size_ >= kSectorSize) {
+    void *probe = ::operator new(kSectorSize, std::align_val_t(kSectorSize));
+    ssize_t got = ::pread(this->fd_, probe, kSectorSize, 0);
+    ::operator delete(probe, std::align_val_t(kSectorSize));
+    if (got < 0) {
+      ::close(this->fd_);
+      this->direct_ = false;
+      this->fd_ = ::open(path.c_str(), O_RDONLY);
+      if (this->fd_ < 0)
+        throw std::runtime_error("Cannot open " + path);
+    }
+  }
+
+  if (allow_io_uring) {
+    auto ring = std::make_unique<Ring>();
+    if (ring->ok()) {
+      this->use_rings_ = true;
+      this->idle_rings_.push_back(std::move(ring));
+    }
+  }
+#else
+  (void)allow_io_uring;
+  this->stream_.open(path, std::ios::binary | std::ios::ate);
+  if (!this->stream_)
+    throw std::runtime_error("Cannot open " + path);
+  this->size_ = static_cast<uint64_t>(this->stream_.tellg());
+#endif
+}
+
+BlockReader::~BlockReader() {
+#if defined(VEGAMDB_HAS_PREAD)
+  if (this->fd_ >= 0)
+    ::close(this->fd_);
+#endif
+}
+
+std::unique_ptr<BlockReader::Ring> BlockReader::acquire_ring() {
+  {
+    std::lock_guard<std::mutex> lock(this->rings_mutex_);
+    if (!this->idle_rings_.empty()) {
+      std::unique_ptr<Ring> ring = std::move(this->idle_rings_.back());
+      this->idle_rings_.pop_back();
+      return ring;
+    }
+  }
+  auto ring = std::make_unique<Ring>();
+  return ring->ok() ? std::move(ring) : nullptr;
+}
+
+void BlockReader::release_ring(std::unique_ptr<Ring> ring) {
+  std::lock_guard<std::mutex> lock(this->rings_mutex_);
+  this->idle_rings_.push_back(std::move(ring));
+}
+
+void BlockReader::read(BlockRequest *requests, size_t n_requests) {
+  for (size_t i = 0; i < n_requests; i++) {
+    if (requests[i].offset + requests[i].length > this->size_)
+      throw std::runtime_error("Read past the end of " + this->path_);
+  }
+
+  std::unique_ptr<Ring> ring = this->use_rings_ ? acquire_ring() : nullptr;
+  if (!ring) {
+    for (size_t i = 0; i < n_requests; i++) {
+      pread_block(requests[i]);
+    }
+    return;
+  }
+
+  // A ring that failed mid-batch is dropped rather than reused
+  int results[Ring::kEntries];
+  for (size_t first = 0; first < n_requests; first += Ring::kEntries) {
+    size_t batch = std::min<size_t>(Ring::kEntries, n_requests - first);
+    ring->read(this->fd_, requests + first, batch, results);
+
+    // Short reads and kernels without IORING_OP_READ finish with pread
+    for (size_t i = 0; i < batch; i++) {
+      if (results[i] != static_cast<int>(requests[first + i].length))
+        pread_block(requests[first + i]);
+    }
+  }
+  release_ring(std::move(ring));
+}
+
+void BlockReader::pread_block(const BlockRequest &request) {
+#if defined(VEGAMDB_HAS_PREAD)
+  size_t done = 0;
+  while (done < request.length) {
+    ssize_t got = ::pread(this->fd_, request.buffer + done,
+                          request.length - done, request.offset + done);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      throw std::runtime_error("Cannot read " + this->path_);
+    done += got;
+  }
+#else
+  std::lock_guard<std::mutex> lock(this->stream_mutex_);
+  this->stream_.seekg(request.offset);
+  this->stream_.read(request.buffer, request.length);
+  if (!this->stream_)
+    throw std::runtime_error("Cannot read " + this->path_);
+#endif
+}
@@ -0,0 +1,169 @@
+// src/utils/Crc32c.cpp
+
+#include "utils/Crc32c.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE4_2__)
+#define VEGAMDB_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define VEGAMDB_CRC32C_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace {
+
+// Reflected Castagnoli polynomial
+constexpr uint32_t kPolynomial = 0x82F63B78u;
+
+// Below this, threads cost more than they save
+constexpr size_t kParallelCrcBytes = size_t(64) << 20;
+constexpr size_t kBytesPerCrcThread = size_t(16) << 20;
+
+#if !defined(VEGAMDB_CRC32C_SSE42) && !defined(VEGAMDB_CRC32C_ARM)
+using SliceTables = std::array<std::array<uint32_t, 256>, 8>;
+
+const SliceTables &slice_tables() {
+  static const SliceTables tables = [] {
+    SliceTables t{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1u)));
+      t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+      for (int s = 1; s < 8; s++)
+        t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+    }
+    return t;
+  }();
+  return tables;
+}
+#endif
+
+// Raw update on the inverted register (no pre/post inversion)
+uint32_t crc32c_update(uint32_t crc, const unsigned char *p, size_t n) {
+#if defined(VEGAMDB_CRC32C_SSE42)
+#if defined(__x86_64__) || defined(_M_X64)
+  uint64_t crc64 = crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+#endif
+  for (; n > 0; n--, p++)
+    crc = _mm_crc32_u8(crc, *p);
+  return crc;
+#elif defined(VEGAMDB_CRC32C_ARM)
+  for (; n >= 8; n -= 8, p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    crc = __crc32cd(crc, word);
+  }
+  for (; n > 0; n--, p++)
+    crc = __crc32cb(crc, *p);
+  return crc;
+#else
+  const SliceTables &t = slice_tables();
+  for (; n >= 8; n -= 8, p += 8) {
+    uint32_t lo, hi;
+    std::memcpy(&lo, p, 4);
+    std::memcpy(&hi, p + 4, 4);
+    lo ^= crc;
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+          t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^
+          t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; n > 0; n--, p++)
+    crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+  return crc;
+#endif
+}
+
+// GF(2) matrix helpers for crc32c_combine (as in zlib's crc32_combine)
+uint32_t gf2_times(const uint32_t *matrix, uint32_t vec) {
+  uint32_t sum = 0;
+  for (; vec; vec >>= 1, matrix++) {
+    if (vec & 1)
+      sum ^= *matrix;
+  }
+  return sum;
+}
+
+void gf2_square(uint32_t *square, const uint32_t *matrix) {
+  for (int n = 0; n < 32; n++)
+    square[n] = gf2_times(matrix, matrix[n]);
+}
+
+} // namespace
+
+uint32_t crc32c(const void *data, size_t size, uint32_t crc) {
+  // Little-endian byte order is assumed by the word-at-a-time paths
+  return ~crc32c_update(~crc, static_cast<const unsigned char *>(data), size);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b) {
+  if (len_b == 0)
+    return crc_a;
+
+  uint32_t even[32]; // Operator for 2^k zero bits, k even
+  uint32_t odd[32];  // ... k odd
+
+  // Operator for one zero bit
+  odd[0] = kPolynomial;
+  for (int n = 1, row = 1; n < 32; n++, row <<= 1)
+    odd[n] = row;
+
+  gf2_square(even, odd); // 2 zero bits
+  gf2_square(odd, even); // 4 zero bits
+
+  // Apply len_b zero bytes to crc_a
+  do {
+    gf2_square(even, odd);
+    if (len_b & 1)
+      crc_a = gf2_times(even, crc_a);
+    len_b >>= 1;
+    if (len_b == 0)
+      break;
+
+    gf2_square(odd, even);
+    if (len_b & 1)
+      crc_a = gf2_times(odd, crc_a);
+    len_b >>= 1;
+  } while (len_b != 0);
+
+  return crc_a ^ crc_b;
+}
+
+uint32_t crc32c_parallel(const void *data, size_t size, size_t n_threads) {
+  if (size < kParallelCrcBytes || n_threads <= 1)
+    return crc32c(data, size);
+
+  size_t n_chunks = std::min(n_threads, size / kBytesPerCrcThread);
+  size_t chunk = (size + n_chunks - 1) / n_chunks;
+  std::vector<uint32_t> crcs(n_chunks);
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+  parallel_for(n_chunks, n_chunks, [&](size_t begin, size_t end) {
+    for (size_t c = begin; c < end; c++) {
+      size_t offset = c * chunk;
+      crcs[c] = crc32c(bytes + offset, std::min(chunk, size - offset));
+    }
+  });
+
+  uint32_t crc = crcs[0];
+  for (size_t c = 1; c < n_chunks; c++) {
+    size_t len = std::min(chunk, size - c * chunk);
+    crc = crc32c_combine(crc, crcs[c], len);
+  }
+  return crc;
+}
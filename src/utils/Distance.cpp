@@ -0,0 +1,319 @@
+// src/utils/Distance.cpp
+
+#include "utils/Distance.hpp"
+#include "utils/Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+std::string metric_name(Metric metric) {
+  switch (metric) {
+  case Metric::L2:
+    return "l2";
+  case Metric::InnerProduct:
+    return "ip";
+  case Metric::Cosine:
+    return "cosine";
+  }
+  return "unknown";
+}
+
+// =========================================================
+// SECTION: Kernel templates
+// D is the vector dimension when known at compile time, or 0 for a runtime
+// `dim`. With a constexpr D the loop trip counts are constants, so the
+// compiler fully unrolls them and drops the scalar tail for multiples of 16.
+// =========================================================
+
+namespace {
+
+template <size_t D>
+inline float l2_kernel(const float *a, const float *b, size_t dim) {
+  const size_t n = D ? D : dim;
+  size_t i = 0;
+  float sum = 0.0f;
+
+#if defined(VEGAMDB_AVX2)
+  // Two accumulators hide FMA latency
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (; i + 16 <= n; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+  }
+  sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(VEGAMDB_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= n; i += 8) {
+    float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    acc0 = vfmaq_f32(acc0, d0, d0);
+    acc1 = vfmaq_f32(acc1, d1, d1);
+  }
+  sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+
+  for (; i < n; i++) {
+    float diff = a[i] - b[i];
+    sum += diff * diff;
+  }
+
+  return sum;
+}
+
+template <size_t D>
+inline float ip_kernel(const float *a, const float *b, size_t dim) {
+  const size_t n = D ? D : dim;
+  size_t i = 0;
+  float sum = 0.0f;
+
+#if defined(VEGAMDB_AVX2)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                           acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                           _mm256_loadu_ps(b + i + 8), acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                           acc0);
+  }
+  sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(VEGAMDB_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= n; i += 8) {
+    acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+
+  for (; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+
+  return sum;
+}
+
+// Squared L2 in kAbandonBlock-wide blocks (in `order`, if given), stopping
+// as soon as the running sum exceeds `bound`. Dimensions past the last
+// whole block are added at the end.
+template <size_t D>
+inline float l2_bounded_kernel(const float *a, const float *b, size_t dim,
+                               float bound, const uint32_t *order) {
+  const size_t n = D ? D : dim;
+  const size_t blocks = n / kAbandonBlock;
+  float sum = 0.0f;
+  for (size_t j = 0; j < blocks; j++) {
+    size_t offset = (order ? order[j] : j) * kAbandonBlock;
+    sum += l2_kernel<kAbandonBlock>(a + offset, b + offset, kAbandonBlock);
+    if (sum > bound)
+      return sum;
+  }
+  size_t tail = blocks * kAbandonBlock;
+  if (tail < n)
+    sum += l2_kernel<0>(a + tail, b + tail, n - tail);
+  return sum;
+}
+
+// Metric-specialized entry point with the DistanceFunction signature
+template <Metric M, size_t D>
+float metric_kernel(const float *a, const float *b, size_t dim) {
+  if constexpr (M == Metric::L2) {
+    return l2_kernel<D>(a, b, dim);
+  } else if constexpr (M == Metric::InnerProduct) {
+    return -ip_kernel<D>(a, b, dim);
+  } else {
+    return 1.0f - ip_kernel<D>(a, b, dim);
+  }
+}
+
+template <Metric M, size_t D>
+float bounded_metric_kernel(const float *a, const float *b, size_t dim,
+                            float bound, const uint32_t *order) {
+  if constexpr (M == Metric::L2) {
+    return l2_bounded_kernel<D>(a, b, dim, bound, order);
+  } else {
+    return metric_kernel<M, D>(a, b, dim);
+  }
+}
+
+template <Metric M> DistanceFunction select_dimension(size_t dim) {
+  switch (dim) {
+  case 64:
+    return &metric_kernel<M, 64>;
+  case 96:
+    return &metric_kernel<M, 96>;
+  case 128:
+    return &metric_kernel<M, 128>;
+  case 256:
+    return &metric_kernel<M, 256>;
+  case 384:
+    return &metric_kernel<M, 384>;
+  case 512:
+    return &metric_kernel<M, 512>;
+  case 768:
+    return &metric_kernel<M, 768>;
+  case 1024:
+    return &metric_kernel<M, 1024>;
+  case 1536:
+    return &metric_kernel<M, 1536>;
+  default:
+    return &metric_kernel<M, 0>;
+  }
+}
+
+template <Metric M> BoundedDistanceFunction select_bounded(size_t dim) {
+  switch (dim) {
+  case 64:
+    return &bounded_metric_kernel<M, 64>;
+  case 96:
+    return &bounded_metric_kernel<M, 96>;
+  case 128:
+    return &bounded_metric_kernel<M, 128>;
+  case 256:
+    return &bounded_metric_kernel<M, 256>;
+  case 384:
+    return &bounded_metric_kernel<M, 384>;
+  case 512:
+    return &bounded_metric_kernel<M, 512>;
+  case 768:
+    return &bounded_metric_kernel<M, 768>;
+  case 1024:
+    return &bounded_metric_kernel<M, 1024>;
+  case 1536:
+    return &bounded_metric_kernel<M, 1536>;
+  default:
+    return &bounded_metric_kernel<M, 0>;
+  }
+}
+
+} // namespace
+
+// =========================================================
+// SECTION: Public kernels
+// =========================================================
+
+float l2_distance_sqr(const float *a, const float *b, size_t dim) {
+  return l2_kernel<0>(a, b, dim);
+}
+
+float inner_product(const float *a, const float *b, size_t dim) {
+  return ip_kernel<0>(a, b, dim);
+}
+
+float compute_distance(Metric metric, const float *a, const float *b,
+                       size_t dim) {
+  switch (metric) {
+  case Metric::L2:
+    return l2_distance_sqr(a, b, dim);
+  case Metric::InnerProduct:
+    return -inner_product(a, b, dim);
+  case Metric::Cosine:
+    return 1.0f - inner_product(a, b, dim);
+  }
+  return 0.0f;
+}
+
+DistanceFunction get_distance_function(Metric metric, size_t dim) {
+  switch (metric) {
+  case Metric::L2:
+    return select_dimension<Metric::L2>(dim);
+  case Metric::InnerProduct:
+    return select_dimension<Metric::InnerProduct>(dim);
+  case Metric::Cosine:
+    return select_dimension<Metric::Cosine>(dim);
+  }
+  return &metric_kernel<Metric::L2, 0>;
+}
+
+BoundedDistanceFunction get_bounded_distance_function(Metric metric,
+                                                      size_t dim) {
+  switch (metric) {
+  case Metric::L2:
+    return select_bounded<Metric::L2>(dim);
+  case Metric::InnerProduct:
+    return select_bounded<Metric::InnerProduct>(dim);
+  case Metric::Cosine:
+    return select_bounded<Metric::Cosine>(dim);
+  }
+  return &bounded_metric_kernel<Metric::L2, 0>;
+}
+
+std::vector<uint32_t> block_order_by_variance(const float *data,
+                                              size_t n_rows, size_t dim,
+                                              size_t max_samples) {
+  size_t blocks = dim / kAbandonBlock;
+  size_t samples = std::min(n_rows, max_samples);
+  if (blocks < 2 || samples < 2)
+    return {};
+
+  // Per-dimension mean and variance over evenly spaced rows
+  std::vector<double> sum(dim, 0.0);
+  std::vector<double> sum_sq(dim, 0.0);
+  for (size_t s = 0; s < samples; s++) {
+    const float *row = data + (s * n_rows / samples) * dim;
+    for (size_t d = 0; d < dim; d++) {
+      sum[d] += row[d];
+      sum_sq[d] += static_cast<double>(row[d]) * row[d];
+    }
+  }
+
+  std::vector<double> block_variance(blocks, 0.0);
+  for (size_t d = 0; d < blocks * kAbandonBlock; d++) {
+    double mean = sum[d] / samples;
+    block_variance[d / kAbandonBlock] += sum_sq[d] / samples - mean * mean;
+  }
+
+  // Visiting blocks out of memory order defeats the hardware prefetcher,
+  // so only reorder when the variance is concentrated: the leading quarter
+  // of blocks must carry at least three times its even share. Those blocks
+  // go first, then the rest, each group in memory order.
+  size_t lead = std::max<size_t>(1, blocks / 4);
+  std::vector<uint32_t> order(blocks);
+  std::iota(order.begin(), order.end(), 0);
+  std::nth_element(order.begin(), order.begin() + lead, order.end(),
+                   [&](uint32_t x, uint32_t y) {
+                     return block_variance[x] > block_variance[y];
+                   });
+
+  double total = 0.0;
+  double leading = 0.0;
+  for (size_t j = 0; j < blocks; j++) {
+    total += block_variance[order[j]];
+    if (j < lead)
+      leading += block_variance[order[j]];
+  }
+  if (total <= 0.0 || leading * blocks < 3.0 * lead * total)
+    return {};
+
+  std::sort(order.begin(), order.begin() + lead);
+  std::sort(order.begin() + lead, order.end());
+  return order;
+}
+
+void normalize(float *v, size_t dim) {
+  float norm = std::sqrt(inner_product(v, v, dim));
+  if (norm == 0.0f)
+    return;
+
+  float inv = 1.0f / norm;
+  for (size_t i = 0; i < dim; i++) {
+    v[i] *= inv;
+  }
+}
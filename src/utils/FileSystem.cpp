@@ -0,0 +1,92 @@
+// src/utils/FileSystem.cpp
+
+#include "utils/FileSystem.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VEGAMDB_HAS_POSIX_IO 1
+#else
+#include <filesystem>
+#endif
+
+bool file_exists(const std::string &path) {
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0;
+#else
+  std::ifstream in(path, std::ios::binary);
+  return static_cast<bool>(in);
+#endif
+}
+
+void sync_file(const std::string &path) {
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open " + path);
+  int rc = ::fsync(fd);
+  ::close(fd);
+  if (rc != 0)
+    throw std::runtime_error("Cannot fsync " + path);
+#else
+  (void)path;
+#endif
+}
+
+void sync_stream(std::FILE *file) {
+  if (std::fflush(file) != 0)
+    throw std::runtime_error("Cannot flush write-ahead log");
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  if (::fsync(::fileno(file)) != 0)
+    throw std::runtime_error("Cannot fsync write-ahead log");
+#endif
+}
+
+void sync_parent_directory(const std::string &path) {
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  size_t slash = path.find_last_of('/');
+  std::string dir = slash == std::string::npos ? "."
+                    : slash == 0                ? "/"
+                                                : path.substr(0, slash);
+  int fd = ::open(dir.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open directory " + dir);
+  // Some filesystems reject fsync on a directory; that is best-effort
+  ::fsync(fd);
+  ::close(fd);
+#else
+  (void)path;
+#endif
+}
+
+void replace_file(const std::string &from, const std::string &to) {
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  if (std::rename(from.c_str(), to.c_str()) != 0)
+    throw std::runtime_error("Cannot rename " + from + " to " + to);
+#else
+  // std::rename does not overwrite on every platform
+  std::error_code ec;
+  std::filesystem::rename(from, to, ec);
+  if (ec)
+    throw std::runtime_error("Cannot rename " + from + " to " + to);
+#endif
+}
+
+void truncate_file(const std::string &path, uint64_t size) {
+#if defined(VEGAMDB_HAS_POSIX_IO)
+  if (::truncate(path.c_str(), static_cast<off_t>(size)) != 0)
+    throw std::runtime_error("Cannot truncate " + path);
+#else
+  std::error_code ec;
+  std::filesystem::resize_file(path, size, ec);
+  if (ec)
+    throw std::runtime_error("Cannot truncate " + path);
+#endif
+}
@@ -0,0 +1,166 @@
+// src/utils/HugePages.cpp
+
+#include "utils/HugePages.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#define VEGAMDB_HAS_HUGE_PAGES 1
+#endif
+
+namespace {
+
+enum class Backing { Explicit, Transparent, Regular };
+
+std::atomic<HugePages> g_mode{HugePages::Transparent};
+
+// Backing of every live large allocation, for huge_page_status()
+struct Registry {
+  std::mutex mutex;
+  std::unordered_map<void *, Backing> backing;
+  uint64_t bytes[3] = {0, 0, 0};
+  uint64_t explicit_fallbacks = 0;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+void record(void *ptr, size_t bytes, Backing backing) {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.backing[ptr] = backing;
+  r.bytes[static_cast<int>(backing)] += bytes;
+}
+
+void forget(void *ptr, size_t bytes) {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  auto it = r.backing.find(ptr);
+  if (it == r.backing.end())
+    return;
+  r.bytes[static_cast<int>(it->second)] -= bytes;
+  r.backing.erase(it);
+}
+
+size_t round_to_huge_pages(size_t bytes) {
+  return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+}
+
+#if defined(VEGAMDB_HAS_HUGE_PAGES)
+// Maps `bytes` (a multiple of kHugePageSize) aligned to kHugePageSize, so
+// the kernel can back every 2 MB of it with one huge page
+void *map_aligned(size_t bytes) {
+  size_t padded = bytes + kHugePageSize;
+  void *addr = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED)
+    throw std::bad_alloc();
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t aligned = (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  if (aligned > start)
+    ::munmap(addr, aligned - start);
+  size_t tail = start + padded - (aligned + bytes);
+  if (tail > 0)
+    ::munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+  return reinterpret_cast<void *>(aligned);
+}
+
+void *map_explicit(size_t bytes) {
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+  flags |= MAP_HUGE_2MB;
+#endif
+  void *addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+  return addr == MAP_FAILED ? nullptr : addr;
+}
+#endif
+
+int64_t read_anon_huge_bytes() {
+#if defined(VEGAMDB_HAS_HUGE_PAGES)
+  std::ifstream in("/proc/self/smaps_rollup");
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.rfind("AnonHugePages:", 0) != 0)
+      continue;
+    std::istringstream fields(line.substr(14));
+    int64_t kb = 0;
+    if (fields >> kb)
+      return kb * 1024;
+  }
+#endif
+  return -1;
+}
+
+} // namespace
+
+void set_huge_pages(HugePages mode) { g_mode.store(mode); }
+
+HugePages huge_pages() { return g_mode.load(); }
+
+void *huge_page_alloc(size_t bytes) {
+#if defined(VEGAMDB_HAS_HUGE_PAGES)
+  size_t rounded = round_to_huge_pages(bytes);
+  HugePages mode = g_mode.load(std::memory_order_relaxed);
+
+  if (mode == HugePages::Explicit) {
+    if (void *addr = map_explicit(rounded)) {
+      record(addr, rounded, Backing::Explicit);
+      return addr;
+    }
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().explicit_fallbacks++;
+  }
+
+  void *addr = map_aligned(rounded);
+  bool advised = mode != HugePages::Off &&
+                 ::madvise(addr, rounded, MADV_HUGEPAGE) == 0;
+  record(addr, rounded, advised ? Backing::Transparent : Backing::Regular);
+  return addr;
+#else
+  void *addr = ::operator new(bytes);
+  record(addr, bytes, Backing::Regular);
+  return addr;
+#endif
+}
+
+void huge_page_free(void *ptr, size_t bytes) noexcept {
+  if (!ptr)
+    return;
+#if defined(VEGAMDB_HAS_HUGE_PAGES)
+  size_t rounded = round_to_huge_pages(bytes);
+  forget(ptr, rounded);
+  ::munmap(ptr, rounded);
+#else
+  forget(ptr, bytes);
+  ::operator delete(ptr);
+#endif
+}
+
+HugePageStatus huge_page_status() {
+  HugePageStatus status;
+  status.mode = g_mode.load();
+#if defined(VEGAMDB_HAS_HUGE_PAGES)
+  status.supported = true;
+#endif
+  {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    status.explicit_bytes = r.bytes[static_cast<int>(Backing::Explicit)];
+    status.transparent_bytes = r.bytes[static_cast<int>(Backing::Transparent)];
+    status.regular_bytes = r.bytes[static_cast<int>(Backing::Regular)];
+    status.explicit_fallbacks = r.explicit_fallbacks;
+  }
+  status.anon_huge_bytes = read_anon_huge_bytes();
+  return status;
+}
@@ -0,0 +1,67 @@
+// src/utils/MappedFile.cpp
+
+#include "utils/MappedFile.hpp"
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VEGAMDB_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string &path) {
+#if defined(VEGAMDB_HAS_MMAP)
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open " + path);
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Cannot stat " + path);
+  }
+  this->size_ = static_cast<size_t>(st.st_size);
+
+  // mmap rejects zero-length mappings; an empty file is just empty
+  if (this->size_ > 0) {
+    void *addr = ::mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Cannot mmap " + path);
+    }
+    this->data_ = static_cast<const unsigned char *>(addr);
+    this->mapped_ = true;
+  }
+  ::close(fd); // The mapping stays valid after close
+#else
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in)
+    throw std::runtime_error("Cannot open " + path);
+
+  this->size_ = static_cast<size_t>(in.tellg());
+  this->buffer_.resize(this->size_);
+  in.seekg(0);
+  in.read(reinterpret_cast<char *>(this->buffer_.data()), this->size_);
+  this->data_ = this->buffer_.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if defined(VEGAMDB_HAS_MMAP)
+  if (this->mapped_)
+    ::munmap(const_cast<unsigned char *>(this->data_), this->size_);
+#endif
+}
+
+void MappedFile::advise_sequential() const {
+#if defined(VEGAMDB_HAS_MMAP)
+  if (this->mapped_)
+    ::madvise(const_cast<unsigned char *>(this->data_), this->size_,
+              MADV_SEQUENTIAL);
+#endif
+}
@@ -1,6 +1,7 @@
 // src/utils/Math.cpp
 
 #include "utils/Math.hpp"
+#include "utils/Distance.hpp"
 #include <cmath>
 #include <cstddef>
 #include <random>
@@ -8,41 +9,16 @@
 
 float euclidean_distance(const std::vector<float> &a,
                          const std::vector<float> &b) {
-  float sum = 0.0f;
-  size_t size = a.size();
-
-  for (size_t i = 0; i < size; i++) {
-    float distance = a[i] - b[i];
-    sum += distance * distance;
-  }
-
-  sum = std::sqrt(sum);
-
-  return sum;
+  return std::sqrt(l2_distance_sqr(a.data(), b.data(), a.size()));
 }
 
 float euclidean_distance_squared(const std::vector<float> &a,
                                  const std::vector<float> &b) {
-  float sum = 0.0f;
-  size_t size = a.size();
-
-  for (size_t i = 0; i < size; i++) {
-    float distance = a[i] - b[i];
-    sum += distance * distance;
-  }
-
-  return sum;
+  return l2_distance_sqr(a.data(), b.data(), a.size());
 }
 
 float dot_product(const std::vector<float> &a, const std::vector<float> &b) {
-  float sum = 0.0f;
-  size_t size = a.size();
-
-  for (int i = 0; i < size; i++) {
-    sum += a[i] * b[i];
-  }
-
-  return sum;
+  return inner_product(a.data(), b.data(), a.size());
 }
 
 std::mt19937 get_random_engine() {
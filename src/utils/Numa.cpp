@@ -0,0 +1,178 @@
+// src/utils/Numa.cpp
+
+#include "utils/Numa.hpp"
+#include "utils/HugePages.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define VEGAMDB_HAS_NUMA 1
+#endif
+
+namespace {
+
+struct Topology {
+  std::vector<int> node_ids;               // OS node id per partition
+  std::vector<std::vector<int>> node_cpus; // CPUs per partition
+  bool simulated = false;                  // VEGAMDB_NUMA_NODES
+};
+
+std::atomic<bool> g_numa_aware{false};
+
+// Parses a sysfs list such as "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string &text) {
+  std::vector<int> cpus;
+  std::stringstream ranges(text);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty() || range == "\n")
+      continue;
+    size_t dash = range.find('-');
+    int first = std::atoi(range.c_str());
+    int last = dash == std::string::npos
+                   ? first
+                   : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+std::string read_line(const std::string &path) {
+  std::ifstream in(path);
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+Topology detect() {
+  Topology topology;
+#if defined(VEGAMDB_HAS_NUMA)
+  std::string online = read_line("/sys/devices/system/node/online");
+  for (int node : parse_cpu_list(online)) {
+    std::vector<int> cpus = parse_cpu_list(read_line(
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+    // Memory-only nodes have nobody to run a partition's scan
+    if (cpus.empty())
+      continue;
+    topology.node_ids.push_back(node);
+    topology.node_cpus.push_back(std::move(cpus));
+  }
+
+  const char *simulated = std::getenv("VEGAMDB_NUMA_NODES");
+  if (simulated && std::atoi(simulated) > 1) {
+    std::vector<int> all;
+    for (const auto &cpus : topology.node_cpus)
+      all.insert(all.end(), cpus.begin(), cpus.end());
+    size_t n = std::atoi(simulated);
+    topology.node_ids.assign(n, -1);
+    topology.node_cpus.assign(n, {});
+    // Round-robin; with fewer CPUs than nodes, nodes share CPUs
+    for (size_t i = 0; !all.empty() && i < std::max(all.size(), n); i++)
+      topology.node_cpus[i % n].push_back(all[i % all.size()]);
+    topology.simulated = true;
+  }
+#endif
+  if (topology.node_cpus.empty()) {
+    topology.node_ids.assign(1, 0);
+    topology.node_cpus.assign(1, {});
+  }
+  return topology;
+}
+
+const Topology &topology() {
+  static const Topology instance = detect();
+  return instance;
+}
+
+} // namespace
+
+void set_numa_aware(bool enabled) { g_numa_aware.store(enabled); }
+
+bool numa_aware() { return g_numa_aware.load(); }
+
+size_t numa_node_count() { return topology().node_cpus.size(); }
+
+bool numa_active() { return numa_aware() && numa_node_count() > 1; }
+
+std::pair<size_t, size_t> numa_partition(size_t rows, size_t node) {
+  size_t nodes = numa_node_count();
+  return {rows * node / nodes, rows * (node + 1) / nodes};
+}
+
+void numa_bind_rows(const float *data, size_t rows, size_t dim) {
+#if defined(VEGAMDB_HAS_NUMA) && defined(SYS_mbind)
+  const Topology &t = topology();
+  size_t nodes = t.node_ids.size();
+  size_t bytes = rows * dim * sizeof(float);
+  if (!numa_active() || t.simulated || bytes < nodes * kHugePageSize)
+    return;
+
+  uintptr_t base = reinterpret_cast<uintptr_t>(data);
+  auto boundary = [&](size_t node) -> uintptr_t {
+    if (node == nodes)
+      return (base + bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    size_t offset = numa_partition(rows, node).first * dim * sizeof(float);
+    return (base + offset) & ~(kHugePageSize - 1);
+  };
+
+  for (size_t i = 0; i < nodes; i++) {
+    int node = t.node_ids[i];
+    uintptr_t begin = std::max(boundary(i), base & ~uintptr_t(4095));
+    uintptr_t end = boundary(i + 1);
+    if (node < 0 || node >= 64 || end <= begin)
+      continue;
+    unsigned long mask = 1UL << node;
+    // Best effort: a failed bind leaves the pages where they are
+    ::syscall(SYS_mbind, begin, end - begin, MPOL_BIND, &mask,
+              sizeof(mask) * 8, MPOL_MF_MOVE);
+  }
+#endif
+}
+
+NumaPin::NumaPin(size_t node) {
+#if defined(VEGAMDB_HAS_NUMA)
+  const Topology &t = topology();
+  if (t.node_cpus.size() <= 1 || node >= t.node_cpus.size())
+    return;
+
+  cpu_set_t previous;
+  if (::sched_getaffinity(0, sizeof(previous), &previous) != 0)
+    return;
+  cpu_set_t target;
+  CPU_ZERO(&target);
+  for (int cpu : t.node_cpus[node]) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &target);
+  }
+  if (::sched_setaffinity(0, sizeof(target), &target) != 0)
+    return;
+
+  this->saved_.resize(sizeof(previous));
+  std::memcpy(this->saved_.data(), &previous, sizeof(previous));
+  this->pinned_ = true;
+#endif
+}
+
+NumaPin::~NumaPin() {
+#if defined(VEGAMDB_HAS_NUMA)
+  if (!this->pinned_)
+    return;
+  cpu_set_t previous;
+  std::memcpy(&previous, this->saved_.data(), sizeof(previous));
+  ::sched_setaffinity(0, sizeof(previous), &previous);
+#endif
+}
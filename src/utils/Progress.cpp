@@ -0,0 +1,121 @@
+// src/utils/Progress.cpp
+
+#include "utils/Progress.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace {
+double seconds_between(std::chrono::steady_clock::time_point from,
+                       std::chrono::steady_clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+} // namespace
+
+void BuildProgress::set_callback(BuildProgressCallback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = std::move(callback);
+}
+
+void BuildProgress::start(const std::string &index) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_ = index;
+    phase_.clear();
+    phases_.clear();
+    build_start_ = phase_start_ = Clock::now();
+    done_.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+  }
+  notify(true);
+}
+
+void BuildProgress::begin_phase(const std::string &name, uint64_t total) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    close_phase_locked(now);
+    phase_ = name;
+    phase_start_ = now;
+    done_.store(0, std::memory_order_relaxed);
+    total_.store(total, std::memory_order_relaxed);
+  }
+  notify(true);
+}
+
+void BuildProgress::advance(uint64_t n) {
+  done_.fetch_add(n, std::memory_order_relaxed);
+  notify(false);
+}
+
+void BuildProgress::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    close_phase_locked(Clock::now());
+    phase_.clear();
+    running_.store(false, std::memory_order_release);
+  }
+  notify(true);
+}
+
+BuildProgressSnapshot BuildProgress::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return snapshot_locked(Clock::now());
+}
+
+void BuildProgress::close_phase_locked(Clock::time_point now) {
+  if (phase_.empty())
+    return;
+  phases_.push_back({phase_, seconds_between(phase_start_, now)});
+}
+
+BuildProgressSnapshot
+BuildProgress::snapshot_locked(Clock::time_point now) const {
+  BuildProgressSnapshot s;
+  s.running = running_.load(std::memory_order_acquire);
+  s.index = index_;
+  s.phase = phase_;
+  s.done = done_.load(std::memory_order_relaxed);
+  s.total = total_.load(std::memory_order_relaxed);
+  s.elapsed_seconds = s.running || !phases_.empty()
+                          ? seconds_between(build_start_, now)
+                          : 0.0;
+  if (!s.running && !phases_.empty()) {
+    // Finished: report the build's own duration, not time since
+    s.elapsed_seconds = 0.0;
+    for (const auto &phase : phases_)
+      s.elapsed_seconds += phase.seconds;
+  }
+  s.phases = phases_;
+  return s;
+}
+
+void BuildProgress::notify(bool force) {
+  // Cheap check first so advance() stays lock-free between callbacks
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now().time_since_epoch())
+                       .count();
+  if (!force &&
+      now_ns < next_callback_ns_.load(std::memory_order_relaxed))
+    return;
+  next_callback_ns_.store(
+      now_ns + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   kCallbackInterval)
+                   .count(),
+      std::memory_order_relaxed);
+
+  BuildProgressCallback callback;
+  BuildProgressSnapshot s;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!callback_)
+      return;
+    callback = callback_;
+    s = snapshot_locked(Clock::now());
+  }
+  callback(s);
+}
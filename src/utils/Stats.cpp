@@ -0,0 +1,133 @@
+// src/utils/Stats.cpp
+
+#include "utils/Stats.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+uint64_t to_ns(double us) {
+  return us > 0.0 ? static_cast<uint64_t>(us * 1000.0) : 0;
+}
+
+double to_us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+uint64_t load(const std::atomic<uint64_t> &counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+void add(std::atomic<uint64_t> &counter, uint64_t value) {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// =========================================================
+// SECTION: Log2Histogram
+// =========================================================
+
+void Log2Histogram::record(uint64_t value) {
+  size_t bucket = 0;
+  while (value > 0 && bucket + 1 < kBuckets) {
+    value >>= 1;
+    bucket++;
+  }
+  add(buckets_[bucket], 1);
+}
+
+std::vector<uint64_t> Log2Histogram::counts() const {
+  std::vector<uint64_t> result(kBuckets);
+  for (size_t i = 0; i < kBuckets; i++) {
+    result[i] = load(buckets_[i]);
+  }
+  return result;
+}
+
+void Log2Histogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+// =========================================================
+// SECTION: SearchStatsSummary
+// =========================================================
+
+double SearchStatsSummary::latency_percentile_us(double p) const {
+  uint64_t total = 0;
+  for (uint64_t count : latency_histogram_us)
+    total += count;
+  if (total == 0)
+    return 0.0;
+
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+  if (rank == 0)
+    rank = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < latency_histogram_us.size(); i++) {
+    seen += latency_histogram_us[i];
+    if (seen >= rank)
+      return i == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(i));
+  }
+  return std::ldexp(1.0, static_cast<int>(latency_histogram_us.size()));
+}
+
+// =========================================================
+// SECTION: SearchStatsAggregator
+// =========================================================
+
+void SearchStatsAggregator::record(const SearchStats &stats) {
+  add(queries_, 1);
+  add(distance_computations_, stats.distance_computations);
+  add(lists_visited_, stats.lists_visited);
+  add(nodes_visited_, stats.nodes_visited);
+  add(leaves_visited_, stats.leaves_visited);
+  add(candidates_, stats.candidates);
+  add(duplicates_removed_, stats.duplicates_removed);
+  add(filter_fallbacks_, stats.filter_fallback ? 1 : 0);
+
+  add(ranking_ns_, to_ns(stats.ranking_us));
+  add(scan_ns_, to_ns(stats.scan_us));
+  add(rerank_ns_, to_ns(stats.rerank_us));
+  add(total_ns_, to_ns(stats.total_us));
+
+  latency_us_.record(static_cast<uint64_t>(stats.total_us));
+  distances_.record(stats.distance_computations);
+}
+
+SearchStatsSummary SearchStatsAggregator::summary() const {
+  SearchStatsSummary s;
+  s.queries = load(queries_);
+  s.distance_computations = load(distance_computations_);
+  s.lists_visited = load(lists_visited_);
+  s.nodes_visited = load(nodes_visited_);
+  s.leaves_visited = load(leaves_visited_);
+  s.candidates = load(candidates_);
+  s.duplicates_removed = load(duplicates_removed_);
+  s.filter_fallbacks = load(filter_fallbacks_);
+
+  s.ranking_us = to_us(load(ranking_ns_));
+  s.scan_us = to_us(load(scan_ns_));
+  s.rerank_us = to_us(load(rerank_ns_));
+  s.total_us = to_us(load(total_ns_));
+
+  s.latency_histogram_us = latency_us_.counts();
+  s.distance_histogram = distances_.counts();
+  return s;
+}
+
+void SearchStatsAggregator::reset() {
+  for (auto *counter :
+       {&queries_, &distance_computations_, &lists_visited_, &nodes_visited_,
+        &leaves_visited_, &candidates_, &duplicates_removed_,
+        &filter_fallbacks_, &ranking_ns_, &scan_ns_, &rerank_ns_,
+        &total_ns_}) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+  latency_us_.reset();
+  distances_.reset();
+}
@@ -0,0 +1,124 @@
+"""Tests for build progress reporting and GIL-free build/search."""
+
+import threading
+
+import pytest
+from vegamdb import VegamDB, BuildProgress
+
+
+class TestBuildProgress:
+
+    def test_idle_before_first_build(self, db):
+        progress = db.build_progress()
+        assert isinstance(progress, BuildProgress)
+        assert not progress.running
+        assert progress.phases == []
+
+    def test_ivf_reports_kmeans_assignments(self, populated_db):
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=5)
+        db.build_index()
+
+        progress = db.build_progress()
+        assert not progress.running
+        assert progress.index == "IVFIndex"
+        assert progress.done == progress.total == 5 * len(data)
+        assert progress.fraction == pytest.approx(1.0)
+        assert [name for name, _ in progress.phases] == ["kmeans"]
+        assert progress.elapsed_seconds >= progress.phases[0][1]
+
+    def test_annoy_reports_trees(self, populated_db):
+        db, _ = populated_db
+        db.use_annoy_index(num_trees=7, k_leaf=50)
+        db.build_index()
+
+        progress = db.build_progress()
+        assert progress.index == "AnnoyIndex"
+        assert progress.done == progress.total == 7
+        assert [name for name, _ in progress.phases] == ["trees"]
+
+    def test_callback_sees_phases(self, populated_db):
+        db, _ = populated_db
+        db.use_annoy_index(num_trees=5, k_leaf=50)
+        seen = []
+        db.build_index(callback=lambda p: seen.append((p.running, p.phase)))
+
+        assert seen[0] == (True, "")
+        assert (True, "trees") in seen
+        assert seen[-1] == (False, "")
+
+    @pytest.mark.filterwarnings(
+        "ignore::pytest.PytestUnraisableExceptionWarning"
+    )
+    def test_callback_errors_do_not_abort_build(self, populated_db):
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=5, n_probe=10)
+
+        def fail(progress):
+            raise RuntimeError("boom")
+
+        db.build_index(callback=fail)
+        assert db.search(data[0], k=1).ids == [0]
+
+    def test_callback_with_other_thread_waiting_on_lock(self, populated_db):
+        """A thread blocked on the database while holding the GIL must not
+        stall a build whose callback needs the GIL."""
+        db, _ = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=20)
+        sizes = []
+        started = threading.Event()
+        stop = threading.Event()
+
+        def poll():
+            started.set()
+            while not stop.is_set():
+                sizes.append(db.size())
+
+        poller = threading.Thread(target=poll)
+        poller.start()
+        started.wait()
+        calls = []
+        build = threading.Thread(
+            target=db.build_index, kwargs={"callback": calls.append})
+        build.start()
+        build.join(timeout=60)
+        stop.set()
+        poller.join(timeout=60)
+
+        assert not build.is_alive() and not poller.is_alive()
+        assert calls and not calls[-1].running
+        assert set(sizes) == {1000}
+
+    def test_poll_from_another_thread(self, populated_db):
+        db, _ = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=20)
+
+        worker = threading.Thread(target=db.build_index)
+        worker.start()
+        while worker.is_alive():
+            progress = db.build_progress()
+            assert progress.done <= progress.total or progress.total == 0
+            worker.join(timeout=0.001)
+
+        assert db.build_progress().done == 20 * 1000
+
+    def test_concurrent_searches(self, populated_db):
+        db, data = populated_db
+        db.use_flat_index()
+        db.build_index()
+        errors = []
+
+        def run(offset):
+            for i in range(offset, offset + 50):
+                if db.search(data[i], k=1).ids != [i]:
+                    errors.append(i)
+
+        threads = [
+            threading.Thread(target=run, args=(t * 50,)) for t in range(4)
+        ]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert errors == []
+        assert db.search_stats().queries == 200
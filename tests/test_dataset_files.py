@@ -0,0 +1,137 @@
+"""Tests for loading vectors from .fvecs/.bvecs/.ivecs/.npy files."""
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, read_ivecs
+
+
+def _write_vecs(path, rows, dtype):
+    """Write TEXMEX records: int32 dim, then the row's components."""
+    rows = np.asarray(rows, dtype=dtype)
+    dim = np.full((rows.shape[0], 1), rows.shape[1], dtype=np.int32)
+    with open(path, "wb") as f:
+        for prefix, row in zip(dim, rows):
+            f.write(prefix.tobytes())
+            f.write(row.tobytes())
+
+
+@pytest.fixture
+def data():
+    return np.random.RandomState(5).standard_normal((300, 16)).astype(np.float32)
+
+
+class TestAddFromFile:
+
+    def test_fvecs(self, data, tmp_path):
+        path = str(tmp_path / "base.fvecs")
+        _write_vecs(path, data, np.float32)
+        db = VegamDB()
+        assert db.add_from_file(path) == 300
+        assert db.size() == 300
+        assert db.dimension() == 16
+        assert db.search(data[9], k=1).ids[0] == 9
+
+    def test_bvecs_converted_to_float(self, tmp_path):
+        rows = np.random.RandomState(1).randint(0, 256, (50, 8)).astype(np.uint8)
+        path = str(tmp_path / "base.bvecs")
+        _write_vecs(path, rows, np.uint8)
+        db = VegamDB()
+        db.add_from_file(path)
+        results = db.search(rows[4].astype(np.float32), k=1)
+        assert results.ids[0] == 4
+        assert results.distances[0] == pytest.approx(0.0)
+
+    @pytest.mark.parametrize("dtype", [np.float32, np.float64])
+    def test_npy(self, data, tmp_path, dtype):
+        path = str(tmp_path / "base.npy")
+        np.save(path, data.astype(dtype))
+        db = VegamDB()
+        assert db.add_from_file(path) == 300
+        assert db.search(data[123], k=1).ids[0] == 123
+
+    def test_max_rows(self, data, tmp_path):
+        path = str(tmp_path / "base.npy")
+        np.save(path, data)
+        db = VegamDB()
+        assert db.add_from_file(path, max_rows=100) == 100
+        assert db.size() == 100
+
+    def test_appends_to_existing_vectors(self, data, tmp_path):
+        path = str(tmp_path / "base.npy")
+        np.save(path, data[100:])
+        db = VegamDB()
+        db.add_vector_numpy(data[:100])
+        db.add_from_file(path)
+        assert db.size() == 300
+        assert db.search(data[250], k=1).ids[0] == 250
+
+    def test_dimension_mismatch_raises(self, data, tmp_path):
+        path = str(tmp_path / "base.npy")
+        np.save(path, data)
+        db = VegamDB()
+        db.add_vector([1.0, 2.0, 3.0])
+        with pytest.raises(ValueError):
+            db.add_from_file(path)
+        assert db.size() == 1
+
+    def test_unknown_extension_raises(self, tmp_path):
+        with pytest.raises(ValueError):
+            VegamDB().add_from_file(str(tmp_path / "base.csv"))
+
+    def test_truncated_file_raises(self, data, tmp_path):
+        path = tmp_path / "base.fvecs"
+        _write_vecs(str(path), data, np.float32)
+        path.write_bytes(path.read_bytes()[:-3])
+        with pytest.raises(RuntimeError):
+            VegamDB().add_from_file(str(path))
+
+    def test_failed_read_adds_nothing(self, tmp_path):
+        # Past the first chunk, so earlier chunks were already read
+        rows = np.random.RandomState(2).random((20000, 4)).astype(np.float32)
+        path = tmp_path / "base.fvecs"
+        _write_vecs(str(path), rows, np.float32)
+        raw = bytearray(path.read_bytes())
+        raw[19000 * 20] = 5  # Dimension prefix of row 19000
+        path.write_bytes(bytes(raw))
+
+        snapshot = str(tmp_path / "db.vegam")
+        db = VegamDB()
+        db.enable_wal(snapshot)
+        db.add_vector_numpy(rows[:10])
+        with pytest.raises(RuntimeError):
+            db.add_from_file(str(path))
+        assert db.size() == 10
+
+        # Nothing reached the log either
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.size() == 10
+
+    def test_fortran_order_npy_raises(self, data, tmp_path):
+        path = str(tmp_path / "base.npy")
+        np.save(path, np.asfortranarray(data))
+        with pytest.raises(RuntimeError):
+            VegamDB().add_from_file(path)
+
+
+class TestReadIvecs:
+
+    def test_ivecs(self, tmp_path):
+        ids = np.arange(40, dtype=np.int32).reshape(4, 10)
+        path = str(tmp_path / "gt.ivecs")
+        _write_vecs(path, ids, np.int32)
+        result = read_ivecs(path)
+        assert result.dtype == np.int32
+        np.testing.assert_array_equal(result, ids)
+
+    def test_integer_npy(self, tmp_path):
+        ids = np.arange(12, dtype=np.int64).reshape(3, 4)
+        path = str(tmp_path / "gt.npy")
+        np.save(path, ids)
+        np.testing.assert_array_equal(read_ivecs(path, max_rows=2), ids[:2])
+
+    def test_ivecs_rejected_as_vectors(self, tmp_path):
+        path = str(tmp_path / "gt.ivecs")
+        _write_vecs(path, np.zeros((2, 3), dtype=np.int32), np.int32)
+        with pytest.raises(ValueError):
+            VegamDB().add_from_file(path)
@@ -0,0 +1,150 @@
+"""Tests for DiskANN Index (disk-resident Vamana graph with PQ navigation)."""
+
+import os
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, DiskANNSearchParams, Metric, SearchStats
+
+
+@pytest.fixture
+def diskann_db(tmp_path):
+    """VegamDB with a DiskANN index built on 1000 vectors."""
+    db = VegamDB()
+    data = np.random.RandomState(42).random((1000, 64)).astype(np.float32)
+    db.add_vector_numpy(data)
+    db.use_diskann_index(str(tmp_path / "graph.bin"), max_degree=32,
+                         build_list=64, search_list=64, pq_subspaces=16)
+    db.build_index()
+    return db, data, tmp_path
+
+
+class TestDiskANNIndex:
+    """DiskANN index search tests."""
+
+    def test_graph_file_written(self, diskann_db):
+        _, _, tmp_path = diskann_db
+        assert os.listdir(tmp_path) == ["graph.bin"]
+        assert os.path.getsize(tmp_path / "graph.bin") % 4096 == 0
+
+    def test_self_query(self, diskann_db):
+        db, data, _ = diskann_db
+        for i in (0, 123, 999):
+            results = db.search(data[i], k=1)
+            assert results.ids == [i]
+            assert results.distances[0] == pytest.approx(0.0, abs=1e-4)
+
+    def test_distances_sorted(self, diskann_db):
+        db, data, _ = diskann_db
+        results = db.search(data[0], k=10)
+        assert len(results.ids) == 10
+        assert results.distances == sorted(results.distances)
+
+    def test_recall_against_flat(self, diskann_db):
+        db, data, _ = diskann_db
+        queries = np.random.RandomState(7).random((20, 64)).astype(np.float32)
+        approx = [db.search(q, k=10).ids for q in queries]
+
+        db.use_flat_index()
+        hits = sum(len(set(a) & set(db.search(q, k=10).ids))
+                   for a, q in zip(approx, queries))
+        assert hits / 200 >= 0.8
+
+    def test_search_params_override(self, diskann_db):
+        db, data, _ = diskann_db
+        params = DiskANNSearchParams()
+        params.search_list = 200
+        params.beam_width = 8
+        results = db.search(data[5], k=5, params=params)
+        assert results.ids[0] == 5
+
+    def test_filter(self, diskann_db):
+        db, data, _ = diskann_db
+        results = db.search(data[0], k=3, filter=[1, 2, 3, 500])
+        assert len(results.ids) == 3
+        assert set(results.ids) <= {1, 2, 3, 500}
+
+    def test_filtered_recall(self, diskann_db):
+        db, data, _ = diskann_db
+        allowed = list(range(0, 1000, 7))
+        queries = np.random.RandomState(3).random((20, 64)).astype(np.float32)
+        # Too short a list for the filter: the search widens it instead of
+        # falling back to an exact scan
+        params = DiskANNSearchParams()
+        params.search_list = 16
+        approx = []
+        for q in queries:
+            stats = SearchStats()
+            approx.append(db.search(q, k=10, params=params, filter=allowed,
+                                    stats=stats).ids)
+            assert not stats.filter_fallback
+
+        db.use_flat_index()
+        hits = sum(len(set(a) & set(db.search(q, k=10, filter=allowed).ids))
+                   for a, q in zip(approx, queries))
+        assert hits / 200 >= 0.85
+
+    def test_build_progress_phases(self, diskann_db):
+        db, _, _ = diskann_db
+        progress = db.build_progress()
+        assert progress.index == "DiskANNIndex"
+        assert [name for name, _ in progress.phases] == ["pq", "graph", "write"]
+
+
+class TestDiskANNPersistence:
+
+    def test_save_load_round_trip(self, diskann_db):
+        db, data, tmp_path = diskann_db
+        before = db.search(data[9], k=5)
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        after = db2.search(data[9], k=5)
+        assert after.ids == before.ids
+
+    def test_load_maps_vectors_read_only(self, diskann_db):
+        db, data, tmp_path = diskann_db
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.is_external() and db2.size() == 1000
+        assert db2.search(data[9], k=1).ids == [9]
+        # Too few allowed ids for the beam: answered from the graph file
+        results = db2.search(data[0], k=3, filter=[1, 2, 3, 500])
+        db.use_flat_index()
+        assert results.ids == db.search(data[0], k=3,
+                                        filter=[1, 2, 3, 500]).ids
+        with pytest.raises(RuntimeError):
+            db2.add_vector(data[0].tolist())
+
+    def test_missing_graph_file_raises(self, diskann_db):
+        db, _, tmp_path = diskann_db
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+        os.remove(tmp_path / "graph.bin")
+
+        with pytest.raises(RuntimeError):
+            VegamDB().load(snapshot)
+
+    def test_failed_load_leaves_database_untouched(self, diskann_db):
+        db, _, tmp_path = diskann_db
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+        os.remove(tmp_path / "graph.bin")
+
+        # The index fails to open after the vectors have decoded
+        target = VegamDB(Metric.COSINE)
+        own = np.random.RandomState(1).random((10, 8)).astype(np.float32)
+        target.add_vector_numpy(own)
+        target.remove([4])
+        with pytest.raises(RuntimeError):
+            target.load(snapshot)
+
+        assert target.size() == 10 and target.dimension() == 8
+        assert target.metric() == Metric.COSINE
+        assert target.is_deleted(4) and target.deleted_count() == 1
+        assert target.search(own[2].tolist(), k=1).ids == [2]
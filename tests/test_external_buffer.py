@@ -0,0 +1,114 @@
+"""Tests for searching a caller-owned NumPy array in place (attach_numpy)."""
+
+import gc
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, Metric
+
+
+@pytest.fixture
+def data():
+    return np.random.RandomState(3).standard_normal((500, 32)).astype(np.float32)
+
+
+class TestAttachNumpy:
+
+    def test_matches_copied_store(self, data):
+        copied = VegamDB()
+        copied.add_vector_numpy(data)
+        attached = VegamDB()
+        attached.attach_numpy(data)
+
+        assert attached.is_external()
+        assert attached.size() == 500
+        assert attached.dimension() == 32
+        for i in (0, 17, 499):
+            a = attached.search(data[i], k=5)
+            b = copied.search(data[i], k=5)
+            assert a.ids == b.ids
+            assert a.distances == pytest.approx(b.distances)
+
+    @pytest.mark.parametrize("index", ["ivf", "annoy"])
+    def test_index_builds_over_attached_array(self, data, index):
+        db = VegamDB()
+        db.attach_numpy(data)
+        if index == "ivf":
+            db.use_ivf_index(n_clusters=8, max_iters=10, n_probe=8)
+        else:
+            db.use_annoy_index(num_trees=5, k_leaf=20, search_k=500)
+        db.build_index()
+        assert db.search(data[42], k=1).ids[0] == 42
+
+    def test_searches_in_place(self, data):
+        db = VegamDB()
+        db.attach_numpy(data)
+        data[10] = 100.0
+        query = np.full(32, 100.0, dtype=np.float32)
+        assert db.search(query, k=1).ids[0] == 10
+
+    def test_keeps_array_alive(self):
+        db = VegamDB()
+        arr = np.ones((4, 8), dtype=np.float32) * np.arange(4, dtype=np.float32)[:, None]
+        db.attach_numpy(arr)
+        del arr
+        gc.collect()
+        query = np.full(8, 3.0, dtype=np.float32)
+        assert db.search(query, k=1).ids[0] == 3
+
+    def test_memmap(self, data, tmp_path):
+        path = tmp_path / "corpus.f32"
+        data.tofile(path)
+        mm = np.memmap(path, dtype=np.float32, mode="r", shape=data.shape)
+        db = VegamDB()
+        db.attach_numpy(mm)
+        assert db.search(data[7], k=1).ids[0] == 7
+
+    def test_read_only(self, data):
+        db = VegamDB()
+        db.attach_numpy(data)
+        with pytest.raises(RuntimeError):
+            db.add_vector_numpy(data[:1])
+        with pytest.raises(RuntimeError):
+            db.add_vector([0.0] * 32)
+
+    def test_rejects_non_empty_db(self, data):
+        db = VegamDB()
+        db.add_vector_numpy(data[:10])
+        with pytest.raises(RuntimeError):
+            db.attach_numpy(data)
+
+    @pytest.mark.parametrize(
+        "bad",
+        [
+            lambda d: d.astype(np.float64),
+            lambda d: d[:, ::2],
+            lambda d: d[0],
+        ],
+    )
+    def test_rejects_unsupported_layout(self, data, bad):
+        db = VegamDB()
+        with pytest.raises(ValueError):
+            db.attach_numpy(bad(data))
+
+    def test_cosine_requires_unit_norm(self, data):
+        db = VegamDB(metric=Metric.COSINE)
+        with pytest.raises(ValueError):
+            db.attach_numpy(data)
+
+        normed = data / np.linalg.norm(data, axis=1, keepdims=True)
+        db.attach_numpy(normed)
+        assert db.search(data[5] * 3.0, k=1).ids[0] == 5
+
+    def test_save_load_owns_copy(self, data, tmp_path):
+        path = str(tmp_path / "attached.vegam")
+        db = VegamDB()
+        db.attach_numpy(data)
+        db.save(path)
+
+        db2 = VegamDB()
+        db2.load(path)
+        assert not db2.is_external()
+        assert db2.size() == 500
+        db2.add_vector_numpy(data[:1])
+        assert db2.size() == 501
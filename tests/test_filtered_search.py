@@ -0,0 +1,152 @@
+"""Tests for filtered search with allow-lists pushed into the index scans."""
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, Bitmap, Predicate, AnnoyIndexParams, IVFSearchParams
+
+
+def _exact_filtered(data, query, allowed, k):
+    allowed = np.array(sorted(allowed))
+    dists = ((data[allowed] - query) ** 2).sum(axis=1)
+    return list(allowed[np.argsort(dists)[:k]])
+
+
+class TestBitmap:
+    """Basic Bitmap behavior."""
+
+    def test_membership(self):
+        bm = Bitmap([1, 5, 64, 200])
+        assert len(bm) == 4
+        assert 5 in bm
+        assert 6 not in bm
+        assert 1000 not in bm
+        assert bm.to_list() == [1, 5, 64, 200]
+
+    def test_add_remove(self):
+        bm = Bitmap()
+        bm.add(10)
+        bm.add(10)
+        assert len(bm) == 1
+        bm.remove(10)
+        assert len(bm) == 0
+
+    def test_set_operations(self):
+        a = Bitmap([1, 2, 3])
+        b = Bitmap([2, 3, 400])
+        assert (a & b).to_list() == [2, 3]
+        assert (a | b).to_list() == [1, 2, 3, 400]
+
+
+class TestFilteredSearch:
+    """Every index must only return allowed ids."""
+
+    @pytest.mark.parametrize("index", ["flat", "ivf", "annoy"])
+    def test_only_allowed_ids(self, populated_db, index):
+        db, data = populated_db
+        if index == "ivf":
+            db.use_ivf_index(n_clusters=10, max_iters=20, n_probe=2)
+        elif index == "annoy":
+            db.use_annoy_index(num_trees=10, k_leaf=20, search_k=100)
+        db.build_index()
+
+        allowed = set(range(0, 1000, 3))
+        results = db.search(data[1], k=10, filter=Bitmap(list(allowed)))
+        assert len(results.ids) == 10
+        assert all(i in allowed for i in results.ids)
+
+    def test_list_filter_flat_exact(self, populated_db):
+        db, data = populated_db
+        allowed = list(range(500, 1000))
+        results = db.search(data[0], k=5, filter=allowed)
+        assert results.ids == _exact_filtered(data, data[0], allowed, 5)
+
+    def test_selective_filter_falls_back_to_exact(self, populated_db):
+        """A tiny allow-list should return the exact filtered neighbors."""
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=20, n_probe=1)
+        db.build_index()
+
+        allowed = [7, 123, 456, 789, 999]
+        params = IVFSearchParams()
+        params.n_probe = 1
+        results = db.search(data[0], k=5, params=params, filter=allowed)
+        assert results.ids == _exact_filtered(data, data[0], allowed, 5)
+
+    def test_annoy_selective_filter(self, populated_db):
+        db, data = populated_db
+        db.use_annoy_index(num_trees=5, k_leaf=20)
+        db.build_index()
+
+        allowed = [11, 22, 33]
+        params = AnnoyIndexParams()
+        params.search_k = 50
+        results = db.search(data[0], k=3, params=params, filter=allowed)
+        assert sorted(results.ids) == allowed
+
+    def test_empty_filter(self, populated_db):
+        db, data = populated_db
+        results = db.search(data[0], k=5, filter=Bitmap())
+        assert len(results.ids) == 0
+
+
+@pytest.fixture
+def attr_db(populated_db):
+    """populated_db with tenant (int), price (float) and color (str) columns."""
+    db, data = populated_db
+    ids = np.arange(1000)
+    db.set_int_attribute("tenant", ids % 10)
+    db.set_float_attribute("price", (ids * 0.5).astype(np.float32))
+    db.set_string_attribute("color", ["red" if i % 2 else "blue" for i in ids])
+    return db, data
+
+
+class TestAttributeFilters:
+    """Predicates over typed attribute columns."""
+
+    def test_attribute_names(self, attr_db):
+        db, _ = attr_db
+        assert db.attribute_names() == ["color", "price", "tenant"]
+
+    def test_eq(self, attr_db):
+        db, _ = attr_db
+        bm = db.evaluate(Predicate.eq("tenant", 3))
+        assert len(bm) == 100
+        assert all(i % 10 == 3 for i in bm.to_list())
+
+    def test_isin_strings(self, attr_db):
+        db, _ = attr_db
+        assert len(db.evaluate(Predicate.isin("color", ["red", "green"]))) == 500
+        assert len(db.evaluate(Predicate.isin("color", ["green"]))) == 0
+
+    def test_range(self, attr_db):
+        db, _ = attr_db
+        bm = db.evaluate(Predicate.range("price", 10.0, 20.0))
+        assert bm.to_list() == list(range(20, 41))
+
+    def test_search_with_predicate(self, attr_db):
+        db, data = attr_db
+        results = db.search(data[3], k=5, filter=Predicate.eq("tenant", 3))
+        assert results.ids[0] == 3
+        assert all(i % 10 == 3 for i in results.ids)
+
+    def test_combined_bitmaps(self, attr_db):
+        db, _ = attr_db
+        bm = db.evaluate(Predicate.eq("tenant", 3)) & db.evaluate(
+            Predicate.eq("color", "red")
+        )
+        assert len(bm) == 100
+
+    def test_unknown_column_raises(self, attr_db):
+        db, data = attr_db
+        with pytest.raises(ValueError):
+            db.search(data[0], k=5, filter=Predicate.eq("missing", 1))
+
+    def test_type_mismatch_raises(self, attr_db):
+        db, _ = attr_db
+        with pytest.raises(ValueError):
+            db.evaluate(Predicate.range("color", 0, 1))
+
+    def test_too_many_values_raises(self, db):
+        db.add_vector([1.0, 2.0])
+        with pytest.raises(ValueError):
+            db.set_int_attribute("tenant", np.arange(5))
@@ -2,7 +2,7 @@
 
 import numpy as np
 import pytest
-from vegamdb import VegamDB
+from vegamdb import VegamDB, SearchStats
 
 
 class TestFlatSearch:
@@ -48,3 +48,83 @@ class TestFlatSearch:
         results = db.search([1.0, 2.0, 3.0], k=5)
         assert len(results.ids) == 0
         assert len(results.distances) == 0
+
+    def test_query_dimension_mismatch_raises(self, populated_db):
+        """A query of another length would read past the stored rows."""
+        db, _ = populated_db
+        with pytest.raises(ValueError):
+            db.search([0.5] * 4096, k=5)
+        with pytest.raises(ValueError):
+            db.search([0.5] * 63, k=5)
+
+    def test_large_scan_matches_brute_force(self):
+        """Scans big enough to be split across threads stay exact."""
+        db = VegamDB()
+        data = np.random.RandomState(5).random((40000, 64)).astype(np.float32)
+        db.add_vector_numpy(data)
+        query = np.random.RandomState(6).random(64).astype(np.float32)
+
+        expected = np.argsort(((data - query) ** 2).sum(axis=1))[:20]
+        assert db.search(query, k=20).ids == list(expected)
+
+    def test_early_abandoning_stays_exact(self):
+        """Bounded distances with reordered dimension blocks stay exact."""
+        db = VegamDB()
+        rng = np.random.RandomState(8)
+        # A few high-variance blocks, so they are visited first
+        scale = np.where(np.arange(768) % 256 < 64, 4.0, 0.5)
+        data = (rng.standard_normal((3000, 768)) * scale).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_flat_index()
+        db.build_index()
+        query = (rng.standard_normal(768) * scale).astype(np.float32)
+
+        distances = ((data - query) ** 2).sum(axis=1)
+        expected = np.argsort(distances)[:10]
+        results = db.search(query, k=10)
+        assert results.ids == list(expected)
+        assert results.distances == pytest.approx(
+            list(distances[expected]), rel=1e-4)
+
+    def test_removal_keeps_the_scan(self):
+        """Once a row is removed every scan is filtered by the live rows;
+        it must rank, break ties and count like the unfiltered one."""
+        db = VegamDB()
+        data = np.random.RandomState(12).random((40000, 64)).astype(np.float32)
+        data[[20, 30]] = data[10]  # three-way tie at distance 0
+        db.add_vector_numpy(data)
+        db.use_flat_index()
+        db.build_index()
+
+        before_stats = SearchStats()
+        before = db.search(data[10], k=10, stats=before_stats)
+        assert before.ids[:3] == [10, 20, 30]
+
+        farthest = int(np.argmax(((data - data[10]) ** 2).sum(axis=1)))
+        db.remove([farthest])
+        after_stats = SearchStats()
+        after = db.search(data[10], k=10, stats=after_stats)
+        assert after.ids == before.ids
+        assert after.distances == before.distances
+        assert after_stats.distance_computations == \
+            before_stats.distance_computations - 1
+        assert after_stats.candidates == before_stats.candidates - 1
+
+    def test_early_abandoning_after_reload(self, tmp_path):
+        """A reloaded index ranks its dimension blocks again and stays
+        exact."""
+        db = VegamDB()
+        rng = np.random.RandomState(9)
+        scale = np.where(np.arange(512) >= 384, 4.0, 0.5)
+        data = (rng.standard_normal((3000, 512)) * scale).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_flat_index()
+        db.build_index()
+        path = str(tmp_path / "flat.vegam")
+        db.save(path)
+
+        loaded = VegamDB()
+        loaded.load(path)
+        query = (rng.standard_normal(512) * scale).astype(np.float32)
+        expected = np.argsort(((data - query) ** 2).sum(axis=1))[:10]
+        assert loaded.search(query, k=10).ids == list(expected)
@@ -0,0 +1,163 @@
+"""Tests for HNSW Index (in-memory graph with concurrent incremental inserts)."""
+
+import threading
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, HNSWSearchParams
+
+
+@pytest.fixture
+def hnsw_db():
+    """VegamDB with an HNSW index built on 1000 vectors."""
+    db = VegamDB()
+    data = np.random.RandomState(42).random((1000, 64)).astype(np.float32)
+    db.add_vector_numpy(data)
+    db.use_hnsw_index(M=16, ef_construction=100)
+    db.build_index()
+    return db, data
+
+
+def brute_force(data, query, k):
+    distances = ((data - query) ** 2).sum(axis=1)
+    return list(np.argsort(distances)[:k])
+
+
+class TestHNSWIndex:
+    """HNSW index search tests."""
+
+    def test_self_query(self, hnsw_db):
+        db, data = hnsw_db
+        for i in (0, 123, 999):
+            assert db.search(data[i], k=1).ids == [i]
+
+    def test_distances_sorted(self, hnsw_db):
+        db, data = hnsw_db
+        results = db.search(data[0], k=10)
+        assert len(results.ids) == 10
+        assert results.distances == sorted(results.distances)
+
+    def test_recall_against_brute_force(self, hnsw_db):
+        db, data = hnsw_db
+        queries = np.random.RandomState(7).random((20, 64)).astype(np.float32)
+        hits = sum(len(set(db.search(q, k=10).ids) &
+                       set(brute_force(data, q, 10))) for q in queries)
+        assert hits / 200 >= 0.9
+
+    def test_search_params_override(self, hnsw_db):
+        db, data = hnsw_db
+        params = HNSWSearchParams()
+        params.ef_search = 200
+        results = db.search(data[5], k=5, params=params)
+        assert results.ids[0] == 5
+
+    def test_filter(self, hnsw_db):
+        db, data = hnsw_db
+        results = db.search(data[0], k=3, filter=list(range(1, 200)))
+        assert len(results.ids) == 3
+        assert all(1 <= i < 200 for i in results.ids)
+
+    def test_build_progress_phase(self, hnsw_db):
+        db, data = hnsw_db
+        progress = db.build_progress()
+        assert progress.index == "HNSWIndex"
+        assert progress.done == progress.total == len(data)
+        assert [name for name, _ in progress.phases] == ["graph"]
+
+
+class TestHNSWStreaming:
+
+    def test_added_vectors_are_searchable(self, hnsw_db):
+        db, _ = hnsw_db
+        new = np.random.RandomState(1).random((300, 64)).astype(np.float32)
+        db.add_vector_numpy(new)
+
+        assert db.search(new[0], k=1).ids == [1000]
+        db.add_vector(list(new[1] + 10.0))
+        assert db.search(new[1] + 10.0, k=1).ids == [1300]
+
+    def test_concurrent_adds_and_searches(self, hnsw_db):
+        db, data = hnsw_db
+        new = np.random.RandomState(2).random((800, 64)).astype(np.float32)
+        errors = []
+
+        def add(chunk):
+            for batch in np.array_split(chunk, 10):
+                db.add_vector_numpy(batch)
+
+        def search():
+            try:
+                for i in range(200):
+                    assert len(db.search(data[i], k=5).ids) == 5
+            except AssertionError as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=add, args=(c,))
+                   for c in np.array_split(new, 4)]
+        threads.append(threading.Thread(target=search))
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        assert not errors
+        assert db.size() == 1800
+        # Every added vector is reachable in the graph
+        for row in new[::50]:
+            assert db.search(row, k=1).distances[0] == pytest.approx(0.0)
+
+    def test_removed_vectors_are_skipped(self, hnsw_db):
+        db, data = hnsw_db
+        db.remove([3])
+        assert 3 not in db.search(data[3], k=5).ids
+
+
+class TestHNSWPersistence:
+
+    def test_save_load_round_trip(self, hnsw_db, tmp_path):
+        db, data = hnsw_db
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.search(data[9], k=5).ids == db.search(data[9], k=5).ids
+
+    def test_wal_replay_links_new_vectors(self, hnsw_db, tmp_path):
+        db, _ = hnsw_db
+        snapshot = str(tmp_path / "db.vegam")
+        db.save(snapshot)
+        db.enable_wal(snapshot, sync=False)
+        extra = np.full(64, 5.0, dtype=np.float32)
+        db.add_vector_numpy(extra)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.search(extra, k=1).ids == [1000]
+
+    def test_save_during_concurrent_adds(self, hnsw_db, tmp_path):
+        """A save can land after the store took a batch but before the
+        graph linked it; the loaded graph must still reach every row."""
+        db, _ = hnsw_db
+        new = np.random.RandomState(3).random((2000, 64)).astype(np.float32)
+        snapshot = str(tmp_path / "db.vegam")
+
+        def add():
+            for batch in np.array_split(new, 20):
+                db.add_vector_numpy(batch)
+
+        adder = threading.Thread(target=add)
+        adder.start()
+        snapshots = []
+        while adder.is_alive() or not snapshots:
+            db.save(snapshot)
+            loaded = VegamDB()
+            loaded.load(snapshot)
+            snapshots.append(loaded)
+        adder.join()
+
+        for loaded in snapshots:
+            added = loaded.size() - 1000
+            for i in range(0, added, 97):
+                result = loaded.search(new[i], k=1)
+                assert result.distances[0] == pytest.approx(0.0)
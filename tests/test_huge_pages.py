@@ -0,0 +1,53 @@
+"""Tests for huge-page backed buffers."""
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, HugePages, set_huge_pages, huge_page_status
+
+
+@pytest.fixture(autouse=True)
+def restore_mode():
+    yield
+    set_huge_pages(HugePages.TRANSPARENT)
+
+
+def large_buffer_bytes(status):
+    return (status.explicit_bytes + status.transparent_bytes +
+            status.regular_bytes)
+
+
+class TestHugePages:
+
+    def test_default_mode(self):
+        assert huge_page_status().mode == HugePages.TRANSPARENT
+
+    def test_set_mode(self):
+        set_huge_pages(HugePages.OFF)
+        assert huge_page_status().mode == HugePages.OFF
+
+    @pytest.mark.parametrize("mode", [HugePages.OFF, HugePages.TRANSPARENT,
+                                      HugePages.EXPLICIT])
+    def test_large_store_is_tracked_and_searchable(self, mode):
+        set_huge_pages(mode)
+        before = large_buffer_bytes(huge_page_status())
+
+        db = VegamDB()
+        data = np.random.RandomState(0).random((20000, 64)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=8, n_probe=8)
+        db.build_index()
+
+        status = huge_page_status()
+        if status.supported:
+            # 20000 x 64 floats is 5 MB, above the 2 MB threshold
+            assert large_buffer_bytes(status) - before >= data.nbytes
+            if mode == HugePages.OFF:
+                assert status.regular_bytes >= data.nbytes
+        assert db.search(data[17], k=1).ids == [17]
+
+    def test_buffers_are_released(self):
+        before = large_buffer_bytes(huge_page_status())
+        db = VegamDB()
+        db.add_vector_numpy(np.ones((20000, 64), dtype=np.float32))
+        del db
+        assert large_buffer_bytes(huge_page_status()) == before
@@ -2,7 +2,7 @@
 
 import numpy as np
 import pytest
-from vegamdb import VegamDB, IVFSearchParams
+from vegamdb import VegamDB, IVFSearchParams, CoarseQuantizer, IVFStorage
 
 
 @pytest.fixture
@@ -54,3 +54,120 @@ class TestIVFIndex:
         assert len(results_high.ids) == 5
         # Higher n_probe should find at least as good a nearest neighbor
         assert results_high.distances[0] <= results_low.distances[0]
+
+    def test_probing_every_list_is_exact(self):
+        """All lists probed (split across threads when large) is exact."""
+        db = VegamDB()
+        data = np.random.RandomState(5).random((40000, 64)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=16, max_iters=5)
+        db.build_index()
+        query = np.random.RandomState(6).random(64).astype(np.float32)
+
+        params = IVFSearchParams()
+        params.n_probe = 16
+        expected = np.argsort(((data - query) ** 2).sum(axis=1))[:20]
+        assert db.search(query, k=20, params=params).ids == list(expected)
+
+    def test_hnsw_coarse_quantizer(self, tmp_path):
+        """A graph over the centroids finds the self-match and persists."""
+        db = VegamDB()
+        data = np.random.RandomState(8).random((5000, 32)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=256, max_iters=5, n_probe=4,
+                         coarse_quantizer=CoarseQuantizer.HNSW)
+        db.build_index()
+
+        params = IVFSearchParams()
+        params.n_probe = 4
+        params.coarse_ef = 128
+        hits = sum(db.search(data[i], k=1, params=params).ids == [i]
+                   for i in range(0, 5000, 50))
+        assert hits >= 95
+
+        path = str(tmp_path / "coarse.vegam")
+        db.save(path)
+        loaded = VegamDB()
+        loaded.load(path)
+        for i in (0, 1234, 4999):
+            assert (loaded.search(data[i], k=5, params=params).ids ==
+                    db.search(data[i], k=5, params=params).ids)
+
+    def test_sq8_storage_with_rerank(self, tmp_path):
+        """SQ8 codes keep recall high; a re-rank returns exact distances."""
+        db = VegamDB()
+        data = np.random.RandomState(9).random((5000, 32)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=16, max_iters=5, storage=IVFStorage.SQ8)
+        db.build_index()
+
+        params = IVFSearchParams()
+        params.n_probe = 16
+        query = data[42]
+        expected = np.argsort(((data - query) ** 2).sum(axis=1))[:10]
+        approx = db.search(query, k=10, params=params)
+        assert len(set(approx.ids) & set(expected)) >= 8
+
+        params.rerank_factor = 2
+        exact = db.search(query, k=10, params=params)
+        assert exact.ids == list(expected)
+        assert exact.distances[0] == pytest.approx(0.0, abs=1e-5)
+
+        path = str(tmp_path / "sq8.vegam")
+        db.save(path)
+        loaded = VegamDB()
+        loaded.load(path)
+        assert loaded.search(query, k=10, params=params).ids == exact.ids
+
+    def test_balanced_lists_respect_cap(self):
+        """max_list_factor bounds every list; stats describe the lists."""
+        rng = np.random.RandomState(10)
+        # One dense blob holding most of the data skews plain k-means
+        data = np.vstack([rng.normal(0, 0.05, (3000, 16)),
+                          rng.random((1000, 16)) * 4]).astype(np.float32)
+        db = VegamDB()
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=20, max_iters=5, max_list_factor=1.5)
+        db.build_index()
+
+        stats = db.ivf_list_size_stats()
+        assert sum(db.ivf_list_sizes()) == 4000
+        assert stats.lists == 20 and stats.mean == pytest.approx(200.0)
+        assert stats.max <= 300
+        assert stats.imbalance <= 1.5
+        assert stats.min <= stats.p50 <= stats.p90 <= stats.p99 <= stats.max
+
+        params = IVFSearchParams()
+        params.n_probe = 20
+        assert db.search(data[5], k=1, params=params).ids == [5]
+
+    def test_negative_list_factor_rejected(self):
+        with pytest.raises(ValueError):
+            VegamDB().use_ivf_index(n_clusters=4, max_list_factor=-1.0)
+
+    def test_list_size_stats_need_ivf(self, populated_db):
+        db, _ = populated_db
+        db.use_flat_index()
+        with pytest.raises(RuntimeError):
+            db.ivf_list_size_stats()
+
+    def test_spill_stores_vectors_twice_and_dedups(self, tmp_path):
+        """spill=2 doubles the lists and never returns an id twice."""
+        db = VegamDB()
+        data = np.random.RandomState(11).random((4000, 16)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=32, max_iters=5, spill=2)
+        db.build_index()
+        assert sum(db.ivf_list_sizes()) == 8000
+
+        params = IVFSearchParams()
+        params.n_probe = 32
+        result = db.search(data[3], k=20, params=params)
+        expected = np.argsort(((data - data[3]) ** 2).sum(axis=1))[:20]
+        assert result.ids == list(expected)
+
+        path = str(tmp_path / "spill.vegam")
+        db.save(path)
+        loaded = VegamDB()
+        loaded.load(path)
+        assert loaded.search(data[3], k=20, params=params).ids == result.ids
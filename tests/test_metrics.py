@@ -0,0 +1,101 @@
+"""Tests for L2, inner-product and cosine metrics across all index types."""
+
+import threading
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, Metric
+
+
+def _use_index(db, index):
+    if index == "ivf":
+        db.use_ivf_index(n_clusters=10, max_iters=20, n_probe=10)
+    elif index == "annoy":
+        db.use_annoy_index(num_trees=10, k_leaf=50, search_k=1000)
+    else:
+        db.use_flat_index()
+    db.build_index()
+
+
+@pytest.fixture
+def data():
+    return np.random.RandomState(7).standard_normal((1000, 32)).astype(np.float32)
+
+
+class TestMetrics:
+    """Each metric must rank like a NumPy reference."""
+
+    def test_default_metric_is_l2(self, db):
+        assert db.metric() == Metric.L2
+
+    @pytest.mark.parametrize("index", ["flat", "ivf", "annoy"])
+    def test_inner_product(self, data, index):
+        db = VegamDB(metric=Metric.IP)
+        db.add_vector_numpy(data)
+        _use_index(db, index)
+
+        query = data[3]
+        results = db.search(query, k=1)
+        expected = int(np.argmax(data @ query))
+        assert results.ids[0] == expected
+        assert results.distances[0] == pytest.approx(
+            -float(data[expected] @ query), rel=1e-4
+        )
+
+    @pytest.mark.parametrize("index", ["flat", "ivf", "annoy"])
+    def test_cosine(self, data, index):
+        db = VegamDB(metric=Metric.COSINE)
+        db.add_vector_numpy(data)
+        _use_index(db, index)
+
+        # Scaling the query must not change cosine results
+        results = db.search(data[3] * 10.0, k=5)
+        assert results.ids[0] == 3
+        assert results.distances[0] == pytest.approx(0.0, abs=1e-5)
+
+        normed = data / np.linalg.norm(data, axis=1, keepdims=True)
+        sims = normed @ normed[3]
+        assert results.distances == pytest.approx(
+            list(1.0 - np.sort(sims)[::-1][:5]), abs=1e-4
+        )
+
+    def test_distances_sorted_for_ip(self, data):
+        db = VegamDB(metric=Metric.IP)
+        db.add_vector_numpy(data)
+        results = db.search(data[0], k=10)
+        assert results.distances == sorted(results.distances)
+
+    def test_metric_persists(self, data, tmp_path):
+        path = str(tmp_path / "cosine.vegam")
+        db = VegamDB(metric=Metric.COSINE)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=5, max_iters=10, n_probe=2)
+        db.build_index()
+        before = db.search(data[0], k=5)
+        db.save(path)
+
+        db2 = VegamDB()
+        db2.load(path)
+        assert db2.metric() == Metric.COSINE
+        after = db2.search(data[0], k=5)
+        assert before.ids == after.ids
+
+    def test_search_during_load_of_other_metric(self, data, tmp_path):
+        path = str(tmp_path / "cosine.vegam")
+        cosine = VegamDB(metric=Metric.COSINE)
+        cosine.add_vector_numpy(data)
+        cosine.save(path)
+
+        db = VegamDB()
+        db.add_vector_numpy(data)
+        loader = threading.Thread(
+            target=lambda: [db.load(path) for _ in range(5)])
+        loader.start()
+        while loader.is_alive():
+            assert db.search(data[3], k=1).ids == [3]
+        loader.join()
+
+        # The query is normalized under the same lock as the metric read
+        results = db.search(data[3] * 10, k=1)
+        assert results.ids == [3]
+        assert results.distances[0] == pytest.approx(0.0, abs=1e-5)
@@ -0,0 +1,34 @@
+"""Tests for NUMA-aware placement and scan routing."""
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, IVFSearchParams, set_numa_aware, numa_nodes
+
+
+@pytest.fixture
+def numa_on():
+    set_numa_aware(True)
+    yield
+    set_numa_aware(False)
+
+
+class TestNuma:
+
+    def test_reports_at_least_one_node(self):
+        assert numa_nodes() >= 1
+
+    def test_flat_and_ivf_stay_exact(self, numa_on):
+        rng = np.random.RandomState(3)
+        data = rng.random((40000, 64)).astype(np.float32)
+        query = rng.random(64).astype(np.float32)
+        expected = list(np.argsort(((data - query) ** 2).sum(axis=1))[:10])
+
+        db = VegamDB()
+        db.add_vector_numpy(data)
+        assert db.search(query, k=10).ids == expected
+
+        db.use_ivf_index(n_clusters=8)
+        db.build_index()
+        params = IVFSearchParams()
+        params.n_probe = 8
+        assert db.search(query, k=10, params=params).ids == expected
@@ -3,7 +3,7 @@
 import os
 import numpy as np
 import pytest
-from vegamdb import VegamDB
+from vegamdb import VegamDB, Metric, Compression, compression_available
 
 
 @pytest.fixture
@@ -91,3 +91,129 @@ class TestAnnoyPersistence:
         assert results_before.distances == pytest.approx(
             results_after.distances, abs=1e-5
         )
+
+
+class TestAttributePersistence:
+    """Attribute columns survive save/load."""
+
+    def test_round_trip(self, tmp_path_db):
+        from vegamdb import Predicate
+
+        db = VegamDB()
+        data = np.random.RandomState(42).random((100, 16)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.set_int_attribute("tenant", np.arange(100) % 4)
+        db.set_string_attribute("tag", ["a", "b"] * 50)
+        db.save(tmp_path_db)
+
+        db2 = VegamDB()
+        db2.load(tmp_path_db)
+        assert db2.attribute_names() == ["tag", "tenant"]
+        assert len(db2.evaluate(Predicate.eq("tenant", 1))) == 25
+        assert len(db2.evaluate(Predicate.eq("tag", "b"))) == 50
+
+
+class TestSnapshotFormat:
+    """Header, checksums and compatibility with the pre-snapshot format."""
+
+    def test_file_starts_with_magic(self, tmp_path_db):
+        db = VegamDB()
+        db.add_vector_numpy(np.ones((4, 8), dtype=np.float32))
+        db.save(tmp_path_db)
+        with open(tmp_path_db, "rb") as f:
+            assert f.read(8) == b"VEGAMDB\0"
+
+    def test_empty_database_round_trip(self, tmp_path_db):
+        VegamDB().save(tmp_path_db)
+
+        db2 = VegamDB()
+        db2.add_vector_numpy(np.ones((3, 8), dtype=np.float32))
+        db2.load(tmp_path_db)
+        assert db2.size() == 0
+
+    def test_corruption_is_detected(self, tmp_path_db):
+        db = VegamDB()
+        data = np.random.RandomState(0).random((200, 16)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.save(tmp_path_db)
+
+        raw = bytearray(open(tmp_path_db, "rb").read())
+        raw[len(raw) // 2] ^= 0xFF
+        open(tmp_path_db, "wb").write(bytes(raw))
+
+        db2 = VegamDB()
+        db2.add_vector_numpy(data[:5])
+        with pytest.raises(RuntimeError, match="checksum"):
+            db2.load(tmp_path_db)
+        # Nothing was replaced
+        assert db2.size() == 5
+
+    def test_truncation_is_detected(self, tmp_path_db):
+        db = VegamDB()
+        db.add_vector_numpy(np.ones((100, 16), dtype=np.float32))
+        db.save(tmp_path_db)
+
+        raw = open(tmp_path_db, "rb").read()
+        open(tmp_path_db, "wb").write(raw[:-16])
+        with pytest.raises(RuntimeError):
+            VegamDB().load(tmp_path_db)
+
+    def test_reads_legacy_files(self, tmp_path_db):
+        # Pre-snapshot layout: rows, dim, vectors, index name length (0),
+        # attribute column count (0), metric
+        data = np.random.RandomState(1).random((50, 8)).astype(np.float32)
+        header = np.array([50, 8], dtype=np.int32).tobytes()
+        trailer = np.array([0, 0, 1], dtype=np.int32).tobytes()
+        with open(tmp_path_db, "wb") as f:
+            f.write(header + data.tobytes() + trailer)
+
+        db = VegamDB()
+        db.load(tmp_path_db)
+        assert db.size() == 50
+        assert db.metric() == Metric.IP
+        assert db.search(data[3], k=1).ids == [int(np.argmax(data @ data[3]))]
+
+    def test_missing_file_raises(self, tmp_path):
+        with pytest.raises(RuntimeError):
+            VegamDB().load(str(tmp_path / "missing.vegam"))
+
+
+class TestSaveOptions:
+    """Compression and parallel serialization must round-trip."""
+
+    @pytest.mark.parametrize("parallel", [True, False])
+    @pytest.mark.parametrize("index", ["ivf", "annoy"])
+    def test_round_trip(self, tmp_path_db, index, parallel):
+        db = VegamDB()
+        data = np.random.RandomState(3).random((600, 16)).astype(np.float32)
+        db.add_vector_numpy(data)
+        if index == "ivf":
+            db.use_ivf_index(n_clusters=8, max_iters=10, n_probe=3)
+        else:
+            db.use_annoy_index(num_trees=6, k_leaf=30)
+        db.build_index()
+        db.set_int_attribute("group", np.arange(600) % 3)
+        before = db.search(data[7], k=10)
+
+        db.save(tmp_path_db, parallel=parallel)
+        db2 = VegamDB()
+        db2.load(tmp_path_db)
+        assert db2.search(data[7], k=10).ids == before.ids
+        assert db2.attribute_names() == ["group"]
+
+    def test_zstd(self, tmp_path_db):
+        db = VegamDB()
+        data = np.random.RandomState(4).random((300, 16)).astype(np.float32)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=4, max_iters=10, n_probe=4)
+        db.build_index()
+
+        if not compression_available(Compression.ZSTD):
+            with pytest.raises(ValueError):
+                db.save(tmp_path_db, compression=Compression.ZSTD)
+            return
+
+        db.save(tmp_path_db, compression=Compression.ZSTD)
+        db2 = VegamDB()
+        db2.load(tmp_path_db)
+        assert db2.search(data[0], k=5).ids == db.search(data[0], k=5).ids
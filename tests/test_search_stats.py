@@ -0,0 +1,86 @@
+"""Tests for per-query SearchStats and aggregate search statistics."""
+
+import numpy as np
+import pytest
+from vegamdb import VegamDB, SearchStats, IVFSearchParams, AnnoyIndexParams
+
+
+class TestSearchStats:
+
+    def test_flat_counts_every_vector(self, populated_db):
+        db, data = populated_db
+        stats = SearchStats()
+        db.search(data[0], k=5, stats=stats)
+        assert stats.distance_computations == 1000
+        assert stats.candidates == 1000
+        assert stats.total_us > 0
+        assert stats.total_us >= stats.scan_us
+
+    def test_ivf_lists_visited(self, populated_db):
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=10, n_probe=3)
+        db.build_index()
+
+        stats = SearchStats()
+        params = IVFSearchParams()
+        params.n_probe = 3
+        db.search(data[0], k=5, params=params, stats=stats)
+        assert stats.lists_visited == 3
+        # 10 centroids + the vectors in the probed lists
+        assert stats.distance_computations == 10 + stats.candidates
+        assert stats.candidates < 1000
+
+    def test_annoy_leaves_and_dedup(self, populated_db):
+        db, data = populated_db
+        db.use_annoy_index(num_trees=10, k_leaf=20, search_k=300)
+        db.build_index()
+
+        stats = SearchStats()
+        params = AnnoyIndexParams()
+        params.search_k = 300
+        params.use_priority_queue = True
+        db.search(data[0], k=5, params=params, stats=stats)
+        assert stats.leaves_visited > 0
+        assert stats.nodes_visited > 0
+        assert stats.candidates == stats.distance_computations
+        # The same point is found by several trees
+        assert stats.duplicates_removed > 0
+
+    def test_filter_fallback_flag(self, populated_db):
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=10, n_probe=2)
+        db.build_index()
+        stats = SearchStats()
+        db.search(data[0], k=3, filter=[1, 2, 3], stats=stats)
+        assert stats.filter_fallback
+        assert stats.candidates == 3
+
+    def test_stats_overwritten_per_query(self, populated_db):
+        db, data = populated_db
+        stats = SearchStats()
+        db.search(data[0], k=5, stats=stats)
+        db.search(data[1], k=5, stats=stats)
+        assert stats.distance_computations == 1000
+
+
+class TestAggregateStats:
+
+    def test_aggregates_accumulate(self, populated_db):
+        db, data = populated_db
+        for i in range(20):
+            db.search(data[i], k=5)
+        summary = db.search_stats()
+        assert summary.queries == 20
+        assert summary.distance_computations == 20 * 1000
+        assert sum(summary.latency_histogram_us) == 20
+        assert sum(summary.distance_histogram) == 20
+        assert summary.latency_percentile_us(50) <= summary.latency_percentile_us(99)
+
+    def test_reset(self, populated_db):
+        db, data = populated_db
+        db.search(data[0], k=5)
+        db.reset_search_stats()
+        summary = db.search_stats()
+        assert summary.queries == 0
+        assert summary.total_us == 0
+        assert summary.latency_percentile_us(99) == 0
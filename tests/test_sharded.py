@@ -0,0 +1,151 @@
+"""Tests for ShardedVegamDB."""
+
+import os
+
+import numpy as np
+import pytest
+from vegamdb import (ShardedVegamDB, ShardPolicy, Bitmap, IVFSearchParams,
+                     SearchStats)
+
+
+def brute_force(data, query, k, allowed=None):
+    distances = ((data - query) ** 2).sum(axis=1)
+    order = [i for i in np.argsort(distances, kind="stable")
+             if allowed is None or i in allowed]
+    return order[:k]
+
+
+@pytest.fixture
+def data():
+    return np.random.RandomState(5).random((3000, 32)).astype(np.float32)
+
+
+class TestShardedVegamDB:
+
+    def test_rejects_zero_shards(self):
+        with pytest.raises(ValueError):
+            ShardedVegamDB(0)
+
+    @pytest.mark.parametrize("policy", [ShardPolicy.HASH, ShardPolicy.RANGE])
+    def test_routing_covers_every_id(self, data, policy):
+        db = ShardedVegamDB(4, policy=policy, range_size=100)
+        db.add_vector_numpy(data[:1000])
+        db.add_vector_numpy(data[1000:])
+        assert db.size() == 3000
+        assert sum(db.shard(i).size() for i in range(4)) == 3000
+        for id in (0, 99, 100, 2999):
+            shard = db.shard_of(id)
+            rows = db.shard(shard).size()
+            assert id in [db.global_id(shard, j) for j in range(rows)]
+        if policy == ShardPolicy.RANGE:
+            assert [db.shard_of(i) for i in (0, 100, 200, 300, 400)] == \
+                [0, 1, 2, 3, 0]
+
+    @pytest.mark.parametrize("policy", [ShardPolicy.HASH, ShardPolicy.RANGE])
+    def test_flat_search_matches_brute_force(self, data, policy):
+        db = ShardedVegamDB(3, policy=policy, range_size=256)
+        db.add_vector_numpy(data)
+        for q in (0, 1234, 2999):
+            result = db.search(data[q], k=10)
+            assert result.ids == brute_force(data, data[q], 10)
+            assert result.distances == sorted(result.distances)
+
+    def test_parallel_build_with_per_shard_indexes(self, data):
+        db = ShardedVegamDB(4)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=4)
+        db.shard(2).use_hnsw_index(M=16)
+        db.build_index()
+
+        params = IVFSearchParams()
+        params.n_probe = 4
+        for q in (7, 2048):
+            assert db.search(data[q], k=1, params=params).ids == [q]
+
+        db.build_shard(1)
+        assert db.search(data[7], k=1, params=params).ids == [7]
+
+    def test_filter_and_remove_use_global_ids(self, data):
+        db = ShardedVegamDB(4)
+        db.add_vector_numpy(data)
+        allowed = set(range(0, 3000, 7))
+        result = db.search(data[0], k=5, filter=Bitmap(sorted(allowed)))
+        assert result.ids == brute_force(data, data[0], 5, allowed)
+
+        db.remove([0, 7])
+        assert db.is_deleted(7) and db.deleted_count() == 2
+        assert 0 not in db.search(data[0], k=5).ids
+        with pytest.raises(ValueError):
+            db.remove([3000])
+
+    def test_query_dimension_mismatch_raises(self, data):
+        db = ShardedVegamDB(2)
+        db.add_vector_numpy(data)
+        with pytest.raises(ValueError):
+            db.search([0.5] * 4096, k=5)
+
+    def test_stats_sum_over_shards(self, data):
+        db = ShardedVegamDB(4)
+        db.add_vector_numpy(data)
+        stats = SearchStats()
+        db.search(data[0], k=5, stats=stats)
+        assert stats.distance_computations == 3000
+        assert db.search_stats().queries == 1
+
+    def test_save_load_round_trip(self, data, tmp_path):
+        path = str(tmp_path / "sharded.vegam")
+        db = ShardedVegamDB(3, policy=ShardPolicy.RANGE, range_size=500)
+        db.add_vector_numpy(data)
+        db.use_ivf_index(n_clusters=4, n_probe=4)
+        db.build_index()
+        db.remove([42])
+        db.save(path)
+
+        loaded = ShardedVegamDB(1)
+        loaded.load(path)
+        assert loaded.shard_count() == 3
+        assert loaded.policy() == ShardPolicy.RANGE
+        assert loaded.size() == 3000
+        assert loaded.is_deleted(42)
+        assert loaded.search(data[17], k=5).ids == db.search(data[17], k=5).ids
+
+    def test_failed_save_keeps_previous_snapshot(self, data, tmp_path):
+        path = str(tmp_path / "sharded.vegam")
+        db = ShardedVegamDB(2, policy=ShardPolicy.RANGE, range_size=500)
+        db.add_vector_numpy(data[:1000])
+        db.save(path)
+
+        # Stop the next save after shard 0: shard 1 cannot be renamed
+        # over a directory
+        db.add_vector_numpy(data[1000:])
+        os.mkdir(path + ".g2.shard1")
+        with pytest.raises(RuntimeError):
+            db.save(path)
+
+        loaded = ShardedVegamDB(1)
+        loaded.load(path)
+        assert loaded.size() == 1000
+        assert loaded.search(data[3], k=1).ids == [3]
+
+        if os.path.isdir(path + ".g2.shard1"):
+            os.rmdir(path + ".g2.shard1")
+        db.save(path)
+        loaded.load(path)
+        assert loaded.size() == 3000
+        assert not os.path.exists(path + ".g1.shard0")
+
+    def test_shard_outlives_load(self, data, tmp_path):
+        path = str(tmp_path / "sharded.vegam")
+        ShardedVegamDB(2).save(path)
+        db = ShardedVegamDB(2)
+        db.add_vector_numpy(data)
+        old = db.shard(0)
+        rows = old.size()
+        db.load(path)
+        assert db.size() == 0
+        assert old.size() == rows
+        assert len(old.search(data[0].tolist(), k=3).ids) == 3
+
+    def test_load_missing_file_raises(self, tmp_path):
+        with pytest.raises(RuntimeError):
+            ShardedVegamDB(2).load(str(tmp_path / "missing.vegam"))
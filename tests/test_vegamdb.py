@@ -55,6 +55,31 @@ class TestAddVectorNumpy:
         assert db.size() == 12
         assert db.dimension() == 3
 
+    def test_dimension_mismatch_raises(self, db):
+        db.add_vector_numpy(np.random.random((10, 8)).astype(np.float32))
+        with pytest.raises(ValueError):
+            db.add_vector_numpy(np.random.random((5, 9)).astype(np.float32))
+        assert db.size() == 10
+
+    def test_float64_converted_with_warning(self, db):
+        data = np.random.RandomState(0).random_sample((20, 16))
+        with pytest.warns(RuntimeWarning):
+            db.add_vector_numpy(data)
+        assert db.size() == 20
+        results = db.search(data[7].astype(np.float32), k=1)
+        assert results.ids[0] == 7
+
+    def test_non_contiguous_converted_with_warning(self, db):
+        """Strided views must be read by stride, not as raw memory."""
+        full = np.random.RandomState(0).random_sample((20, 32)).astype(np.float32)
+        view = full[:, ::2]
+        with pytest.warns(RuntimeWarning):
+            db.add_vector_numpy(view)
+        assert db.dimension() == 16
+        results = db.search(np.ascontiguousarray(view[5]), k=1)
+        assert results.ids[0] == 5
+        assert results.distances[0] == pytest.approx(0.0, abs=1e-6)
+
 
 class TestEmptyDB:
     """Edge cases for empty databases."""
@@ -0,0 +1,156 @@
+"""Tests for removal, atomic saves and the write-ahead log."""
+
+import os
+import numpy as np
+import pytest
+from vegamdb import VegamDB
+
+
+@pytest.fixture
+def snapshot(tmp_path):
+    """Returns a temp snapshot path; its log lives at <path>.wal."""
+    return str(tmp_path / "db.vegam")
+
+
+def make_data(n=200, dim=16, seed=0):
+    return np.random.RandomState(seed).random((n, dim)).astype(np.float32)
+
+
+class TestRemove:
+
+    def test_removed_ids_are_not_returned(self, populated_db):
+        db, data = populated_db
+        db.remove([0, 5])
+
+        assert db.size() == 1000
+        assert db.deleted_count() == 2
+        assert db.is_deleted(0) and not db.is_deleted(1)
+        assert 0 not in db.search(data[0], k=10).ids
+
+    def test_remove_with_filter(self, populated_db):
+        db, data = populated_db
+        db.remove([2])
+        results = db.search(data[2], k=5, filter=[1, 2, 3])
+        assert sorted(results.ids) == [1, 3]
+
+    def test_remove_with_ivf(self, populated_db):
+        db, data = populated_db
+        db.use_ivf_index(n_clusters=10, max_iters=10, n_probe=10)
+        db.build_index()
+        db.remove([7])
+        assert 7 not in db.search(data[7], k=5).ids
+
+    def test_out_of_range_raises(self, populated_db):
+        db, _ = populated_db
+        with pytest.raises(ValueError):
+            db.remove([0, 1000])
+        assert db.deleted_count() == 0
+
+    def test_tombstones_persist(self, populated_db, snapshot):
+        db, _ = populated_db
+        db.remove([10, 20])
+        db.save(snapshot)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.deleted_count() == 2
+        assert db2.is_deleted(10) and db2.is_deleted(20)
+
+
+class TestAtomicSave:
+
+    def test_no_temp_file_left(self, populated_db, snapshot):
+        db, _ = populated_db
+        db.save(snapshot)
+        db.save(snapshot)
+        assert os.listdir(os.path.dirname(snapshot)) == ["db.vegam"]
+
+
+class TestWriteAheadLog:
+
+    def test_replays_changes_after_snapshot(self, snapshot):
+        data = make_data()
+        db = VegamDB()
+        db.add_vector_numpy(data[:100])
+        db.save(snapshot)
+        db.enable_wal(snapshot)
+        assert db.wal_enabled()
+
+        db.add_vector_numpy(data[100:])
+        db.remove([3])
+        del db  # No save: the changes live only in the log
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.size() == 200
+        assert db2.is_deleted(3)
+        assert db2.search(data[150], k=1).ids == [150]
+
+    def test_save_checkpoints_the_log(self, snapshot):
+        data = make_data()
+        db = VegamDB()
+        db.enable_wal(snapshot)
+        db.add_vector_numpy(data)
+        db.save(snapshot)
+        assert os.path.getsize(snapshot + ".wal") == 8  # Magic only
+
+        db.remove([0])
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.size() == 200
+        assert db2.deleted_count() == 1
+
+    def test_log_without_snapshot(self, snapshot):
+        data = make_data()
+        db = VegamDB()
+        db.enable_wal(snapshot, sync=False)
+        db.add_vector_numpy(data)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.size() == 200
+
+    def test_torn_tail_is_ignored(self, snapshot):
+        data = make_data()
+        db = VegamDB()
+        db.enable_wal(snapshot)
+        db.add_vector_numpy(data[:50])
+        db.add_vector_numpy(data[50:])
+        db.disable_wal()
+
+        # Cut the last record in half, as a crash mid-append would
+        wal = snapshot + ".wal"
+        with open(wal, "r+b") as f:
+            f.truncate(os.path.getsize(wal) - 100)
+
+        db2 = VegamDB()
+        db2.load(snapshot)
+        assert db2.size() == 50
+
+    def test_unapplied_log_is_rejected(self, snapshot):
+        db = VegamDB()
+        db.enable_wal(snapshot)
+        db.add_vector_numpy(make_data())
+
+        with pytest.raises(RuntimeError):
+            VegamDB().enable_wal(snapshot)
+
+    @pytest.mark.parametrize("with_snapshot", [False, True])
+    def test_bad_log_leaves_database_untouched(self, snapshot, with_snapshot):
+        if with_snapshot:
+            other = VegamDB()
+            other.add_vector_numpy(make_data(n=5, dim=4))
+            other.save(snapshot)
+        with open(snapshot + ".wal", "wb") as f:
+            f.write(b"not a log" * 10)
+
+        data = make_data(n=8)
+        db = VegamDB()
+        db.add_vector_numpy(data)
+        db.remove([3])
+        with pytest.raises(RuntimeError):
+            db.load(snapshot)
+
+        assert db.size() == 8 and db.dimension() == 16
+        assert db.is_deleted(3)
+        assert db.search(data[5].tolist(), k=1).ids == [5]
@@ -1,14 +1,38 @@
 from vegamdb._vegamdb import (
     VegamDB,
+    ShardedVegamDB,
+    ShardPolicy,
+    Metric,
+    Compression,
+    HugePages,
+    HugePageStatus,
     FlatIndex,
     IVFIndex,
+    CoarseQuantizer,
+    IVFStorage,
+    ListSizeStats,
     AnnoyIndex,
+    HNSWIndex,
+    DiskANNIndex,
     SearchResults,
+    BuildProgress,
+    SearchStats,
+    SearchStatsSummary,
     SearchParams,
     IVFSearchParams,
     AnnoyIndexParams,
+    HNSWSearchParams,
+    DiskANNSearchParams,
+    Bitmap,
+    Predicate,
     KMeans,
     KMeansIndex,
+    read_ivecs,
+    compression_available,
+    set_huge_pages,
+    huge_page_status,
+    set_numa_aware,
+    numa_nodes,
 )
 
 __version__ = "0.1.3"
\ No newline at end of file
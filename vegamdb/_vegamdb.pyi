@@ -3,11 +3,110 @@
 # Type stubs for the compiled C++ extension module.
 # Provides IDE autocomplete and type checking support.
 
-from typing import List, Optional, Union
+from typing import Callable, List, Optional, Tuple, Union, overload
 
 import numpy
 
 
+class Metric:
+    """Similarity metric of a database.
+
+    All metrics are reported as distances where smaller is closer:
+        L2: squared Euclidean distance.
+        IP: negated inner product (maximum inner product search).
+        COSINE: 1 - cosine similarity. Vectors are normalized on insert.
+    """
+
+    L2: "Metric"
+    IP: "Metric"
+    COSINE: "Metric"
+
+
+class Compression:
+    """Compression for VegamDB.save().
+
+    Applies to the index and attribute sections; vectors are stored raw.
+    NONE: No compression (IVF ids are still delta-encoded).
+    ZSTD: zstd level 1. Only in builds with VEGAMDB_WITH_ZSTD; check
+        compression_available().
+    """
+
+    NONE: "Compression"
+    ZSTD: "Compression"
+
+
+def compression_available(compression: Compression) -> bool:
+    """True if this build can write and read the given Compression."""
+    ...
+
+
+class HugePages:
+    """Backing for large buffers.
+
+    Applies to buffers of 2 MB or more: the vector store, IVF lists and
+    HNSW adjacency. Linux only; elsewhere every mode behaves like OFF.
+    OFF: Regular 4 KB pages.
+    TRANSPARENT: madvise(MADV_HUGEPAGE) on 2 MB aligned mappings (default).
+    EXPLICIT: MAP_HUGETLB pages from the pool reserved in
+        /proc/sys/vm/nr_hugepages; falls back to TRANSPARENT when empty.
+    """
+
+    OFF: "HugePages"
+    TRANSPARENT: "HugePages"
+    EXPLICIT: "HugePages"
+
+
+class HugePageStatus:
+    """What the live large buffers obtained, from huge_page_status().
+
+    Attributes:
+        mode: Current HugePages mode.
+        supported: False on platforms without huge page support.
+        explicit_bytes: Bytes backed by hugetlbfs pages.
+        transparent_bytes: Bytes the kernel accepted
+            madvise(MADV_HUGEPAGE) for.
+        regular_bytes: Bytes of large buffers left on regular pages.
+        explicit_fallbacks: EXPLICIT allocations the pool could not serve.
+        anon_huge_bytes: Transparent huge page memory of the whole process
+            as reported by the kernel, or -1 if unavailable.
+    """
+
+    mode: HugePages
+    supported: bool
+    explicit_bytes: int
+    transparent_bytes: int
+    regular_bytes: int
+    explicit_fallbacks: int
+    anon_huge_bytes: int
+
+
+def set_huge_pages(mode: HugePages) -> None:
+    """Set the HugePages mode for buffers allocated from now on. Existing
+    buffers keep their pages until they are reallocated."""
+    ...
+
+
+def huge_page_status() -> HugePageStatus:
+    """Report how the live large buffers are backed (HugePageStatus)."""
+    ...
+
+
+def set_numa_aware(enabled: bool) -> None:
+    """Split stored vectors into one partition per NUMA node.
+
+    Each partition's pages are bound to its node as vectors are added or
+    loaded, and large Flat and IVF scans run each partition on threads
+    pinned to that node before merging the results. A no-op on
+    single-node machines. Off by default.
+    """
+    ...
+
+
+def numa_nodes() -> int:
+    """Number of NUMA nodes with CPUs (1 on single-node machines)."""
+    ...
+
+
 class SearchResults:
     """Container returned by VegamDB.search().
 
@@ -22,6 +121,162 @@ class SearchResults:
     """List of distances corresponding to each neighbor."""
 
 
+class SearchStats:
+    """Statistics for a single search.
+
+    Pass an instance as ``VegamDB.search(..., stats=s)``; it is overwritten
+    with what that query did. Times are in microseconds.
+    """
+
+    def __init__(self) -> None: ...
+
+    distance_computations: int
+    """Vector and centroid distances computed."""
+    lists_visited: int
+    """IVF inverted lists scanned."""
+    nodes_visited: int
+    """Annoy internal nodes evaluated / HNSW nodes expanded / DiskANN
+    nodes read from disk."""
+    leaves_visited: int
+    """Annoy leaves collected."""
+    candidates: int
+    """Vectors scored."""
+    duplicates_removed: int
+    """Candidates found in more than one leaf."""
+    filter_fallback: bool
+    """True if a selective filter took the exact path."""
+    ranking_us: float
+    """IVF centroid ranking / Annoy, HNSW or DiskANN traversal."""
+    scan_us: float
+    """List scan (IVF), full scan (Flat), candidate scoring (Annoy)."""
+    rerank_us: float
+    """Selecting the final top-k."""
+    total_us: float
+    """Whole search call."""
+
+
+class SearchStatsSummary:
+    """Aggregate statistics from VegamDB.search_stats().
+
+    Counters and times (microseconds) are sums over ``queries`` searches.
+    Histograms are power-of-two buckets: bucket 0 counts zeros and bucket
+    i counts values in [2**(i-1), 2**i).
+    """
+
+    queries: int
+    distance_computations: int
+    lists_visited: int
+    nodes_visited: int
+    leaves_visited: int
+    candidates: int
+    duplicates_removed: int
+    filter_fallbacks: int
+    ranking_us: float
+    scan_us: float
+    rerank_us: float
+    total_us: float
+    latency_histogram_us: List[int]
+    distance_histogram: List[int]
+
+    def latency_percentile_us(self, p: float) -> float:
+        """Approximate latency percentile (p in [0, 100]): the upper edge
+        of the histogram bucket holding that rank."""
+        ...
+
+
+class BuildProgress:
+    """Progress of the current or last VegamDB.build_index() call.
+
+    ``done`` / ``total`` count work units of the current phase: for IVF's
+    "kmeans" phase, vectors assigned across all iterations (SQ8 storage
+    then reports "sq8", two passes over the vectors); for Annoy's
+    "trees" phase, trees built. HNSW reports "graph" (vectors inserted).
+    DiskANN reports "pq" (subspaces trained), "graph" (two insertion
+    passes over the vectors) and "write" (nodes laid out on disk).
+    """
+
+    running: bool
+    index: str
+    phase: str
+    done: int
+    total: int
+    elapsed_seconds: float
+
+    @property
+    def fraction(self) -> float:
+        """done / total (0 if total is 0)."""
+        ...
+
+    @property
+    def phases(self) -> List[Tuple[str, float]]:
+        """Completed phases as (name, seconds) tuples."""
+        ...
+
+
+class Bitmap:
+    """Allow-list of vector ids for filtered search.
+
+    Only ids contained in the bitmap can appear in search results. The
+    filter is applied inside the index scan, so k results are returned
+    whenever at least k ids are allowed.
+
+    Example::
+
+        allowed = Bitmap([3, 17, 42])
+        results = db.search(query, k=5, filter=allowed)
+    """
+
+    @overload
+    def __init__(self) -> None:
+        """Create an empty bitmap."""
+        ...
+    @overload
+    def __init__(self, ids: List[int]) -> None:
+        """Create a bitmap with the given ids set."""
+        ...
+    def add(self, id: int) -> None:
+        """Allow the given id."""
+        ...
+    def remove(self, id: int) -> None:
+        """Disallow the given id."""
+        ...
+    def to_list(self) -> List[int]:
+        """Return the allowed ids in ascending order."""
+        ...
+    def __len__(self) -> int: ...
+    def __contains__(self, id: int) -> bool: ...
+    def __and__(self, other: "Bitmap") -> "Bitmap": ...
+    def __or__(self, other: "Bitmap") -> "Bitmap": ...
+
+
+class Predicate:
+    """Filter over a per-vector attribute column.
+
+    Predicates are compiled into a Bitmap inside the engine and cached, so
+    filtered queries never call back into Python per candidate.
+
+    Example::
+
+        db.set_int_attribute("tenant_id", tenant_ids)
+        results = db.search(query, k=5, filter=Predicate.eq("tenant_id", 7))
+    """
+
+    @staticmethod
+    def eq(column: str, value: Union[int, float, str]) -> "Predicate":
+        """Rows whose value equals `value`."""
+        ...
+    @staticmethod
+    def isin(column: str, values: List[Union[int, float, str]]) -> "Predicate":
+        """Rows whose value is one of `values`."""
+        ...
+    @staticmethod
+    def range(
+        column: str, lo: Union[int, float], hi: Union[int, float]
+    ) -> "Predicate":
+        """Rows whose numeric value lies in [lo, hi] (inclusive)."""
+        ...
+
+
 class SearchParams:
     """Base class for index-specific search parameters."""
 
@@ -34,6 +289,11 @@ class IVFSearchParams(SearchParams):
     Attributes:
         n_probe: Number of clusters to probe during search.
             Higher values improve recall at the cost of speed. Default: 1.
+        coarse_ef: Candidate list size when an HNSW coarse quantizer
+            ranks the clusters. 0 (default) uses max(64, 8 * n_probe).
+        rerank_factor: With SQ8 storage, re-score the best
+            k * rerank_factor candidates with the full vectors. 0 (default)
+            returns the approximate code distances.
 
     Example::
 
@@ -44,6 +304,10 @@ class IVFSearchParams(SearchParams):
 
     n_probe: int
     """Number of clusters to probe during search (default: 1)."""
+    coarse_ef: int
+    """Candidate list size of the HNSW coarse quantizer (0: automatic)."""
+    rerank_factor: int
+    """SQ8 storage: candidates re-scored exactly, as a multiple of k (0: no re-rank)."""
     def __init__(self) -> None: ...
 
 
@@ -71,6 +335,48 @@ class AnnoyIndexParams(SearchParams):
     def __init__(self) -> None: ...
 
 
+class HNSWSearchParams(SearchParams):
+    """Search parameters for the HNSW index.
+
+    Attributes:
+        ef_search: Candidate list size at query time (raised to k if
+            smaller). Higher values improve recall at the cost of speed.
+
+    Example::
+
+        params = HNSWSearchParams()
+        params.ef_search = 200
+        results = db.search(query, k=10, params=params)
+    """
+
+    ef_search: int
+    """Candidate list size at query time (default: 50)."""
+    def __init__(self) -> None: ...
+
+
+class DiskANNSearchParams(SearchParams):
+    """Search parameters for the DiskANN index.
+
+    Attributes:
+        search_list: Candidate list size L (raised to k if smaller, and
+            scaled by 1 / the fraction of ids a filter allows). Higher
+            values improve recall at the cost of more disk reads.
+        beam_width: Nodes read from disk per round trip. Default: 4.
+
+    Example::
+
+        params = DiskANNSearchParams()
+        params.search_list = 200
+        results = db.search(query, k=10, params=params)
+    """
+
+    search_list: int
+    """Candidate list size L (default: 100)."""
+    beam_width: int
+    """Nodes read from disk per round trip (default: 4)."""
+    def __init__(self) -> None: ...
+
+
 class IndexBase:
     """Abstract base class for all index types."""
 
@@ -80,7 +386,52 @@ class IndexBase:
 class FlatIndex(IndexBase):
     """Brute-force flat index for exact nearest neighbor search."""
 
-    def __init__(self) -> None: ...
+    def __init__(self, metric: Metric = Metric.L2) -> None: ...
+
+
+class CoarseQuantizer:
+    """How an IVF index ranks its clusters.
+
+    FLAT: Score every centroid and keep the n_probe closest (exact).
+    HNSW: Search an HNSW graph over the centroids; sublinear in
+        n_clusters, worth it from about 16k clusters.
+    """
+
+    FLAT: "CoarseQuantizer"
+    HNSW: "CoarseQuantizer"
+
+
+class IVFStorage:
+    """What an IVF index stores in its lists.
+
+    FULL: Ids only; scans read the full vectors.
+    SQ8: Each vector's residual to its centroid as one byte per
+        dimension. Scans read 4x fewer bytes; distances are approximate
+        unless IVFSearchParams.rerank_factor re-scores them.
+    """
+
+    FULL: "IVFStorage"
+    SQ8: "IVFStorage"
+
+
+class ListSizeStats:
+    """Distribution of IVF list sizes, in rows.
+
+    A query scans the lists it probes, so ``max`` and the upper
+    percentiles bound its tail latency. ``imbalance`` is max / mean (1.0
+    is perfectly even).
+    """
+
+    lists: int
+    empty: int
+    min: int
+    max: int
+    mean: float
+    stddev: float
+    p50: int
+    p90: int
+    p99: int
+    imbalance: float
 
 
 class IVFIndex(IndexBase):
@@ -92,8 +443,21 @@ class IVFIndex(IndexBase):
         dimension: int,
         max_iters: int = 50,
         n_probe: int = 1,
+        metric: Metric = Metric.L2,
+        coarse_quantizer: CoarseQuantizer = CoarseQuantizer.FLAT,
+        storage: IVFStorage = IVFStorage.FULL,
+        max_list_factor: float = 0.0,
+        spill: int = 1,
     ) -> None: ...
 
+    def list_sizes(self) -> List[int]:
+        """Rows in each list, in list order (empty before build)."""
+        ...
+
+    def list_size_stats(self) -> ListSizeStats:
+        """Summary of the list size distribution (see ListSizeStats)."""
+        ...
+
 
 class AnnoyIndex(IndexBase):
     """Approximate Nearest Neighbors using random projection trees."""
@@ -105,14 +469,58 @@ class AnnoyIndex(IndexBase):
         k_leaf: int,
         search_k: int = -1,
         use_priority_queue: bool = True,
+        metric: Metric = Metric.L2,
+    ) -> None: ...
+
+
+class HNSWIndex(IndexBase):
+    """In-memory HNSW graph with concurrent, incremental inserts."""
+
+    def __init__(
+        self,
+        M: int = 16,
+        ef_construction: int = 200,
+        ef_search: int = 50,
+        metric: Metric = Metric.L2,
+    ) -> None: ...
+
+
+class DiskANNIndex(IndexBase):
+    """Disk-resident Vamana graph searched with PQ-guided beam search."""
+
+    def __init__(
+        self,
+        dimension: int,
+        graph_path: str,
+        max_degree: int = 64,
+        build_list: int = 100,
+        alpha: float = 1.2,
+        search_list: int = 100,
+        beam_width: int = 4,
+        pq_subspaces: int = 0,
+        metric: Metric = Metric.L2,
     ) -> None: ...
 
+    @property
+    def graph_path(self) -> str:
+        """File holding the graph and full vectors."""
+        ...
+
+    @property
+    def uses_io_uring(self) -> bool:
+        """True if disk reads are batched with io_uring."""
+        ...
+
 
 class VegamDB:
     """A high-performance vector database with pluggable index types."""
 
-    def __init__(self) -> None:
-        """Create a new empty VegamDB instance."""
+    def __init__(self, metric: Metric = Metric.L2) -> None:
+        """Create a new empty VegamDB instance using the given metric."""
+        ...
+
+    def metric(self) -> Metric:
+        """Return the similarity metric of the database."""
         ...
 
     def dimension(self) -> int:
@@ -124,16 +532,111 @@ class VegamDB:
         ...
 
     def add_vector_numpy(self, input_array: numpy.ndarray) -> None:
-        """Add vectors from a NumPy float32 array (zero-copy).
+        """Add vectors from a NumPy array.
+
+        A C-contiguous float32 array is copied once, as a single block,
+        directly into the store. Other dtypes or layouts are converted to
+        a temporary float32 array first and emit a RuntimeWarning.
 
         Args:
             input_array: 1D array of shape (dim,) for a single vector,
                 or 2D array of shape (n_vectors, dim) for batch insertion.
+
+        Raises:
+            RuntimeError: If the array is not 1D or 2D.
+            ValueError: If the vector dimension differs from the stored one.
         """
         ...
 
+    def add_from_file(self, path: str, max_rows: int = 0) -> int:
+        """Add vectors from an .fvecs, .bvecs or .npy file.
+
+        The file is memory-mapped and streamed into the store in C++,
+        without a NumPy round trip. uint8 and float64 data are converted
+        to float32. The file is added whole or not at all: if reading
+        fails part way, no rows are added or logged.
+
+        Args:
+            path: Path ending in .fvecs, .bvecs or .npy.
+            max_rows: Read at most this many vectors (0 = all).
+
+        Returns:
+            Number of vectors added.
+
+        Raises:
+            ValueError: For an unknown extension, integer data, or a
+                dimension that differs from the stored one.
+            RuntimeError: If the file is unreadable or malformed.
+        """
+        ...
+
+    def attach_numpy(self, array: numpy.ndarray) -> None:
+        """Search a caller-owned array in place instead of copying it.
+
+        The database keeps a reference to the array and becomes read-only.
+        Works with np.memmap. For COSINE the rows must be unit-norm.
+
+        Args:
+            array: 2D C-contiguous float32 array of shape (n_vectors, dim).
+
+        Raises:
+            ValueError: If the array has the wrong shape, dtype or layout.
+            RuntimeError: If the database already holds vectors.
+        """
+        ...
+
+    def is_external(self) -> bool:
+        """True if the database wraps an array attached with attach_numpy(),
+        or a DiskANN snapshot whose vectors load() left on disk."""
+        ...
+
     def size(self) -> int:
-        """Return the number of vectors stored in the database."""
+        """Return the number of vectors stored in the database, including
+        removed ones (ids are never reused)."""
+        ...
+
+    def remove(self, ids: List[int]) -> None:
+        """Remove vectors by id. Removed vectors never appear in search
+        results; their ids are not reused.
+
+        Raises:
+            ValueError: If an id is out of range (nothing is removed).
+        """
+        ...
+
+    def is_deleted(self, id: int) -> bool:
+        """True if the vector with this id was removed."""
+        ...
+
+    def deleted_count(self) -> int:
+        """Number of removed vectors."""
+        ...
+
+    def set_int_attribute(
+        self, name: str, values: Union[List[int], numpy.ndarray]
+    ) -> None:
+        """Set an int64 attribute column (one value per vector)."""
+        ...
+
+    def set_float_attribute(
+        self, name: str, values: Union[List[float], numpy.ndarray]
+    ) -> None:
+        """Set a float attribute column (one value per vector)."""
+        ...
+
+    def set_string_attribute(self, name: str, values: List[str]) -> None:
+        """Set a string/enum attribute column (one value per vector).
+
+        Values are dictionary-encoded.
+        """
+        ...
+
+    def attribute_names(self) -> List[str]:
+        """Return the names of all attribute columns."""
+        ...
+
+    def evaluate(self, predicate: Predicate) -> Bitmap:
+        """Compile a predicate into a Bitmap of matching vector ids."""
         ...
 
     def use_flat_index(self) -> None:
@@ -141,7 +644,14 @@ class VegamDB:
         ...
 
     def use_ivf_index(
-        self, n_clusters: int, max_iters: int = 50, n_probe: int = 1
+        self,
+        n_clusters: int,
+        max_iters: int = 50,
+        n_probe: int = 1,
+        coarse_quantizer: CoarseQuantizer = CoarseQuantizer.FLAT,
+        storage: IVFStorage = IVFStorage.FULL,
+        max_list_factor: float = 0.0,
+        spill: int = 1,
     ) -> None:
         """Set the index to IVF (Inverted File Index) for approximate search.
 
@@ -149,6 +659,19 @@ class VegamDB:
             n_clusters: Number of Voronoi cells (clusters) for partitioning.
             max_iters: Maximum K-Means iterations for training (default: 50).
             n_probe: Number of clusters to search at query time (default: 1).
+            coarse_quantizer: CoarseQuantizer.HNSW ranks clusters with a
+                graph over the centroids instead of scoring them all
+                (default: FLAT).
+            storage: IVFStorage.SQ8 keeps 8-bit residual codes in the
+                lists and scans those instead of the vectors (default: FULL).
+            max_list_factor: Balanced k-means: no list holds more than
+                max(1, factor) times the mean list size. 0 (default) leaves
+                list sizes to plain k-means.
+            spill: Lists each vector is stored in: its own cluster plus the
+                spill - 1 next-closest ones (default: 1). Vectors near
+                cluster boundaries are then found with a smaller n_probe,
+                at spill times the id (and SQ8 code) memory; repeats are
+                dropped at search time.
         """
         ...
 
@@ -164,8 +687,82 @@ class VegamDB:
         """
         ...
 
-    def build_index(self) -> None:
-        """Explicitly build/train the current index on stored vectors."""
+    def use_hnsw_index(
+        self, M: int = 16, ef_construction: int = 200, ef_search: int = 50
+    ) -> None:
+        """Set the index to HNSW (Hierarchical Navigable Small World).
+
+        Once built, the index stays current: add_vector_numpy() links new
+        vectors into the graph (on all cores for large batches) before it
+        returns, while searches from other threads keep running.
+
+        Args:
+            M: Links per node per layer; layer 0 gets 2 * M (default: 16).
+            ef_construction: Candidate list size while inserting
+                (default: 200).
+            ef_search: Default candidate list size at query time
+                (default: 50).
+        """
+        ...
+
+    def use_diskann_index(
+        self,
+        graph_path: str,
+        max_degree: int = 64,
+        build_list: int = 100,
+        alpha: float = 1.2,
+        search_list: int = 100,
+        beam_width: int = 4,
+        pq_subspaces: int = 0,
+    ) -> None:
+        """Set the index to a disk-resident DiskANN (Vamana) graph.
+
+        build_index() writes the graph, with a full-precision copy of every
+        vector, to ``graph_path`` in 4 KiB-aligned blocks. Only PQ codes
+        stay in memory. Searches read nodes from that file, so it must stay
+        in place; save() records its path.
+
+        Args:
+            graph_path: File to write the graph to.
+            max_degree: Neighbors per node R (default: 64).
+            build_list: Candidate list size during construction.
+            alpha: Pruning slack; > 1 keeps long-range edges (default: 1.2).
+            search_list: Default candidate list size L at query time.
+            beam_width: Default nodes read per disk round trip.
+            pq_subspaces: PQ bytes per vector held in memory
+                (0: dimension / 4).
+        """
+        ...
+
+    def build_index(
+        self, callback: Optional[Callable[[BuildProgress], None]] = None
+    ) -> None:
+        """Explicitly build/train the current index on stored vectors.
+
+        The GIL is released while building, so other Python threads can
+        poll build_progress() (searches wait for the build to finish).
+
+        Args:
+            callback: Optional callable taking a BuildProgress. Called on
+                the calling thread at each phase change and at most every
+                200 ms during a phase, while the build runs on a worker
+                thread.
+        """
+        ...
+
+    def ivf_list_sizes(self) -> List[int]:
+        """Rows in each list of the current IVF index, in list order.
+        Raises RuntimeError if the index is not IVF."""
+        ...
+
+    def ivf_list_size_stats(self) -> ListSizeStats:
+        """Summary of the current IVF index's list sizes (see
+        ListSizeStats). Raises RuntimeError if the index is not IVF."""
+        ...
+
+    def build_progress(self) -> BuildProgress:
+        """Return a BuildProgress snapshot of the current or last build.
+        Does not wait for a running build."""
         ...
 
     def search(
@@ -173,25 +770,301 @@ class VegamDB:
         query: Union[List[float], numpy.ndarray],
         k: int,
         params: Optional[SearchParams] = None,
+        filter: Optional[Union[Bitmap, Predicate, List[int], numpy.ndarray]] = None,
+        stats: Optional[SearchStats] = None,
     ) -> SearchResults:
         """Search for the k nearest neighbors of a query vector.
 
         Args:
             query: 1D list of floats representing the query vector.
             k: Number of nearest neighbors to return.
-            params: Optional IVFSearchParams or AnnoyIndexParams.
+            params: Optional IVFSearchParams, AnnoyIndexParams,
+                HNSWSearchParams or DiskANNSearchParams.
+            filter: Optional allow-list: a Bitmap, a list of ids, or a
+                Predicate over an attribute column. Only allowed ids are
+                returned. Very selective filters are answered by an exact
+                scan over the allowed ids.
+            stats: Optional SearchStats, overwritten with this query's
+                counters and phase timings.
 
         Returns:
             SearchResults with .ids (list[int]) and .distances (list[float]).
+
+        Raises:
+            ValueError: If the query's length differs from the stored
+                vectors' dimension.
+        """
+        ...
+
+    def search_stats(self) -> SearchStatsSummary:
+        """Aggregate statistics over all searches since creation or the
+        last reset_search_stats(). Safe to call while searching."""
+        ...
+
+    def reset_search_stats(self) -> None:
+        """Zero the aggregate search statistics."""
+        ...
+
+    def save(
+        self,
+        filename: str,
+        compression: Compression = Compression.NONE,
+        parallel: bool = True,
+    ) -> None:
+        """Save the database (vectors + index) to a binary file.
+
+        Each section is checksummed (CRC32C) and written in large blocks.
+        The snapshot goes to a temp file that is fsynced and renamed over
+        ``filename``, so a crash leaves either the old or the new file.
+        Saving to the path given to enable_wal() empties the log.
+
+        Args:
+            filename: Destination path.
+            compression: Compression for the index and attribute sections.
+                Raises ValueError if this build does not support it.
+            parallel: Serialize the index and attributes on worker threads
+                while the vectors are written (uses memory for a copy of
+                them).
+        """
+        ...
+
+    def load(self, filename: str) -> None:
+        """Load a database (vectors + index) from a binary file, then
+        replay ``filename``.wal if it exists.
+
+        A DiskANN snapshot's vectors are mapped read-only rather than
+        copied (when there is no log to replay), so the database becomes
+        read-only, as after attach_numpy().
+
+        Raises:
+            RuntimeError: If the file is corrupt, truncated or missing.
+        """
+        ...
+
+    def enable_wal(self, snapshot_path: str, sync: bool = True) -> None:
+        """Log every later add/remove to ``snapshot_path``.wal.
+
+        Each call is appended to the log before it is applied; load()
+        replays the records the snapshot does not contain, and
+        save(snapshot_path) empties the log. When reopening a database,
+        load() it before enabling the log. Attribute changes are not
+        logged.
+
+        Args:
+            snapshot_path: The snapshot file this log belongs to.
+            sync: fsync the log on every call (survives power loss). When
+                False, writes only reach the OS (survives a process crash).
+
+        Raises:
+            RuntimeError: If the log cannot be opened or holds changes
+                this database has not applied.
+        """
+        ...
+
+    def disable_wal(self) -> None:
+        """Stop logging adds and removes."""
+        ...
+
+    def wal_enabled(self) -> bool:
+        """True if a write-ahead log is enabled."""
+        ...
+
+
+class ShardPolicy:
+    """How ShardedVegamDB assigns ids to shards.
+
+    HASH: A hash of the id picks the shard; every batch spreads evenly.
+    RANGE: Runs of ``range_size`` consecutive ids go to the shards in turn.
+    """
+
+    HASH: "ShardPolicy"
+    RANGE: "ShardPolicy"
+
+
+class ShardedVegamDB:
+    """Vectors partitioned across independent shards.
+
+    Each shard is a VegamDB with its own index. Batches of vectors are
+    routed to their shards and added in parallel, build_index() builds all
+    shards in parallel, and search() queries every shard concurrently and
+    merges their top-k. Ids are global, in insertion order.
+    """
+
+    def __init__(
+        self,
+        n_shards: int,
+        policy: ShardPolicy = ShardPolicy.HASH,
+        metric: Metric = Metric.L2,
+        range_size: int = 4096,
+    ) -> None:
+        """Create an empty database with ``n_shards`` shards.
+
+        Raises:
+            ValueError: If n_shards or range_size is 0.
+        """
+        ...
+
+    def metric(self) -> Metric:
+        """Return the similarity metric of the database."""
+        ...
+
+    def policy(self) -> ShardPolicy:
+        """Return the ShardPolicy ids are routed by."""
+        ...
+
+    def shard_count(self) -> int:
+        """Return the number of shards."""
+        ...
+
+    def shard(self, i: int) -> VegamDB:
+        """Return shard ``i`` as a VegamDB, e.g. to give it its own index.
+        Its ids are local; global_id() translates them. A shard fetched
+        before load() stays usable but is no longer part of this database.
+
+        Raises:
+            IndexError: If i is out of range.
+        """
+        ...
+
+    def shard_of(self, id: int) -> int:
+        """Return the shard holding global id ``id``."""
+        ...
+
+    def global_id(self, shard: int, local_id: int) -> int:
+        """Translate a shard's local id into the global id."""
+        ...
+
+    def dimension(self) -> int:
+        """Return the dimensionality of stored vectors (0 if empty)."""
+        ...
+
+    def size(self) -> int:
+        """Return the number of vectors added, over all shards."""
+        ...
+
+    def add_vector(self, vec: Union[List[float], numpy.ndarray]) -> None:
+        """Add a single vector as a Python list of floats."""
+        ...
+
+    def add_vector_numpy(self, input_array: numpy.ndarray) -> None:
+        """Add vectors from a 1D or 2D NumPy array. Rows are routed to
+        their shards and each shard's rows are added on its own thread."""
+        ...
+
+    def remove(self, ids: List[int]) -> None:
+        """Tombstone vectors by global id.
+
+        Raises:
+            ValueError: If an id is out of range (nothing is removed).
+        """
+        ...
+
+    def is_deleted(self, id: int) -> bool:
+        """True if the vector with this id was removed."""
+        ...
+
+    def deleted_count(self) -> int:
+        """Number of removed vectors."""
+        ...
+
+    def use_flat_index(self) -> None:
+        """Give every shard a brute-force flat index."""
+        ...
+
+    def use_ivf_index(
+        self,
+        n_clusters: int,
+        max_iters: int = 50,
+        n_probe: int = 1,
+        coarse_quantizer: CoarseQuantizer = CoarseQuantizer.FLAT,
+        storage: IVFStorage = IVFStorage.FULL,
+        max_list_factor: float = 0.0,
+        spill: int = 1,
+    ) -> None:
+        """Give every shard an IVF index with ``n_clusters`` clusters of
+        its own (see VegamDB.use_ivf_index)."""
+        ...
+
+    def use_hnsw_index(
+        self, M: int = 16, ef_construction: int = 200, ef_search: int = 50
+    ) -> None:
+        """Give every shard an HNSW graph of its own (see
+        VegamDB.use_hnsw_index)."""
+        ...
+
+    def use_annoy_index(
+        self,
+        num_trees: int,
+        k_leaf: int,
+        search_k: int = -1,
+        use_priority_queue: bool = True,
+    ) -> None:
+        """Give every shard an Annoy forest of its own (see
+        VegamDB.use_annoy_index)."""
+        ...
+
+    def build_index(self) -> None:
+        """Build every non-empty shard in parallel. Shards without an
+        index get a flat one."""
+        ...
+
+    def build_shard(self, i: int) -> None:
+        """Build (or rebuild) shard ``i`` only; the others keep serving."""
+        ...
+
+    def search(
+        self,
+        query: Union[List[float], numpy.ndarray],
+        k: int,
+        params: Optional[SearchParams] = None,
+        filter: Optional[Union[Bitmap, List[int], numpy.ndarray]] = None,
+        stats: Optional[SearchStats] = None,
+    ) -> SearchResults:
+        """Search all shards concurrently and merge their top-k.
+
+        Args:
+            query: 1D list of floats representing the query vector.
+            k: Number of nearest neighbors to return.
+            params: Optional search parameters, passed to every shard.
+            filter: Optional allow-list of global ids: a Bitmap or a list.
+            stats: Optional SearchStats. Counters are summed over shards;
+                phase times are the slowest shard's.
+
+        Returns:
+            SearchResults with global ids, closest first.
+
+        Raises:
+            ValueError: If the query's length differs from the stored
+                vectors' dimension.
         """
         ...
 
-    def save(self, filename: str) -> None:
-        """Save the database (vectors + index) to a binary file."""
+    def search_stats(self) -> SearchStatsSummary:
+        """Aggregate statistics over all searches since creation or the
+        last reset_search_stats()."""
+        ...
+
+    def reset_search_stats(self) -> None:
+        """Zero the aggregate search statistics."""
+        ...
+
+    def save(
+        self, filename: str, compression: Compression = Compression.NONE
+    ) -> None:
+        """Save every shard, in parallel, to ``filename``.g<N>.shard<i> for
+        a new generation N, then a manifest to ``filename``, then delete
+        the previous generation. A crash mid-save leaves the previous
+        snapshot loadable."""
         ...
 
     def load(self, filename: str) -> None:
-        """Load a database (vectors + index) from a binary file."""
+        """Load a database saved by save(), replacing this one's shards
+        and configuration.
+
+        Raises:
+            RuntimeError: If a file is missing or a shard does not match
+                the manifest.
+        """
         ...
 
 
@@ -207,10 +1080,26 @@ class KMeansIndex:
 class KMeans:
     """Standalone K-Means clustering utility."""
 
-    def __init__(self, n_clusters: int, dimension: int, max_iters: int) -> None:
+    def __init__(
+        self,
+        n_clusters: int,
+        dimension: int,
+        max_iters: int,
+        metric: Metric = Metric.L2,
+        max_bucket_factor: float = 0.0,
+    ) -> None:
         """Create a KMeans instance with given parameters."""
         ...
 
     def train(self, data: List[List[float]]) -> KMeansIndex:
         """Train K-Means on the provided data and return a KMeansIndex."""
         ...
+
+
+def read_ivecs(path: str, max_rows: int = 0) -> numpy.ndarray:
+    """Read an .ivecs (or integer .npy) file, e.g. ground-truth neighbor ids.
+
+    Returns:
+        int32 array of shape (n_rows, dim).
+    """
+    ...